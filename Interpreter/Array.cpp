@@ -0,0 +1,351 @@
+
+#include "Array.h"
+
+#include <limits>
+
+namespace {
+
+// How far past the number of integer keys stored in the vector a new integer
+// key may be and still be stored there
+constexpr size_t MinimumGrowth = 16;
+
+/**
+ * @brief Get the integer which a key represents, if it is written the way the
+ * macro language formats non-negative integers (no sign or leading zeros).
+ *
+ * @param key The key to check.
+ * @return The integer, or -1 if the key isn't such an integer, including one
+ * too large for an int.
+ */
+int IndexOf(const std::string &key) {
+
+	if (key.empty() || (key[0] == '0' && key.size() > 1)) {
+		return -1;
+	}
+
+	constexpr int Max = std::numeric_limits<int>::max();
+
+	int index = 0;
+	for (char ch : key) {
+		if (ch < '0' || ch > '9') {
+			return -1;
+		}
+
+		const int digit = ch - '0';
+		if (index > (Max - digit) / 10) {
+			return -1;
+		}
+
+		index = index * 10 + digit;
+	}
+
+	return index;
+}
+
+}
+
+/**
+ * @brief Find the value of an element.
+ *
+ * @param index The integer key of the element.
+ * @return The element's value, or nullptr if there is no such element. The
+ * pointer is invalidated by any change to the array's keys.
+ */
+DataValue *Array::find(int index) {
+
+	if (index >= 0) {
+		if (static_cast<size_t>(index) < elements_.size()) {
+			std::optional<DataValue> &element = elements_[static_cast<size_t>(index)];
+			return element ? &*element : nullptr;
+		}
+
+		if (hashedIndexes_ == 0) {
+			return nullptr;
+		}
+	}
+
+	auto it = hashed_.find(std::to_string(index));
+	return (it != hashed_.end()) ? &it->second : nullptr;
+}
+
+/**
+ * @brief Find the value of an element.
+ *
+ * @param key The key of the element.
+ * @return The element's value, or nullptr if there is no such element. The
+ * pointer is invalidated by any change to the array's keys.
+ */
+DataValue *Array::find(const std::string &key) {
+
+	const int index = IndexOf(key);
+	if (index != -1) {
+		return find(index);
+	}
+
+	auto it = hashed_.find(key);
+	return (it != hashed_.end()) ? &it->second : nullptr;
+}
+
+/**
+ * @brief Set the value of an element, adding the element if necessary.
+ *
+ * @param index The integer key of the element.
+ * @param value The value to store.
+ */
+void Array::insert(int index, const DataValue &value) {
+
+	if (index < 0) {
+		insertHashed(std::to_string(index), value, false);
+		return;
+	}
+
+	const auto n = static_cast<size_t>(index);
+
+	if (n >= elements_.size()) {
+		if (n > elementCount_ * 2 + MinimumGrowth) {
+			insertHashed(std::to_string(index), value, true);
+			return;
+		}
+
+		grow(n + 1);
+	}
+
+	std::optional<DataValue> &element = elements_[n];
+	if (!element) {
+		++elementCount_;
+
+		// a loop which adds and erases keys without ever iterating would
+		// otherwise grow the list forever
+		if (addedIndexes_.size() >= elements_.size()) {
+			updateKeys();
+		}
+
+		addedIndexes_.push_back(index);
+	}
+
+	element = value;
+}
+
+/**
+ * @brief Set the value of an element, adding the element if necessary.
+ *
+ * @param key The key of the element.
+ * @param value The value to store.
+ */
+void Array::insert(const std::string &key, const DataValue &value) {
+
+	const int index = IndexOf(key);
+	if (index != -1) {
+		insert(index, value);
+		return;
+	}
+
+	insertHashed(key, value, false);
+}
+
+/**
+ * @brief Set the value of an element which is stored in the hash table.
+ *
+ * @param key The key of the element.
+ * @param value The value to store.
+ * @param isIndex `true` if the key is an integer which belongs in the vector
+ * once the vector grows far enough.
+ */
+void Array::insertHashed(std::string key, const DataValue &value, bool isIndex) {
+
+	auto [it, inserted] = hashed_.insert_or_assign(std::move(key), value);
+	if (inserted) {
+		keys_.insert(it->first);
+		if (isIndex) {
+			++hashedIndexes_;
+		}
+	}
+}
+
+/**
+ * @brief Lengthen the vector of integer keyed elements, moving any elements in
+ * the new range out of the hash table.
+ *
+ * @param size The new size of the vector.
+ */
+void Array::grow(size_t size) {
+
+	const size_t oldSize = elements_.size();
+	elements_.resize(size);
+
+	for (size_t n = oldSize; n < size && hashedIndexes_ != 0; ++n) {
+		auto it = hashed_.find(std::to_string(n));
+		if (it != hashed_.end()) {
+			elements_[n] = std::move(it->second);
+			hashed_.erase(it);
+			--hashedIndexes_;
+			++elementCount_;
+		}
+	}
+}
+
+/**
+ * @brief Remove an element.
+ *
+ * @param index The integer key of the element.
+ * @return `true` if the element existed, `false` otherwise.
+ */
+bool Array::erase(int index) {
+
+	if (index >= 0 && static_cast<size_t>(index) < elements_.size()) {
+		std::optional<DataValue> &element = elements_[static_cast<size_t>(index)];
+		if (!element) {
+			return false;
+		}
+
+		element.reset();
+		--elementCount_;
+
+		// if the key is still waiting in addedIndexes_, updateKeys() will skip it
+		keys_.erase(std::to_string(index));
+		return true;
+	}
+
+	if (index >= 0 && hashedIndexes_ == 0) {
+		return false;
+	}
+
+	const std::string key = std::to_string(index);
+	if (hashed_.erase(key) == 0) {
+		return false;
+	}
+
+	if (index >= 0) {
+		--hashedIndexes_;
+	}
+
+	keys_.erase(key);
+	return true;
+}
+
+/**
+ * @brief Remove an element.
+ *
+ * @param key The key of the element.
+ * @return `true` if the element existed, `false` otherwise.
+ */
+bool Array::erase(const std::string &key) {
+
+	const int index = IndexOf(key);
+	if (index != -1) {
+		return erase(index);
+	}
+
+	if (hashed_.erase(key) == 0) {
+		return false;
+	}
+
+	keys_.erase(key);
+	return true;
+}
+
+/**
+ * @brief Remove all of the elements.
+ */
+void Array::clear() {
+	elements_.clear();
+	hashed_.clear();
+	keys_.clear();
+	addedIndexes_.clear();
+	elementCount_  = 0;
+	hashedIndexes_ = 0;
+}
+
+/**
+ * @brief Get the number of elements.
+ *
+ * @return The number of elements.
+ */
+size_t Array::size() const noexcept {
+	return elementCount_ + hashed_.size();
+}
+
+/**
+ * @brief Get all of the keys in string order.
+ *
+ * @return The keys. The reference is invalidated by any change to the array's
+ * keys.
+ */
+const std::set<std::string> &Array::keys() {
+	updateKeys();
+	return keys_;
+}
+
+/**
+ * @brief Find the first key in string order.
+ *
+ * @param key Where to store the key.
+ * @return `true` if there is a key, `false` if the array is empty.
+ */
+bool Array::first(std::string *key) {
+
+	updateKeys();
+
+	if (keys_.empty()) {
+		return false;
+	}
+
+	*key = *keys_.begin();
+	return true;
+}
+
+/**
+ * @brief Find the key which follows `key` in string order. Elements may be
+ * added or removed between calls, including the one whose key is `key`.
+ *
+ * @param key The previous key, where the next key will be stored.
+ * @return `true` if there is a next key, `false` otherwise.
+ */
+bool Array::next(std::string *key) {
+
+	updateKeys();
+
+	auto it = keys_.upper_bound(*key);
+	if (it == keys_.end()) {
+		return false;
+	}
+
+	*key = *it;
+	return true;
+}
+
+/**
+ * @brief Find the first key which is not before `key` in string order. This is
+ * `key` itself unless its element has been removed.
+ *
+ * @param key The key to start from, where the key found will be stored.
+ * @return `true` if there is such a key, `false` otherwise.
+ */
+bool Array::seek(std::string *key) {
+
+	updateKeys();
+
+	auto it = keys_.lower_bound(*key);
+	if (it == keys_.end()) {
+		return false;
+	}
+
+	*key = *it;
+	return true;
+}
+
+/**
+ * @brief Add the integer keys which were added to the vector since the last
+ * update to the ordered keys.
+ */
+void Array::updateKeys() {
+
+	for (int index : addedIndexes_) {
+		// skip keys which have been erased since they were added
+		if (static_cast<size_t>(index) < elements_.size() && elements_[static_cast<size_t>(index)]) {
+			keys_.insert(std::to_string(index));
+		}
+	}
+
+	addedIndexes_.clear();
+}
@@ -0,0 +1,54 @@
+
+#ifndef ARRAY_H_
+#define ARRAY_H_
+
+#include "DataValue.h"
+
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief The elements of a macro language array.
+ *
+ * Keys which are non-negative integers, written the way the macro language
+ * formats integers, are stored in a vector indexed by the integer, as long as
+ * the vector stays reasonably dense, so that `a[i]` needs neither formatting
+ * nor hashing. All other keys are stored in a hash table.
+ *
+ * Iteration visits the keys in string order, as it always has, using an
+ * ordered set of the keys which is kept up to date as keys come and go. Only
+ * the formatting of new integer keys is put off until the keys are needed.
+ */
+class Array {
+public:
+	DataValue *find(int index);
+	DataValue *find(const std::string &key);
+	bool erase(int index);
+	bool erase(const std::string &key);
+	bool first(std::string *key);
+	bool next(std::string *key);
+	bool seek(std::string *key);
+	const std::set<std::string> &keys();
+	size_t size() const noexcept;
+	void clear();
+	void insert(int index, const DataValue &value);
+	void insert(const std::string &key, const DataValue &value);
+
+private:
+	void grow(size_t size);
+	void insertHashed(std::string key, const DataValue &value, bool isIndex);
+	void updateKeys();
+
+private:
+	std::vector<std::optional<DataValue>> elements_;    // values of the keys 0, 1, 2, ... indexed by the key
+	std::unordered_map<std::string, DataValue> hashed_; // values of all other keys
+	std::set<std::string> keys_;                        // all of the keys in string order, except those in addedIndexes_
+	std::vector<int> addedIndexes_;                     // integer keys added to elements_ which aren't in keys_ yet
+	size_t elementCount_  = 0;                          // the number of keys stored in elements_
+	size_t hashedIndexes_ = 0;                          // the number of integer keys which were too far past the end of elements_
+};
+
+#endif
@@ -4,8 +4,8 @@
 
 #include <QString>
 
+#include <algorithm>
 #include <limits>
-#include <map>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -14,6 +14,7 @@
 
 #include <gsl/span>
 
+class Array;
 class DocumentWidget;
 struct DataValue;
 struct Program;
@@ -21,15 +22,29 @@ union Inst;
 
 using Arguments      = gsl::span<DataValue>;
 using LibraryRoutine = std::error_code (*)(DocumentWidget *document, Arguments arguments, DataValue *result);
-using Array          = std::map<std::string, DataValue>;
 using ArrayPtr       = std::shared_ptr<Array>;
 
-// we use a kind of "fat iterator", because the arrayIter function
-// needs to know if the iterator is at the end of the map. This requirement
-// means that we need a reference to the map to compare against
+// we use a kind of "fat iterator", which remembers the key of the next element
+// to visit rather than pointing at an element, so that it stays valid while
+// the loop adds and removes elements
 struct ArrayIterator {
 	ArrayPtr m;
-	Array::iterator it;
+	std::string key; // the key of the next element to visit
+	bool atEnd = true;
+};
+
+// a read-only view of part of a string which is shared with other values, such
+// as a large range of a document's text, so that large strings can be passed
+// around without being copied. It behaves like a string in every other way
+struct StringSlice {
+	std::shared_ptr<const std::string> text;
+	size_t offset = 0;
+	size_t length = 0;
+	bool ascii    = false; // every character in the slice is 7-bit ASCII, so bytes and characters correspond
+
+	std::string_view view() const {
+		return std::string_view(*text).substr(offset, length);
+	}
 };
 
 using Data = std::variant<
@@ -41,7 +56,8 @@ using Data = std::variant<
 	LibraryRoutine,
 	Program *,
 	Inst *,
-	DataValue *>;
+	DataValue *,
+	StringSlice>;
 
 struct DataValue {
 	Data value;
@@ -92,6 +108,26 @@ inline DataValue make_value(std::string_view str) {
 	return DV;
 }
 
+inline DataValue make_value(const StringSlice &slice) {
+	DataValue DV;
+	DV.value = slice;
+	return DV;
+}
+
+inline DataValue make_value(const std::shared_ptr<const std::string> &text, size_t offset, size_t length) {
+	StringSlice slice;
+	slice.text   = text;
+	slice.offset = offset;
+	slice.length = length;
+
+	const std::string_view view = slice.view();
+	slice.ascii                 = std::all_of(view.begin(), view.end(), [](char ch) {
+		return static_cast<unsigned char>(ch) < 0x80;
+	});
+
+	return make_value(slice);
+}
+
 inline DataValue make_value(const QString &str) {
 	DataValue DV;
 	DV.value = str.toStdString();
@@ -131,7 +167,11 @@ inline bool is_integer(const DataValue &dv) {
 }
 
 inline bool is_string(const DataValue &dv) {
-	return dv.value.index() == 2;
+	return dv.value.index() == 2 || std::holds_alternative<StringSlice>(dv.value);
+}
+
+inline bool is_string_slice(const DataValue &dv) {
+	return std::holds_alternative<StringSlice>(dv.value);
 }
 
 inline bool is_array(const DataValue &dv) {
@@ -143,9 +183,26 @@ inline std::string to_string(const DataValue &dv) {
 	if (auto n = std::get_if<int>(&dv.value)) {
 		return std::to_string(*n);
 	}
+	if (auto slice = std::get_if<StringSlice>(&dv.value)) {
+		return std::string(slice->view());
+	}
+	return std::get<std::string>(dv.value);
+}
+
+// NOTE: unlike to_string, only for values which are strings, and the
+// view is only valid for as long as the value is
+inline std::string_view to_string_view(const DataValue &dv) {
+
+	if (auto slice = std::get_if<StringSlice>(&dv.value)) {
+		return slice->view();
+	}
 	return std::get<std::string>(dv.value);
 }
 
+inline const StringSlice &to_string_slice(const DataValue &dv) {
+	return std::get<StringSlice>(dv.value);
+}
+
 inline int to_integer(const DataValue &dv) {
 	return std::get<int>(dv.value);
 }
@@ -166,7 +223,7 @@ inline Inst *to_instruction(const DataValue &dv) {
 	return std::get<Inst *>(dv.value);
 }
 
-inline ArrayPtr to_array(const DataValue &dv) {
+inline const ArrayPtr &to_array(const DataValue &dv) {
 	return std::get<ArrayPtr>(dv.value);
 }
 
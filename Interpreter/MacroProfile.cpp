@@ -0,0 +1,283 @@
+
+#include "MacroProfile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// the statistics for each line of a program
+struct ProgramProfile {
+	std::string name;
+	std::vector<MacroProfileEntry> lines;
+};
+
+bool Profiling = false;
+
+// every program which exists, by the address of its code
+std::map<const Inst *, const Program *> Programs;
+
+// the statistics of the programs which have run while profiling, and of
+// those which have since been deleted
+std::unordered_map<const Program *, std::unique_ptr<ProgramProfile>> Profiles;
+std::vector<std::unique_ptr<ProgramProfile>> RetiredProfiles;
+
+std::unordered_map<std::string, MacroProfileEntry> Builtins;
+
+// where instructions which don't belong to a known program are counted
+MacroProfileEntry UnknownEntry;
+const int UnknownLine = 0;
+
+/**
+ * @brief Get the statistics of a program, creating them if necessary.
+ *
+ * @param prog The program.
+ * @return The statistics.
+ */
+ProgramProfile *ProfileOf(const Program *prog) {
+
+	std::unique_ptr<ProgramProfile> &profile = Profiles[prog];
+	if (!profile) {
+		profile       = std::make_unique<ProgramProfile>();
+		profile->name = prog->name.empty() ? std::string("(macro)") : prog->name;
+
+		const auto maxLine = std::max_element(prog->lines.begin(), prog->lines.end());
+		profile->lines.resize((maxLine == prog->lines.end()) ? 1 : static_cast<size_t>(*maxLine) + 1);
+	}
+
+	return profile.get();
+}
+
+/**
+ * @brief Format a duration as a number of milliseconds.
+ *
+ * @param time The duration.
+ * @return The number of milliseconds.
+ */
+double Milliseconds(Clock::duration time) {
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+}
+
+/**
+ * @brief Turn macro profiling on or off. Macros which are already running are
+ * affected from the next time they are resumed.
+ *
+ * @param enable `true` to collect statistics, `false` to stop.
+ */
+void SetMacroProfiling(bool enable) {
+	Profiling = enable;
+}
+
+/**
+ * @brief Check whether macro profiling is on.
+ *
+ * @return `true` if statistics are being collected, `false` otherwise.
+ */
+bool MacroProfilingEnabled() {
+	return Profiling;
+}
+
+/**
+ * @brief Discard the statistics collected so far.
+ */
+void ResetMacroProfile() {
+
+	// NOTE: a running macro may be using the entries of live programs, so they are cleared in place
+	for (auto &profile : Profiles) {
+		std::fill(profile.second->lines.begin(), profile.second->lines.end(), MacroProfileEntry());
+	}
+
+	RetiredProfiles.clear();
+	Builtins.clear();
+	UnknownEntry = MacroProfileEntry();
+}
+
+/**
+ * @brief Describe the statistics collected so far, with the most expensive
+ * source lines and built-in subroutines first.
+ *
+ * @return The report, as a table for each.
+ */
+std::string MacroProfileReport() {
+
+	// combine the lines of programs which have the same name, such as a macro which was redefined
+	std::map<std::pair<std::string, int>, MacroProfileEntry> lines;
+
+	auto addLines = [&lines](const ProgramProfile &profile) {
+		for (size_t line = 0; line < profile.lines.size(); ++line) {
+			const MacroProfileEntry &entry = profile.lines[line];
+			if (entry.count != 0) {
+				MacroProfileEntry &total = lines[{profile.name, static_cast<int>(line)}];
+				total.count += entry.count;
+				total.time += entry.time;
+			}
+		}
+	};
+
+	for (const auto &profile : Profiles) {
+		addLines(*profile.second);
+	}
+
+	for (const auto &profile : RetiredProfiles) {
+		addLines(*profile);
+	}
+
+	std::vector<std::pair<std::string, MacroProfileEntry>> rows;
+	for (const auto &line : lines) {
+		rows.emplace_back(line.first.first + ':' + std::to_string(line.first.second), line.second);
+	}
+
+	if (UnknownEntry.count != 0) {
+		rows.emplace_back("(unknown)", UnknownEntry);
+	}
+
+	std::vector<std::pair<std::string, MacroProfileEntry>> builtins(Builtins.begin(), Builtins.end());
+
+	auto byTime = [](const std::pair<std::string, MacroProfileEntry> &lhs, const std::pair<std::string, MacroProfileEntry> &rhs) {
+		return lhs.second.time > rhs.second.time;
+	};
+
+	std::sort(rows.begin(), rows.end(), byTime);
+	std::sort(builtins.begin(), builtins.end(), byTime);
+
+	std::string report = "Macro profile. The time of a line includes the built-in subroutines it calls,\n"
+						 "and any macros which they run.\n\n";
+
+	char buffer[64];
+	std::snprintf(buffer, sizeof(buffer), "%12s %14s  ", "time (ms)", "instructions");
+	report += buffer;
+	report += "line\n";
+
+	for (const auto &row : rows) {
+		std::snprintf(buffer, sizeof(buffer), "%12.3f %14lld  ", Milliseconds(row.second.time), static_cast<long long>(row.second.count));
+		report += buffer;
+		report += row.first;
+		report += '\n';
+	}
+
+	std::snprintf(buffer, sizeof(buffer), "\n%12s %14s  ", "time (ms)", "calls");
+	report += buffer;
+	report += "built-in subroutine\n";
+
+	for (const auto &builtin : builtins) {
+		std::snprintf(buffer, sizeof(buffer), "%12.3f %14lld  ", Milliseconds(builtin.second.time), static_cast<long long>(builtin.second.count));
+		report += buffer;
+		report += builtin.first;
+		report += '\n';
+	}
+
+	return report;
+}
+
+/**
+ * @brief Make a newly created program known to the profiler, so that the
+ * instructions it executes can be attributed to it.
+ *
+ * @param prog The program, whose code must not move while it exists.
+ */
+void ProfileRegisterProgram(const Program *prog) {
+	if (!prog->code.empty()) {
+		Programs[prog->code.data()] = prog;
+	}
+}
+
+/**
+ * @brief Forget about a program which is being deleted, keeping any
+ * statistics collected for it.
+ *
+ * @param prog The program.
+ */
+void ProfileUnregisterProgram(const Program *prog) {
+
+	if (!prog->code.empty()) {
+		Programs.erase(prog->code.data());
+	}
+
+	auto it = Profiles.find(prog);
+	if (it != Profiles.end()) {
+		RetiredProfiles.push_back(std::move(it->second));
+		Profiles.erase(it);
+	}
+}
+
+/**
+ * @brief Record a call of a built-in subroutine.
+ *
+ * @param name The name of the subroutine.
+ * @param time How long it took.
+ */
+void ProfileBuiltinCall(const std::string &name, std::chrono::steady_clock::duration time) {
+	MacroProfileEntry &entry = Builtins[name];
+	++entry.count;
+	entry.time += time;
+}
+
+/**
+ * @brief Constructor for MacroProfileRun.
+ */
+MacroProfileRun::MacroProfileRun()
+	: since_(Clock::now()) {
+}
+
+/**
+ * @brief Destructor for MacroProfileRun. Charges the time since the last
+ * change of line to that line.
+ */
+MacroProfileRun::~MacroProfileRun() {
+	if (current_) {
+		current_->time += Clock::now() - since_;
+	}
+}
+
+/**
+ * @brief Find the program which `inst` belongs to, after a call or return has
+ * moved execution into a different program.
+ *
+ * @param inst The instruction about to be executed.
+ */
+void MacroProfileRun::enterProgram(const Inst *inst) {
+
+	auto it = Programs.upper_bound(inst);
+	if (it != Programs.begin()) {
+		--it;
+		const Program *prog = it->second;
+		if (inst < prog->code.data() + prog->code.size() && prog->lines.size() == prog->code.size()) {
+			begin_   = prog->code.data();
+			end_     = begin_ + prog->code.size();
+			lines_   = prog->lines.data();
+			entries_ = ProfileOf(prog)->lines.data();
+			return;
+		}
+	}
+
+	begin_   = inst;
+	end_     = inst + 1;
+	lines_   = &UnknownLine;
+	entries_ = &UnknownEntry;
+}
+
+/**
+ * @brief Charge the time since the last change of line to that line, and
+ * start timing another.
+ *
+ * @param entry The statistics of the line being started.
+ */
+void MacroProfileRun::switchTo(MacroProfileEntry *entry) {
+
+	const Clock::time_point now = Clock::now();
+	if (current_) {
+		current_->time += now - since_;
+	}
+
+	current_ = entry;
+	since_   = now;
+}
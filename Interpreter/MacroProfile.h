@@ -0,0 +1,68 @@
+
+#ifndef MACRO_PROFILE_H_
+#define MACRO_PROFILE_H_
+
+#include "interpret.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+struct MacroProfileEntry {
+	int64_t count = 0; // the number of calls of a built-in subroutine, or instructions executed by a line
+	std::chrono::steady_clock::duration time{};
+};
+
+void SetMacroProfiling(bool enable);
+bool MacroProfilingEnabled();
+void ResetMacroProfile();
+std::string MacroProfileReport();
+
+void ProfileRegisterProgram(const Program *prog);
+void ProfileUnregisterProgram(const Program *prog);
+void ProfileBuiltinCall(const std::string &name, std::chrono::steady_clock::duration time);
+
+/**
+ * @brief Attributes the instructions executed by one call of continueMacro,
+ * and the time they take, to the source lines they were generated from.
+ */
+class MacroProfileRun {
+public:
+	MacroProfileRun();
+	MacroProfileRun(const MacroProfileRun &)            = delete;
+	MacroProfileRun &operator=(const MacroProfileRun &) = delete;
+	~MacroProfileRun();
+
+public:
+	/**
+	 * @brief Records that `inst` is about to be executed.
+	 *
+	 * @param inst The instruction.
+	 */
+	void instruction(const Inst *inst) {
+		if (inst < begin_ || inst >= end_) {
+			enterProgram(inst);
+		}
+
+		MacroProfileEntry *entry = &entries_[lines_[inst - begin_]];
+		if (entry != current_) {
+			switchTo(entry);
+		}
+
+		++entry->count;
+	}
+
+private:
+	void enterProgram(const Inst *inst);
+	void switchTo(MacroProfileEntry *entry);
+
+private:
+	const Inst *begin_          = nullptr; // the code of the program being executed
+	const Inst *end_            = nullptr;
+	const int *lines_           = nullptr; // the source line of each of its instructions
+	MacroProfileEntry *entries_ = nullptr; // its statistics, indexed by line
+	MacroProfileEntry *current_ = nullptr; // the line being executed
+	std::chrono::steady_clock::time_point since_; // when execution of that line began
+};
+
+#endif
@@ -0,0 +1,170 @@
+
+#include "interpret.h"
+#include "parse.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Workload {
+	const char *name;
+	std::string source;
+};
+
+/**
+ * @brief Builds macros which spend their time in the interpreter rather than
+ * in built-in routines, each running its loop about `n` times.
+ */
+std::vector<Workload> MakeWorkloads(long n) {
+
+	const std::string count = std::to_string(n);
+
+	return {
+		{"counting loop",
+		 "sum = 0\n"
+		 "for (i = 0; i < " + count + "; i++) {\n"
+		 "	sum = (sum + i) % 65536\n"
+		 "}\n"
+		 "return sum\n"},
+		{"while loop",
+		 "x = 0\n"
+		 "i = " + count + "\n"
+		 "while (i > 0) {\n"
+		 "	x = (x + i * 3) % 1000\n"
+		 "	i--\n"
+		 "}\n"
+		 "return x\n"},
+		{"nested conditions",
+		 "hits = 0\n"
+		 "for (i = 0; i < " + count + "; i++) {\n"
+		 "	j = i % 7\n"
+		 "	if (j == 3) {\n"
+		 "		hits++\n"
+		 "	} else if (j >= 5) {\n"
+		 "		hits = hits + 2\n"
+		 "	}\n"
+		 "}\n"
+		 "return hits\n"},
+		{"string compare",
+		 "hits = 0\n"
+		 "misses = 0\n"
+		 "for (i = 0; i < " + std::to_string(n / 4) + "; i++) {\n"
+		 "	s = (i % 100) \"\"\n"
+		 "	if (s != \"42\") {\n"
+		 "		misses++\n"
+		 "	} else {\n"
+		 "		hits++\n"
+		 "	}\n"
+		 "}\n"
+		 "return hits \"/\" misses\n"},
+		{"array access",
+		 "for (i = 0; i < 100; i++) {\n"
+		 "	a[i] = i\n"
+		 "}\n"
+		 "sum = 0\n"
+		 "for (i = 0; i < " + std::to_string(n / 4) + "; i++) {\n"
+		 "	sum = (sum + a[i % 100]) % 65536\n"
+		 "}\n"
+		 "return sum\n"},
+	};
+}
+
+/**
+ * @brief Compiles and runs `source` to completion, resuming it whenever it
+ * gives up its time slice.
+ *
+ * @param source The macro to run.
+ * @param seconds Where to store how long the macro took to execute.
+ * @return The macro's result as a string, or an error message.
+ */
+std::string RunMacro(const std::string &source, double *seconds) {
+
+	using Clock = std::chrono::steady_clock;
+
+	QString msg;
+	int stoppedAt;
+	std::unique_ptr<Program> prog(CompileMacro(QString::fromStdString(source), &msg, &stoppedAt));
+	if (!prog) {
+		return "compile error: " + msg.toStdString();
+	}
+
+	DataValue result;
+	std::shared_ptr<MacroContext> continuation;
+
+	const auto start = Clock::now();
+	int status       = ExecuteMacro(nullptr, prog.get(), {}, &result, continuation, &msg);
+	while (status == MACRO_TIME_LIMIT || status == MACRO_PREEMPT) {
+		status = continueMacro(continuation, &result, &msg);
+	}
+	*seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	if (status == MACRO_ERROR) {
+		return "error: " + msg.toStdString();
+	}
+
+	return is_unset(result) ? std::string() : to_string(result);
+}
+
+/**
+ * @brief Times a workload three ways: calling each instruction through a
+ * function pointer, as the interpreter used to, dispatching through the
+ * switch, and dispatching through the switch with superinstructions.
+ */
+bool Benchmark(const Workload &workload) {
+
+	double callElapsed;
+	SetMacroSwitchDispatch(false);
+	SetMacroSuperinstructions(false);
+	const std::string callResult = RunMacro(workload.source, &callElapsed);
+
+	double plainElapsed;
+	SetMacroSwitchDispatch(true);
+	const std::string plainResult = RunMacro(workload.source, &plainElapsed);
+
+	double fusedElapsed;
+	SetMacroSuperinstructions(true);
+	const std::string fusedResult = RunMacro(workload.source, &fusedElapsed);
+
+	std::printf("%-20s %12s %10.1f %10.1f %10.1f %8.2fx %8.2fx\n",
+				workload.name,
+				fusedResult.c_str(),
+				callElapsed * 1000.0,
+				plainElapsed * 1000.0,
+				fusedElapsed * 1000.0,
+				callElapsed / plainElapsed,
+				callElapsed / fusedElapsed);
+
+	if (plainResult != callResult || fusedResult != callResult) {
+		std::fprintf(stderr, "ERROR    : got \"%s\" and \"%s\", expected \"%s\"\n", plainResult.c_str(), fusedResult.c_str(), callResult.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+}
+
+/**
+ * @brief Usage: nedit-macro-bench [loop iterations]
+ */
+int main(int argc, char *argv[]) {
+
+	const long n = (argc > 1) ? std::strtol(argv[1], nullptr, 10) : 2000000;
+
+	InitMacroGlobals();
+
+	std::printf("%-20s %12s %10s %10s %10s %9s %9s\n", "workload", "result", "call ms", "switch ms", "fused ms", "switch", "fused");
+
+	bool ok = true;
+	for (const Workload &workload : MakeWorkloads(n)) {
+		ok = Benchmark(workload) && ok;
+	}
+
+	CleanupMacroGlobals();
+	return ok ? 0 : -1;
+}
@@ -1,10 +1,16 @@
 
 #include "interpret.h"
+#include "MacroProfile.h"
 #include "Util/utils.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <iterator>
+#include <set>
 #include <stack>
+#include <unordered_map>
 
 #include <gsl/gsl_util>
 
@@ -25,9 +31,9 @@ constexpr int MaxProgramSize = 4096;
 // Maximum length for error messages
 constexpr int MaxErrorMessageLen = 256;
 
-// Number of instructions the interpreter is allowed to execute before
-// preempting and returning to allow other things to run
-constexpr int InstructionLimit = 100;
+// Number of instructions the interpreter executes between checks of the
+// clock, to see if the macro's time slice is over
+constexpr int TimeSliceCheckInterval = 128;
 
 // Temporary markers placed in a Branch address location to designate
 // which loop address (break or continue) the location needs
@@ -56,18 +62,32 @@ const auto MacroTooLarge = QLatin1String("macro too large");
 
 // Global symbols and function definitions
 std::deque<Symbol *> GlobalSymList;
+std::unordered_map<std::string_view, Symbol *> GlobalSymTable; // GlobalSymList by name, the keys refer to the symbols' own names
+std::unordered_map<std::string, Symbol *> StringConstTable;     // string constants in GlobalSymList by value
 
 // Temporary global data for use while accumulating programs
-std::deque<Symbol *> LocalSymList; // symbols local to the program
-Inst Prog[MaxProgramSize];         // the program
-Inst *ProgP;                       // next free spot for code gen.
-std::stack<Inst *> LoopStack;      // addresses of break, cont stmts
+std::deque<Symbol *> LocalSymList;                            // symbols local to the program
+std::unordered_map<std::string_view, Symbol *> LocalSymTable; // LocalSymList by name
+Inst Prog[MaxProgramSize];                                    // the program
+int ProgLines[MaxProgramSize];                                // the source line of each instruction of the program
+int SourceLine = 1;                                           // the source line of the code being generated
+Inst *ProgP;                                                  // next free spot for code gen.
+std::stack<Inst *> LoopStack;                                 // addresses of break, cont stmts
+
+// Whether FinishCreatingProgram combines common instruction sequences
+bool Superinstructions = true;
+
+#ifdef NEDIT_MACRO_BENCH
+// Whether instructions are executed by indirect calls instead of through Dispatch
+bool CallDispatch = false;
+#endif
 
 // Global data for the interpreter
 MacroContext Context;
 
 const char *ErrorMessage; // global for returning error messages from executing functions
 bool PreemptRequest;      // passes preemption requests from called routines back up to the interpreter
+int SliceCountdown;       // instructions left until the next check of the time slice
 
 // Stack-> symN-sym0(FP), argArray, nArgs, oldFP, retPC, argN-arg1, next, ...
 constexpr int FP_ARG_ARRAY_CACHE_INDEX = -1;
@@ -250,6 +270,163 @@ int ErrorCheck(const char *s) {
 	}
 }
 
+/**
+ * @brief Get the number of operands which follow an instruction in the code.
+ *
+ * @param op The instruction.
+ * @return The number of operands.
+ */
+int OperandCount(Operations op) {
+	switch (op) {
+	case OP_PUSH_SYM:
+	case OP_ASSIGN:
+	case OP_BRANCH:
+	case OP_BRANCH_TRUE:
+	case OP_BRANCH_FALSE:
+	case OP_BRANCH_NEVER:
+	case OP_ARRAY_REF:
+	case OP_ARRAY_ASSIGN:
+	case OP_BEGIN_ARRAY_ITER:
+	case OP_ARRAY_DELETE:
+	case OP_PUSH_SYM_PUSH_SYM_ADD:
+	case OP_PUSH_SYM_INCR_ASSIGN:
+	case OP_PUSH_SYM_DECR_ASSIGN:
+		return 1;
+	case OP_SUBR_CALL:
+	case OP_PUSH_ARRAY_SYM:
+	case OP_ARRAY_REF_ASSIGN_SETUP:
+		return 2;
+	case OP_ARRAY_ITER:
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief Replace the first instruction of common sequences with a
+ * superinstruction which does the work of the whole sequence.
+ *
+ * The rest of the sequence is left in place, and the superinstruction skips
+ * over it, so branches into the middle of a sequence still work, and no
+ * branch offsets need to be adjusted. When its operands aren't of the types
+ * it is specialized for, a superinstruction just does what the first
+ * instruction would have done, and execution carries on with the rest of the
+ * sequence as usual.
+ *
+ * @param code The code of a finished program.
+ */
+void FuseInstructions(std::vector<Inst> &code) {
+
+	auto opAt = [&code](size_t i, Operations op) {
+		return i < code.size() && code[i].op == op;
+	};
+
+	for (size_t i = 0; i < code.size(); i += 1 + OperandCount(code[i].op)) {
+		switch (code[i].op) {
+		case OP_PUSH_SYM:
+			if (opAt(i + 2, OP_PUSH_SYM) && opAt(i + 4, OP_ADD)) {
+				code[i].op = OP_PUSH_SYM_PUSH_SYM_ADD;
+			} else if (opAt(i + 2, OP_INCR) && opAt(i + 3, OP_ASSIGN) && i + 4 < code.size() && code[i + 4].sym == code[i + 1].sym) {
+				code[i].op = OP_PUSH_SYM_INCR_ASSIGN;
+			} else if (opAt(i + 2, OP_DECR) && opAt(i + 3, OP_ASSIGN) && i + 4 < code.size() && code[i + 4].sym == code[i + 1].sym) {
+				code[i].op = OP_PUSH_SYM_DECR_ASSIGN;
+			}
+			break;
+		case OP_GT:
+			if (opAt(i + 1, OP_BRANCH_FALSE)) {
+				code[i].op = OP_GT_BRANCH_FALSE;
+			}
+			break;
+		case OP_LT:
+			if (opAt(i + 1, OP_BRANCH_FALSE)) {
+				code[i].op = OP_LT_BRANCH_FALSE;
+			}
+			break;
+		case OP_GE:
+			if (opAt(i + 1, OP_BRANCH_FALSE)) {
+				code[i].op = OP_GE_BRANCH_FALSE;
+			}
+			break;
+		case OP_LE:
+			if (opAt(i + 1, OP_BRANCH_FALSE)) {
+				code[i].op = OP_LE_BRANCH_FALSE;
+			}
+			break;
+		case OP_EQ:
+			if (opAt(i + 1, OP_BRANCH_FALSE)) {
+				code[i].op = OP_EQ_BRANCH_FALSE;
+			}
+			break;
+		case OP_NE:
+			if (opAt(i + 1, OP_BRANCH_FALSE)) {
+				code[i].op = OP_NE_BRANCH_FALSE;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/**
+ * @brief The key of an array element, as computed from the arguments on the
+ * stack. A single integer argument is kept as an integer, so that it can be
+ * looked up without being formatted.
+ */
+struct ArrayKey {
+	std::string string;
+	int index    = 0;
+	bool isIndex = false;
+
+	std::string str() const {
+		return isIndex ? std::to_string(index) : string;
+	}
+};
+
+/**
+ * @brief Find an element of an array.
+ *
+ * @param theArray The array to search in.
+ * @param key The key of the element.
+ * @return The element's value, or nullptr if it isn't in the array.
+ */
+DataValue *ArrayFind(const DataValue &theArray, const ArrayKey &key) {
+	const ArrayPtr &m = to_array(theArray);
+	return key.isIndex ? m->find(key.index) : m->find(key.string);
+}
+
+/**
+ * @brief Insert a value into an array, replacing any existing element.
+ *
+ * @param theArray The array to insert into.
+ * @param key The key under which to insert the value.
+ * @param theValue The value to insert.
+ */
+void ArrayInsert(const DataValue &theArray, const ArrayKey &key, const DataValue &theValue) {
+	const ArrayPtr &m = to_array(theArray);
+	if (key.isIndex) {
+		m->insert(key.index, theValue);
+	} else {
+		m->insert(key.string, theValue);
+	}
+}
+
+/**
+ * @brief Delete an element from an array, if it is present.
+ *
+ * @param theArray The array from which to delete the element.
+ * @param key The key of the element.
+ */
+void ArrayDelete(const DataValue &theArray, const ArrayKey &key) {
+	const ArrayPtr &m = to_array(theArray);
+	if (key.isIndex) {
+		m->erase(key.index);
+	} else {
+		m->erase(key.string);
+	}
+}
+
 }
 
 static void AddLoopAddress(Inst *addr);
@@ -297,9 +474,83 @@ static int BeginArrayIter();
 static int ArrayIter();
 static int InArray();
 static int DeleteArrayElement();
+static int PushSymPushSymAdd();
+static int PushSymIncrAssign();
+static int PushSymDecrAssign();
+static int GtBranchFalse();
+static int LtBranchFalse();
+static int GeBranchFalse();
+static int LeBranchFalse();
+static int EqBranchFalse();
+static int NeBranchFalse();
+static int Dispatch(Operations op);
+
+#ifdef NEDIT_MACRO_BENCH
+/* The instructions indexed by opcode. Calling through this table is how
+   instructions used to be executed, before Dispatch; the benchmark builds it
+   so that the two can be compared */
+using operation_type = int (*)();
+
+const operation_type OpFns[] = {
+	ReturnNoValue,          // OP_RETURN_NO_VAL
+	ReturnValue,            // OP_RETURN
+	PushSymValue,           // OP_PUSH_SYM
+	DupStack,               // OP_DUP
+	Add,                    // OP_ADD
+	Subtract,               // OP_SUB
+	Multiply,               // OP_MUL
+	Divide,                 // OP_DIV
+	Modulo,                 // OP_MOD
+	Negate,                 // OP_NEGATE
+	Increment,              // OP_INCR
+	Decrement,              // OP_DECR
+	Gt,                     // OP_GT
+	Lt,                     // OP_LT
+	Ge,                     // OP_GE
+	Le,                     // OP_LE
+	Eq,                     // OP_EQ
+	Ne,                     // OP_NE
+	BitAnd,                 // OP_BIT_AND
+	BitOr,                  // OP_BIT_OR
+	LogicalAnd,             // OP_AND
+	LogicalOr,              // OP_OR
+	LogicalNot,             // OP_NOT
+	Power,                  // OP_POWER
+	Concat,                 // OP_CONCAT
+	Assign,                 // OP_ASSIGN
+	CallSubroutine,         // OP_SUBR_CALL
+	FetchReturnVal,         // OP_FETCH_RET_VAL
+	Branch,                 // OP_BRANCH
+	BranchTrue,             // OP_BRANCH_TRUE
+	BranchFalse,            // OP_BRANCH_FALSE
+	BranchNever,            // OP_BRANCH_NEVER
+	ArrayRef,               // OP_ARRAY_REF
+	ArrayAssign,            // OP_ARRAY_ASSIGN
+	BeginArrayIter,         // OP_BEGIN_ARRAY_ITER
+	ArrayIter,              // OP_ARRAY_ITER
+	InArray,                // OP_IN_ARRAY
+	DeleteArrayElement,     // OP_ARRAY_DELETE
+	PushArraySymVal,        // OP_PUSH_ARRAY_SYM
+	ArrayRefAndAssignSetup, // OP_ARRAY_REF_ASSIGN_SETUP
+	PushArgValue,           // OP_PUSH_ARG
+	PushArgCount,           // OP_PUSH_ARG_COUNT
+	PushArgArray,           // OP_PUSH_ARG_ARRAY
+	PushSymPushSymAdd,      // OP_PUSH_SYM_PUSH_SYM_ADD
+	PushSymIncrAssign,      // OP_PUSH_SYM_INCR_ASSIGN
+	PushSymDecrAssign,      // OP_PUSH_SYM_DECR_ASSIGN
+	GtBranchFalse,          // OP_GT_BRANCH_FALSE
+	LtBranchFalse,          // OP_LT_BRANCH_FALSE
+	GeBranchFalse,          // OP_GE_BRANCH_FALSE
+	LeBranchFalse,          // OP_LE_BRANCH_FALSE
+	EqBranchFalse,          // OP_EQ_BRANCH_FALSE
+	NeBranchFalse,          // OP_NE_BRANCH_FALSE
+};
+
+static_assert(std::size(OpFns) == OP_NE_BRANCH_FALSE + 1, "OpFns must have an entry for every instruction");
+#endif
 
 static ArrayIterator ArrayIterateFirst(DataValue *theArray);
-static ArrayIterator ArrayIterateNext(ArrayIterator iterator);
+static bool ArrayIterateNext(ArrayIterator *iterator);
 
 #if defined(DEBUG_ASSEMBLY) || defined(DEBUG_STACK)
 #define DEBUG_DISASSEMBLER
@@ -321,56 +572,6 @@ static void StackDump(int n, int extra);
 #define DISASM_RT(i, n)
 #endif
 
-/* Array for mapping operations to functions for performing the operations
-   Must correspond to the enum called "operations" in interpret.h */
-using operation_type = int (*)();
-
-static const operation_type OpFns[N_OPS] = {
-	ReturnNoValue,
-	ReturnValue,
-	PushSymValue,
-	DupStack,
-	Add,
-	Subtract,
-	Multiply,
-	Divide,
-	Modulo,
-	Negate,
-	Increment,
-	Decrement,
-	Gt,
-	Lt,
-	Ge,
-	Le,
-	Eq,
-	Ne,
-	BitAnd,
-	BitOr,
-	LogicalAnd,
-	LogicalOr,
-	LogicalNot,
-	Power,
-	Concat,
-	Assign,
-	CallSubroutine,
-	FetchReturnVal,
-	Branch,
-	BranchTrue,
-	BranchFalse,
-	BranchNever,
-	ArrayRef,
-	ArrayAssign,
-	BeginArrayIter,
-	ArrayIter,
-	InArray,
-	DeleteArrayElement,
-	PushArraySymVal,
-	ArrayRefAndAssignSetup,
-	PushArgValue,
-	PushArgCount,
-	PushArgArray,
-};
-
 /**
  * @brief Initializes macro language global variables. Must be called before
  * any macros are parsed, as the parser uses action routine
@@ -396,6 +597,10 @@ void CleanupMacroGlobals() {
 	for (Symbol *sym : GlobalSymList) {
 		delete sym;
 	}
+
+	GlobalSymList.clear();
+	GlobalSymTable.clear();
+	StringConstTable.clear();
 }
 
 /*
@@ -411,8 +616,10 @@ void CleanupMacroGlobals() {
  */
 void BeginCreatingProgram() {
 	LocalSymList.clear();
-	ProgP     = Prog;
-	LoopStack = std::stack<Inst *>();
+	LocalSymTable.clear();
+	ProgP      = Prog;
+	SourceLine = 1;
+	LoopStack  = std::stack<Inst *>();
 }
 
 /**
@@ -423,9 +630,15 @@ std::unique_ptr<Program> FinishCreatingProgram() {
 
 	auto newProg = std::make_unique<Program>();
 	std::copy(Prog, ProgP, std::back_inserter(newProg->code));
+	std::copy(ProgLines, ProgLines + (ProgP - Prog), std::back_inserter(newProg->lines));
 
 	newProg->localSymList = LocalSymList;
 	LocalSymList.clear();
+	LocalSymTable.clear();
+
+	if (Superinstructions) {
+		FuseInstructions(newProg->code);
+	}
 
 	int fpOffset = 0;
 
@@ -435,10 +648,20 @@ std::unique_ptr<Program> FinishCreatingProgram() {
 		s->value = make_value(fpOffset++);
 	}
 
+	ProfileRegisterProgram(newProg.get());
+
 	DISASM(newProg->code.data(), newProg->code.size());
 	return newProg;
 }
 
+/**
+ * @brief Destructor for Program.
+ */
+Program::~Program() {
+	ProfileUnregisterProgram(this);
+	qDeleteAll(localSymList);
+}
+
 /**
  * @brief Add an operator (instruction) to the end of the current program
  */
@@ -448,7 +671,8 @@ bool AddOp(int op, QString *msg) {
 		return false;
 	}
 
-	ProgP++->func = OpFns[op];
+	ProgLines[ProgP - Prog] = SourceLine;
+	ProgP++->op = static_cast<Operations>(op);
 	return true;
 }
 
@@ -465,6 +689,7 @@ bool AddSym(Symbol *sym, QString *msg) {
 		return false;
 	}
 
+	ProgLines[ProgP - Prog] = SourceLine;
 	ProgP++->sym = sym;
 	return true;
 }
@@ -482,6 +707,7 @@ bool AddImmediate(int value, QString *msg) {
 		return false;
 	}
 
+	ProgLines[ProgP - Prog] = SourceLine;
 	ProgP++->value = value;
 	return true;
 }
@@ -502,7 +728,8 @@ bool AddBranchOffset(const Inst *to, QString *msg) {
 	/* we don't use gsl::narrow here because when `to` is nullptr (to indicate
 	 * end of program) it produces values that won't fit into an int on
 	 * 64-bit systems */
-	ProgP->value = static_cast<int>(to - ProgP);
+	ProgLines[ProgP - Prog] = SourceLine;
+	ProgP->value            = static_cast<int>(to - ProgP);
 	ProgP++;
 	return true;
 }
@@ -532,6 +759,46 @@ void SwapCode(Inst *start, Inst *boundary, Inst *end) {
 	std::reverse(start, boundary); // 1
 	std::reverse(boundary, end);   // 2
 	std::reverse(start, end);      // 3
+
+	// the source lines go with the instructions
+	std::reverse(ProgLines + (start - Prog), ProgLines + (boundary - Prog));
+	std::reverse(ProgLines + (boundary - Prog), ProgLines + (end - Prog));
+	std::reverse(ProgLines + (start - Prog), ProgLines + (end - Prog));
+}
+
+/**
+ * @brief Set whether programs created from now on combine common instruction
+ * sequences into superinstructions. This is on by default, and is mostly
+ * useful for measuring the difference it makes.
+ *
+ * @param enable `true` to create superinstructions, `false` otherwise.
+ */
+void SetMacroSuperinstructions(bool enable) {
+	Superinstructions = enable;
+}
+
+#ifdef NEDIT_MACRO_BENCH
+/**
+ * @brief Set whether macros execute their instructions through the dispatch
+ * switch, which is the default, or by an indirect call to each instruction,
+ * as they used to. Only built into the benchmark, which measures the
+ * difference it makes.
+ *
+ * @param enable `true` to use the switch, `false` to use indirect calls.
+ */
+void SetMacroSwitchDispatch(bool enable) {
+	CallDispatch = !enable;
+}
+#endif
+
+/**
+ * @brief Set the source line which the code generated from now on comes
+ * from. Called by the parser as it moves through the source.
+ *
+ * @param line The line, counting from 1.
+ */
+void SetSourceLine(int line) {
+	SourceLine = line;
 }
 
 /*
@@ -631,11 +898,13 @@ void FillLoopAddrs(const Inst *breakAddr, const Inst *continueAddr) {
  * @param result Where the result of the macro execution will be stored.
  * @param continuation A MacroContext that will hold the state of the macro execution for resuming later.
  * @param msg Where error messages will be stored if an error occurs.
+ * @param timeSlice How long the macro may run before continueMacro returns
+ * MACRO_TIME_LIMIT, or UnlimitedMacroTimeSlice to run it until it is done.
  * @return One of the ExecReturnCodes: MACRO_DONE, MACRO_PREEMPT, or MACRO_ERROR.
  * if MACRO_DONE is returned, the macro completed, and the returned value (if any) can be read from "result".
  * If MACRO_PREEMPT is returned, the macro exceeded its allotted time-slice and scheduled...
  */
-int ExecuteMacro(DocumentWidget *document, Program *prog, gsl::span<DataValue> arguments, DataValue *result, std::shared_ptr<MacroContext> &continuation, QString *msg) {
+int ExecuteMacro(DocumentWidget *document, Program *prog, gsl::span<DataValue> arguments, DataValue *result, std::shared_ptr<MacroContext> &continuation, QString *msg, std::chrono::milliseconds timeSlice) {
 
 	/* Create an execution context (a stack, a stack pointer, a frame pointer,
 	   and a program counter) which will retain the program state across
@@ -647,6 +916,7 @@ int ExecuteMacro(DocumentWidget *document, Program *prog, gsl::span<DataValue> a
 	context->PC            = prog->code.data();
 	context->RunDocument   = document;
 	context->FocusDocument = document;
+	context->TimeSlice     = timeSlice;
 
 	continuation = context;
 
@@ -682,7 +952,11 @@ int ExecuteMacro(DocumentWidget *document, Program *prog, gsl::span<DataValue> a
  */
 ExecReturnCodes continueMacro(const std::shared_ptr<MacroContext> &continuation, DataValue *result, QString *msg) {
 
-	int instCount = 0;
+	using Clock = std::chrono::steady_clock;
+
+	const bool timeSliced            = continuation->TimeSlice != UnlimitedMacroTimeSlice;
+	const Clock::time_point deadline = timeSliced ? Clock::now() + continuation->TimeSlice : Clock::time_point();
+	SliceCountdown                   = TimeSliceCheckInterval;
 
 	/* To allow macros to be invoked arbitrarily (such as those automatically
 	   triggered within smart-indent) within executing macros, this call is
@@ -693,17 +967,31 @@ ExecReturnCodes continueMacro(const std::shared_ptr<MacroContext> &continuation,
 	Q_ASSERT(continuation);
 
 	/*
-	** Execution Loop:  Call the successive routine addresses in the program
+	** Execution Loop:  Dispatch the successive instructions in the program
 	** until one returns something other than StatusOk, then take action
 	*/
 	RestoreContext(continuation);
 	ErrorMessage = nullptr;
+
+	std::optional<MacroProfileRun> profileRun;
+	if (MacroProfilingEnabled()) {
+		profileRun.emplace();
+	}
+
 	Q_FOREVER {
 
 		// Execute an instruction
 		Inst *inst = Context.PC++;
 
-		auto status = static_cast<OpStatusCodes>(inst->func());
+		if (profileRun) {
+			profileRun->instruction(inst);
+		}
+
+#ifdef NEDIT_MACRO_BENCH
+		auto status = static_cast<OpStatusCodes>(CallDispatch ? OpFns[inst->op]() : Dispatch(inst->op));
+#else
+		auto status = static_cast<OpStatusCodes>(Dispatch(inst->op));
+#endif
 
 		// If error return was not StatusOk, return to caller
 		switch (status) {
@@ -724,15 +1012,19 @@ ExecReturnCodes continueMacro(const std::shared_ptr<MacroContext> &continuation,
 			break;
 		}
 
-		/* Count instructions executed.  If the instruction limit is hit,
+		/* Every so often, check the clock. If the time slice is over,
 		   preempt, store re-start information in continuation and give
-		   X, other macros, and other shell scripts a chance to execute */
-		++instCount;
+		   the event loop, other macros, and other shell scripts a chance
+		   to execute */
 #if defined(ENABLE_PREEMPTION)
-		if (instCount >= InstructionLimit) {
-			SaveContext(continuation);
-			RestoreContext(&oldContext);
-			return MACRO_TIME_LIMIT;
+		if (timeSliced && --SliceCountdown <= 0) {
+			if (Clock::now() >= deadline) {
+				SaveContext(continuation);
+				RestoreContext(&oldContext);
+				return MACRO_TIME_LIMIT;
+			}
+
+			SliceCountdown = TimeSliceCheckInterval;
 		}
 #endif
 	}
@@ -783,7 +1075,7 @@ void preemptMacro() {
  * @param dv The DataValue to set as the return value.
  */
 void modifyReturnedValue(const std::shared_ptr<MacroContext> &context, const DataValue &dv) {
-	if ((context->PC - 1)->func == FetchReturnVal) {
+	if ((context->PC - 1)->op == OP_FETCH_RET_VAL) {
 		*(context->StackP - 1) = dv;
 	}
 }
@@ -841,12 +1133,9 @@ Symbol *InstallIteratorSymbol() {
  */
 Symbol *LookupStringConstSymbol(std::string_view value) {
 
-	auto it = std::find_if(GlobalSymList.begin(), GlobalSymList.end(), [value](Symbol *s) {
-		return (s->type == SymbolConst && is_string(s->value) && to_string(s->value) == value);
-	});
-
-	if (it != GlobalSymList.end()) {
-		return *it;
+	auto it = StringConstTable.find(std::string(value));
+	if (it != StringConstTable.end()) {
+		return it->second;
 	}
 
 	return nullptr;
@@ -901,21 +1190,15 @@ Symbol *LookupSymbolEx(const QString &name) {
 Symbol *LookupSymbol(std::string_view name) {
 
 	// first look for a local symbol
-	auto local = std::find_if(LocalSymList.begin(), LocalSymList.end(), [name](Symbol *s) {
-		return (s->name == name);
-	});
-
-	if (local != LocalSymList.end()) {
-		return *local;
+	auto local = LocalSymTable.find(name);
+	if (local != LocalSymTable.end()) {
+		return local->second;
 	}
 
 	// then a global symbol
-	auto global = std::find_if(GlobalSymList.begin(), GlobalSymList.end(), [name](Symbol *s) {
-		return (s->name == name);
-	});
-
-	if (global != GlobalSymList.end()) {
-		return *global;
+	auto global = GlobalSymTable.find(name);
+	if (global != GlobalSymTable.end()) {
+		return global->second;
 	}
 
 	return nullptr;
@@ -945,10 +1228,19 @@ Symbol *InstallSymbol(std::string name, SymbolType type, const DataValue &value)
 
 	auto s = new Symbol{std::move(name), type, value};
 
+	/* NOTE: when names are duplicated, lookups find the most recently
+	 * installed local symbol and the first installed global symbol, just as a
+	 * search of the lists in order would */
 	if (type == SymbolLocal) {
 		LocalSymList.push_front(s);
+		LocalSymTable[s->name] = s;
 	} else {
 		GlobalSymList.push_back(s);
+		GlobalSymTable.emplace(s->name, s);
+
+		if (type == SymbolConst && is_string(s->value)) {
+			StringConstTable.emplace(to_string(s->value), s);
+		}
 	}
 	return s;
 }
@@ -974,6 +1266,11 @@ Symbol *PromoteToGlobal(Symbol *sym) {
 	// Remove sym from the local symbol list
 	LocalSymList.erase(std::remove(LocalSymList.begin(), LocalSymList.end(), sym), LocalSymList.end());
 
+	auto local = LocalSymTable.find(sym->name);
+	if (local != LocalSymTable.end() && local->second == sym) {
+		LocalSymTable.erase(local);
+	}
+
 	/* There are two scenarios which could make this check succeed:
 	   a) this sym is in the GlobalSymList as a SymbolLocal symbol
 	   b) there is another symbol as a non-SymbolLocal in the GlobalSymList
@@ -1001,6 +1298,7 @@ Symbol *PromoteToGlobal(Symbol *sym) {
 	sym->type = SymbolGlobal;
 
 	GlobalSymList.push_back(sym);
+	GlobalSymTable.emplace(sym->name, sym);
 
 	return sym;
 }
@@ -1361,31 +1659,34 @@ static int Add() {
 			const ArrayPtr &leftMap  = to_array(leftVal);
 			const ArrayPtr &rightMap = to_array(rightVal);
 
-			auto leftIter  = leftMap->begin();
-			auto rightIter = rightMap->begin();
+			const std::set<std::string> &leftKeys  = leftMap->keys();
+			const std::set<std::string> &rightKeys = rightMap->keys();
+
+			auto leftIter  = leftKeys.begin();
+			auto rightIter = rightKeys.begin();
 
-			while (leftIter != leftMap->end() || rightIter != rightMap->end()) {
+			while (leftIter != leftKeys.end() || rightIter != rightKeys.end()) {
 
 				bool insertResult = true;
 
-				if (leftIter != leftMap->end() && rightIter != rightMap->end()) {
-					const int compareResult = leftIter->first.compare(rightIter->first);
+				if (leftIter != leftKeys.end() && rightIter != rightKeys.end()) {
+					const int compareResult = leftIter->compare(*rightIter);
 					if (compareResult < 0) {
-						insertResult = ArrayInsert(&resultArray, leftIter->first, &leftIter->second);
+						insertResult = ArrayInsert(&resultArray, *leftIter, leftMap->find(*leftIter));
 						++leftIter;
 					} else if (compareResult > 0) {
-						insertResult = ArrayInsert(&resultArray, rightIter->first, &rightIter->second);
+						insertResult = ArrayInsert(&resultArray, *rightIter, rightMap->find(*rightIter));
 						++rightIter;
 					} else {
-						insertResult = ArrayInsert(&resultArray, rightIter->first, &rightIter->second);
+						insertResult = ArrayInsert(&resultArray, *rightIter, rightMap->find(*rightIter));
 						++leftIter;
 						++rightIter;
 					}
-				} else if (leftIter != leftMap->end()) {
-					insertResult = ArrayInsert(&resultArray, leftIter->first, &leftIter->second);
+				} else if (leftIter != leftKeys.end()) {
+					insertResult = ArrayInsert(&resultArray, *leftIter, leftMap->find(*leftIter));
 					++leftIter;
 				} else {
-					insertResult = ArrayInsert(&resultArray, rightIter->first, &rightIter->second);
+					insertResult = ArrayInsert(&resultArray, *rightIter, rightMap->find(*rightIter));
 					++rightIter;
 				}
 				if (!insertResult) {
@@ -1439,16 +1740,19 @@ static int Subtract() {
 			const ArrayPtr &leftMap  = to_array(leftVal);
 			const ArrayPtr &rightMap = to_array(rightVal);
 
-			auto leftIter  = leftMap->begin();
-			auto rightIter = rightMap->begin();
+			const std::set<std::string> &leftKeys  = leftMap->keys();
+			const std::set<std::string> &rightKeys = rightMap->keys();
 
-			while (leftIter != leftMap->end()) {
+			auto leftIter  = leftKeys.begin();
+			auto rightIter = rightKeys.begin();
+
+			while (leftIter != leftKeys.end()) {
 				bool insertResult = true;
 
-				if (leftIter != leftMap->end() && rightIter != rightMap->end()) {
-					const int compareResult = leftIter->first.compare(rightIter->first);
+				if (leftIter != leftKeys.end() && rightIter != rightKeys.end()) {
+					const int compareResult = leftIter->compare(*rightIter);
 					if (compareResult < 0) {
-						insertResult = ArrayInsert(&resultArray, leftIter->first, &leftIter->second);
+						insertResult = ArrayInsert(&resultArray, *leftIter, leftMap->find(*leftIter));
 						++leftIter;
 					} else if (compareResult > 0) {
 						++rightIter;
@@ -1456,8 +1760,8 @@ static int Subtract() {
 						++leftIter;
 						++rightIter;
 					}
-				} else if (leftIter != leftMap->end()) {
-					insertResult = ArrayInsert(&resultArray, leftIter->first, &leftIter->second);
+				} else if (leftIter != leftKeys.end()) {
+					insertResult = ArrayInsert(&resultArray, *leftIter, leftMap->find(*leftIter));
 					++leftIter;
 				}
 				if (!insertResult) {
@@ -1699,19 +2003,22 @@ static int BitAnd() {
 			const ArrayPtr &leftMap  = to_array(leftVal);
 			const ArrayPtr &rightMap = to_array(rightVal);
 
-			auto leftIter  = leftMap->begin();
-			auto rightIter = rightMap->begin();
+			const std::set<std::string> &leftKeys  = leftMap->keys();
+			const std::set<std::string> &rightKeys = rightMap->keys();
+
+			auto leftIter  = leftKeys.begin();
+			auto rightIter = rightKeys.begin();
 
-			while (leftIter != leftMap->end() && rightIter != rightMap->end()) {
+			while (leftIter != leftKeys.end() && rightIter != rightKeys.end()) {
 				bool insertResult       = true;
-				const int compareResult = leftIter->first.compare(rightIter->first);
+				const int compareResult = leftIter->compare(*rightIter);
 
 				if (compareResult < 0) {
 					++leftIter;
 				} else if (compareResult > 0) {
 					++rightIter;
 				} else {
-					insertResult = ArrayInsert(&resultArray, rightIter->first, &rightIter->second);
+					insertResult = ArrayInsert(&resultArray, *rightIter, rightMap->find(*rightIter));
 					++leftIter;
 					++rightIter;
 				}
@@ -1771,29 +2078,32 @@ static int BitOr() {
 			const ArrayPtr &leftMap  = to_array(leftVal);
 			const ArrayPtr &rightMap = to_array(rightVal);
 
-			auto leftIter  = leftMap->begin();
-			auto rightIter = rightMap->begin();
+			const std::set<std::string> &leftKeys  = leftMap->keys();
+			const std::set<std::string> &rightKeys = rightMap->keys();
 
-			while (leftIter != leftMap->end() || rightIter != rightMap->end()) {
+			auto leftIter  = leftKeys.begin();
+			auto rightIter = rightKeys.begin();
+
+			while (leftIter != leftKeys.end() || rightIter != rightKeys.end()) {
 				bool insertResult = true;
 
-				if (leftIter != leftMap->end() && rightIter != rightMap->end()) {
-					const int compareResult = leftIter->first.compare(rightIter->first);
+				if (leftIter != leftKeys.end() && rightIter != rightKeys.end()) {
+					const int compareResult = leftIter->compare(*rightIter);
 					if (compareResult < 0) {
-						insertResult = ArrayInsert(&resultArray, leftIter->first, &leftIter->second);
+						insertResult = ArrayInsert(&resultArray, *leftIter, leftMap->find(*leftIter));
 						++leftIter;
 					} else if (compareResult > 0) {
-						insertResult = ArrayInsert(&resultArray, rightIter->first, &rightIter->second);
+						insertResult = ArrayInsert(&resultArray, *rightIter, rightMap->find(*rightIter));
 						++rightIter;
 					} else {
 						++leftIter;
 						++rightIter;
 					}
-				} else if (leftIter != leftMap->end()) {
-					insertResult = ArrayInsert(&resultArray, leftIter->first, &leftIter->second);
+				} else if (leftIter != leftKeys.end()) {
+					insertResult = ArrayInsert(&resultArray, *leftIter, leftMap->find(*leftIter));
 					++leftIter;
 				} else {
-					insertResult = ArrayInsert(&resultArray, rightIter->first, &rightIter->second);
+					insertResult = ArrayInsert(&resultArray, *rightIter, rightMap->find(*rightIter));
 					++rightIter;
 				}
 				if (!insertResult) {
@@ -1964,11 +2274,23 @@ static int CallSubroutine() {
 		// Call the function and check for preemption
 		PreemptRequest = false;
 
-		if (const std::error_code ec = to_subroutine(sym->value)(Context.FocusDocument, Arguments(Context.StackP, nArgs), &result)) {
+		std::error_code ec;
+		if (MacroProfilingEnabled()) {
+			const auto start = std::chrono::steady_clock::now();
+			ec               = to_subroutine(sym->value)(Context.FocusDocument, Arguments(Context.StackP, nArgs), &result);
+			ProfileBuiltinCall(sym->name, std::chrono::steady_clock::now() - start);
+		} else {
+			ec = to_subroutine(sym->value)(Context.FocusDocument, Arguments(Context.StackP, nArgs), &result);
+		}
+
+		if (ec) {
 			return ExecError(ec, sym->name.c_str());
 		}
 
-		if (Context.PC->func == FetchReturnVal) {
+		// a built-in may take a while, so check the time slice right away
+		SliceCountdown = 0;
+
+		if (Context.PC->op == OP_FETCH_RET_VAL) {
 
 			if (is_unset(result)) {
 				return ExecError("%s does not return a value", sym->name.c_str());
@@ -2084,7 +2406,7 @@ static int ReturnValueOrNone(bool valOnStack) {
 		} else {
 			PUSH(make_value());
 		}
-	} else if (Context.PC->func == FetchReturnVal) {
+	} else if (Context.PC->op == OP_FETCH_RET_VAL) {
 		if (valOnStack) {
 			PUSH(retVal);
 			Context.PC++;
@@ -2195,6 +2517,315 @@ static int BranchNever() {
 	return StatusOk;
 }
 
+/**
+ * @brief Get the value of a symbol which holds an integer.
+ *
+ * @param sym The symbol to look up.
+ * @return A pointer to the symbol's value, or nullptr if the symbol isn't a
+ * local variable, global variable or constant, or its value isn't an integer.
+ */
+static DataValue *IntegerSymValue(Symbol *sym) {
+
+	DataValue *value;
+
+	switch (sym->type) {
+	case SymbolLocal:
+		value = &FP_GET_SYM_VAL(Context.FrameP, sym);
+		break;
+	case SymbolGlobal:
+	case SymbolConst:
+		value = &sym->value;
+		break;
+	default:
+		return nullptr;
+	}
+
+	return is_integer(*value) ? value : nullptr;
+}
+
+/**
+ * @brief Push the sum of two integer symbols onto the stack. Replaces the
+ * sequence PUSH_SYM, PUSH_SYM, ADD.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int PushSymPushSymAdd() {
+
+	/*
+	** Before: Prog->  [Sym1], PUSH_SYM, Sym2, ADD, next, ...
+	**         TheStack-> next, ...
+	** After:  Prog->  Sym1, PUSH_SYM, Sym2, ADD, [next], ...
+	**         TheStack-> [sum], next, ...
+	** If either value isn't an integer, only Sym1 is pushed, and execution
+	** continues with the PUSH_SYM.
+	*/
+
+	DISASM_RT(Context.PC - 1, 5);
+	STACKDUMP(0, 3);
+
+	const DataValue *v1 = IntegerSymValue(Context.PC[0].sym);
+	const DataValue *v2 = IntegerSymValue(Context.PC[2].sym);
+
+	if (!v1 || !v2) {
+		return PushSymValue();
+	}
+
+	Context.PC += 4;
+	PUSH_INT(to_integer(*v1) + to_integer(*v2));
+	return StatusOk;
+}
+
+/**
+ * @brief Add `delta` to an integer variable in place.
+ *
+ * @param delta The amount to add.
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int PushSymStepAssign(int delta) {
+
+	/*
+	** Before: Prog->  [Sym], INCR/DECR, ASSIGN, Sym, next, ...
+	**         TheStack-> next, ...
+	** After:  Prog->  Sym, INCR/DECR, ASSIGN, Sym, [next], ...
+	**         TheStack-> next, ...
+	** If the value isn't an integer, or the symbol can't be assigned to, it is
+	** only pushed, and execution continues with the INCR/DECR.
+	*/
+
+	DISASM_RT(Context.PC - 1, 5);
+	STACKDUMP(0, 3);
+
+	Symbol *sym      = Context.PC->sym;
+	DataValue *value = (sym->type == SymbolConst) ? nullptr : IntegerSymValue(sym);
+
+	if (!value) {
+		return PushSymValue();
+	}
+
+	*value = make_value(to_integer(*value) + delta);
+	Context.PC += 4;
+	return StatusOk;
+}
+
+/**
+ * @brief Increment an integer variable in place. Replaces the sequence
+ * PUSH_SYM, INCR, ASSIGN.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int PushSymIncrAssign() {
+	return PushSymStepAssign(1);
+}
+
+/**
+ * @brief Decrement an integer variable in place. Replaces the sequence
+ * PUSH_SYM, DECR, ASSIGN.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int PushSymDecrAssign() {
+	return PushSymStepAssign(-1);
+}
+
+/*
+** Comparisons followed by a conditional branch
+** Before: Prog->  BRANCH_FALSE, branchDest, next, ..., (branchdest)next
+**         TheStack-> value2, value1, next, ...
+** After:  either: Prog->  BRANCH_FALSE, branchDest, [next], ...
+** After:  or:     Prog->  BRANCH_FALSE, branchDest, next, ..., (branchdest)[next]
+**         TheStack-> next, ...
+*/
+#define COMPARE_AND_BRANCH_FALSE(compare)   \
+	do {                                    \
+		if (const int status = (compare)(); \
+			status != StatusOk) {           \
+			return status;                  \
+		}                                   \
+		++Context.PC;                       \
+		return BranchFalse();               \
+	} while (0)
+
+/**
+ * @brief Branch if the first value isn't greater than the second. Replaces
+ * the sequence GT, BRANCH_FALSE.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int GtBranchFalse() {
+	COMPARE_AND_BRANCH_FALSE(Gt);
+}
+
+/**
+ * @brief Branch if the first value isn't less than the second. Replaces the
+ * sequence LT, BRANCH_FALSE.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int LtBranchFalse() {
+	COMPARE_AND_BRANCH_FALSE(Lt);
+}
+
+/**
+ * @brief Branch if the first value isn't greater than or equal to the second.
+ * Replaces the sequence GE, BRANCH_FALSE.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int GeBranchFalse() {
+	COMPARE_AND_BRANCH_FALSE(Ge);
+}
+
+/**
+ * @brief Branch if the first value isn't less than or equal to the second.
+ * Replaces the sequence LE, BRANCH_FALSE.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int LeBranchFalse() {
+	COMPARE_AND_BRANCH_FALSE(Le);
+}
+
+/**
+ * @brief Branch if two values aren't equal. Replaces the sequence EQ,
+ * BRANCH_FALSE.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int EqBranchFalse() {
+	COMPARE_AND_BRANCH_FALSE(Eq);
+}
+
+/**
+ * @brief Branch if two values are equal. Replaces the sequence NE,
+ * BRANCH_FALSE.
+ *
+ * @return StatusOk on success, or an error code if an error occurred.
+ */
+static int NeBranchFalse() {
+	COMPARE_AND_BRANCH_FALSE(Ne);
+}
+
+/**
+ * @brief Execute a single instruction. The PC points just past the
+ * instruction, at its operands (if any).
+ *
+ * @param op The instruction to execute.
+ * @return StatusOk on success, or another status code to stop execution.
+ *
+ * @note This is a switch rather than a table of function pointers so that the
+ * compiler can inline the instructions into a single jump table.
+ */
+static int Dispatch(Operations op) {
+	switch (op) {
+	case OP_RETURN_NO_VAL:
+		return ReturnNoValue();
+	case OP_RETURN:
+		return ReturnValue();
+	case OP_PUSH_SYM:
+		return PushSymValue();
+	case OP_DUP:
+		return DupStack();
+	case OP_ADD:
+		return Add();
+	case OP_SUB:
+		return Subtract();
+	case OP_MUL:
+		return Multiply();
+	case OP_DIV:
+		return Divide();
+	case OP_MOD:
+		return Modulo();
+	case OP_NEGATE:
+		return Negate();
+	case OP_INCR:
+		return Increment();
+	case OP_DECR:
+		return Decrement();
+	case OP_GT:
+		return Gt();
+	case OP_LT:
+		return Lt();
+	case OP_GE:
+		return Ge();
+	case OP_LE:
+		return Le();
+	case OP_EQ:
+		return Eq();
+	case OP_NE:
+		return Ne();
+	case OP_BIT_AND:
+		return BitAnd();
+	case OP_BIT_OR:
+		return BitOr();
+	case OP_AND:
+		return LogicalAnd();
+	case OP_OR:
+		return LogicalOr();
+	case OP_NOT:
+		return LogicalNot();
+	case OP_POWER:
+		return Power();
+	case OP_CONCAT:
+		return Concat();
+	case OP_ASSIGN:
+		return Assign();
+	case OP_SUBR_CALL:
+		return CallSubroutine();
+	case OP_FETCH_RET_VAL:
+		return FetchReturnVal();
+	case OP_BRANCH:
+		return Branch();
+	case OP_BRANCH_TRUE:
+		return BranchTrue();
+	case OP_BRANCH_FALSE:
+		return BranchFalse();
+	case OP_BRANCH_NEVER:
+		return BranchNever();
+	case OP_ARRAY_REF:
+		return ArrayRef();
+	case OP_ARRAY_ASSIGN:
+		return ArrayAssign();
+	case OP_BEGIN_ARRAY_ITER:
+		return BeginArrayIter();
+	case OP_ARRAY_ITER:
+		return ArrayIter();
+	case OP_IN_ARRAY:
+		return InArray();
+	case OP_ARRAY_DELETE:
+		return DeleteArrayElement();
+	case OP_PUSH_ARRAY_SYM:
+		return PushArraySymVal();
+	case OP_ARRAY_REF_ASSIGN_SETUP:
+		return ArrayRefAndAssignSetup();
+	case OP_PUSH_ARG:
+		return PushArgValue();
+	case OP_PUSH_ARG_COUNT:
+		return PushArgCount();
+	case OP_PUSH_ARG_ARRAY:
+		return PushArgArray();
+	case OP_PUSH_SYM_PUSH_SYM_ADD:
+		return PushSymPushSymAdd();
+	case OP_PUSH_SYM_INCR_ASSIGN:
+		return PushSymIncrAssign();
+	case OP_PUSH_SYM_DECR_ASSIGN:
+		return PushSymDecrAssign();
+	case OP_GT_BRANCH_FALSE:
+		return GtBranchFalse();
+	case OP_LT_BRANCH_FALSE:
+		return LtBranchFalse();
+	case OP_GE_BRANCH_FALSE:
+		return GeBranchFalse();
+	case OP_LE_BRANCH_FALSE:
+		return LeBranchFalse();
+	case OP_EQ_BRANCH_FALSE:
+		return EqBranchFalse();
+	case OP_NE_BRANCH_FALSE:
+		return NeBranchFalse();
+	}
+
+	return ExecError("internal error: unknown instruction %d", op);
+}
+
 /**
  * @brief Recursively copy an array.
  *
@@ -2208,31 +2839,45 @@ int ArrayCopy(DataValue *dstArray, const DataValue *srcArray) {
 }
 
 /**
- * @brief Create a key string for an array from the arguments on the stack.
+ * @brief Create a key for an array from the arguments on the stack.
  *
  * @param nArgs The number of arguments to process from the stack.
- * @param keyString A string where the key will be stored.
+ * @param key Where the key will be stored.
  * @param leaveParams If `true`, the parameters will not be popped from the stack after processing.
  * @return StatusOk on success, or an error code if an error occurred.
  */
-static int MakeArrayKeyFromArgs(int64_t nArgs, std::string *keyString, bool leaveParams) {
+static int MakeArrayKeyFromArgs(int64_t nArgs, ArrayKey *key, bool leaveParams) {
 	DataValue tmpVal;
 
-	std::string str;
+	key->isIndex = false;
 
-	for (int64_t i = nArgs - 1; i >= 0; --i) {
-		if (i != nArgs - 1) {
-			str.append(ARRAY_DIM_SEP);
-		}
-		PEEK(tmpVal, i);
+	if (nArgs == 1) {
+		PEEK(tmpVal, 0);
 		if (is_integer(tmpVal)) {
-			str.append(std::to_string(to_integer(tmpVal)));
-		} else if (is_string(tmpVal)) {
-			auto s = to_string(tmpVal);
-			str.append(s.begin(), s.end());
-		} else {
-			return ExecError("can only index array with string or int.");
+			key->index   = to_integer(tmpVal);
+			key->isIndex = true;
+		}
+	}
+
+	if (!key->isIndex) {
+		std::string str;
+
+		for (int64_t i = nArgs - 1; i >= 0; --i) {
+			if (i != nArgs - 1) {
+				str.append(ARRAY_DIM_SEP);
+			}
+			PEEK(tmpVal, i);
+			if (is_integer(tmpVal)) {
+				str.append(std::to_string(to_integer(tmpVal)));
+			} else if (is_string(tmpVal)) {
+				auto s = to_string(tmpVal);
+				str.append(s.begin(), s.end());
+			} else {
+				return ExecError("can only index array with string or int.");
+			}
 		}
+
+		key->string = std::move(str);
 	}
 
 	if (!leaveParams) {
@@ -2241,8 +2886,6 @@ static int MakeArrayKeyFromArgs(int64_t nArgs, std::string *keyString, bool leav
 		}
 	}
 
-	*keyString = str;
-
 	return StatusOk;
 }
 
@@ -2257,12 +2900,7 @@ static int MakeArrayKeyFromArgs(int64_t nArgs, std::string *keyString, bool leav
 bool ArrayInsert(DataValue *theArray, const std::string &keyStr, DataValue *theValue) {
 
 	const ArrayPtr &m = to_array(*theArray);
-	auto p            = m->insert(std::make_pair(keyStr, *theValue));
-	if (p.second) {
-		return true;
-	}
-
-	p.first->second = *theValue;
+	m->insert(keyStr, *theValue);
 	return true;
 }
 
@@ -2275,11 +2913,7 @@ bool ArrayInsert(DataValue *theArray, const std::string &keyStr, DataValue *theV
 void ArrayDelete(DataValue *theArray, const std::string &keyStr) {
 
 	const ArrayPtr &m = to_array(*theArray);
-
-	auto it = m->find(keyStr);
-	if (it != m->end()) {
-		m->erase(it);
-	}
+	m->erase(keyStr);
 }
 
 /**
@@ -2315,9 +2949,8 @@ int ArraySize(DataValue *theArray) {
 bool ArrayGet(DataValue *theArray, const std::string &keyStr, DataValue *theValue) {
 
 	const ArrayPtr &m = to_array(*theArray);
-	auto it           = m->find(keyStr);
-	if (it != m->end()) {
-		*theValue = it->second;
+	if (const DataValue *value = m->find(keyStr)) {
+		*theValue = *value;
 		return true;
 	}
 
@@ -2332,23 +2965,24 @@ bool ArrayGet(DataValue *theArray, const std::string &keyStr, DataValue *theValu
  */
 ArrayIterator ArrayIterateFirst(DataValue *theArray) {
 
-	const ArrayPtr &m = to_array(*theArray);
-	ArrayIterator it{m, m->begin()};
-
+	ArrayIterator it;
+	it.m     = to_array(*theArray);
+	it.atEnd = !it.m->first(&it.key);
 	return it;
 }
 
 /**
- * @brief Advance the iterator to the next element in the array.
+ * @brief Advance the iterator to the next element in the array, in key order.
  *
  * @param iterator The iterator to advance.
- * @return The updated iterator, now pointing to the next element.
+ * @return `true` if the iterator now refers to an element, `false` if there
+ * are no more elements.
  */
-ArrayIterator ArrayIterateNext(ArrayIterator iterator) {
+bool ArrayIterateNext(ArrayIterator *iterator) {
 
-	Q_ASSERT(iterator.it != iterator.m->end());
-	++(iterator.it);
-	return iterator;
+	Q_ASSERT(!iterator->atEnd);
+	iterator->atEnd = !iterator->m->next(&iterator->key);
+	return !iterator->atEnd;
 }
 
 /**
@@ -2366,8 +3000,7 @@ static int ArrayRef() {
 	 */
 
 	DataValue srcArray;
-	DataValue valueItem;
-	std::string keyString;
+	ArrayKey key;
 
 	const int64_t nDim = Context.PC++->value;
 
@@ -2375,17 +3008,18 @@ static int ArrayRef() {
 	STACKDUMP(nDim, 3);
 
 	if (nDim > 0) {
-		const int errNum = MakeArrayKeyFromArgs(nDim, &keyString, false);
+		const int errNum = MakeArrayKeyFromArgs(nDim, &key, false);
 		if (errNum != StatusOk) {
 			return errNum;
 		}
 
 		POP(srcArray);
 		if (is_array(srcArray)) {
-			if (!ArrayGet(&srcArray, keyString, &valueItem)) {
-				return ExecError("referenced array value not in array: %s", keyString.c_str());
+			const DataValue *valueItem = ArrayFind(srcArray, key);
+			if (!valueItem) {
+				return ExecError("referenced array value not in array: %s", key.str().c_str());
 			}
-			PUSH(valueItem);
+			PUSH(*valueItem);
 			return StatusOk;
 		}
 
@@ -2415,7 +3049,7 @@ static int ArrayAssign() {
 	**         TheStack-> next, ...
 	*/
 
-	std::string keyString;
+	ArrayKey key;
 	DataValue srcValue;
 	DataValue dstArray;
 
@@ -2427,7 +3061,7 @@ static int ArrayAssign() {
 	if (nDim > 0) {
 		POP(srcValue);
 
-		if (const int errNum = MakeArrayKeyFromArgs(nDim, &keyString, false); errNum != StatusOk) {
+		if (const int errNum = MakeArrayKeyFromArgs(nDim, &key, false); errNum != StatusOk) {
 			return errNum;
 		}
 
@@ -2449,11 +3083,8 @@ static int ArrayAssign() {
 			}
 		}
 
-		if (ArrayInsert(&dstArray, keyString, &srcValue)) {
-			return StatusOk;
-		}
-
-		return ExecError("array member allocation failure");
+		ArrayInsert(dstArray, key, srcValue);
+		return StatusOk;
 	}
 
 	return ExecError("empty operator []");
@@ -2474,9 +3105,8 @@ static int ArrayRefAndAssignSetup() {
 	 */
 
 	DataValue srcArray;
-	DataValue valueItem;
 	DataValue moveExpr;
-	std::string keyString;
+	ArrayKey key;
 
 	const int64_t binaryOp = Context.PC++->value;
 	const int64_t nDim     = Context.PC++->value;
@@ -2489,16 +3119,17 @@ static int ArrayRefAndAssignSetup() {
 	}
 
 	if (nDim > 0) {
-		if (const int errNum = MakeArrayKeyFromArgs(nDim, &keyString, true); errNum != StatusOk) {
+		if (const int errNum = MakeArrayKeyFromArgs(nDim, &key, true); errNum != StatusOk) {
 			return errNum;
 		}
 
 		PEEK(srcArray, nDim);
 		if (is_array(srcArray)) {
-			if (!ArrayGet(&srcArray, keyString, &valueItem)) {
-				return ExecError("referenced array value not in array: %s", keyString.c_str());
+			const DataValue *valueItem = ArrayFind(srcArray, key);
+			if (!valueItem) {
+				return ExecError("referenced array value not in array: %s", key.str().c_str());
 			}
-			PUSH(valueItem);
+			PUSH(*valueItem);
 			if (binaryOp) {
 				PUSH(moveExpr);
 			}
@@ -2606,11 +3237,16 @@ static int ArrayIter() {
 
 	DataValue *iteratorValPtr = &FP_GET_SYM_VAL(Context.FrameP, iterator);
 
-	const ArrayIterator thisEntry = to_iterator(*iteratorValPtr);
+	ArrayIterator &thisEntry = std::get<ArrayIterator>(iteratorValPtr->value);
+
+	// NOTE: the body of the loop may have deleted the element the iterator refers to
+	if (!thisEntry.atEnd) {
+		thisEntry.atEnd = !thisEntry.m->seek(&thisEntry.key);
+	}
 
-	if (thisEntry.it != thisEntry.m->end()) {
-		*itemValPtr     = make_value(thisEntry.it->first);
-		*iteratorValPtr = make_value(ArrayIterateNext(thisEntry));
+	if (!thisEntry.atEnd) {
+		*itemValPtr = make_value(thisEntry.key);
+		ArrayIterateNext(&thisEntry);
 	} else {
 		Context.PC = branchAddr;
 	}
@@ -2657,12 +3293,13 @@ static int InArray() {
 
 		const ArrayPtr &m = to_array(leftArray);
 
-		inResult  = 1;
-		auto iter = m->begin();
-		while (inResult && iter != m->end()) {
-			inResult = inResult && ArrayGet(&theArray, iter->first, &theValue);
-			++iter;
-		}
+		const ArrayPtr &rightMap = to_array(theArray);
+
+		const std::set<std::string> &leftKeys = m->keys();
+
+		inResult = std::all_of(leftKeys.begin(), leftKeys.end(), [&rightMap](const std::string &key) {
+			return rightMap->find(key) != nullptr;
+		});
 	} else {
 		std::string keyStr;
 		POP_STRING(keyStr);
@@ -2693,7 +3330,7 @@ static int DeleteArrayElement() {
 	 */
 
 	DataValue theArray;
-	std::string keyString;
+	ArrayKey key;
 
 	const int64_t nDim = Context.PC++->value;
 
@@ -2701,7 +3338,7 @@ static int DeleteArrayElement() {
 	STACKDUMP(nDim + 1, 3);
 
 	if (nDim > 0) {
-		const int errNum = MakeArrayKeyFromArgs(nDim, &keyString, false);
+		const int errNum = MakeArrayKeyFromArgs(nDim, &key, false);
 		if (errNum != StatusOk) {
 			return errNum;
 		}
@@ -2710,7 +3347,7 @@ static int DeleteArrayElement() {
 	POP(theArray);
 	if (is_array(theArray)) {
 		if (nDim > 0) {
-			ArrayDelete(&theArray, keyString);
+			ArrayDelete(theArray, key);
 		} else {
 			ArrayDeleteAll(&theArray);
 		}
@@ -2862,7 +3499,16 @@ static void Disassemble(Inst *inst, size_t nInstr) {
 		"ARRAY_REF_ASSIGN_SETUP", // ArrayRefAndAssignSetup
 		"PUSH_ARG",               // $arg[expr]
 		"PUSH_ARG_COUNT",         // $arg[]
-		"PUSH_ARG_ARRAY"          // $arg
+		"PUSH_ARG_ARRAY",         // $arg
+		"PUSH_SYM_PUSH_SYM_ADD",  // PushSymPushSymAdd
+		"PUSH_SYM_INCR_ASSIGN",   // PushSymIncrAssign
+		"PUSH_SYM_DECR_ASSIGN",   // PushSymDecrAssign
+		"GT_BRANCH_FALSE",        // GtBranchFalse
+		"LT_BRANCH_FALSE",        // LtBranchFalse
+		"GE_BRANCH_FALSE",        // GeBranchFalse
+		"LE_BRANCH_FALSE",        // LeBranchFalse
+		"EQ_BRANCH_FALSE",        // EqBranchFalse
+		"NE_BRANCH_FALSE"         // NeBranchFalse
 	};
 	int j;
 
@@ -2870,9 +3516,9 @@ static void Disassemble(Inst *inst, size_t nInstr) {
 	for (size_t i = 0; i < nInstr; ++i) {
 		printf("Prog %8p ", static_cast<void *>(&inst[i]));
 		for (j = 0; j < N_OPS; ++j) {
-			if (inst[i].func == OpFns[j]) {
+			if (inst[i].op == j) {
 				printf("%22s ", opNames[j]);
-				if (j == OP_PUSH_SYM || j == OP_ASSIGN) {
+				if (j == OP_PUSH_SYM || j == OP_ASSIGN || j == OP_PUSH_SYM_PUSH_SYM_ADD || j == OP_PUSH_SYM_INCR_ASSIGN || j == OP_PUSH_SYM_DECR_ASSIGN) {
 					Symbol *sym = inst[i + 1].sym;
 					printf("%s", sym->name.c_str());
 					if (is_string(sym->value) && sym->name.compare(0, 8, "string #") == 0) {
@@ -2,11 +2,13 @@
 #ifndef INTERPRET_H_
 #define INTERPRET_H_
 
+#include "Array.h"
 #include "DataValue.h"
 
 #include <QString>
 #include <QtAlgorithms>
 
+#include <chrono>
 #include <deque>
 #include <memory>
 #include <string_view>
@@ -31,7 +33,7 @@ enum SymbolType {
 	SymbolMacroFunc
 };
 
-#define N_OPS 43
+#define N_OPS 52
 enum Operations {
 	OP_RETURN_NO_VAL,
 	OP_RETURN,
@@ -75,7 +77,18 @@ enum Operations {
 	OP_ARRAY_REF_ASSIGN_SETUP,
 	OP_PUSH_ARG,
 	OP_PUSH_ARG_COUNT,
-	OP_PUSH_ARG_ARRAY
+	OP_PUSH_ARG_ARRAY,
+
+	// superinstructions, which are only produced by FinishCreatingProgram
+	OP_PUSH_SYM_PUSH_SYM_ADD,
+	OP_PUSH_SYM_INCR_ASSIGN,
+	OP_PUSH_SYM_DECR_ASSIGN,
+	OP_GT_BRANCH_FALSE,
+	OP_LT_BRANCH_FALSE,
+	OP_GE_BRANCH_FALSE,
+	OP_LE_BRANCH_FALSE,
+	OP_EQ_BRANCH_FALSE,
+	OP_NE_BRANCH_FALSE
 };
 
 enum ExecReturnCodes {
@@ -86,7 +99,7 @@ enum ExecReturnCodes {
 };
 
 union Inst {
-	int (*func)();
+	Operations op;
 	int64_t value;
 	Symbol *sym;
 };
@@ -102,25 +115,32 @@ struct Symbol {
 
 struct Program {
 
-	~Program() {
-		qDeleteAll(localSymList);
-	}
+	~Program();
 
 	std::deque<Symbol *> localSymList;
 	std::vector<Inst> code;
+	std::vector<int> lines; // the source line of each instruction in code, counting from 1
+	std::string name;       // where the program came from, for profiling
 };
 
 /* Information needed to re-start a preempted macro */
+// How long a macro runs before giving the event loop a chance to run
+constexpr std::chrono::milliseconds DefaultMacroTimeSlice(8);
+
+// A time slice which lets a macro run until it is done or preempts itself
+constexpr std::chrono::milliseconds UnlimitedMacroTimeSlice(0);
+
 struct MacroContext {
 
 	using stack_type = std::shared_ptr<DataValue>;
 
-	stack_type Stack;                        // the stack
-	DataValue *StackP             = nullptr; // next free spot on stack
-	DataValue *FrameP             = nullptr; // frame pointer (start of local variables for the current subroutine invocation)
-	Inst *PC                      = nullptr; // program counter during execution
-	DocumentWidget *RunDocument   = nullptr; // document from which macro was run
-	DocumentWidget *FocusDocument = nullptr; // document on which macro commands operate
+	stack_type Stack;                                            // the stack
+	DataValue *StackP                   = nullptr;               // next free spot on stack
+	DataValue *FrameP                   = nullptr;               // frame pointer (start of local variables for the current subroutine invocation)
+	Inst *PC                            = nullptr;               // program counter during execution
+	DocumentWidget *RunDocument         = nullptr;               // document from which macro was run
+	DocumentWidget *FocusDocument       = nullptr;               // document on which macro commands operate
+	std::chrono::milliseconds TimeSlice = DefaultMacroTimeSlice; // how long each call of continueMacro may run
 };
 
 void InitMacroGlobals();
@@ -155,9 +175,14 @@ void BeginCreatingProgram();
 void FillLoopAddrs(const Inst *breakAddr, const Inst *continueAddr);
 void StartLoopAddrList();
 void SwapCode(Inst *start, Inst *boundary, Inst *end);
+void SetMacroSuperinstructions(bool enable);
+#ifdef NEDIT_MACRO_BENCH
+void SetMacroSwitchDispatch(bool enable);
+#endif
+void SetSourceLine(int line);
 
 // Routines for executing programs
-int ExecuteMacro(DocumentWidget *document, Program *prog, gsl::span<DataValue> arguments, DataValue *result, std::shared_ptr<MacroContext> &continuation, QString *msg);
+int ExecuteMacro(DocumentWidget *document, Program *prog, gsl::span<DataValue> arguments, DataValue *result, std::shared_ptr<MacroContext> &continuation, QString *msg, std::chrono::milliseconds timeSlice = DefaultMacroTimeSlice);
 ExecReturnCodes continueMacro(const std::shared_ptr<MacroContext> &continuation, DataValue *result, QString *msg);
 void RunMacroAsSubrCall(Program *prog);
 void preemptMacro();
@@ -31,6 +31,8 @@ static int follow_non_whitespace(char expect, int yes, int no);
 static QString ErrMsg;
 static QString::const_iterator InPtr;
 static QString::const_iterator EndPtr;
+static QString::const_iterator LinePtr; /* how far newlines have been counted */
+static int Line;                        /* the line LinePtr is on, where the last token began */
 extern Inst *LoopStack[]; /* addresses of break, cont stmts */
 extern Inst **LoopStackPtr;  /*  to fill at the end of a loop */
 
@@ -442,6 +444,8 @@ Program *CompileMacro(const QString &expr, QString *msg, int *stoppedAt) {
 	QString::const_iterator start = expr.begin();
 	InPtr                         = start;
 	EndPtr                        = start + expr.size();
+	LinePtr                       = start;
+	Line                          = 1;
 
 	if (yyparse()) {
 		*msg          = ErrMsg;
@@ -487,6 +491,16 @@ static int yylex(void) {
 		}
 	}
 
+	/* code generated from here on is attributed to the line of the previous
+	   token, as the parser has usually read one token past the code it
+	   generates, then move on to the line of this one */
+	SetSourceLine(Line);
+	for (; LinePtr < InPtr; ++LinePtr) {
+		if (*LinePtr == QLatin1Char('\n')) {
+			++Line;
+		}
+	}
+
 	/* return end of input at the end of the string */
 	if (InPtr == EndPtr) {
 		return 0;
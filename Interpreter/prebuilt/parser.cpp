@@ -101,11 +101,13 @@ static int follow_non_whitespace(char expect, int yes, int no);
 static QString ErrMsg;
 static QString::const_iterator InPtr;
 static QString::const_iterator EndPtr;
+static QString::const_iterator LinePtr; /* how far newlines have been counted */
+static int Line;                        /* the line LinePtr is on, where the last token began */
 extern Inst *LoopStack[]; /* addresses of break, cont stmts */
 extern Inst **LoopStackPtr;  /*  to fill at the end of a loop */
 
 
-#line 109 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 111 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -599,17 +601,17 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    74,    74,    77,    80,    83,    87,    88,    89,    91,
-      92,    94,    95,    98,   101,   105,   110,   110,   120,   126,
-     132,   135,   139,   142,   145,   148,   151,   154,   157,   160,
-     163,   166,   169,   174,   179,   184,   189,   194,   199,   204,
-     209,   214,   219,   224,   228,   232,   236,   240,   245,   249,
-     252,   255,   259,   262,   265,   269,   270,   274,   277,   281,
-     284,   288,   292,   295,   298,   301,   306,   307,   310,   313,
-     316,   319,   322,   325,   328,   331,   334,   337,   340,   343,
-     346,   349,   352,   355,   358,   361,   364,   367,   370,   373,
-     377,   381,   385,   389,   393,   397,   401,   405,   408,   412,
-     417,   422,   423
+       0,    76,    76,    79,    82,    85,    89,    90,    91,    93,
+      94,    96,    97,   100,   103,   107,   112,   112,   122,   128,
+     134,   137,   141,   144,   147,   150,   153,   156,   159,   162,
+     165,   168,   171,   176,   181,   186,   191,   196,   201,   206,
+     211,   216,   221,   226,   230,   234,   238,   242,   247,   251,
+     254,   257,   261,   264,   267,   271,   272,   276,   279,   283,
+     286,   290,   294,   297,   300,   303,   308,   309,   312,   315,
+     318,   321,   324,   327,   330,   333,   336,   339,   342,   345,
+     348,   351,   354,   357,   360,   363,   366,   369,   372,   375,
+     379,   383,   387,   391,   395,   399,   403,   407,   410,   414,
+     419,   424,   425
 };
 #endif
 
@@ -1366,783 +1368,783 @@ yyreduce:
   switch (yyn)
     {
   case 2: /* program: blank stmts  */
-#line 74 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 76 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                         {
                 ADD_OP(OP_RETURN_NO_VAL); return 0;
             }
-#line 1374 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1376 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 3: /* program: blank '{' blank stmts '}'  */
-#line 77 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 79 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                         {
                 ADD_OP(OP_RETURN_NO_VAL); return 0;
             }
-#line 1382 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1384 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 4: /* program: blank '{' blank '}'  */
-#line 80 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 82 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_RETURN_NO_VAL); return 0;
             }
-#line 1390 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1392 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 5: /* program: error  */
-#line 83 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 85 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                     {
                 return 1;
             }
-#line 1398 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1400 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 12: /* stmt: IF '(' cond ')' blank block  */
-#line 95 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 97 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                            {
                 SET_BR_OFF((yyvsp[-3].inst), GetPC());
             }
-#line 1406 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1408 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 13: /* stmt: IF '(' cond ')' blank block else blank block  */
-#line 98 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 100 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                                       {
                 SET_BR_OFF((yyvsp[-6].inst), ((yyvsp[-2].inst)+1)); SET_BR_OFF((yyvsp[-2].inst), GetPC());
             }
-#line 1414 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1416 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 14: /* stmt: while '(' cond ')' blank block  */
-#line 101 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 103 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                              {
                 ADD_OP(OP_BRANCH); ADD_BR_OFF((yyvsp[-5].inst));
                 SET_BR_OFF((yyvsp[-3].inst), GetPC()); FillLoopAddrs(GetPC(), (yyvsp[-5].inst));
             }
-#line 1423 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1425 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 15: /* stmt: for '(' comastmts ';' cond ';' comastmts ')' blank block  */
-#line 105 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 107 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                                        {
                 FillLoopAddrs(GetPC()+2+((yyvsp[-3].inst)-((yyvsp[-5].inst)+1)), GetPC());
                 SwapCode((yyvsp[-5].inst)+1, (yyvsp[-3].inst), GetPC());
                 ADD_OP(OP_BRANCH); ADD_BR_OFF((yyvsp[-7].inst)); SET_BR_OFF((yyvsp[-5].inst), GetPC());
             }
-#line 1433 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1435 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 16: /* $@1: %empty  */
-#line 110 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 112 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                               {
                 Symbol *iterSym = InstallIteratorSymbol();
                 ADD_OP(OP_BEGIN_ARRAY_ITER); ADD_SYM(iterSym);
                 ADD_OP(OP_ARRAY_ITER); ADD_SYM((yyvsp[-3].sym)); ADD_SYM(iterSym); ADD_BR_OFF(nullptr);
             }
-#line 1443 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1445 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 17: /* stmt: for '(' SYMBOL IN arrayexpr ')' $@1 blank block  */
-#line 115 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 117 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                             {
                     ADD_OP(OP_BRANCH); ADD_BR_OFF((yyvsp[-4].inst)+2);
                     SET_BR_OFF((yyvsp[-4].inst)+5, GetPC());
                     FillLoopAddrs(GetPC(), (yyvsp[-4].inst)+2);
             }
-#line 1453 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1455 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 18: /* stmt: BREAK '\n' blank  */
-#line 120 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 122 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                {
                 ADD_OP(OP_BRANCH); ADD_BR_OFF(nullptr);
                 if (AddBreakAddr(GetPC()-1)) {
                     yyerror("break outside loop"); YYERROR;
                 }
             }
-#line 1464 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1466 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 19: /* stmt: CONTINUE '\n' blank  */
-#line 126 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 128 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_BRANCH); ADD_BR_OFF(nullptr);
                 if (AddContinueAddr(GetPC()-1)) {
                     yyerror("continue outside loop"); YYERROR;
                 }
             }
-#line 1475 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1477 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 20: /* stmt: RETURN expr '\n' blank  */
-#line 132 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 134 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                      {
                 ADD_OP(OP_RETURN);
             }
-#line 1483 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1485 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 21: /* stmt: RETURN '\n' blank  */
-#line 135 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 137 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                 {
                 ADD_OP(OP_RETURN_NO_VAL);
             }
-#line 1491 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1493 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 22: /* simpstmt: SYMBOL '=' expr  */
-#line 139 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 141 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                             {
                 ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1499 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1501 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 23: /* simpstmt: evalsym ADDEQ expr  */
-#line 142 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 144 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                 ADD_OP(OP_ADD); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1507 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1509 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 24: /* simpstmt: evalsym SUBEQ expr  */
-#line 145 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 147 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                 ADD_OP(OP_SUB); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1515 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1517 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 25: /* simpstmt: evalsym MULEQ expr  */
-#line 148 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 150 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                 ADD_OP(OP_MUL); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1523 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1525 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 26: /* simpstmt: evalsym DIVEQ expr  */
-#line 151 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 153 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                 ADD_OP(OP_DIV); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1531 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1533 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 27: /* simpstmt: evalsym MODEQ expr  */
-#line 154 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 156 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                 ADD_OP(OP_MOD); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1539 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1541 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 28: /* simpstmt: evalsym ANDEQ expr  */
-#line 157 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 159 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                 ADD_OP(OP_BIT_AND); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1547 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1549 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 29: /* simpstmt: evalsym OREQ expr  */
-#line 160 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 162 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                 {
                 ADD_OP(OP_BIT_OR); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-2].sym));
             }
-#line 1555 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1557 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 30: /* simpstmt: DELETE arraylv '[' arglist ']'  */
-#line 163 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 165 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                              {
                 ADD_OP(OP_ARRAY_DELETE); ADD_IMMED((yyvsp[-1].nArgs));
             }
-#line 1563 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1565 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 31: /* simpstmt: initarraylv '[' arglist ']' '=' expr  */
-#line 166 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 168 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                    {
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1571 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1573 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 32: /* simpstmt: initarraylv '[' arglist ']' ADDEQ expr  */
-#line 169 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 171 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                      {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(1); ADD_IMMED((yyvsp[-3].nArgs));
                 ADD_OP(OP_ADD);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1581 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1583 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 33: /* simpstmt: initarraylv '[' arglist ']' SUBEQ expr  */
-#line 174 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 176 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                      {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(1); ADD_IMMED((yyvsp[-3].nArgs));
                 ADD_OP(OP_SUB);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1591 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1593 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 34: /* simpstmt: initarraylv '[' arglist ']' MULEQ expr  */
-#line 179 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 181 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                      {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(1); ADD_IMMED((yyvsp[-3].nArgs));
                 ADD_OP(OP_MUL);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1601 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1603 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 35: /* simpstmt: initarraylv '[' arglist ']' DIVEQ expr  */
-#line 184 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 186 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                      {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(1); ADD_IMMED((yyvsp[-3].nArgs));
                 ADD_OP(OP_DIV);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1611 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1613 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 36: /* simpstmt: initarraylv '[' arglist ']' MODEQ expr  */
-#line 189 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 191 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                      {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(1); ADD_IMMED((yyvsp[-3].nArgs));
                 ADD_OP(OP_MOD);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1621 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1623 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 37: /* simpstmt: initarraylv '[' arglist ']' ANDEQ expr  */
-#line 194 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 196 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                      {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(1); ADD_IMMED((yyvsp[-3].nArgs));
                 ADD_OP(OP_BIT_AND);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1631 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1633 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 38: /* simpstmt: initarraylv '[' arglist ']' OREQ expr  */
-#line 199 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 201 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                     {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(1); ADD_IMMED((yyvsp[-3].nArgs));
                 ADD_OP(OP_BIT_OR);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-3].nArgs));
             }
-#line 1641 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1643 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 39: /* simpstmt: initarraylv '[' arglist ']' INCR  */
-#line 204 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 206 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(0); ADD_IMMED((yyvsp[-2].nArgs));
                 ADD_OP(OP_INCR);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-2].nArgs));
             }
-#line 1651 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1653 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 40: /* simpstmt: initarraylv '[' arglist ']' DECR  */
-#line 209 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 211 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(0); ADD_IMMED((yyvsp[-2].nArgs));
                 ADD_OP(OP_DECR);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-2].nArgs));
             }
-#line 1661 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1663 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 41: /* simpstmt: INCR initarraylv '[' arglist ']'  */
-#line 214 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 216 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(0); ADD_IMMED((yyvsp[-1].nArgs));
                 ADD_OP(OP_INCR);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-1].nArgs));
             }
-#line 1671 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1673 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 42: /* simpstmt: DECR initarraylv '[' arglist ']'  */
-#line 219 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 221 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                                {
                 ADD_OP(OP_ARRAY_REF_ASSIGN_SETUP); ADD_IMMED(0); ADD_IMMED((yyvsp[-1].nArgs));
                 ADD_OP(OP_DECR);
                 ADD_OP(OP_ARRAY_ASSIGN); ADD_IMMED((yyvsp[-1].nArgs));
             }
-#line 1681 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1683 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 43: /* simpstmt: SYMBOL '(' arglist ')'  */
-#line 224 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 226 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                      {
                 ADD_OP(OP_SUBR_CALL);
                 ADD_SYM(PromoteToGlobal((yyvsp[-3].sym))); ADD_IMMED((yyvsp[-1].nArgs));
             }
-#line 1690 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1692 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 44: /* simpstmt: INCR SYMBOL  */
-#line 228 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 230 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym)); ADD_OP(OP_INCR);
                 ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[0].sym));
             }
-#line 1699 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1701 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 45: /* simpstmt: SYMBOL INCR  */
-#line 232 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 234 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[-1].sym)); ADD_OP(OP_INCR);
                 ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-1].sym));
             }
-#line 1708 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1710 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 46: /* simpstmt: DECR SYMBOL  */
-#line 236 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 238 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym)); ADD_OP(OP_DECR);
                 ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[0].sym));
             }
-#line 1717 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1719 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 47: /* simpstmt: SYMBOL DECR  */
-#line 240 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 242 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[-1].sym)); ADD_OP(OP_DECR);
                 ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-1].sym));
             }
-#line 1726 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1728 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 48: /* evalsym: SYMBOL  */
-#line 245 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 247 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                    {
                 (yyval.sym) = (yyvsp[0].sym); ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym));
             }
-#line 1734 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1736 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 49: /* comastmts: %empty  */
-#line 249 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 251 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 (yyval.inst) = GetPC();
             }
-#line 1742 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1744 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 50: /* comastmts: simpstmt  */
-#line 252 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 254 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                        {
                 (yyval.inst) = GetPC();
             }
-#line 1750 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1752 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 51: /* comastmts: comastmts ',' simpstmt  */
-#line 255 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 257 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                      {
                 (yyval.inst) = GetPC();
             }
-#line 1758 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1760 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 52: /* arglist: %empty  */
-#line 259 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 261 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 (yyval.nArgs) = 0;
             }
-#line 1766 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1768 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 53: /* arglist: expr  */
-#line 262 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 264 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                    {
                 (yyval.nArgs) = 1;
             }
-#line 1774 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1776 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 54: /* arglist: arglist ',' expr  */
-#line 265 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 267 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                {
                 (yyval.nArgs) = (yyvsp[-2].nArgs) + 1;
             }
-#line 1782 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1784 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 56: /* expr: expr numexpr  */
-#line 270 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 272 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                         {
                 ADD_OP(OP_CONCAT);
             }
-#line 1790 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1792 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 57: /* initarraylv: SYMBOL  */
-#line 274 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 276 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                        {
                     ADD_OP(OP_PUSH_ARRAY_SYM); ADD_SYM((yyvsp[0].sym)); ADD_IMMED(1);
                 }
-#line 1798 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1800 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 58: /* initarraylv: initarraylv '[' arglist ']'  */
-#line 277 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 279 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                               {
                     ADD_OP(OP_ARRAY_REF); ADD_IMMED((yyvsp[-1].nArgs));
                 }
-#line 1806 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1808 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 59: /* arraylv: SYMBOL  */
-#line 281 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 283 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                    {
                 ADD_OP(OP_PUSH_ARRAY_SYM); ADD_SYM((yyvsp[0].sym)); ADD_IMMED(0);
             }
-#line 1814 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1816 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 60: /* arraylv: arraylv '[' arglist ']'  */
-#line 284 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 286 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                       {
                 ADD_OP(OP_ARRAY_REF); ADD_IMMED((yyvsp[-1].nArgs));
             }
-#line 1822 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1824 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 61: /* arrayexpr: numexpr  */
-#line 288 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 290 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                     {
                 (yyval.inst) = GetPC();
             }
-#line 1830 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1832 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 62: /* numexpr: NUMBER  */
-#line 292 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 294 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                    {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym));
             }
-#line 1838 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1840 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 63: /* numexpr: STRING  */
-#line 295 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 297 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                      {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym));
             }
-#line 1846 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1848 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 64: /* numexpr: SYMBOL  */
-#line 298 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 300 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                      {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym));
             }
-#line 1854 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1856 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 65: /* numexpr: SYMBOL '(' arglist ')'  */
-#line 301 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 303 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                      {
                 ADD_OP(OP_SUBR_CALL);
                 ADD_SYM(PromoteToGlobal((yyvsp[-3].sym))); ADD_IMMED((yyvsp[-1].nArgs));
                 ADD_OP(OP_FETCH_RET_VAL);
             }
-#line 1864 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1866 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 67: /* numexpr: ARG_LOOKUP '[' numexpr ']'  */
-#line 307 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 309 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                          {
                ADD_OP(OP_PUSH_ARG);
             }
-#line 1872 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1874 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 68: /* numexpr: ARG_LOOKUP '[' ']'  */
-#line 310 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 312 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                ADD_OP(OP_PUSH_ARG_COUNT);
             }
-#line 1880 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1882 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 69: /* numexpr: ARG_LOOKUP  */
-#line 313 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 315 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                          {
                ADD_OP(OP_PUSH_ARG_ARRAY);
             }
-#line 1888 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1890 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 70: /* numexpr: numexpr '[' arglist ']'  */
-#line 316 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 318 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                       {
                 ADD_OP(OP_ARRAY_REF); ADD_IMMED((yyvsp[-1].nArgs));
             }
-#line 1896 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1898 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 71: /* numexpr: numexpr '+' numexpr  */
-#line 319 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 321 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_ADD);
             }
-#line 1904 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1906 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 72: /* numexpr: numexpr '-' numexpr  */
-#line 322 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 324 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_SUB);
             }
-#line 1912 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1914 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 73: /* numexpr: numexpr '*' numexpr  */
-#line 325 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 327 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_MUL);
             }
-#line 1920 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1922 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 74: /* numexpr: numexpr '/' numexpr  */
-#line 328 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 330 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_DIV);
             }
-#line 1928 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1930 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 75: /* numexpr: numexpr '%' numexpr  */
-#line 331 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 333 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_MOD);
             }
-#line 1936 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1938 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 76: /* numexpr: numexpr POW numexpr  */
-#line 334 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 336 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_POWER);
             }
-#line 1944 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1946 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 77: /* numexpr: '-' numexpr  */
-#line 337 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 339 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                              {
                 ADD_OP(OP_NEGATE);
             }
-#line 1952 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1954 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 78: /* numexpr: numexpr GT numexpr  */
-#line 340 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 342 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_GT);
             }
-#line 1960 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1962 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 79: /* numexpr: numexpr GE numexpr  */
-#line 343 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 345 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_GE);
             }
-#line 1968 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1970 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 80: /* numexpr: numexpr LT numexpr  */
-#line 346 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 348 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_LT);
             }
-#line 1976 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1978 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 81: /* numexpr: numexpr LE numexpr  */
-#line 349 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 351 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_LE);
             }
-#line 1984 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1986 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 82: /* numexpr: numexpr EQ numexpr  */
-#line 352 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 354 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_EQ);
             }
-#line 1992 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 1994 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 83: /* numexpr: numexpr NE numexpr  */
-#line 355 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 357 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_NE);
             }
-#line 2000 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2002 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 84: /* numexpr: numexpr '&' numexpr  */
-#line 358 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 360 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                   {
                 ADD_OP(OP_BIT_AND);
             }
-#line 2008 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2010 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 85: /* numexpr: numexpr '|' numexpr  */
-#line 361 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 363 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                    {
                 ADD_OP(OP_BIT_OR);
             }
-#line 2016 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2018 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 86: /* numexpr: numexpr and numexpr  */
-#line 364 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 366 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                             {
                 ADD_OP(OP_AND); SET_BR_OFF((yyvsp[-1].inst), GetPC());
             }
-#line 2024 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2026 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 87: /* numexpr: numexpr or numexpr  */
-#line 367 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 369 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                           {
                 ADD_OP(OP_OR); SET_BR_OFF((yyvsp[-1].inst), GetPC());
             }
-#line 2032 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2034 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 88: /* numexpr: NOT numexpr  */
-#line 370 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 372 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_NOT);
             }
-#line 2040 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2042 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 89: /* numexpr: INCR SYMBOL  */
-#line 373 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 375 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym)); ADD_OP(OP_INCR);
                 ADD_OP(OP_DUP); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[0].sym));
             }
-#line 2049 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2051 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 90: /* numexpr: SYMBOL INCR  */
-#line 377 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 379 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[-1].sym)); ADD_OP(OP_DUP);
                 ADD_OP(OP_INCR); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-1].sym));
             }
-#line 2058 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2060 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 91: /* numexpr: DECR SYMBOL  */
-#line 381 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 383 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[0].sym)); ADD_OP(OP_DECR);
                 ADD_OP(OP_DUP); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[0].sym));
             }
-#line 2067 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2069 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 92: /* numexpr: SYMBOL DECR  */
-#line 385 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 387 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                           {
                 ADD_OP(OP_PUSH_SYM); ADD_SYM((yyvsp[-1].sym)); ADD_OP(OP_DUP);
                 ADD_OP(OP_DECR); ADD_OP(OP_ASSIGN); ADD_SYM((yyvsp[-1].sym));
             }
-#line 2076 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2078 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 93: /* numexpr: numexpr IN numexpr  */
-#line 389 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 391 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                                  {
                 ADD_OP(OP_IN_ARRAY);
             }
-#line 2084 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2086 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 94: /* while: WHILE  */
-#line 393 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 395 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
               {
             (yyval.inst) = GetPC(); StartLoopAddrList();
         }
-#line 2092 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2094 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 95: /* for: FOR  */
-#line 397 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 399 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
             {
             StartLoopAddrList(); (yyval.inst) = GetPC();
         }
-#line 2100 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2102 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 96: /* else: ELSE  */
-#line 401 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 403 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
              {
             ADD_OP(OP_BRANCH); (yyval.inst) = GetPC(); ADD_BR_OFF(nullptr);
         }
-#line 2108 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2110 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 97: /* cond: %empty  */
-#line 405 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 407 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                       {
             ADD_OP(OP_BRANCH_NEVER); (yyval.inst) = GetPC(); ADD_BR_OFF(nullptr);
         }
-#line 2116 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2118 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 98: /* cond: numexpr  */
-#line 408 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 410 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
                   {
             ADD_OP(OP_BRANCH_FALSE); (yyval.inst) = GetPC(); ADD_BR_OFF(nullptr);
         }
-#line 2124 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2126 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 99: /* and: AND  */
-#line 412 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 414 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
             {
             ADD_OP(OP_DUP); ADD_OP(OP_BRANCH_FALSE); (yyval.inst) = GetPC();
             ADD_BR_OFF(nullptr);
         }
-#line 2133 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2135 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
   case 100: /* or: OR  */
-#line 417 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 419 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
            {
             ADD_OP(OP_DUP); ADD_OP(OP_BRANCH_TRUE); (yyval.inst) = GetPC();
             ADD_BR_OFF(nullptr);
         }
-#line 2142 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2144 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
     break;
 
 
-#line 2146 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
+#line 2148 "/home/eteran/projects/nedit-ng/build/Interpreter/parser.cpp"
 
       default: break;
     }
@@ -2335,7 +2337,7 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 426 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 428 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
  /* User Subroutines Section */
 
 
@@ -2355,6 +2357,8 @@ Program *CompileMacro(const QString &expr, QString *msg, int *stoppedAt) {
 	QString::const_iterator start = expr.begin();
 	InPtr                         = start;
 	EndPtr                        = start + expr.size();
+	LinePtr                       = start;
+	Line                          = 1;
 
 	if (yyparse()) {
 		*msg          = ErrMsg;
@@ -2400,6 +2404,16 @@ static int yylex(void) {
 		}
 	}
 
+	/* code generated from here on is attributed to the line of the previous
+	   token, as the parser has usually read one token past the code it
+	   generates, then move on to the line of this one */
+	SetSourceLine(Line);
+	for (; LinePtr < InPtr; ++LinePtr) {
+		if (*LinePtr == QLatin1Char('\n')) {
+			++Line;
+		}
+	}
+
 	/* return end of input at the end of the string */
 	if (InPtr == EndPtr) {
 		return 0;
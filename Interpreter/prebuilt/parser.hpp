@@ -97,7 +97,7 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 39 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
+#line 41 "/home/eteran/projects/nedit-ng/Interpreter/parser.y"
 
     Symbol *sym;
     Inst *inst;
@@ -32,7 +32,7 @@ T *Operand(T *p) noexcept {
 template <class T>
 uint8_t GetOpCode(T *p) noexcept {
 	static_assert(sizeof(T) == 1, "Invalid Pointer Type");
-	return *reinterpret_cast<uint8_t *>(p);
+	return *reinterpret_cast<const uint8_t *>(p);
 }
 
 /**
@@ -52,7 +52,7 @@ struct Range {
 	int32_t upper;
 };
 
-uint8_t *Chunk(int paren, int *flag_param, Range &range_param);
+uint8_t *Chunk(ParseContext &ctx, int paren, int *flag_param, Range &range_param);
 
 const char DefaultMetaChar[] = "{.*+?[(|)^<>$";
 const char AsciiDigits[]     = "0123456789"; // Same for all locales.
@@ -73,9 +73,9 @@ char LetterChar[AlnumCharSize];  // InitAnsiClasses() and ShortcutEscape().
  *
  * @note A slightly simplified inline version is available via NextPointer().
  */
-uint8_t *NextPtr(uint8_t *ptr) noexcept {
+uint8_t *NextPtr(ParseContext &ctx, uint8_t *ptr) noexcept {
 
-	if (pContext.FirstPass) {
+	if (ctx.FirstPass) {
 		return nullptr;
 	}
 
@@ -119,9 +119,9 @@ constexpr uint8_t PUT_OFFSET_R(T v) noexcept {
  *
  * @return `true` if the next character is a quantifier (*, +, ?, or {).
  */
-bool IsQuantifier() noexcept {
-	const char ch = pContext.Reg_Parse.peek();
-	return (ch == '*' || ch == '+' || ch == '?' || ch == pContext.Brace_Char);
+bool IsQuantifier(ParseContext &ctx) noexcept {
+	const char ch = ctx.Reg_Parse.peek();
+	return (ch == '*' || ch == '+' || ch == '?' || ch == ctx.Brace_Char);
 }
 
 /**
@@ -186,18 +186,18 @@ bool InitAnsiClasses() noexcept {
  * @return The start of the emitted node.
  */
 template <class T>
-uint8_t *EmitNode(T op_code) noexcept {
+uint8_t *EmitNode(ParseContext &ctx, T op_code) noexcept {
 
-	if (pContext.FirstPass) {
-		pContext.Reg_Size += NODE_SIZE<size_t>;
+	if (ctx.FirstPass) {
+		ctx.Reg_Size += NODE_SIZE<size_t>;
 		return FirstPassToken;
 	}
 
-	const size_t end_offset = pContext.Code.size();
-	pContext.Code.push_back(static_cast<uint8_t>(op_code));
-	pContext.Code.push_back(0);
-	pContext.Code.push_back(0);
-	return &pContext.Code[end_offset];
+	const size_t end_offset = ctx.Code.size();
+	ctx.Code.push_back(static_cast<uint8_t>(op_code));
+	ctx.Code.push_back(0);
+	ctx.Code.push_back(0);
+	return &ctx.Code[end_offset];
 }
 
 /**
@@ -206,12 +206,12 @@ uint8_t *EmitNode(T op_code) noexcept {
  * @param ch The byte to emit.
  */
 template <class T>
-void EmitByte(T ch) noexcept {
+void EmitByte(ParseContext &ctx, T ch) noexcept {
 
-	if (pContext.FirstPass) {
-		pContext.Reg_Size++;
+	if (ctx.FirstPass) {
+		ctx.Reg_Size++;
 	} else {
-		pContext.Code.push_back(static_cast<uint8_t>(ch));
+		ctx.Code.push_back(static_cast<uint8_t>(ch));
 	}
 }
 
@@ -221,23 +221,23 @@ void EmitByte(T ch) noexcept {
  * @param ch The byte to emit, which can be a character or a special character class.
  */
 template <class T>
-void EmitClassByte(T ch) noexcept {
+void EmitClassByte(ParseContext &ctx, T ch) noexcept {
 
-	if (pContext.FirstPass) {
-		pContext.Reg_Size++;
+	if (ctx.FirstPass) {
+		ctx.Reg_Size++;
 
-		if (pContext.Is_Case_Insensitive && safe_isalpha(ch)) {
-			pContext.Reg_Size++;
+		if (ctx.Is_Case_Insensitive && safe_isalpha(ch)) {
+			ctx.Reg_Size++;
 		}
 
 	} else {
-		if (pContext.Is_Case_Insensitive && safe_isalpha(ch)) {
+		if (ctx.Is_Case_Insensitive && safe_isalpha(ch)) {
 			/* For case insensitive character classes, emit both upper and lower
 			 * case versions of alphabetical characters. */
-			pContext.Code.push_back(static_cast<uint8_t>(safe_tolower(ch)));
-			pContext.Code.push_back(static_cast<uint8_t>(safe_toupper(ch)));
+			ctx.Code.push_back(static_cast<uint8_t>(safe_tolower(ch)));
+			ctx.Code.push_back(static_cast<uint8_t>(safe_toupper(ch)));
 		} else {
-			pContext.Code.push_back(static_cast<uint8_t>(ch));
+			ctx.Code.push_back(static_cast<uint8_t>(ch));
 		}
 	}
 }
@@ -251,42 +251,42 @@ void EmitClassByte(T ch) noexcept {
  * @return The start of the emitted node, or a special token if in first pass.
  */
 template <class Ch>
-uint8_t *EmitSpecial(Ch op_code, uint32_t test_val, size_t index) noexcept {
+uint8_t *EmitSpecial(ParseContext &ctx, Ch op_code, uint32_t test_val, size_t index) noexcept {
 
-	if (pContext.FirstPass) {
+	if (ctx.FirstPass) {
 		switch (op_code) {
 		case POS_BEHIND_OPEN:
 		case NEG_BEHIND_OPEN:
-			pContext.Reg_Size += LENGTH_SIZE<size_t>; // Length of the look-behind match
-			pContext.Reg_Size += NODE_SIZE<size_t>;   // Make room for the node
+			ctx.Reg_Size += LENGTH_SIZE<size_t>; // Length of the look-behind match
+			ctx.Reg_Size += NODE_SIZE<size_t>;   // Make room for the node
 			break;
 
 		case TEST_COUNT:
-			pContext.Reg_Size += NEXT_PTR_SIZE<size_t>; // Make room for a test value.
+			ctx.Reg_Size += NEXT_PTR_SIZE<size_t>; // Make room for a test value.
 			[[fallthrough]];
 		case INC_COUNT:
-			pContext.Reg_Size += INDEX_SIZE<size_t>; // Make room for an index value.
+			ctx.Reg_Size += INDEX_SIZE<size_t>; // Make room for an index value.
 			[[fallthrough]];
 		default:
-			pContext.Reg_Size += NODE_SIZE<size_t>; // Make room for the node.
+			ctx.Reg_Size += NODE_SIZE<size_t>; // Make room for the node.
 		}
 
 		return FirstPassToken;
 	}
 
-	uint8_t *ret_val = EmitNode(op_code); // Return the address for start of node.
+	uint8_t *ret_val = EmitNode(ctx, op_code); // Return the address for start of node.
 	if (op_code == INC_COUNT || op_code == TEST_COUNT) {
-		pContext.Code.push_back(index & 0xff);
+		ctx.Code.push_back(index & 0xff);
 
 		if (op_code == TEST_COUNT) {
-			pContext.Code.push_back(PUT_OFFSET_L(test_val));
-			pContext.Code.push_back(PUT_OFFSET_R(test_val));
+			ctx.Code.push_back(PUT_OFFSET_L(test_val));
+			ctx.Code.push_back(PUT_OFFSET_R(test_val));
 		}
 	} else if (op_code == POS_BEHIND_OPEN || op_code == NEG_BEHIND_OPEN) {
-		pContext.Code.push_back(PUT_OFFSET_L(test_val));
-		pContext.Code.push_back(PUT_OFFSET_R(test_val));
-		pContext.Code.push_back(PUT_OFFSET_L(test_val));
-		pContext.Code.push_back(PUT_OFFSET_R(test_val));
+		ctx.Code.push_back(PUT_OFFSET_L(test_val));
+		ctx.Code.push_back(PUT_OFFSET_R(test_val));
+		ctx.Code.push_back(PUT_OFFSET_L(test_val));
+		ctx.Code.push_back(PUT_OFFSET_R(test_val));
 	}
 	return ret_val;
 }
@@ -297,16 +297,16 @@ uint8_t *EmitSpecial(Ch op_code, uint32_t test_val, size_t index) noexcept {
  * @param search_from The start of the node chain to search.
  * @param point_to The location where the NEXT pointer should point.
  */
-void Tail(uint8_t *search_from, const uint8_t *point_to) {
+void Tail(ParseContext &ctx, uint8_t *search_from, const uint8_t *point_to) {
 
-	if (pContext.FirstPass) {
+	if (ctx.FirstPass) {
 		return;
 	}
 
 	// Find the last node in the chain (node with a null NEXT pointer)
 	uint8_t *scan = search_from;
 
-	while (uint8_t *next = NextPtr(scan)) {
+	while (uint8_t *next = NextPtr(ctx, scan)) {
 		scan = next;
 	}
 
@@ -334,9 +334,9 @@ void Tail(uint8_t *search_from, const uint8_t *point_to) {
  * @param index The index value for INIT_COUNT, which is used to track the number of matches.
  * @return The start of the newly inserted node, or a special token if in first pass.
  */
-uint8_t *Insert(uint8_t op, const uint8_t *insert_pos, uint32_t min, uint32_t max, uint16_t index) {
+uint8_t *Insert(ParseContext &ctx, uint8_t op, const uint8_t *insert_pos, uint32_t min, uint32_t max, uint16_t index) {
 
-	if (pContext.FirstPass) {
+	if (ctx.FirstPass) {
 
 		size_t insert_size = NODE_SIZE<size_t>;
 
@@ -348,12 +348,12 @@ uint8_t *Insert(uint8_t op, const uint8_t *insert_pos, uint32_t min, uint32_t ma
 			insert_size += INDEX_SIZE<size_t>;
 		}
 
-		pContext.Reg_Size += insert_size;
+		ctx.Reg_Size += insert_size;
 		return FirstPassToken;
 	}
 
 	// Where operand used to be.
-	const ptrdiff_t offset = insert_pos - pContext.Code.data();
+	const ptrdiff_t offset = insert_pos - ctx.Code.data();
 
 	// assemble the new node in place, then insert it
 	uint8_t new_node[16];
@@ -376,8 +376,8 @@ uint8_t *Insert(uint8_t op, const uint8_t *insert_pos, uint32_t min, uint32_t ma
 		*ptr++ = (index & 0xff);
 	}
 
-	pContext.Code.insert(pContext.Code.begin() + offset, new_node, ptr);
-	return &pContext.Code[static_cast<size_t>(offset)]; // Return a pointer to the start of the code moved.
+	ctx.Code.insert(ctx.Code.begin() + offset, new_node, ptr);
+	return &ctx.Code[static_cast<size_t>(offset)]; // Return a pointer to the start of the code moved.
 }
 
 /**
@@ -422,7 +422,7 @@ uint8_t *Insert(uint8_t op, const uint8_t *insert_pos, uint32_t min, uint32_t ma
  * @return The start of the emitted node, or nullptr if the character
  */
 template <ShortcutEscapeFlag Flags, class Ch>
-uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
+uint8_t *ShortcutEscape(ParseContext &ctx, Ch ch, int *flag_param) {
 
 	constexpr char codes[] = "ByYdDlLsSwW";
 
@@ -450,7 +450,7 @@ uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
 		if constexpr (Flags == EMIT_CLASS_BYTES) {
 			class_name = AsciiDigits;
 		} else if constexpr (Flags == EMIT_NODE) {
-			ret_val = (safe_islower(ch) ? EmitNode(DIGIT) : EmitNode(NOT_DIGIT));
+			ret_val = (safe_islower(ch) ? EmitNode(ctx, DIGIT) : EmitNode(ctx, NOT_DIGIT));
 		}
 		break;
 	case 'l':
@@ -458,22 +458,22 @@ uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
 		if constexpr (Flags == EMIT_CLASS_BYTES) {
 			class_name = LetterChar;
 		} else if constexpr (Flags == EMIT_NODE) {
-			ret_val = (safe_islower(ch) ? EmitNode(LETTER) : EmitNode(NOT_LETTER));
+			ret_val = (safe_islower(ch) ? EmitNode(ctx, LETTER) : EmitNode(ctx, NOT_LETTER));
 		}
 		break;
 	case 's':
 	case 'S':
 		if constexpr (Flags == EMIT_CLASS_BYTES) {
-			if (pContext.Match_Newline) {
-				EmitByte('\n');
+			if (ctx.Match_Newline) {
+				EmitByte(ctx, '\n');
 			}
 
 			class_name = WhiteSpace;
 		} else if constexpr (Flags == EMIT_NODE) {
-			if (pContext.Match_Newline) {
-				ret_val = (safe_islower(ch) ? EmitNode(SPACE_NL) : EmitNode(NOT_SPACE_NL));
+			if (ctx.Match_Newline) {
+				ret_val = (safe_islower(ch) ? EmitNode(ctx, SPACE_NL) : EmitNode(ctx, NOT_SPACE_NL));
 			} else {
-				ret_val = (safe_islower(ch) ? EmitNode(SPACE) : EmitNode(NOT_SPACE));
+				ret_val = (safe_islower(ch) ? EmitNode(ctx, SPACE) : EmitNode(ctx, NOT_SPACE));
 			}
 		}
 		break;
@@ -482,7 +482,7 @@ uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
 		if constexpr (Flags == EMIT_CLASS_BYTES) {
 			class_name = WordChar;
 		} else if constexpr (Flags == EMIT_NODE) {
-			ret_val = (safe_islower(ch) ? EmitNode(WORD_CHAR) : EmitNode(NOT_WORD_CHAR));
+			ret_val = (safe_islower(ch) ? EmitNode(ctx, WORD_CHAR) : EmitNode(ctx, NOT_WORD_CHAR));
 		}
 		break;
 
@@ -491,7 +491,7 @@ uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
 		 * table will be available for these nodes to use. */
 	case 'y':
 		if constexpr (Flags == EMIT_NODE) {
-			ret_val = EmitNode(IS_DELIM);
+			ret_val = EmitNode(ctx, IS_DELIM);
 		} else {
 			Raise<RegexError>("internal error #5 'ShortcutEscape'");
 		}
@@ -499,14 +499,14 @@ uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
 
 	case 'Y':
 		if constexpr (Flags == EMIT_NODE) {
-			ret_val = EmitNode(NOT_DELIM);
+			ret_val = EmitNode(ctx, NOT_DELIM);
 		} else {
 			Raise<RegexError>("internal error #6 'ShortcutEscape'");
 		}
 		break;
 	case 'B':
 		if constexpr (Flags == EMIT_NODE) {
-			ret_val = EmitNode(NOT_BOUNDARY);
+			ret_val = EmitNode(ctx, NOT_BOUNDARY);
 		} else {
 			Raise<RegexError>("internal error #7 'ShortcutEscape'");
 		}
@@ -527,7 +527,7 @@ uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
 		// TODO(eteran): maybe emit the length of the string first
 		// so we don't have to depend on the NUL character during execution
 		while (*class_name != '\0') {
-			EmitByte(*class_name++);
+			EmitByte(ctx, *class_name++);
 		}
 	}
 
@@ -537,13 +537,13 @@ uint8_t *ShortcutEscape(Ch ch, int *flag_param) {
 /**
  * @brief Perform a tail operation on (ptr + offset) but only if `ptr` is not nullptr.
  */
-void OffsetTail(uint8_t *ptr, int offset, uint8_t *val) {
+void OffsetTail(ParseContext &ctx, uint8_t *ptr, int offset, uint8_t *val) {
 
-	if (pContext.FirstPass || !ptr) {
+	if (ctx.FirstPass || !ptr) {
 		return;
 	}
 
-	Tail(ptr + offset, val);
+	Tail(ctx, ptr + offset, val);
 }
 
 /**
@@ -554,13 +554,13 @@ void OffsetTail(uint8_t *ptr, int offset, uint8_t *val) {
  * @param offset The offset to apply to the pointer.
  * @param val The value to set the NEXT pointer to, if applicable.
  */
-void BranchTail(uint8_t *ptr, int offset, uint8_t *val) {
+void BranchTail(ParseContext &ctx, uint8_t *ptr, int offset, uint8_t *val) {
 
-	if (pContext.FirstPass || !ptr || GetOpCode(ptr) != BRANCH) {
+	if (ctx.FirstPass || !ptr || GetOpCode(ptr) != BRANCH) {
 		return;
 	}
 
-	Tail(ptr + offset, val);
+	Tail(ctx, ptr + offset, val);
 }
 
 /**
@@ -582,7 +582,7 @@ void BranchTail(uint8_t *ptr, int offset, uint8_t *val) {
  *         is invalid or not applicable.
  */
 template <ShortcutEscapeFlag Flags>
-uint8_t *BackRef(Reader reader, int *flag_param) {
+uint8_t *BackRef(ParseContext &ctx, Reader reader, int *flag_param) {
 
 	bool is_cross_regex = false;
 
@@ -604,7 +604,7 @@ uint8_t *BackRef(Reader reader, int *flag_param) {
 	}
 
 	// Make sure parentheses for requested back-reference are complete.
-	if (!is_cross_regex && !pContext.Closed_Parens[paren_no]) {
+	if (!is_cross_regex && !ctx.Closed_Parens[paren_no]) {
 		Raise<RegexError>("\\%d is an illegal back reference", paren_no);
 	}
 
@@ -613,23 +613,23 @@ uint8_t *BackRef(Reader reader, int *flag_param) {
 		/* Skip past the '~' in a cross regex back reference.
 		 * We only do this if we are emitting code.
 		 */
-		if (pContext.Reg_Parse.match('~')) {
-			if (pContext.Is_Case_Insensitive) {
-				ret_val = EmitNode(X_REGEX_BR_CI);
+		if (ctx.Reg_Parse.match('~')) {
+			if (ctx.Is_Case_Insensitive) {
+				ret_val = EmitNode(ctx, X_REGEX_BR_CI);
 			} else {
-				ret_val = EmitNode(X_REGEX_BR);
+				ret_val = EmitNode(ctx, X_REGEX_BR);
 			}
 		} else {
-			if (pContext.Is_Case_Insensitive) {
-				ret_val = EmitNode(BACK_REF_CI);
+			if (ctx.Is_Case_Insensitive) {
+				ret_val = EmitNode(ctx, BACK_REF_CI);
 			} else {
-				ret_val = EmitNode(BACK_REF);
+				ret_val = EmitNode(ctx, BACK_REF);
 			}
 		}
 
-		EmitByte(paren_no);
+		EmitByte(ctx, paren_no);
 
-		if (is_cross_regex || pContext.Paren_Has_Width[paren_no]) {
+		if (is_cross_regex || ctx.Paren_Has_Width[paren_no]) {
 			*flag_param |= HAS_WIDTH;
 		}
 	} else if constexpr (Flags == CHECK_ESCAPE) {
@@ -654,7 +654,7 @@ uint8_t *BackRef(Reader reader, int *flag_param) {
  *       together so that it can turn them into a single EXACTLY node, which
  *       is smaller to store and faster to run.
  */
-uint8_t *Atom(int *flag_param, Range &range_param) {
+uint8_t *Atom(ParseContext &ctx, int *flag_param, Range &range_param) {
 
 	uint8_t *ret_val;
 	uint8_t test;
@@ -671,42 +671,42 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 	   string)... period. Handles multiple sequential comments,
 	   e.g. '(?# one)(?# two)...'  */
 
-	while (pContext.Reg_Parse.match("(?#")) {
+	while (ctx.Reg_Parse.match("(?#")) {
 
-		pContext.Reg_Parse.consume_until(')');
-		pContext.Reg_Parse.match(')');
+		ctx.Reg_Parse.consume_until(')');
+		ctx.Reg_Parse.match(')');
 
-		if (pContext.Reg_Parse.eof() || pContext.Reg_Parse.next_is(')') || pContext.Reg_Parse.next_is('|')) {
+		if (ctx.Reg_Parse.eof() || ctx.Reg_Parse.next_is(')') || ctx.Reg_Parse.next_is('|')) {
 			/* Hit end of regex string or end of parenthesized regex; have to
 			 return "something" (i.e. a NOTHING node) to avoid generating an
 			 error. */
-			return EmitNode(NOTHING);
+			return EmitNode(ctx, NOTHING);
 		}
 	}
 
-	if (pContext.Reg_Parse.eof()) {
+	if (ctx.Reg_Parse.eof()) {
 		// Supposed to be caught earlier.
 		Raise<RegexError>("internal error #3, 'atom'");
 	}
 
-	switch (const char ch = pContext.Reg_Parse.read(); ch) {
+	switch (const char ch = ctx.Reg_Parse.read(); ch) {
 	case '^':
-		ret_val = EmitNode(BOL);
+		ret_val = EmitNode(ctx, BOL);
 		break;
 	case '$':
-		ret_val = EmitNode(EOL);
+		ret_val = EmitNode(ctx, EOL);
 		break;
 	case '<':
-		ret_val = EmitNode(BOWORD);
+		ret_val = EmitNode(ctx, BOWORD);
 		break;
 	case '>':
-		ret_val = EmitNode(EOWORD);
+		ret_val = EmitNode(ctx, EOWORD);
 		break;
 	case '.':
-		if (pContext.Match_Newline) {
-			ret_val = EmitNode(EVERY);
+		if (ctx.Match_Newline) {
+			ret_val = EmitNode(ctx, EVERY);
 		} else {
-			ret_val = EmitNode(ANY);
+			ret_val = EmitNode(ctx, ANY);
 		}
 
 		*flag_param |= (HAS_WIDTH | SIMPLE);
@@ -714,36 +714,36 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 		range_param.upper = 1;
 		break;
 	case '(':
-		if (pContext.Reg_Parse.match('?')) { // Special parenthetical expression
+		if (ctx.Reg_Parse.match('?')) { // Special parenthetical expression
 
 			range_local.lower = 0; // Make sure it is always used
 			range_local.upper = 0;
 
-			if (pContext.Reg_Parse.match(':')) {
-				ret_val = Chunk(NO_CAPTURE, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match('=')) {
-				ret_val = Chunk(POS_AHEAD_OPEN, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match('!')) {
-				ret_val = Chunk(NEG_AHEAD_OPEN, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match('i')) {
-				ret_val = Chunk(INSENSITIVE, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match('I')) {
-				ret_val = Chunk(SENSITIVE, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match('n')) {
-				ret_val = Chunk(NEWLINE, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match('N')) {
-				ret_val = Chunk(NO_NEWLINE, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match("<=")) {
-				ret_val = Chunk(POS_BEHIND_OPEN, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match("<!")) {
-				ret_val = Chunk(NEG_BEHIND_OPEN, &flags_local, range_local);
-			} else if (pContext.Reg_Parse.match('<')) {
-				Raise<RegexError>("invalid look-behind syntax, \"(?<%c...)\"", pContext.Reg_Parse.peek());
+			if (ctx.Reg_Parse.match(':')) {
+				ret_val = Chunk(ctx, NO_CAPTURE, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match('=')) {
+				ret_val = Chunk(ctx, POS_AHEAD_OPEN, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match('!')) {
+				ret_val = Chunk(ctx, NEG_AHEAD_OPEN, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match('i')) {
+				ret_val = Chunk(ctx, INSENSITIVE, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match('I')) {
+				ret_val = Chunk(ctx, SENSITIVE, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match('n')) {
+				ret_val = Chunk(ctx, NEWLINE, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match('N')) {
+				ret_val = Chunk(ctx, NO_NEWLINE, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match("<=")) {
+				ret_val = Chunk(ctx, POS_BEHIND_OPEN, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match("<!")) {
+				ret_val = Chunk(ctx, NEG_BEHIND_OPEN, &flags_local, range_local);
+			} else if (ctx.Reg_Parse.match('<')) {
+				Raise<RegexError>("invalid look-behind syntax, \"(?<%c...)\"", ctx.Reg_Parse.peek());
 			} else {
-				Raise<RegexError>("invalid grouping syntax, \"(?%c...)\"", pContext.Reg_Parse.peek());
+				Raise<RegexError>("invalid grouping syntax, \"(?%c...)\"", ctx.Reg_Parse.peek());
 			}
 		} else { // Normal capturing parentheses
-			ret_val = Chunk(PAREN, &flags_local, range_local);
+			ret_val = Chunk(ctx, PAREN, &flags_local, range_local);
 		}
 
 		if (!ret_val) {
@@ -768,9 +768,9 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 		if (ParseContext::Enable_Counting_Quantifier) {
 			Raise<RegexError>("{m,n} follows nothing");
 		} else {
-			ret_val = EmitNode(EXACTLY); // Treat braces as literals.
-			EmitByte('{');
-			EmitByte('\0');
+			ret_val = EmitNode(ctx, EXACTLY); // Treat braces as literals.
+			EmitByte(ctx, '{');
+			EmitByte(ctx, '\0');
 			range_param.lower = 1;
 			range_param.upper = 1;
 		}
@@ -781,36 +781,36 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 
 		// Handle characters that can only occur at the start of a class.
 
-		if (pContext.Reg_Parse.match('^')) { // Complement of range.
-			ret_val = EmitNode(ANY_BUT);
+		if (ctx.Reg_Parse.match('^')) { // Complement of range.
+			ret_val = EmitNode(ctx, ANY_BUT);
 
 			/* All negated classes include newline unless escaped with
 			   a "(?n)" switch. */
 
-			if (!pContext.Match_Newline) {
-				EmitByte('\n');
+			if (!ctx.Match_Newline) {
+				EmitByte(ctx, '\n');
 			}
 		} else {
-			ret_val = EmitNode(ANY_OF);
+			ret_val = EmitNode(ctx, ANY_OF);
 		}
 
 		/* If '-' or ']' is the first character in a class,
 		   it is a literal character in the class. */
-		if (const char ch = pContext.Reg_Parse.match_if([](char c) { return c == ']' || c == '-'; })) {
+		if (const char ch = ctx.Reg_Parse.match_if([](char c) { return c == ']' || c == '-'; })) {
 			last_emit = static_cast<uint8_t>(ch);
-			EmitByte(ch);
+			EmitByte(ctx, ch);
 		}
 
 		// Handle the rest of the class characters.
-		while (!pContext.Reg_Parse.eof() && !pContext.Reg_Parse.next_is(']')) {
-			if (pContext.Reg_Parse.match('-')) { // Process a range, e.g [a-z].
+		while (!ctx.Reg_Parse.eof() && !ctx.Reg_Parse.next_is(']')) {
+			if (ctx.Reg_Parse.match('-')) { // Process a range, e.g [a-z].
 
-				if (pContext.Reg_Parse.next_is(']') || pContext.Reg_Parse.eof()) {
+				if (ctx.Reg_Parse.next_is(']') || ctx.Reg_Parse.eof()) {
 					/* If '-' is the last character in a class it is a literal
 					   character.  If 'Reg_Parse' points to the end of the
 					   regex string, an error will be generated later. */
 
-					EmitByte('-');
+					EmitByte(ctx, '-');
 					last_emit = '-';
 				} else {
 					/* We must get the range starting character value from the
@@ -825,27 +825,27 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 					unsigned int last_value;
 					unsigned int second_value = static_cast<unsigned int>(last_emit) + 1;
 
-					if (pContext.Reg_Parse.match('\\')) {
+					if (ctx.Reg_Parse.match('\\')) {
 						/* Handle escaped characters within a class range.
 						   Specifically disallow shortcut escapes as the end of
 						   a class range.  To allow this would be ambiguous
 						   since shortcut escapes represent a set of characters,
 						   and it would not be clear which character of the
 						   class should be treated as the "last" character. */
-						if ((test = NumericEscape<uint8_t>(pContext.Reg_Parse.peek(), &pContext.Reg_Parse))) {
+						if ((test = NumericEscape<uint8_t>(ctx.Reg_Parse.peek(), &ctx.Reg_Parse))) {
 							last_value = test;
-						} else if ((test = LiteralEscape<uint8_t>(pContext.Reg_Parse.peek()))) {
+						} else if ((test = LiteralEscape<uint8_t>(ctx.Reg_Parse.peek()))) {
 							last_value = test;
-						} else if (ShortcutEscape<CHECK_CLASS_ESCAPE>(pContext.Reg_Parse.peek(), nullptr)) {
-							Raise<RegexError>("\\%c is not allowed as range operand", pContext.Reg_Parse.peek());
+						} else if (ShortcutEscape<CHECK_CLASS_ESCAPE>(ctx, ctx.Reg_Parse.peek(), nullptr)) {
+							Raise<RegexError>("\\%c is not allowed as range operand", ctx.Reg_Parse.peek());
 						} else {
-							Raise<RegexError>("\\%c is an invalid char class escape sequence", pContext.Reg_Parse.peek());
+							Raise<RegexError>("\\%c is an invalid char class escape sequence", ctx.Reg_Parse.peek());
 						}
 					} else {
-						last_value = static_cast<unsigned int>(pContext.Reg_Parse.peek());
+						last_value = static_cast<unsigned int>(ctx.Reg_Parse.peek());
 					}
 
-					if (pContext.Is_Case_Insensitive) {
+					if (ctx.Is_Case_Insensitive) {
 						second_value = static_cast<unsigned int>(safe_tolower(second_value));
 						last_value   = static_cast<unsigned int>(safe_tolower(last_value));
 					}
@@ -863,53 +863,53 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 					   was emitted by the previous iteration of while loop. */
 
 					for (; second_value <= last_value; second_value++) {
-						EmitClassByte(second_value);
+						EmitClassByte(ctx, second_value);
 					}
 
 					last_emit = static_cast<uint8_t>(last_value);
 
-					pContext.Reg_Parse.read();
+					ctx.Reg_Parse.read();
 
 				} // End class character range code.
-			} else if (pContext.Reg_Parse.match('\\')) {
+			} else if (ctx.Reg_Parse.match('\\')) {
 
-				if ((test = NumericEscape<uint8_t>(pContext.Reg_Parse.peek(), &pContext.Reg_Parse)) != '\0') {
-					EmitClassByte(test);
+				if ((test = NumericEscape<uint8_t>(ctx.Reg_Parse.peek(), &ctx.Reg_Parse)) != '\0') {
+					EmitClassByte(ctx, test);
 
 					last_emit = test;
-				} else if ((test = LiteralEscape<uint8_t>(pContext.Reg_Parse.peek())) != '\0') {
-					EmitByte(test);
+				} else if ((test = LiteralEscape<uint8_t>(ctx.Reg_Parse.peek())) != '\0') {
+					EmitByte(ctx, test);
 					last_emit = test;
-				} else if (ShortcutEscape<CHECK_CLASS_ESCAPE>(pContext.Reg_Parse.peek(), nullptr)) {
+				} else if (ShortcutEscape<CHECK_CLASS_ESCAPE>(ctx, ctx.Reg_Parse.peek(), nullptr)) {
 
-					if (pContext.Reg_Parse.peek(1) == '-') {
+					if (ctx.Reg_Parse.peek(1) == '-') {
 						/* Specifically disallow shortcut escapes as the start
 						   of a character class range (see comment above.) */
-						Raise<RegexError>("\\%c not allowed as range operand", pContext.Reg_Parse.peek());
+						Raise<RegexError>("\\%c not allowed as range operand", ctx.Reg_Parse.peek());
 					} else {
 						/* Emit the bytes that are part of the shortcut
 						   escape sequence's range (e.g. \d = 0123456789) */
-						ShortcutEscape<EMIT_CLASS_BYTES>(pContext.Reg_Parse.peek(), nullptr);
+						ShortcutEscape<EMIT_CLASS_BYTES>(ctx, ctx.Reg_Parse.peek(), nullptr);
 					}
 				} else {
-					Raise<RegexError>("\\%c is an invalid char class escape sequence", pContext.Reg_Parse.peek());
+					Raise<RegexError>("\\%c is an invalid char class escape sequence", ctx.Reg_Parse.peek());
 				}
 
-				pContext.Reg_Parse.read();
+				ctx.Reg_Parse.read();
 
 				// End of class escaped sequence code
 			} else {
-				const char ch = pContext.Reg_Parse.read();
-				EmitClassByte(ch); // Ordinary class character.
+				const char ch = ctx.Reg_Parse.read();
+				EmitClassByte(ctx, ch); // Ordinary class character.
 				last_emit = static_cast<uint8_t>(ch);
 			}
 		}
 
-		if (!pContext.Reg_Parse.match(']')) {
+		if (!ctx.Reg_Parse.match(']')) {
 			Raise<RegexError>("missing right ']'");
 		}
 
-		EmitByte('\0');
+		EmitByte(ctx, '\0');
 
 		/* NOTE: it is impossible to specify an empty class.  This is
 		   because [] would be interpreted as "begin character class"
@@ -924,19 +924,19 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 	break; // End of character class code.
 
 	case '\\':
-		if ((ret_val = ShortcutEscape<EMIT_NODE>(pContext.Reg_Parse.peek(), flag_param))) {
+		if ((ret_val = ShortcutEscape<EMIT_NODE>(ctx, ctx.Reg_Parse.peek(), flag_param))) {
 
-			pContext.Reg_Parse.read();
+			ctx.Reg_Parse.read();
 			range_param.lower = 1;
 			range_param.upper = 1;
 			break;
 
-		} else if ((ret_val = BackRef<EMIT_NODE>(pContext.Reg_Parse, flag_param))) {
+		} else if ((ret_val = BackRef<EMIT_NODE>(ctx, ctx.Reg_Parse, flag_param))) {
 			/* Can't make any assumptions about a back-reference as to SIMPLE
 			   or HAS_WIDTH.  For example (^|<) is neither simple nor has
 			   width.  So we don't flip bits in flag_param here. */
 
-			pContext.Reg_Parse.read();
+			ctx.Reg_Parse.read();
 			// Back-references always have an unknown length
 			range_param.lower = -1;
 			range_param.upper = -1;
@@ -950,61 +950,61 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 		 * escapes. */
 		[[fallthrough]];
 	default:
-		pContext.Reg_Parse.putback(); /* If we fell through from the above code, we are now
+		ctx.Reg_Parse.putback(); /* If we fell through from the above code, we are now
 									   * pointing at the back slash (\) character. */
 		{
 			Reader parse_save;
 			int len = 0;
 
-			if (pContext.Is_Case_Insensitive) {
-				ret_val = EmitNode(SIMILAR);
+			if (ctx.Is_Case_Insensitive) {
+				ret_val = EmitNode(ctx, SIMILAR);
 			} else {
-				ret_val = EmitNode(EXACTLY);
+				ret_val = EmitNode(ctx, EXACTLY);
 			}
 
 			/* Loop until we find a meta character, shortcut escape, back
 			 * reference, or end of regex string. */
 
-			for (; !pContext.Reg_Parse.eof() && !::strchr(pContext.Meta_Char, static_cast<int>(pContext.Reg_Parse.peek())); len++) {
+			for (; !ctx.Reg_Parse.eof() && !::strchr(ctx.Meta_Char, static_cast<int>(ctx.Reg_Parse.peek())); len++) {
 				/* Save where we are in case we have to back
 				   this character out. */
 
-				parse_save = pContext.Reg_Parse;
+				parse_save = ctx.Reg_Parse;
 
-				if (pContext.Reg_Parse.match('\\')) {
+				if (ctx.Reg_Parse.match('\\')) {
 
 					// at the escaped character
 
-					if ((test = NumericEscape<uint8_t>(pContext.Reg_Parse.peek(), &pContext.Reg_Parse))) {
-						if (pContext.Is_Case_Insensitive) {
-							EmitByte(safe_tolower(test));
+					if ((test = NumericEscape<uint8_t>(ctx.Reg_Parse.peek(), &ctx.Reg_Parse))) {
+						if (ctx.Is_Case_Insensitive) {
+							EmitByte(ctx, safe_tolower(test));
 						} else {
-							EmitByte(test);
+							EmitByte(ctx, test);
 						}
-					} else if ((test = LiteralEscape<uint8_t>(pContext.Reg_Parse.peek()))) {
-						EmitByte(test);
-					} else if (BackRef<CHECK_ESCAPE>(pContext.Reg_Parse, nullptr)) {
+					} else if ((test = LiteralEscape<uint8_t>(ctx.Reg_Parse.peek()))) {
+						EmitByte(ctx, test);
+					} else if (BackRef<CHECK_ESCAPE>(ctx, ctx.Reg_Parse, nullptr)) {
 						// Leave back reference for next 'atom' call
-						pContext.Reg_Parse.putback();
+						ctx.Reg_Parse.putback();
 						break;
-					} else if (ShortcutEscape<CHECK_ESCAPE>(pContext.Reg_Parse.peek(), nullptr)) {
+					} else if (ShortcutEscape<CHECK_ESCAPE>(ctx, ctx.Reg_Parse.peek(), nullptr)) {
 						// Leave shortcut escape for next 'atom' call
-						pContext.Reg_Parse.putback();
+						ctx.Reg_Parse.putback();
 						break;
 					} else {
 						/* None of the above calls generated an error message
 						   so generate our own here. */
 
-						Raise<RegexError>("\\%c is an invalid escape sequence", pContext.Reg_Parse.peek());
+						Raise<RegexError>("\\%c is an invalid escape sequence", ctx.Reg_Parse.peek());
 					}
 
-					pContext.Reg_Parse.read();
+					ctx.Reg_Parse.read();
 				} else {
 					// Ordinary character
-					if (pContext.Is_Case_Insensitive) {
-						EmitByte(safe_tolower(pContext.Reg_Parse.read()));
+					if (ctx.Is_Case_Insensitive) {
+						EmitByte(ctx, safe_tolower(ctx.Reg_Parse.read()));
 					} else {
-						EmitByte(pContext.Reg_Parse.read());
+						EmitByte(ctx, ctx.Reg_Parse.read());
 					}
 				}
 
@@ -1015,13 +1015,13 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 				   have an EXACTLY node with an 'abc' operand followed by a STAR
 				   node followed by another EXACTLY node with a 'd' operand. */
 
-				if (IsQuantifier() && len > 0) {
-					pContext.Reg_Parse = parse_save; // Point to previous regex token.
+				if (IsQuantifier(ctx) && len > 0) {
+					ctx.Reg_Parse = parse_save; // Point to previous regex token.
 
-					if (pContext.FirstPass) {
-						pContext.Reg_Size--;
+					if (ctx.FirstPass) {
+						ctx.Reg_Size--;
 					} else {
-						pContext.Code.pop_back();
+						ctx.Code.pop_back();
 					}
 					break;
 				}
@@ -1040,7 +1040,7 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
 			range_param.lower = len;
 			range_param.upper = len;
 
-			EmitByte('\0');
+			EmitByte(ctx, '\0');
 		}
 	}
 
@@ -1061,7 +1061,7 @@ uint8_t *Atom(int *flag_param, Range &range_param) {
  *                    to indicate the lower and upper bounds of the piece's length.
  * @return The start of the emitted node, or nullptr if an error occurs.
  */
-uint8_t *Piece(int *flag_param, Range &range_param) {
+uint8_t *Piece(ParseContext &ctx, int *flag_param, Range &range_param) {
 
 	uint8_t *next;
 	uint16_t min_max[2] = {0, REG_INFINITY};
@@ -1072,19 +1072,19 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 	bool digit_present[2] = {false, false};
 	Range range_local;
 
-	uint8_t *ret_val = Atom(&flags_local, range_local);
+	uint8_t *ret_val = Atom(ctx, &flags_local, range_local);
 
 	if (!ret_val) {
 		return nullptr; // Something went wrong.
 	}
 
-	if (!IsQuantifier()) {
+	if (!IsQuantifier(ctx)) {
 		*flag_param = flags_local;
 		range_param = range_local;
 		return ret_val;
 	}
 
-	char op_code = pContext.Reg_Parse.read();
+	char op_code = ctx.Reg_Parse.read();
 
 	if (op_code == '{') { // {n,m} quantifier present
 
@@ -1109,9 +1109,9 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			   value for max and min of 65,535 is due to using 2 bytes to store
 			   each value in the compiled regex code. */
 
-			pContext.Reg_Parse.consume_whitespace();
+			ctx.Reg_Parse.consume_whitespace();
 
-			if (auto digits = pContext.Reg_Parse.match(std::regex("[0-9]+"))) {
+			if (auto digits = ctx.Reg_Parse.match(std::regex("[0-9]+"))) {
 
 				digit_present[i] = digits->size() != 0;
 
@@ -1127,9 +1127,9 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 				}
 			}
 
-			pContext.Reg_Parse.consume_whitespace();
+			ctx.Reg_Parse.consume_whitespace();
 
-			if (!comma_present && pContext.Reg_Parse.match(',')) {
+			if (!comma_present && ctx.Reg_Parse.match(',')) {
 				comma_present = true;
 			}
 		}
@@ -1155,7 +1155,7 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			min_max[1] = min_max[0]; // {x} means {x,x}
 		}
 
-		if (!pContext.Reg_Parse.match('}')) {
+		if (!ctx.Reg_Parse.match('}')) {
 			Raise<RegexError>("{m,n} specification missing right '}'");
 		}
 
@@ -1166,7 +1166,7 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 	}
 
 	// Check for a minimal matching (non-greedy or "lazy") specification.
-	const bool lazy = pContext.Reg_Parse.match('?');
+	const bool lazy = ctx.Reg_Parse.match('?');
 
 	// Avoid overhead of counting if possible
 	if (op_code == '{') {
@@ -1183,7 +1183,7 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			*flag_param = flags_local;
 			range_param = range_local;
 			return ret_val;
-		} else if (pContext.Num_Braces > static_cast<int>(std::numeric_limits<uint8_t>::max())) {
+		} else if (ctx.Num_Braces > static_cast<int>(std::numeric_limits<uint8_t>::max())) {
 			Raise<RegexError>("number of {m,n} constructs > %d", UINT8_MAX);
 		}
 	}
@@ -1233,16 +1233,16 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 	 *---------------------------------------------------------------------*/
 
 	if (op_code == '*' && (flags_local & SIMPLE)) {
-		Insert(lazy ? LAZY_STAR : STAR, ret_val, 0UL, 0UL, 0);
+		Insert(ctx, lazy ? LAZY_STAR : STAR, ret_val, 0UL, 0UL, 0);
 
 	} else if (op_code == '+' && (flags_local & SIMPLE)) {
-		Insert(lazy ? LAZY_PLUS : PLUS, ret_val, 0UL, 0UL, 0);
+		Insert(ctx, lazy ? LAZY_PLUS : PLUS, ret_val, 0UL, 0UL, 0);
 
 	} else if (op_code == '?' && (flags_local & SIMPLE)) {
-		Insert(lazy ? LAZY_QUESTION : QUESTION, ret_val, 0UL, 0UL, 0);
+		Insert(ctx, lazy ? LAZY_QUESTION : QUESTION, ret_val, 0UL, 0UL, 0);
 
 	} else if (op_code == '{' && (flags_local & SIMPLE)) {
-		Insert(lazy ? LAZY_BRACE : BRACE, ret_val, min_max[0], min_max[1], 0);
+		Insert(ctx, lazy ? LAZY_BRACE : BRACE, ret_val, min_max[0], min_max[1], 0);
 
 	} else if ((op_code == '*' || op_code == '+') && lazy) {
 		/*  Node structure for (x)*?    Node structure for (x)+? construct.
@@ -1259,21 +1259,21 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 		 *
 		 */
 
-		Tail(ret_val, EmitNode(BACK));         // 1
-		Insert(BRANCH, ret_val, 0UL, 0UL, 0);  // 2,4
-		Insert(NOTHING, ret_val, 0UL, 0UL, 0); // 3
+		Tail(ctx, ret_val, EmitNode(ctx, BACK));    // 1
+		Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);  // 2,4
+		Insert(ctx, NOTHING, ret_val, 0UL, 0UL, 0); // 3
 
-		next = EmitNode(NOTHING); // 2,3
+		next = EmitNode(ctx, NOTHING); // 2,3
 
-		OffsetTail(ret_val, NODE_SIZE<size_t>, next);        // 2
-		Tail(ret_val, next);                                 // 3
-		Insert(BRANCH, ret_val, 0UL, 0UL, 0);                // 4,5
-		Tail(ret_val, ret_val + (2 * NODE_SIZE<size_t>));    // 4
-		OffsetTail(ret_val, 3 * NODE_SIZE<size_t>, ret_val); // 5
+		OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next);        // 2
+		Tail(ctx, ret_val, next);                                 // 3
+		Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);                // 4,5
+		Tail(ctx, ret_val, ret_val + (2 * NODE_SIZE<size_t>));    // 4
+		OffsetTail(ctx, ret_val, 3 * NODE_SIZE<size_t>, ret_val); // 5
 
 		if (op_code == '+') {
-			Insert(NOTHING, ret_val, 0UL, 0UL, 0);            // 6
-			Tail(ret_val, ret_val + (4 * NODE_SIZE<size_t>)); // 6
+			Insert(ctx, NOTHING, ret_val, 0UL, 0UL, 0);            // 6
+			Tail(ctx, ret_val, ret_val + (4 * NODE_SIZE<size_t>)); // 6
 		}
 	} else if (op_code == '*') {
 		/* Node structure for (x)* construct.
@@ -1284,11 +1284,11 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 		 *       \__3_______|  4
 		 */
 
-		Insert(BRANCH, ret_val, 0UL, 0UL, 0);                   // 1,3
-		OffsetTail(ret_val, NODE_SIZE<size_t>, EmitNode(BACK)); // 2
-		OffsetTail(ret_val, NODE_SIZE<size_t>, ret_val);        // 1
-		Tail(ret_val, EmitNode(BRANCH));                        // 3
-		Tail(ret_val, EmitNode(NOTHING));                       // 4
+		Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);                        // 1,3
+		OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, EmitNode(ctx, BACK)); // 2
+		OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, ret_val);             // 1
+		Tail(ctx, ret_val, EmitNode(ctx, BRANCH));                        // 3
+		Tail(ctx, ret_val, EmitNode(ctx, NOTHING));                       // 4
 	} else if (op_code == '+') {
 		/* Node structure for (x)+ construct.
 		 *
@@ -1299,12 +1299,12 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 		 *          1     3    4
 		 */
 
-		next = EmitNode(BRANCH); // 1
+		next = EmitNode(ctx, BRANCH); // 1
 
-		Tail(ret_val, next);              // 1
-		Tail(EmitNode(BACK), ret_val);    // 2
-		Tail(next, EmitNode(BRANCH));     // 3
-		Tail(ret_val, EmitNode(NOTHING)); // 4
+		Tail(ctx, ret_val, next);                   // 1
+		Tail(ctx, EmitNode(ctx, BACK), ret_val);    // 2
+		Tail(ctx, next, EmitNode(ctx, BRANCH));     // 3
+		Tail(ctx, ret_val, EmitNode(ctx, NOTHING)); // 4
 	} else if (op_code == '?' && lazy) {
 		/* Node structure for (x)?? construct.
 		 *       _4__        1_
@@ -1314,16 +1314,16 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 		 *          \_____3____|
 		 */
 
-		Insert(BRANCH, ret_val, 0UL, 0UL, 0);  // 2,4
-		Insert(NOTHING, ret_val, 0UL, 0UL, 0); // 3
+		Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);  // 2,4
+		Insert(ctx, NOTHING, ret_val, 0UL, 0UL, 0); // 3
 
-		next = EmitNode(NOTHING); // 1,2,3
+		next = EmitNode(ctx, NOTHING); // 1,2,3
 
-		OffsetTail(ret_val, 2 * NODE_SIZE<size_t>, next);   // 1
-		OffsetTail(ret_val, NODE_SIZE<size_t>, next);       // 2
-		Tail(ret_val, next);                                // 3
-		Insert(BRANCH, ret_val, 0UL, 0UL, 0);               // 4
-		Tail(ret_val, (ret_val + (2 * NODE_SIZE<size_t>))); // 4
+		OffsetTail(ctx, ret_val, 2 * NODE_SIZE<size_t>, next);   // 1
+		OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next);       // 2
+		Tail(ctx, ret_val, next);                                // 3
+		Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);               // 4
+		Tail(ctx, ret_val, (ret_val + (2 * NODE_SIZE<size_t>))); // 4
 
 	} else if (op_code == '?') {
 		/* Node structure for (x)? construct.
@@ -1333,13 +1333,13 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 		 *             \__3_|
 		 */
 
-		Insert(BRANCH, ret_val, 0UL, 0UL, 0); // 1
-		Tail(ret_val, EmitNode(BRANCH));      // 1
+		Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0); // 1
+		Tail(ctx, ret_val, EmitNode(ctx, BRANCH)); // 1
 
-		next = EmitNode(NOTHING); // 2,3
+		next = EmitNode(ctx, NOTHING); // 2,3
 
-		Tail(ret_val, next);                          // 2
-		OffsetTail(ret_val, NODE_SIZE<size_t>, next); // 3
+		Tail(ctx, ret_val, next);                          // 2
+		OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next); // 3
 	} else if (op_code == '{' && min_max[0] == min_max[1]) {
 		/* Node structure for (x){m}, (x){m}?, (x){m,m}, or (x){m,m}? constructs.
 		 * Note that minimal and maximal matching mean the same thing when we
@@ -1352,16 +1352,16 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 		 *     5              4
 		 */
 
-		Tail(ret_val, EmitSpecial(INC_COUNT, 0UL, pContext.Num_Braces));         // 1
-		Tail(ret_val, EmitSpecial(TEST_COUNT, min_max[0], pContext.Num_Braces)); // 2
-		Tail(EmitNode(BACK), ret_val);                                           // 3
-		Tail(ret_val, EmitNode(NOTHING));                                        // 4
+		Tail(ctx, ret_val, EmitSpecial(ctx, INC_COUNT, 0UL, ctx.Num_Braces));         // 1
+		Tail(ctx, ret_val, EmitSpecial(ctx, TEST_COUNT, min_max[0], ctx.Num_Braces)); // 2
+		Tail(ctx, EmitNode(ctx, BACK), ret_val);                                      // 3
+		Tail(ctx, ret_val, EmitNode(ctx, NOTHING));                                   // 4
 
-		next = Insert(INIT_COUNT, ret_val, 0UL, 0UL, pContext.Num_Braces); // 5
+		next = Insert(ctx, INIT_COUNT, ret_val, 0UL, 0UL, ctx.Num_Braces); // 5
 
-		Tail(ret_val, next); // 5
+		Tail(ctx, ret_val, next); // 5
 
-		pContext.Num_Braces++;
+		ctx.Num_Braces++;
 	} else if (op_code == '{' && lazy) {
 		if (min_max[0] == 0 && min_max[1] != REG_INFINITY) {
 			/* Node structure for (x){0,n}? or {,n}? construct.
@@ -1374,26 +1374,26 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			 *            \______5____________|
 			 */
 
-			Tail(ret_val, EmitSpecial(INC_COUNT, 0UL, pContext.Num_Braces)); // 1
+			Tail(ctx, ret_val, EmitSpecial(ctx, INC_COUNT, 0UL, ctx.Num_Braces)); // 1
 
-			next = EmitSpecial(TEST_COUNT, min_max[0], pContext.Num_Braces); // 2,7
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[0], ctx.Num_Braces); // 2,7
 
-			Tail(ret_val, next);                                     // 2
-			Insert(BRANCH, ret_val, 0UL, 0UL, pContext.Num_Braces);  // 4,6
-			Insert(NOTHING, ret_val, 0UL, 0UL, pContext.Num_Braces); // 5
-			Insert(BRANCH, ret_val, 0UL, 0UL, pContext.Num_Braces);  // 3,4,8
-			Tail(EmitNode(BACK), ret_val);                           // 3
-			Tail(ret_val, ret_val + (2 * NODE_SIZE<size_t>));        // 4
+			Tail(ctx, ret_val, next);                                // 2
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, ctx.Num_Braces);  // 4,6
+			Insert(ctx, NOTHING, ret_val, 0UL, 0UL, ctx.Num_Braces); // 5
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, ctx.Num_Braces);  // 3,4,8
+			Tail(ctx, EmitNode(ctx, BACK), ret_val);                 // 3
+			Tail(ctx, ret_val, ret_val + (2 * NODE_SIZE<size_t>));   // 4
 
-			next = EmitNode(NOTHING); // 5,6,7
+			next = EmitNode(ctx, NOTHING); // 5,6,7
 
-			OffsetTail(ret_val, NODE_SIZE<size_t>, next);     // 5
-			OffsetTail(ret_val, 2 * NODE_SIZE<size_t>, next); // 6
-			OffsetTail(ret_val, 3 * NODE_SIZE<size_t>, next); // 7
+			OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next);     // 5
+			OffsetTail(ctx, ret_val, 2 * NODE_SIZE<size_t>, next); // 6
+			OffsetTail(ctx, ret_val, 3 * NODE_SIZE<size_t>, next); // 7
 
-			next = Insert(INIT_COUNT, ret_val, 0UL, 0UL, pContext.Num_Braces); // 8
+			next = Insert(ctx, INIT_COUNT, ret_val, 0UL, 0UL, ctx.Num_Braces); // 8
 
-			Tail(ret_val, next); // 8
+			Tail(ctx, ret_val, next); // 8
 
 		} else if (min_max[0] > 0 && min_max[1] == REG_INFINITY) {
 			/* Node structure for (x){m,}? construct.
@@ -1407,25 +1407,25 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			 *            \_______6______________|
 			 */
 
-			Tail(ret_val, EmitSpecial(INC_COUNT, 0UL, pContext.Num_Braces)); // 1
+			Tail(ctx, ret_val, EmitSpecial(ctx, INC_COUNT, 0UL, ctx.Num_Braces)); // 1
 
-			next = EmitSpecial(TEST_COUNT, min_max[0], pContext.Num_Braces); // 2,4
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[0], ctx.Num_Braces); // 2,4
 
-			Tail(ret_val, next);                   // 2
-			Tail(EmitNode(BACK), ret_val);         // 3
-			Tail(ret_val, EmitNode(BACK));         // 4
-			Insert(BRANCH, ret_val, 0UL, 0UL, 0);  // 5,7
-			Insert(NOTHING, ret_val, 0UL, 0UL, 0); // 6
+			Tail(ctx, ret_val, next);                   // 2
+			Tail(ctx, EmitNode(ctx, BACK), ret_val);    // 3
+			Tail(ctx, ret_val, EmitNode(ctx, BACK));    // 4
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);  // 5,7
+			Insert(ctx, NOTHING, ret_val, 0UL, 0UL, 0); // 6
 
-			next = EmitNode(NOTHING); // 5,6
+			next = EmitNode(ctx, NOTHING); // 5,6
 
-			OffsetTail(ret_val, NODE_SIZE<size_t>, next);                          // 5
-			Tail(ret_val, next);                                                   // 6
-			Insert(BRANCH, ret_val, 0UL, 0UL, 0);                                  // 7,8
-			Tail(ret_val, ret_val + (2 * NODE_SIZE<size_t>));                      // 7
-			OffsetTail(ret_val, 3 * NODE_SIZE<size_t>, ret_val);                   // 8
-			Insert(INIT_COUNT, ret_val, 0UL, 0UL, pContext.Num_Braces);            // 9
-			Tail(ret_val, ret_val + INDEX_SIZE<size_t> + (4 * NODE_SIZE<size_t>)); // 9
+			OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next);                          // 5
+			Tail(ctx, ret_val, next);                                                   // 6
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);                                  // 7,8
+			Tail(ctx, ret_val, ret_val + (2 * NODE_SIZE<size_t>));                      // 7
+			OffsetTail(ctx, ret_val, 3 * NODE_SIZE<size_t>, ret_val);                   // 8
+			Insert(ctx, INIT_COUNT, ret_val, 0UL, 0UL, ctx.Num_Braces);                 // 9
+			Tail(ctx, ret_val, ret_val + INDEX_SIZE<size_t> + (4 * NODE_SIZE<size_t>)); // 9
 
 		} else {
 			/* Node structure for (x){m,n}? construct.
@@ -1440,32 +1440,32 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			 *             \_______5_________________|
 			 */
 
-			Tail(ret_val, EmitSpecial(INC_COUNT, 0UL, pContext.Num_Braces)); // 1
+			Tail(ctx, ret_val, EmitSpecial(ctx, INC_COUNT, 0UL, ctx.Num_Braces)); // 1
 
-			next = EmitSpecial(TEST_COUNT, min_max[1], pContext.Num_Braces); // 2,7
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[1], ctx.Num_Braces); // 2,7
 
-			Tail(ret_val, next); // 2
+			Tail(ctx, ret_val, next); // 2
 
-			next = EmitSpecial(TEST_COUNT, min_max[0], pContext.Num_Braces); // 4
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[0], ctx.Num_Braces); // 4
 
-			Tail(EmitNode(BACK), ret_val);         // 3
-			Tail(next, EmitNode(BACK));            // 4
-			Insert(BRANCH, ret_val, 0UL, 0UL, 0);  // 6,8
-			Insert(NOTHING, ret_val, 0UL, 0UL, 0); // 5
-			Insert(BRANCH, ret_val, 0UL, 0UL, 0);  // 8,9
+			Tail(ctx, EmitNode(ctx, BACK), ret_val);    // 3
+			Tail(ctx, next, EmitNode(ctx, BACK));       // 4
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);  // 6,8
+			Insert(ctx, NOTHING, ret_val, 0UL, 0UL, 0); // 5
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0);  // 8,9
 
-			next = EmitNode(NOTHING); // 5,6,7
+			next = EmitNode(ctx, NOTHING); // 5,6,7
 
-			OffsetTail(ret_val, NODE_SIZE<size_t>, next);                          // 5
-			OffsetTail(ret_val, 2 * NODE_SIZE<size_t>, next);                      // 6
-			OffsetTail(ret_val, 3 * NODE_SIZE<size_t>, next);                      // 7
-			Tail(ret_val, ret_val + (2 * NODE_SIZE<size_t>));                      // 8
-			OffsetTail(next, -NODE_SIZE<int>, ret_val);                            // 9
-			Insert(INIT_COUNT, ret_val, 0UL, 0UL, pContext.Num_Braces);            // 10
-			Tail(ret_val, ret_val + INDEX_SIZE<size_t> + (4 * NODE_SIZE<size_t>)); // 10
+			OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next);                          // 5
+			OffsetTail(ctx, ret_val, 2 * NODE_SIZE<size_t>, next);                      // 6
+			OffsetTail(ctx, ret_val, 3 * NODE_SIZE<size_t>, next);                      // 7
+			Tail(ctx, ret_val, ret_val + (2 * NODE_SIZE<size_t>));                      // 8
+			OffsetTail(ctx, next, -NODE_SIZE<int>, ret_val);                            // 9
+			Insert(ctx, INIT_COUNT, ret_val, 0UL, 0UL, ctx.Num_Braces);                 // 10
+			Tail(ctx, ret_val, ret_val + INDEX_SIZE<size_t> + (4 * NODE_SIZE<size_t>)); // 10
 		}
 
-		pContext.Num_Braces++;
+		ctx.Num_Braces++;
 	} else if (op_code == '{') {
 		if (min_max[0] == 0 && min_max[1] != REG_INFINITY) {
 			/* Node structure for (x){0,n} or (x){,n} construct.
@@ -1478,23 +1478,23 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			 *    7   \________4________|
 			 */
 
-			Tail(ret_val, EmitSpecial(INC_COUNT, 0UL, pContext.Num_Braces)); // 1
+			Tail(ctx, ret_val, EmitSpecial(ctx, INC_COUNT, 0UL, ctx.Num_Braces)); // 1
 
-			next = EmitSpecial(TEST_COUNT, min_max[1], pContext.Num_Braces); // 2,6
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[1], ctx.Num_Braces); // 2,6
 
-			Tail(ret_val, next);                  // 2
-			Insert(BRANCH, ret_val, 0UL, 0UL, 0); // 3,4,7
-			Tail(EmitNode(BACK), ret_val);        // 3
+			Tail(ctx, ret_val, next);                  // 2
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0); // 3,4,7
+			Tail(ctx, EmitNode(ctx, BACK), ret_val);   // 3
 
-			next = EmitNode(BRANCH); // 4,5
+			next = EmitNode(ctx, BRANCH); // 4,5
 
-			Tail(ret_val, next);                          // 4
-			Tail(next, EmitNode(NOTHING));                // 5,6
-			OffsetTail(ret_val, NODE_SIZE<size_t>, next); // 6
+			Tail(ctx, ret_val, next);                          // 4
+			Tail(ctx, next, EmitNode(ctx, NOTHING));           // 5,6
+			OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next); // 6
 
-			next = Insert(INIT_COUNT, ret_val, 0UL, 0UL, pContext.Num_Braces); // 7
+			next = Insert(ctx, INIT_COUNT, ret_val, 0UL, 0UL, ctx.Num_Braces); // 7
 
-			Tail(ret_val, next); // 7
+			Tail(ctx, ret_val, next); // 7
 
 		} else if (min_max[0] > 0 && min_max[1] == REG_INFINITY) {
 			/* Node structure for (x){m,} construct.
@@ -1507,24 +1507,24 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			 *        \__________6__________|
 			 */
 
-			Tail(ret_val, EmitSpecial(INC_COUNT, 0UL, pContext.Num_Braces)); // 1
+			Tail(ctx, ret_val, EmitSpecial(ctx, INC_COUNT, 0UL, ctx.Num_Braces)); // 1
 
-			next = EmitSpecial(TEST_COUNT, min_max[0], pContext.Num_Braces); // 2
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[0], ctx.Num_Braces); // 2
 
-			Tail(ret_val, next);                  // 2
-			Tail(EmitNode(BACK), ret_val);        // 3
-			Insert(BRANCH, ret_val, 0UL, 0UL, 0); // 4,6
+			Tail(ctx, ret_val, next);                  // 2
+			Tail(ctx, EmitNode(ctx, BACK), ret_val);   // 3
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0); // 4,6
 
-			next = EmitNode(BACK); // 4
+			next = EmitNode(ctx, BACK); // 4
 
-			Tail(next, ret_val);                          // 4
-			OffsetTail(ret_val, NODE_SIZE<size_t>, next); // 5
-			Tail(ret_val, EmitNode(BRANCH));              // 6
-			Tail(ret_val, EmitNode(NOTHING));             // 7
+			Tail(ctx, next, ret_val);                          // 4
+			OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next); // 5
+			Tail(ctx, ret_val, EmitNode(ctx, BRANCH));         // 6
+			Tail(ctx, ret_val, EmitNode(ctx, NOTHING));        // 7
 
-			Insert(INIT_COUNT, ret_val, 0UL, 0UL, pContext.Num_Braces); // 8
+			Insert(ctx, INIT_COUNT, ret_val, 0UL, 0UL, ctx.Num_Braces); // 8
 
-			Tail(ret_val, ret_val + INDEX_SIZE<size_t> + (2 * NODE_SIZE<size_t>)); // 8
+			Tail(ctx, ret_val, ret_val + INDEX_SIZE<size_t> + (2 * NODE_SIZE<size_t>)); // 8
 
 		} else {
 			/* Node structure for (x){m,n} construct.
@@ -1538,33 +1538,33 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 			 *         \_________5_____________|
 			 */
 
-			Tail(ret_val, EmitSpecial(INC_COUNT, 0UL, pContext.Num_Braces)); // 1
+			Tail(ctx, ret_val, EmitSpecial(ctx, INC_COUNT, 0UL, ctx.Num_Braces)); // 1
 
-			next = EmitSpecial(TEST_COUNT, min_max[1], pContext.Num_Braces); // 2,4
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[1], ctx.Num_Braces); // 2,4
 
-			Tail(ret_val, next); // 2
+			Tail(ctx, ret_val, next); // 2
 
-			next = EmitSpecial(TEST_COUNT, min_max[0], pContext.Num_Braces); // 4
+			next = EmitSpecial(ctx, TEST_COUNT, min_max[0], ctx.Num_Braces); // 4
 
-			Tail(EmitNode(BACK), ret_val);        // 3
-			Tail(next, EmitNode(BACK));           // 4
-			Insert(BRANCH, ret_val, 0UL, 0UL, 0); // 5,6
+			Tail(ctx, EmitNode(ctx, BACK), ret_val);   // 3
+			Tail(ctx, next, EmitNode(ctx, BACK));      // 4
+			Insert(ctx, BRANCH, ret_val, 0UL, 0UL, 0); // 5,6
 
-			next = EmitNode(BRANCH); // 5,8
+			next = EmitNode(ctx, BRANCH); // 5,8
 
-			Tail(ret_val, next);                        // 5
-			OffsetTail(next, -NODE_SIZE<int>, ret_val); // 6
+			Tail(ctx, ret_val, next);                        // 5
+			OffsetTail(ctx, next, -NODE_SIZE<int>, ret_val); // 6
 
-			next = EmitNode(NOTHING); // 7,8
+			next = EmitNode(ctx, NOTHING); // 7,8
 
-			OffsetTail(ret_val, NODE_SIZE<size_t>, next); // 7
+			OffsetTail(ctx, ret_val, NODE_SIZE<size_t>, next); // 7
 
-			OffsetTail(next, -NODE_SIZE<int>, next);                               // 8
-			Insert(INIT_COUNT, ret_val, 0UL, 0UL, pContext.Num_Braces);            // 9
-			Tail(ret_val, ret_val + INDEX_SIZE<size_t> + (2 * NODE_SIZE<size_t>)); // 9
+			OffsetTail(ctx, next, -NODE_SIZE<int>, next);                               // 8
+			Insert(ctx, INIT_COUNT, ret_val, 0UL, 0UL, ctx.Num_Braces);                 // 9
+			Tail(ctx, ret_val, ret_val + INDEX_SIZE<size_t> + (2 * NODE_SIZE<size_t>)); // 9
 		}
 
-		pContext.Num_Braces++;
+		ctx.Num_Braces++;
 	} else {
 		/* We get here if the IS_QUANTIFIER macro is not coordinated properly
 		   with this function. */
@@ -1572,11 +1572,11 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
 		Raise<RegexError>("internal error #2, 'piece'");
 	}
 
-	if (IsQuantifier()) {
+	if (IsQuantifier(ctx)) {
 		if (op_code == '{') {
-			Raise<RegexError>("nested quantifiers, {m,n}%c", pContext.Reg_Parse.peek());
+			Raise<RegexError>("nested quantifiers, {m,n}%c", ctx.Reg_Parse.peek());
 		} else {
-			Raise<RegexError>("nested quantifiers, %c%c", op_code, pContext.Reg_Parse.peek());
+			Raise<RegexError>("nested quantifiers, %c%c", op_code, ctx.Reg_Parse.peek());
 		}
 	}
 
@@ -1593,7 +1593,7 @@ uint8_t *Piece(int *flag_param, Range &range_param) {
  *                    to indicate the lower and upper bounds of the alternative's length.
  * @return The start of the emitted node for the alternative, or nullptr if an error occurs.
  */
-uint8_t *Alternative(int *flag_param, Range &range_param) {
+uint8_t *Alternative(ParseContext &ctx, int *flag_param, Range &range_param) {
 
 	uint8_t *ret_val;
 	uint8_t *chain;
@@ -1605,14 +1605,14 @@ uint8_t *Alternative(int *flag_param, Range &range_param) {
 	range_param.lower = 0;     // Idem
 	range_param.upper = 0;
 
-	ret_val = EmitNode(BRANCH);
+	ret_val = EmitNode(ctx, BRANCH);
 	chain   = nullptr;
 
 	/* Loop until we hit the start of the next alternative, the end of this set
 	   of alternatives (end of parentheses), or the end of the regex. */
 
-	while (!pContext.Reg_Parse.eof() && !pContext.Reg_Parse.next_is('|') && !pContext.Reg_Parse.next_is(')')) {
-		latest = Piece(&flags_local, range_local);
+	while (!ctx.Reg_Parse.eof() && !ctx.Reg_Parse.next_is('|') && !ctx.Reg_Parse.next_is(')')) {
+		latest = Piece(ctx, &flags_local, range_local);
 
 		if (!latest) {
 			return nullptr; // Something went wrong.
@@ -1629,14 +1629,14 @@ uint8_t *Alternative(int *flag_param, Range &range_param) {
 		}
 
 		if (chain) { // Connect the regex atoms together sequentially.
-			Tail(chain, latest);
+			Tail(ctx, chain, latest);
 		}
 
 		chain = latest;
 	}
 
 	if (!chain) { // Loop ran zero times.
-		EmitNode(NOTHING);
+		EmitNode(ctx, NOTHING);
 	}
 
 	return ret_val;
@@ -1658,15 +1658,15 @@ uint8_t *Alternative(int *flag_param, Range &range_param) {
  *                    to indicate the lower and upper bounds of the chunk's length.
  * @return The start of the emitted node for the chunk, or nullptr if an error occurs.
  */
-uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
+uint8_t *Chunk(ParseContext &ctx, int paren, int *flag_param, Range &range_param) {
 
 	uint8_t *ret_val  = nullptr;
 	uint8_t *ender    = nullptr;
 	size_t this_paren = 0;
 	int flags_local;
 	bool first               = true;
-	const bool old_sensitive = pContext.Is_Case_Insensitive;
-	const bool old_newline   = pContext.Match_Newline;
+	const bool old_sensitive = ctx.Is_Case_Insensitive;
+	const bool old_newline   = ctx.Match_Newline;
 
 	Range range_local;
 	bool look_only                   = false;
@@ -1678,36 +1678,36 @@ uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
 	// Make an OPEN node, if parenthesized.
 
 	if (paren == PAREN) {
-		if (pContext.Total_Paren >= MaxSubExpr) {
+		if (ctx.Total_Paren >= MaxSubExpr) {
 			Raise<RegexError>("number of ()'s > %u", MaxSubExpr);
 		}
 
-		this_paren = pContext.Total_Paren;
-		++pContext.Total_Paren;
-		ret_val = EmitNode(OPEN + this_paren);
+		this_paren = ctx.Total_Paren;
+		++ctx.Total_Paren;
+		ret_val = EmitNode(ctx, OPEN + this_paren);
 	} else if (paren == POS_AHEAD_OPEN || paren == NEG_AHEAD_OPEN) {
 		*flag_param = WORST; // Look ahead is zero width.
 		look_only   = true;
-		ret_val     = EmitNode(paren);
+		ret_val     = EmitNode(ctx, paren);
 	} else if (paren == POS_BEHIND_OPEN || paren == NEG_BEHIND_OPEN) {
 		*flag_param = WORST; // Look behind is zero width.
 		look_only   = true;
 		// We'll overwrite the zero length later on, so we save the ptr
-		ret_val                 = EmitSpecial(paren, 0, 0);
+		ret_val                 = EmitSpecial(ctx, paren, 0, 0);
 		emit_look_behind_bounds = ret_val + NODE_SIZE<size_t>;
 	} else if (paren == INSENSITIVE) {
-		pContext.Is_Case_Insensitive = true;
+		ctx.Is_Case_Insensitive = true;
 	} else if (paren == SENSITIVE) {
-		pContext.Is_Case_Insensitive = false;
+		ctx.Is_Case_Insensitive = false;
 	} else if (paren == NEWLINE) {
-		pContext.Match_Newline = true;
+		ctx.Match_Newline = true;
 	} else if (paren == NO_NEWLINE) {
-		pContext.Match_Newline = false;
+		ctx.Match_Newline = false;
 	}
 
 	// Pick up the branches, linking them together.
 	do {
-		uint8_t *const this_branch = Alternative(&flags_local, range_local);
+		uint8_t *const this_branch = Alternative(ctx, &flags_local, range_local);
 		if (!this_branch) {
 			return nullptr;
 		}
@@ -1732,7 +1732,7 @@ uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
 			}
 		}
 
-		Tail(ret_val, this_branch); // Connect BRANCH -> BRANCH.
+		Tail(ctx, ret_val, this_branch); // Connect BRANCH -> BRANCH.
 
 		/* If any alternative could be zero width, consider the whole
 		   parenthesized thing to be zero width. */
@@ -1742,40 +1742,40 @@ uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
 		}
 
 		// Are there more alternatives to process?
-		if (pContext.Reg_Parse.eof() || !pContext.Reg_Parse.next_is('|')) {
+		if (ctx.Reg_Parse.eof() || !ctx.Reg_Parse.next_is('|')) {
 			break;
 		}
 
-		pContext.Reg_Parse.read();
+		ctx.Reg_Parse.read();
 	} while (true);
 
 	// Make a closing node, and hook it on the end.
 
 	if (paren == PAREN) {
-		ender = EmitNode(CLOSE + this_paren);
+		ender = EmitNode(ctx, CLOSE + this_paren);
 	} else if (paren == NO_PAREN) {
-		ender = EmitNode(END);
+		ender = EmitNode(ctx, END);
 	} else if (paren == POS_AHEAD_OPEN || paren == NEG_AHEAD_OPEN) {
-		ender = EmitNode(LOOK_AHEAD_CLOSE);
+		ender = EmitNode(ctx, LOOK_AHEAD_CLOSE);
 	} else if (paren == POS_BEHIND_OPEN || paren == NEG_BEHIND_OPEN) {
-		ender = EmitNode(LOOK_BEHIND_CLOSE);
+		ender = EmitNode(ctx, LOOK_BEHIND_CLOSE);
 	} else {
-		ender = EmitNode(NOTHING);
+		ender = EmitNode(ctx, NOTHING);
 	}
 
-	Tail(ret_val, ender);
+	Tail(ctx, ret_val, ender);
 
 	// Hook the tails of the branch alternatives to the closing node.
-	for (uint8_t *this_branch = ret_val; this_branch != nullptr; this_branch = NextPtr(this_branch)) {
-		BranchTail(this_branch, NODE_SIZE<size_t>, ender);
+	for (uint8_t *this_branch = ret_val; this_branch != nullptr; this_branch = NextPtr(ctx, this_branch)) {
+		BranchTail(ctx, this_branch, NODE_SIZE<size_t>, ender);
 	}
 
 	// Check for proper termination.
 
-	if (paren != NO_PAREN && !pContext.Reg_Parse.match(')')) {
+	if (paren != NO_PAREN && !ctx.Reg_Parse.match(')')) {
 		Raise<RegexError>("missing right parenthesis ')'");
-	} else if (paren == NO_PAREN && !pContext.Reg_Parse.eof()) {
-		if (pContext.Reg_Parse.match(')')) {
+	} else if (paren == NO_PAREN && !ctx.Reg_Parse.eof()) {
+		if (ctx.Reg_Parse.match(')')) {
 			Raise<RegexError>("missing left parenthesis '('");
 		} else {
 			Raise<RegexError>("junk on end"); // "Can't happen" - NOT REACHED
@@ -1792,7 +1792,7 @@ uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
 			Raise<RegexError>("max. look-behind size is too large (>65535)");
 		}
 
-		if (!pContext.FirstPass) {
+		if (!ctx.FirstPass) {
 			*emit_look_behind_bounds++ = PUT_OFFSET_L(range_param.lower);
 			*emit_look_behind_bounds++ = PUT_OFFSET_R(range_param.lower);
 			*emit_look_behind_bounds++ = PUT_OFFSET_L(range_param.upper);
@@ -1811,25 +1811,25 @@ uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
 	/* Set a bit in Closed_Parens to let future calls to function 'BackRef'
 	   know that we have closed this set of parentheses. */
 
-	if (paren == PAREN && this_paren < pContext.Closed_Parens.size()) {
-		pContext.Closed_Parens[this_paren] = true;
+	if (paren == PAREN && this_paren < ctx.Closed_Parens.size()) {
+		ctx.Closed_Parens[this_paren] = true;
 
 		/* Determine if a parenthesized expression is modified by a quantifier
 		   that can have zero width. */
-		if (pContext.Reg_Parse.next_is('?') || pContext.Reg_Parse.next_is('*')) {
+		if (ctx.Reg_Parse.next_is('?') || ctx.Reg_Parse.next_is('*')) {
 			zero_width++;
-		} else if (pContext.Reg_Parse.next_is(pContext.Brace_Char)) {
+		} else if (ctx.Reg_Parse.next_is(ctx.Brace_Char)) {
 
-			if (pContext.Reg_Parse.peek(1) == ',' || pContext.Reg_Parse.peek(1) == '}') {
+			if (ctx.Reg_Parse.peek(1) == ',' || ctx.Reg_Parse.peek(1) == '}') {
 				zero_width++;
-			} else if (pContext.Reg_Parse.peek(1) == '0') {
+			} else if (ctx.Reg_Parse.peek(1) == '0') {
 				size_t i = 2;
 
-				while (pContext.Reg_Parse.peek(i) == '0') {
+				while (ctx.Reg_Parse.peek(i) == '0') {
 					i++;
 				}
 
-				if (pContext.Reg_Parse.peek(i) == ',') {
+				if (ctx.Reg_Parse.peek(i) == ',') {
 					zero_width++;
 				}
 			}
@@ -1842,12 +1842,12 @@ uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
 	   (*) or question (?) quantifiers to be applied to a back-reference that
 	   refers to this set of parentheses. */
 
-	if ((*flag_param & HAS_WIDTH) && paren == PAREN && !zero_width && this_paren < pContext.Paren_Has_Width.size()) {
-		pContext.Paren_Has_Width[this_paren] = true;
+	if ((*flag_param & HAS_WIDTH) && paren == PAREN && !zero_width && this_paren < ctx.Paren_Has_Width.size()) {
+		ctx.Paren_Has_Width[this_paren] = true;
 	}
 
-	pContext.Is_Case_Insensitive = old_sensitive;
-	pContext.Match_Newline       = old_newline;
+	ctx.Is_Case_Insensitive = old_sensitive;
+	ctx.Match_Newline       = old_newline;
 
 	return ret_val;
 }
@@ -1875,26 +1875,29 @@ uint8_t *Chunk(int paren, int *flag_param, Range &range_param) {
 Regex::Regex(std::string_view exp, int defaultFlags) {
 
 	Regex *const re = this;
+	ParseContext ctx;
 
 	int flags_local;
 	Range range_local;
 
 	if (ParseContext::Enable_Counting_Quantifier) {
-		pContext.Brace_Char = '{';
-		pContext.Meta_Char  = &DefaultMetaChar[0];
+		ctx.Brace_Char = '{';
+		ctx.Meta_Char  = &DefaultMetaChar[0];
 	} else {
-		pContext.Brace_Char = '*';                 // Bypass the '{' in
-		pContext.Meta_Char  = &DefaultMetaChar[1]; // DefaultMetaChar
+		ctx.Brace_Char = '*';                 // Bypass the '{' in
+		ctx.Meta_Char  = &DefaultMetaChar[1]; // DefaultMetaChar
 	}
 
-	// Initialize arrays used by function 'ShortcutEscape'.
-	if (!InitAnsiClasses()) {
+	// Initialize arrays used by function 'ShortcutEscape'. This happens exactly
+	// once, no matter how many threads are compiling expressions.
+	static const bool ansiClassesInitialized = InitAnsiClasses();
+	if (!ansiClassesInitialized) {
 		Raise<RegexError>("internal error #1, 'CompileRE'");
 	}
 
-	pContext.FirstPass = true;
-	pContext.Reg_Size  = 0UL;
-	pContext.Code.clear();
+	ctx.FirstPass = true;
+	ctx.Reg_Size  = 0UL;
+	ctx.Code.clear();
 
 	/* We can't allocate space until we know how big the compiled form will be,
 	   but we can't compile it (and thus know how big it is) until we've got a
@@ -1917,30 +1920,30 @@ Regex::Regex(std::string_view exp, int defaultFlags) {
 		 *    Match_Newline:       Newlines are NOT matched by default
 		 *                         in character classes
 		 */
-		pContext.Is_Case_Insensitive = ((defaultFlags & RE_DEFAULT_CASE_INSENSITIVE) != 0);
+		ctx.Is_Case_Insensitive = ((defaultFlags & RE_DEFAULT_CASE_INSENSITIVE) != 0);
 #if 0 // Currently not used. Uncomment if needed.
-		pContext.Match_Newline       = ((defaultFlags & RE_DEFAULT_MATCH_NEWLINE) != 0);
+		ctx.Match_Newline       = ((defaultFlags & RE_DEFAULT_MATCH_NEWLINE) != 0);
 #else
-		pContext.Match_Newline = false;
+		ctx.Match_Newline = false;
 #endif
 
-		pContext.Reg_Parse       = Reader(exp);
-		pContext.InputString     = exp;
-		pContext.Total_Paren     = 1;
-		pContext.Num_Braces      = 0;
-		pContext.Closed_Parens   = 0;
-		pContext.Paren_Has_Width = 0;
+		ctx.Reg_Parse       = Reader(exp);
+		ctx.InputString     = exp;
+		ctx.Total_Paren     = 1;
+		ctx.Num_Braces      = 0;
+		ctx.Closed_Parens   = 0;
+		ctx.Paren_Has_Width = 0;
 
-		EmitByte(Magic);
-		EmitByte('%'); // Placeholder for num of capturing parentheses.
-		EmitByte('%'); // Placeholder for num of general {m,n} constructs.
+		EmitByte(ctx, Magic);
+		EmitByte(ctx, '%'); // Placeholder for num of capturing parentheses.
+		EmitByte(ctx, '%'); // Placeholder for num of general {m,n} constructs.
 
-		if (!Chunk(NO_PAREN, &flags_local, range_local)) {
+		if (!Chunk(ctx, NO_PAREN, &flags_local, range_local)) {
 			Raise<RegexError>("internal error #10, 'CompileRE'");
 		}
 
 		if (pass == 1) {
-			if (pContext.Reg_Size >= MaxCompiledSize) {
+			if (ctx.Reg_Size >= MaxCompiledSize) {
 				/* Too big for NEXT pointers NEXT_PTR_SIZE bytes long to span.
 				   This is a real issue since the first BRANCH node usually points
 				   to the end of the compiled regex code. */
@@ -1949,18 +1952,18 @@ Regex::Regex(std::string_view exp, int defaultFlags) {
 			}
 
 			// NOTE(eteran): For now, we NEED this to avoid issues regarding holding pointers to reallocated space
-			pContext.Code.reserve(pContext.Reg_Size);
-			pContext.FirstPass = false;
+			ctx.Code.reserve(ctx.Reg_Size);
+			ctx.FirstPass = false;
 		}
 	}
 
-	pContext.Code[1] = static_cast<uint8_t>(pContext.Total_Paren - 1);
-	pContext.Code[2] = static_cast<uint8_t>(pContext.Num_Braces);
+	ctx.Code[1] = static_cast<uint8_t>(ctx.Total_Paren - 1);
+	ctx.Code[2] = static_cast<uint8_t>(ctx.Num_Braces);
 
-	assert(pContext.Code.size() == pContext.Reg_Size);
+	assert(ctx.Code.size() == ctx.Reg_Size);
 
 	// move over what we compiled
-	re->program = std::move(pContext.Code);
+	re->program = std::move(ctx.Code);
 
 	/*----------------------------------------*
 	 * Dig out information for optimizations. *
@@ -1969,7 +1972,7 @@ Regex::Regex(std::string_view exp, int defaultFlags) {
 	// First BRANCH.
 	uint8_t *scan = (&re->program[REGEX_START_OFFSET]);
 
-	if (GetOpCode(NextPtr(scan)) == END) { // Only one top-level choice.
+	if (GetOpCode(NextPtr(ctx, scan)) == END) { // Only one top-level choice.
 		scan = Operand(scan);
 
 		// Starting-point info.
@@ -11,7 +11,7 @@
 
 class Regex;
 
-// Global work variables for 'CompileRE'.
+// Work variables for a single regex compilation.
 struct ParseContext {
 	Reader Reg_Parse; // Input scan ptr (scans user's regex)
 	std::string_view InputString;
@@ -29,6 +29,4 @@ struct ParseContext {
 	char Brace_Char;
 };
 
-extern ParseContext pContext;
-
 #endif
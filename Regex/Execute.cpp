@@ -15,8 +15,7 @@
 
 namespace {
 
-bool Match(uint8_t *prog, size_t *branch_index_param);
-bool Attempt(Regex *prog, const char *string);
+bool Match(ExecuteContext &ctx, const uint8_t *prog, size_t *branch_index_param);
 
 /**
  * @brief Get the next pointer in the regex program.
@@ -37,7 +36,7 @@ bool Attempt(Regex *prog, const char *string);
  * @note This function used to be a macro, but was changed to an inline function
  * to improve type safety and maintainability.
  */
-FORCE_INLINE uint8_t *NextPointer(uint8_t *ptr) noexcept {
+FORCE_INLINE const uint8_t *NextPointer(const uint8_t *ptr) noexcept {
 
 	// NOTE(eteran): like NextPtr, but is inline
 	// doesn't do "is this a first pass compile" check
@@ -56,18 +55,21 @@ FORCE_INLINE uint8_t *NextPointer(uint8_t *ptr) noexcept {
 }
 
 /**
- * @brief Determine if the end of the string has been reached.
+ * @brief Determine if the end of the string has been reached. Reaching the
+ * physical end is remembered, since the match might have gone differently
+ * if the string had been longer.
  *
  * @param ptr The current position in the string.
  * @return `true` if the end of the string has been reached, `false` otherwise.
  */
-FORCE_INLINE bool EndOfString(const char *ptr) noexcept {
+FORCE_INLINE bool EndOfString(ExecuteContext &ctx, const char *ptr) noexcept {
 
-	if (eContext.End_Of_String != nullptr && ptr >= eContext.End_Of_String) {
+	if (ptr >= ctx.Real_End_Of_String) {
+		ctx.Hit_End = true;
 		return true;
 	}
 
-	if (ptr >= eContext.Real_End_Of_String) {
+	if (ctx.End_Of_String != nullptr && ptr >= ctx.End_Of_String) {
 		return true;
 	}
 
@@ -100,10 +102,10 @@ FORCE_INLINE uint16_t GetUpper(const uint8_t *p) noexcept {
  * @param ch The character to check.
  * @return `true` if the character is a delimiter, `false` otherwise.
  */
-bool IsDelimeter(int ch) noexcept {
+bool IsDelimeter(const ExecuteContext &ctx, int ch) noexcept {
 	auto n = static_cast<unsigned int>(ch);
-	if (n < eContext.Current_Delimiters.size()) {
-		return eContext.Current_Delimiters[n];
+	if (n < ctx.Current_Delimiters.size()) {
+		return ctx.Current_Delimiters[n];
 	}
 
 	return false;
@@ -118,9 +120,9 @@ bool IsDelimeter(int ch) noexcept {
  * @return The number of characters consumed from the input string.
  */
 template <class Pred>
-uint32_t GreedyConsume(const char *input, uint32_t max, Pred pred) {
+uint32_t GreedyConsume(ExecuteContext &ctx, const char *input, uint32_t max, Pred pred) {
 	uint32_t count = 0;
-	while (count < max && !EndOfString(input) && pred(*input)) {
+	while (count < max && !EndOfString(ctx, input) && pred(*input)) {
 		++count;
 		++input;
 	}
@@ -136,89 +138,89 @@ uint32_t GreedyConsume(const char *input, uint32_t max, Pred pred) {
  *            If `max` is greater than zero, match up to `max` times.
  * @return The actual number of matches made.
  */
-uint32_t Greedy(uint8_t *p, uint32_t max) {
+uint32_t Greedy(ExecuteContext &ctx, const uint8_t *p, uint32_t max) {
 
 	uint32_t count = 0;
 
-	const char *const input_str = eContext.Reg_Input;
+	const char *const input_str = ctx.Reg_Input;
 	const uint8_t *operand      = Operand(p); // Literal char or start of class characters.
 	const uint32_t max_cmp      = (max > 0) ? max : std::numeric_limits<uint32_t>::max();
 
 	switch (GetOpCode(p)) {
 	case ANY:
 		// Race to the end of the line or string. Dot DOESN'T match newline.
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return ch != '\n'; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return ch != '\n'; });
 		break;
 	case EVERY:
 		// Race to the end of the line or string. Dot DOES match newline.
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { (void)ch; return true; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { (void)ch; return true; });
 		break;
 	case EXACTLY:
 		// Count occurrences of single character operand.
-		count = GreedyConsume(input_str, max_cmp, [operand](char ch) { return static_cast<char>(*operand) == ch; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [operand](char ch) { return static_cast<char>(*operand) == ch; });
 		break;
 	case SIMILAR:
 		// Case insensitive version of EXACTLY
-		count = GreedyConsume(input_str, max_cmp, [operand](char ch) { return static_cast<char>(*operand) == safe_tolower(ch); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [operand](char ch) { return static_cast<char>(*operand) == safe_tolower(ch); });
 		break;
 	case ANY_OF:
 		// [...] character class.
-		count = GreedyConsume(input_str, max_cmp, [operand](char ch) { return ::strchr(reinterpret_cast<const char *>(operand), ch) != nullptr; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [operand](char ch) { return ::strchr(reinterpret_cast<const char *>(operand), ch) != nullptr; });
 		break;
 	case ANY_BUT:
 		/* [^...] Negated character class- does NOT normally match newline
 		 * (\n added usually to operand at compile time.) */
-		count = GreedyConsume(input_str, max_cmp, [operand](char ch) { return ::strchr(reinterpret_cast<const char *>(operand), ch) == nullptr; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [operand](char ch) { return ::strchr(reinterpret_cast<const char *>(operand), ch) == nullptr; });
 		break;
 	case IS_DELIM:
 		/* \y (not a word delimiter char)
 		 * NOTE: '\n' and '\0' are always word delimiters. */
-		count = GreedyConsume(input_str, max_cmp, IsDelimeter);
+		count = GreedyConsume(ctx, input_str, max_cmp, [&ctx](char ch) { return IsDelimeter(ctx, ch); });
 		break;
 	case NOT_DELIM:
 		/* \Y (not a word delimiter char)
 		 * NOTE: '\n' and '\0' are always word delimiters. */
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return !IsDelimeter(ch); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [&ctx](char ch) { return !IsDelimeter(ctx, ch); });
 		break;
 	case WORD_CHAR:
 		// \w (word character, alpha-numeric or underscore)
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return (safe_isalnum(ch) || ch == '_'); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return (safe_isalnum(ch) || ch == '_'); });
 		break;
 	case NOT_WORD_CHAR:
 		// \W (NOT a word character)
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return !safe_isalnum(ch) && ch != '_' && ch != '\n'; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return !safe_isalnum(ch) && ch != '_' && ch != '\n'; });
 		break;
 	case DIGIT:
 		// same as [0123456789]
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return safe_isdigit(ch); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return safe_isdigit(ch); });
 		break;
 	case NOT_DIGIT:
 		// same as [^0123456789]
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return !safe_isdigit(ch) && ch != '\n'; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return !safe_isdigit(ch) && ch != '\n'; });
 		break;
 	case SPACE:
 		// same as [ \t\r\f\v]-- doesn't match newline.
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return safe_isspace(ch) && ch != '\n'; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return safe_isspace(ch) && ch != '\n'; });
 		break;
 	case SPACE_NL:
 		// same as [\n \t\r\f\v]-- matches newline.
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return safe_isspace(ch); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return safe_isspace(ch); });
 		break;
 	case NOT_SPACE:
 		// same as [^\n \t\r\f\v]-- doesn't match newline.
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return !safe_isspace(ch); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return !safe_isspace(ch); });
 		break;
 	case NOT_SPACE_NL:
 		// same as [^ \t\r\f\v]-- matches newline.
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return (!safe_isspace(ch) || ch == '\n'); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return (!safe_isspace(ch) || ch == '\n'); });
 		break;
 	case LETTER:
 		// same as [a-zA-Z]
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return safe_isalpha(ch); });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return safe_isalpha(ch); });
 		break;
 	case NOT_LETTER:
 		// same as [^a-zA-Z]
-		count = GreedyConsume(input_str, max_cmp, [](char ch) { return !safe_isalpha(ch) && ch != '\n'; });
+		count = GreedyConsume(ctx, input_str, max_cmp, [](char ch) { return !safe_isalpha(ch) && ch != '\n'; });
 		break;
 	default:
 		/* Called inappropriately.  Only atoms that are SIMPLE should generate
@@ -229,21 +231,21 @@ uint32_t Greedy(uint8_t *p, uint32_t max) {
 	}
 
 	// Point to character just after last matched character.
-	eContext.Reg_Input = input_str + count;
+	ctx.Reg_Input = input_str + count;
 	return count;
 }
 
-#define MATCH_RETURN(X)             \
-	do {                            \
-		--eContext.Recursion_Count; \
-		return (X);                 \
+#define MATCH_RETURN(X)        \
+	do {                       \
+		--ctx.Recursion_Count; \
+		return (X);            \
 	} while (0)
 
-#define CHECK_RECURSION_LIMIT()                  \
-	do {                                         \
-		if (eContext.Recursion_Limit_Exceeded) { \
-			MATCH_RETURN(false);                 \
-		}                                        \
+#define CHECK_RECURSION_LIMIT()             \
+	do {                                    \
+		if (ctx.Recursion_Limit_Exceeded) { \
+			MATCH_RETURN(false);            \
+		}                                   \
 	} while (0)
 
 /**
@@ -259,23 +261,23 @@ uint32_t Greedy(uint8_t *p, uint32_t max) {
  * @param branch_index_param If not `nullptr`, this will be set to the index of the branch that matched.
  * @return `true` if the match is successful, `false` otherwise.
  */
-bool Match(uint8_t *prog, size_t *branch_index_param) {
+bool Match(ExecuteContext &ctx, const uint8_t *prog, size_t *branch_index_param) {
 
-	if (++eContext.Recursion_Count > RecursionLimit) {
+	if (++ctx.Recursion_Count > RecursionLimit) {
 		// Prevent duplicate errors
-		if (!eContext.Recursion_Limit_Exceeded) {
+		if (!ctx.Recursion_Limit_Exceeded) {
 			ReportError("recursion limit exceeded, please re-specify expression");
 		}
 
-		eContext.Recursion_Limit_Exceeded = true;
+		ctx.Recursion_Limit_Exceeded = true;
 		MATCH_RETURN(false);
 	}
 
 	// Current node.
-	uint8_t *scan = prog;
+	const uint8_t *scan = prog;
 
 	while (scan) {
-		uint8_t *next = NextPointer(scan);
+		const uint8_t *next = NextPointer(scan);
 
 		switch (GetOpCode(scan)) {
 		case BRANCH:
@@ -285,9 +287,9 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 				size_t branch_index_local = 0;
 
 				do {
-					const char *save = eContext.Reg_Input;
+					const char *save = ctx.Reg_Input;
 
-					if (Match(Operand(scan), nullptr)) {
+					if (Match(ctx, Operand(scan), nullptr)) {
 						if (branch_index_param) {
 							*branch_index_param = branch_index_local;
 						}
@@ -298,8 +300,8 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 
 					++branch_index_local;
 
-					eContext.Reg_Input = save; // Backtrack.
-					scan               = NextPointer(scan);
+					ctx.Reg_Input = save; // Backtrack.
+					scan          = NextPointer(scan);
 				} while (scan != nullptr && GetOpCode(scan) == BRANCH);
 
 				MATCH_RETURN(false); // NOT REACHED
@@ -307,53 +309,62 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			break;
 
 		case EXACTLY: {
-			uint8_t *opnd = Operand(scan);
+			const uint8_t *opnd = Operand(scan);
 
 			// Inline the first character, for speed.
-			if (EndOfString(eContext.Reg_Input) || static_cast<char>(*opnd) != *eContext.Reg_Input) {
+			if (EndOfString(ctx, ctx.Reg_Input) || static_cast<char>(*opnd) != *ctx.Reg_Input) {
 				MATCH_RETURN(false);
 			}
 
 			const auto str   = reinterpret_cast<const char *>(opnd);
 			const size_t len = strlen(str);
 
-			if (eContext.End_Of_String != nullptr && eContext.Reg_Input + len > eContext.End_Of_String) {
+			if (ctx.End_Of_String != nullptr && ctx.Reg_Input + len > ctx.End_Of_String) {
 				MATCH_RETURN(false);
 			}
 
-			if (len > 1 && strncmp(str, eContext.Reg_Input, len) != 0) {
+			const auto available = static_cast<size_t>(ctx.Real_End_Of_String - ctx.Reg_Input);
+			if (len > available) {
+				// it would have matched if the string had been long enough
+				if (strncmp(str, ctx.Reg_Input, available) == 0) {
+					ctx.Hit_End = true;
+				}
+				MATCH_RETURN(false);
+			}
+
+			if (len > 1 && strncmp(str, ctx.Reg_Input, len) != 0) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input += len;
+			ctx.Reg_Input += len;
 		} break;
 
 		case SIMILAR: {
 			uint8_t test;
-			uint8_t *opnd = Operand(scan);
+			const uint8_t *opnd = Operand(scan);
 
 			/* Note: the SIMILAR operand was converted to lower case during
 				   regex compile. */
 			while ((test = *opnd++) != '\0') {
-				if (EndOfString(eContext.Reg_Input) || safe_tolower(*eContext.Reg_Input++) != test) {
+				if (EndOfString(ctx, ctx.Reg_Input) || safe_tolower(*ctx.Reg_Input++) != test) {
 					MATCH_RETURN(false);
 				}
 			}
 		} break;
 
 		case BOL: // '^' (beginning of line anchor)
-			if (eContext.Reg_Input == eContext.Start_Of_String) {
-				if (eContext.Prev_Is_BOL) {
+			if (ctx.Reg_Input == ctx.Start_Of_String) {
+				if (ctx.Prev_Is_BOL) {
 					break;
 				}
-			} else if (eContext.Reg_Input[-1] == '\n') {
+			} else if (ctx.Reg_Input[-1] == '\n') {
 				break;
 			}
 
 			MATCH_RETURN(false);
 
 		case EOL: // '$' anchor matches end of line and end of string
-			if ((EndOfString(eContext.Reg_Input) && eContext.Succ_Is_EOL) || *eContext.Reg_Input == '\n') {
+			if ((EndOfString(ctx, ctx.Reg_Input) && ctx.Succ_Is_EOL) || *ctx.Reg_Input == '\n') {
 				break;
 			}
 
@@ -363,18 +374,18 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 					 /* Check to see if the current character is not a delimiter and the preceding character is. */
 			{
 				bool prev_is_delim;
-				if (eContext.Reg_Input == eContext.Start_Of_String) {
-					prev_is_delim = eContext.Prev_Is_Delim;
+				if (ctx.Reg_Input == ctx.Start_Of_String) {
+					prev_is_delim = ctx.Prev_Is_Delim;
 				} else {
-					prev_is_delim = IsDelimeter(eContext.Reg_Input[-1]);
+					prev_is_delim = IsDelimeter(ctx, ctx.Reg_Input[-1]);
 				}
 
 				if (prev_is_delim) {
 					bool current_is_delim;
-					if (EndOfString(eContext.Reg_Input)) {
-						current_is_delim = eContext.Succ_Is_Delim;
+					if (EndOfString(ctx, ctx.Reg_Input)) {
+						current_is_delim = ctx.Succ_Is_Delim;
 					} else {
-						current_is_delim = IsDelimeter(*eContext.Reg_Input);
+						current_is_delim = IsDelimeter(ctx, *ctx.Reg_Input);
 					}
 
 					if (!current_is_delim) {
@@ -389,18 +400,18 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 					 /* Check to see if the current character is a delimiter and the preceding character is not. */
 			{
 				bool prev_is_delim;
-				if (eContext.Reg_Input == eContext.Start_Of_String) {
-					prev_is_delim = eContext.Prev_Is_Delim;
+				if (ctx.Reg_Input == ctx.Start_Of_String) {
+					prev_is_delim = ctx.Prev_Is_Delim;
 				} else {
-					prev_is_delim = IsDelimeter(eContext.Reg_Input[-1]);
+					prev_is_delim = IsDelimeter(ctx, ctx.Reg_Input[-1]);
 				}
 
 				if (!prev_is_delim) {
 					bool current_is_delim;
-					if (EndOfString(eContext.Reg_Input)) {
-						current_is_delim = eContext.Succ_Is_Delim;
+					if (EndOfString(ctx, ctx.Reg_Input)) {
+						current_is_delim = ctx.Succ_Is_Delim;
 					} else {
-						current_is_delim = IsDelimeter(*eContext.Reg_Input);
+						current_is_delim = IsDelimeter(ctx, *ctx.Reg_Input);
 					}
 
 					if (current_is_delim) {
@@ -416,16 +427,16 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			bool prev_is_delim;
 			bool current_is_delim;
 
-			if (eContext.Reg_Input == eContext.Start_Of_String) {
-				prev_is_delim = eContext.Prev_Is_Delim;
+			if (ctx.Reg_Input == ctx.Start_Of_String) {
+				prev_is_delim = ctx.Prev_Is_Delim;
 			} else {
-				prev_is_delim = IsDelimeter(eContext.Reg_Input[-1]);
+				prev_is_delim = IsDelimeter(ctx, ctx.Reg_Input[-1]);
 			}
 
-			if (EndOfString(eContext.Reg_Input)) {
-				current_is_delim = eContext.Succ_Is_Delim;
+			if (EndOfString(ctx, ctx.Reg_Input)) {
+				current_is_delim = ctx.Succ_Is_Delim;
 			} else {
-				current_is_delim = IsDelimeter(*eContext.Reg_Input);
+				current_is_delim = IsDelimeter(ctx, *ctx.Reg_Input);
 			}
 
 			if (!(prev_is_delim ^ current_is_delim)) {
@@ -435,143 +446,143 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			MATCH_RETURN(false);
 
 		case IS_DELIM: // \y (A word delimiter character.)
-			if (!EndOfString(eContext.Reg_Input) && IsDelimeter(*eContext.Reg_Input)) {
-				eContext.Reg_Input++;
+			if (!EndOfString(ctx, ctx.Reg_Input) && IsDelimeter(ctx, *ctx.Reg_Input)) {
+				ctx.Reg_Input++;
 				break;
 			}
 
 			MATCH_RETURN(false);
 
 		case NOT_DELIM: // \Y (NOT a word delimiter character.)
-			if (!EndOfString(eContext.Reg_Input) && !IsDelimeter(*eContext.Reg_Input)) {
-				eContext.Reg_Input++;
+			if (!EndOfString(ctx, ctx.Reg_Input) && !IsDelimeter(ctx, *ctx.Reg_Input)) {
+				ctx.Reg_Input++;
 				break;
 			}
 
 			MATCH_RETURN(false);
 
 		case WORD_CHAR: // \w (word character; alpha-numeric or underscore)
-			if (!EndOfString(eContext.Reg_Input) && (safe_isalnum(*eContext.Reg_Input) || *eContext.Reg_Input == '_')) {
-				eContext.Reg_Input++;
+			if (!EndOfString(ctx, ctx.Reg_Input) && (safe_isalnum(*ctx.Reg_Input) || *ctx.Reg_Input == '_')) {
+				ctx.Reg_Input++;
 				break;
 			}
 
 			MATCH_RETURN(false);
 
 		case NOT_WORD_CHAR: // \W (NOT a word character)
-			if (EndOfString(eContext.Reg_Input) || safe_isalnum(*eContext.Reg_Input) || *eContext.Reg_Input == '_' || *eContext.Reg_Input == '\n') {
+			if (EndOfString(ctx, ctx.Reg_Input) || safe_isalnum(*ctx.Reg_Input) || *ctx.Reg_Input == '_' || *ctx.Reg_Input == '\n') {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case ANY: // '.' (matches any character EXCEPT newline)
-			if (EndOfString(eContext.Reg_Input) || *eContext.Reg_Input == '\n') {
+			if (EndOfString(ctx, ctx.Reg_Input) || *ctx.Reg_Input == '\n') {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case EVERY: // '.' (matches any character INCLUDING newline)
-			if (EndOfString(eContext.Reg_Input)) {
+			if (EndOfString(ctx, ctx.Reg_Input)) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case DIGIT: // \d, same as [0123456789]
-			if (EndOfString(eContext.Reg_Input) || !safe_isdigit(*eContext.Reg_Input)) {
+			if (EndOfString(ctx, ctx.Reg_Input) || !safe_isdigit(*ctx.Reg_Input)) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case NOT_DIGIT: // \D, same as [^0123456789]
-			if (EndOfString(eContext.Reg_Input) || safe_isdigit(*eContext.Reg_Input) || *eContext.Reg_Input == '\n') {
+			if (EndOfString(ctx, ctx.Reg_Input) || safe_isdigit(*ctx.Reg_Input) || *ctx.Reg_Input == '\n') {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case LETTER: // \l, same as [a-zA-Z]
-			if (EndOfString(eContext.Reg_Input) || !safe_isalpha(*eContext.Reg_Input)) {
+			if (EndOfString(ctx, ctx.Reg_Input) || !safe_isalpha(*ctx.Reg_Input)) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case NOT_LETTER: // \L, same as [^0123456789]
-			if (EndOfString(eContext.Reg_Input) || safe_isalpha(*eContext.Reg_Input) || *eContext.Reg_Input == '\n') {
+			if (EndOfString(ctx, ctx.Reg_Input) || safe_isalpha(*ctx.Reg_Input) || *ctx.Reg_Input == '\n') {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case SPACE: // \s, same as [ \t\r\f\v]
-			if (EndOfString(eContext.Reg_Input) || !safe_isspace(*eContext.Reg_Input) || *eContext.Reg_Input == '\n') {
+			if (EndOfString(ctx, ctx.Reg_Input) || !safe_isspace(*ctx.Reg_Input) || *ctx.Reg_Input == '\n') {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case SPACE_NL: // \s, same as [\n \t\r\f\v]
-			if (EndOfString(eContext.Reg_Input) || !safe_isspace(*eContext.Reg_Input)) {
+			if (EndOfString(ctx, ctx.Reg_Input) || !safe_isspace(*ctx.Reg_Input)) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case NOT_SPACE: // \S, same as [^\n \t\r\f\v]
-			if (EndOfString(eContext.Reg_Input) || safe_isspace(*eContext.Reg_Input)) {
+			if (EndOfString(ctx, ctx.Reg_Input) || safe_isspace(*ctx.Reg_Input)) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case NOT_SPACE_NL: // \S, same as [^ \t\r\f\v]
-			if (EndOfString(eContext.Reg_Input) || (safe_isspace(*eContext.Reg_Input) && *eContext.Reg_Input != '\n')) {
+			if (EndOfString(ctx, ctx.Reg_Input) || (safe_isspace(*ctx.Reg_Input) && *ctx.Reg_Input != '\n')) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case ANY_OF: // [...] character class.
-			if (EndOfString(eContext.Reg_Input)) {
+			if (EndOfString(ctx, ctx.Reg_Input)) {
 				MATCH_RETURN(false); /* Needed because strchr () considers \0
 										as a member of the character set. */
 			}
 
-			if (::strchr(reinterpret_cast<char *>(Operand(scan)), *eContext.Reg_Input) == nullptr) {
+			if (::strchr(reinterpret_cast<const char *>(Operand(scan)), *ctx.Reg_Input) == nullptr) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case ANY_BUT: /* [^...] Negated character class-- does NOT normally
 					  match newline (\n added usually to operand at compile
 					  time.) */
 
-			if (EndOfString(eContext.Reg_Input)) {
+			if (EndOfString(ctx, ctx.Reg_Input)) {
 				MATCH_RETURN(false); // See comment for ANY_OF.
 			}
 
-			if (::strchr(reinterpret_cast<char *>(Operand(scan)), *eContext.Reg_Input) != nullptr) {
+			if (::strchr(reinterpret_cast<const char *>(Operand(scan)), *ctx.Reg_Input) != nullptr) {
 				MATCH_RETURN(false);
 			}
 
-			eContext.Reg_Input++;
+			ctx.Reg_Input++;
 			break;
 
 		case NOTHING:
@@ -592,7 +603,7 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			uint32_t max         = 0;
 			const char *save;
 			uint8_t next_char;
-			uint8_t *next_op;
+			const uint8_t *next_op;
 			bool lazy = false;
 
 			/* Lookahead (when possible) to avoid useless match attempts
@@ -645,19 +656,19 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 				next_op = Operand(scan + (2 * NEXT_PTR_SIZE<size_t>));
 			}
 
-			save = eContext.Reg_Input;
+			save = ctx.Reg_Input;
 
 			if (lazy) {
 				if (min > 0) {
-					num_matched = Greedy(next_op, min);
+					num_matched = Greedy(ctx, next_op, min);
 				}
 			} else {
-				num_matched = Greedy(next_op, max);
+				num_matched = Greedy(ctx, next_op, max);
 			}
 
 			while (min <= num_matched && num_matched <= max) {
-				if (next_char == '\0' || (!EndOfString(eContext.Reg_Input) && static_cast<char>(next_char) == *eContext.Reg_Input)) {
-					if (Match(next, nullptr)) {
+				if (next_char == '\0' || (!EndOfString(ctx, ctx.Reg_Input) && static_cast<char>(next_char) == *ctx.Reg_Input)) {
+					if (Match(ctx, next, nullptr)) {
 						MATCH_RETURN(true);
 					}
 
@@ -666,7 +677,7 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 
 				// Couldn't or didn't match.
 				if (lazy) {
-					if (!Greedy(next_op, 1)) {
+					if (!Greedy(ctx, next_op, 1)) {
 						MATCH_RETURN(false);
 					}
 
@@ -677,7 +688,7 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 					break;
 				}
 
-				eContext.Reg_Input = save + num_matched;
+				ctx.Reg_Input = save + num_matched;
 			}
 
 			MATCH_RETURN(false);
@@ -686,23 +697,23 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 		break;
 
 		case END:
-			if (eContext.Extent_Ptr_FW == nullptr || (eContext.Reg_Input - eContext.Extent_Ptr_FW) > 0) {
-				eContext.Extent_Ptr_FW = eContext.Reg_Input;
+			if (ctx.Extent_Ptr_FW == nullptr || (ctx.Reg_Input - ctx.Extent_Ptr_FW) > 0) {
+				ctx.Extent_Ptr_FW = ctx.Reg_Input;
 			}
 
 			MATCH_RETURN(true); // Success!
 			break;
 
 		case INIT_COUNT:
-			eContext.BraceCounts[*Operand(scan)] = 0;
+			ctx.BraceCounts[*Operand(scan)] = 0;
 			break;
 
 		case INC_COUNT:
-			eContext.BraceCounts[*Operand(scan)]++;
+			ctx.BraceCounts[*Operand(scan)]++;
 			break;
 
 		case TEST_COUNT:
-			if (eContext.BraceCounts[*Operand(scan)] < static_cast<uint32_t>(GetOffset(scan + NEXT_PTR_SIZE<size_t> + INDEX_SIZE<size_t>))) {
+			if (ctx.BraceCounts[*Operand(scan)] < static_cast<uint32_t>(GetOffset(scan + NEXT_PTR_SIZE<size_t> + INDEX_SIZE<size_t>))) {
 				next = scan + NODE_SIZE<size_t> + INDEX_SIZE<size_t> + NEXT_PTR_SIZE<size_t>;
 			}
 			break;
@@ -720,16 +731,16 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 
 #ifdef ENABLE_CROSS_REGEX_BACKREF
 			if (GetOpCode(scan) == X_REGEX_BR || GetOpCode(scan) == X_REGEX_BR_CI) {
-				if (eContext.Cross_Regex_Backref == nullptr) {
+				if (ctx.Cross_Regex_Backref == nullptr) {
 					MATCH_RETURN(0);
 				}
 
-				captured = eContext.Cross_Regex_Backref->startp[paren_no];
-				finish   = eContext.Cross_Regex_Backref->endp[paren_no];
+				captured = ctx.Cross_Regex_Backref->startp[paren_no];
+				finish   = ctx.Cross_Regex_Backref->endp[paren_no];
 			} else {
 #endif
-				captured = eContext.Back_Ref_Start[paren_no];
-				finish   = eContext.Back_Ref_End[paren_no];
+				captured = ctx.Back_Ref_Start[paren_no];
+				finish   = ctx.Back_Ref_End[paren_no];
 #ifdef ENABLE_CROSS_REGEX_BACKREF
 			}
 #endif
@@ -745,13 +756,13 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 				if (GetOpCode(scan) == BACK_REF_CI) {
 #endif
 					while (captured < finish) {
-						if (EndOfString(eContext.Reg_Input) || safe_tolower(*captured++) != safe_tolower(*eContext.Reg_Input++)) {
+						if (EndOfString(ctx, ctx.Reg_Input) || safe_tolower(*captured++) != safe_tolower(*ctx.Reg_Input++)) {
 							MATCH_RETURN(false);
 						}
 					}
 				} else {
 					while (captured < finish) {
-						if (EndOfString(eContext.Reg_Input) || *captured++ != *eContext.Reg_Input++) {
+						if (EndOfString(ctx, ctx.Reg_Input) || *captured++ != *ctx.Reg_Input++) {
 							MATCH_RETURN(false);
 						}
 					}
@@ -766,14 +777,14 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 		case POS_AHEAD_OPEN:
 		case NEG_AHEAD_OPEN: {
 
-			const char *save = eContext.Reg_Input;
+			const char *save = ctx.Reg_Input;
 
 			/* Temporarily ignore the logical end of the string, to allow
 			   lookahead past the end. */
-			const char *saved_end  = eContext.End_Of_String;
-			eContext.End_Of_String = nullptr;
+			const char *saved_end = ctx.End_Of_String;
+			ctx.End_Of_String     = nullptr;
 
-			const bool answer = Match(next, nullptr); // Does the look-ahead regex match?
+			const bool answer = Match(ctx, next, nullptr); // Does the look-ahead regex match?
 
 			CHECK_RECURSION_LIMIT();
 
@@ -786,12 +797,12 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 				   may need more text than it matches to accomplish a
 				   re-match. */
 
-				if (eContext.Extent_Ptr_FW == nullptr || (eContext.Reg_Input - eContext.Extent_Ptr_FW) > 0) {
-					eContext.Extent_Ptr_FW = eContext.Reg_Input;
+				if (ctx.Extent_Ptr_FW == nullptr || (ctx.Reg_Input - ctx.Extent_Ptr_FW) > 0) {
+					ctx.Extent_Ptr_FW = ctx.Reg_Input;
 				}
 
-				eContext.Reg_Input     = save;      // Backtrack to look-ahead start.
-				eContext.End_Of_String = saved_end; // Restore logical end.
+				ctx.Reg_Input     = save;      // Backtrack to look-ahead start.
+				ctx.End_Of_String = saved_end; // Restore logical end.
 
 				/* Jump to the node just after the (?=...) or (?!...)
 				   Construct. */
@@ -804,8 +815,8 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 
 				next = NextPointer(next); // Skip the LOOK_AHEAD_CLOSE
 			} else {
-				eContext.Reg_Input     = save;      // Backtrack to look-ahead start.
-				eContext.End_Of_String = saved_end; // Restore logical end.
+				ctx.Reg_Input     = save;      // Backtrack to look-ahead start.
+				ctx.End_Of_String = saved_end; // Restore logical end.
 
 				MATCH_RETURN(false);
 			}
@@ -819,13 +830,13 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			bool found = false;
 			const char *saved_end;
 
-			save      = eContext.Reg_Input;
-			saved_end = eContext.End_Of_String;
+			save      = ctx.Reg_Input;
+			saved_end = ctx.End_Of_String;
 
 			/* Prevent overshoot (greedy matching could end past the
 			   current position) by tightening the matching boundary.
 			   Lookahead inside lookbehind can still cross that boundary. */
-			eContext.End_Of_String = eContext.Reg_Input;
+			ctx.End_Of_String = ctx.Reg_Input;
 
 			const uint16_t lower = GetLower(scan);
 			const uint16_t upper = GetUpper(scan);
@@ -836,20 +847,21 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			   is not constant: we have to make sure the expression doesn't
 			   match for _any_ of the starting positions. */
 			for (uint32_t offset = lower; offset <= upper; ++offset) {
-				eContext.Reg_Input = save - offset;
+				ctx.Reg_Input = save - offset;
 
-				if (eContext.Reg_Input < eContext.Look_Behind_To) {
+				if (ctx.Reg_Input < ctx.Look_Behind_To) {
 					// No need to look any further
+					ctx.Hit_Start = true;
 					break;
 				}
 
-				const bool answer = Match(next, nullptr); // Does the look-behind regex match?
+				const bool answer = Match(ctx, next, nullptr); // Does the look-behind regex match?
 
 				CHECK_RECURSION_LIMIT();
 
 				/* The match must have ended at the current position;
 				   otherwise it is invalid */
-				if (answer && eContext.Reg_Input == save) {
+				if (answer && ctx.Reg_Input == save) {
 					// It matched, exactly far enough
 					found = true;
 
@@ -861,8 +873,8 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 					   leading look-behind may need more text than it matches
 					   to accomplish a re-match. */
 
-					if (eContext.Extent_Ptr_BW == nullptr || (eContext.Extent_Ptr_BW - (save - offset)) > 0) {
-						eContext.Extent_Ptr_BW = save - offset;
+					if (ctx.Extent_Ptr_BW == nullptr || (ctx.Extent_Ptr_BW - (save - offset)) > 0) {
+						ctx.Extent_Ptr_BW = save - offset;
 					}
 
 					break;
@@ -870,8 +882,8 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			}
 
 			// Always restore the position and the logical string end.
-			eContext.Reg_Input     = save;
-			eContext.End_Of_String = saved_end;
+			ctx.Reg_Input     = save;
+			ctx.End_Of_String = saved_end;
 
 			if ((GetOpCode(scan) == POS_BEHIND_OPEN) ? found : !found) {
 				/* The look-behind matches, so we must jump to the next
@@ -902,19 +914,19 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			if ((GetOpCode(scan) > OPEN) && (GetOpCode(scan) < OPEN + MaxSubExpr)) {
 
 				const uint8_t no = GetOpCode(scan) - OPEN;
-				const char *save = eContext.Reg_Input;
+				const char *save = ctx.Reg_Input;
 
 				if (no < 10) {
-					eContext.Back_Ref_Start[no] = save;
-					eContext.Back_Ref_End[no]   = nullptr;
+					ctx.Back_Ref_Start[no] = save;
+					ctx.Back_Ref_End[no]   = nullptr;
 				}
 
-				if (Match(next, nullptr)) {
+				if (Match(ctx, next, nullptr)) {
 					/* Do not set 'Start_Ptr_Ptr' if some later invocation (think
 					   recursion) of the same parentheses already has. */
 
-					if (eContext.Start_Ptr_Ptr[no] == nullptr) {
-						eContext.Start_Ptr_Ptr[no] = save;
+					if (ctx.Start_Ptr_Ptr[no] == nullptr) {
+						ctx.Start_Ptr_Ptr[no] = save;
 					}
 
 					MATCH_RETURN(true);
@@ -924,18 +936,18 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 			} else if ((GetOpCode(scan) > CLOSE) && (GetOpCode(scan) < CLOSE + MaxSubExpr)) {
 
 				const uint8_t no = GetOpCode(scan) - CLOSE;
-				const char *save = eContext.Reg_Input;
+				const char *save = ctx.Reg_Input;
 
 				if (no < 10) {
-					eContext.Back_Ref_End[no] = save;
+					ctx.Back_Ref_End[no] = save;
 				}
 
-				if (Match(next, nullptr)) {
+				if (Match(ctx, next, nullptr)) {
 					/* Do not set 'End_Ptr_Ptr' if some later invocation of the
 					   same parentheses already has. */
 
-					if (eContext.End_Ptr_Ptr[no] == nullptr) {
-						eContext.End_Ptr_Ptr[no] = save;
+					if (ctx.End_Ptr_Ptr[no] == nullptr) {
+						ctx.End_Ptr_Ptr[no] = save;
 					}
 
 					MATCH_RETURN(true);
@@ -963,34 +975,36 @@ bool Match(uint8_t *prog, size_t *branch_index_param) {
 /**
  * @brief Attempt to match at a specific point.
  *
+ * @param ctx The state of the match in progress.
  * @param prog The regex program to match against the input string.
+ * @param match Receives the captured text if the match is successful.
  * @param string The input string to match against the regex program.
  * @return `true` if the match is successful, `false` otherwise.
  */
-bool Attempt(Regex *prog, const char *string) {
+bool Attempt(ExecuteContext &ctx, const Regex *prog, RegexMatch *match, const char *string) {
 
 	size_t branch_index = 0; // Must be set to zero !
 
-	eContext.Reg_Input     = string;
-	eContext.Start_Ptr_Ptr = prog->startp.begin();
-	eContext.End_Ptr_Ptr   = prog->endp.begin();
+	ctx.Reg_Input     = string;
+	ctx.Start_Ptr_Ptr = match->startp.begin();
+	ctx.End_Ptr_Ptr   = match->endp.begin();
 
 	// Reset the recursion counter.
-	eContext.Recursion_Count = 0;
+	ctx.Recursion_Count = 0;
 
 	// Overhead due to capturing parentheses.
-	eContext.Extent_Ptr_BW = string;
-	eContext.Extent_Ptr_FW = nullptr;
+	ctx.Extent_Ptr_BW = string;
+	ctx.Extent_Ptr_FW = nullptr;
 
-	std::fill_n(prog->startp.begin(), eContext.Total_Paren + 1, nullptr);
-	std::fill_n(prog->endp.begin(), eContext.Total_Paren + 1, nullptr);
+	std::fill_n(match->startp.begin(), ctx.Total_Paren + 1, nullptr);
+	std::fill_n(match->endp.begin(), ctx.Total_Paren + 1, nullptr);
 
-	if (Match((&prog->program[REGEX_START_OFFSET]), &branch_index)) {
-		prog->startp[0]  = string;
-		prog->endp[0]    = eContext.Reg_Input;     // <-- One char AFTER
-		prog->extentpBW  = eContext.Extent_Ptr_BW; //     matched string!
-		prog->extentpFW  = eContext.Extent_Ptr_FW;
-		prog->top_branch = branch_index;
+	if (Match(ctx, (&prog->program[REGEX_START_OFFSET]), &branch_index)) {
+		match->startp[0]  = string;
+		match->endp[0]    = ctx.Reg_Input;     // <-- One char AFTER
+		match->extentpBW  = ctx.Extent_Ptr_BW; //     matched string!
+		match->extentpFW  = ctx.Extent_Ptr_FW;
+		match->top_branch = branch_index;
 
 		return true;
 	}
@@ -1001,8 +1015,11 @@ bool Attempt(Regex *prog, const char *string) {
 }
 
 /**
- * @brief Match a Regex against a string.
+ * @brief Match a Regex against a string. All of the state of the match lives
+ * on the stack of this call, so a compiled Regex may be used by any number of
+ * threads at once.
  *
+ * @param match Receives the captured text if the match is successful.
  * @param start The logical start of the string to match against.
  * @param end The logical end of the string to match against. If `nullptr`, the
  *            physical end of the string is used. Matches may not BEGIN past this
@@ -1028,7 +1045,7 @@ bool Attempt(Regex *prog, const char *string) {
  *                   to determine the physical end of the string regardless of '\0' termination.
  * @return `true` if the match is successful, `false` otherwise.
  */
-bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_char, int succ_char, const char *delimiters, const char *look_behind_to, const char *match_to, const char *string_end) {
+bool Regex::ExecRE(RegexMatch *match, const char *start, const char *end, bool reverse, int prev_char, int succ_char, const char *delimiters, const char *look_behind_to, const char *match_to, const char *string_end) const {
 
 	/*
 	Notes: look_behind_to <= start <= end <= match_to
@@ -1040,7 +1057,8 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 	+--------------+-----------------+-------------+
 	*/
 
-	Regex *const re = this;
+	const Regex *const re = this;
+	ExecuteContext ctx    = {};
 
 	// Check validity of program.
 	if (!re->isValid()) {
@@ -1052,14 +1070,17 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 	bool ret_val = false;
 
 	// If caller has supplied delimiters, make a delimiter table
-	eContext.Current_Delimiters = delimiters ? Regex::makeDelimiterTable(delimiters) : Regex::Default_Delimiters;
+	ctx.Current_Delimiters = delimiters ? Regex::makeDelimiterTable(delimiters) : Regex::Default_Delimiters;
 
 	// Remember the logical and physical end of the string.
-	eContext.End_Of_String      = match_to;
-	eContext.Real_End_Of_String = string_end;
+	ctx.End_Of_String      = match_to;
+	ctx.Real_End_Of_String = string_end;
+
+	// a successor character means the text carries on past the physical end of this string
+	const bool more_text = (succ_char != -1);
 
 	if (!end && reverse) {
-		for (end = start; !EndOfString(end); end++) {
+		for (end = start; !EndOfString(ctx, end); end++) {
 		}
 		succ_char = '\n';
 	} else if (!end) {
@@ -1067,23 +1088,23 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 	}
 
 	// Remember the beginning of the string for matching BOL
-	eContext.Start_Of_String = start;
-	eContext.Look_Behind_To  = (look_behind_to ? look_behind_to : start);
+	ctx.Start_Of_String = start;
+	ctx.Look_Behind_To  = (look_behind_to ? look_behind_to : start);
 
-	eContext.Prev_Is_BOL   = (prev_char == '\n') || (prev_char == -1);
-	eContext.Succ_Is_EOL   = (succ_char == '\n') || (succ_char == -1);
-	eContext.Prev_Is_Delim = (prev_char == -1) || eContext.Current_Delimiters[static_cast<uint8_t>(prev_char)];
-	eContext.Succ_Is_Delim = (succ_char == -1) || eContext.Current_Delimiters[static_cast<uint8_t>(succ_char)];
+	ctx.Prev_Is_BOL   = (prev_char == '\n') || (prev_char == -1);
+	ctx.Succ_Is_EOL   = (succ_char == '\n') || (succ_char == -1);
+	ctx.Prev_Is_Delim = (prev_char == -1) || ctx.Current_Delimiters[static_cast<uint8_t>(prev_char)];
+	ctx.Succ_Is_Delim = (succ_char == -1) || ctx.Current_Delimiters[static_cast<uint8_t>(succ_char)];
 
-	eContext.Total_Paren = re->program[1];
-	eContext.Num_Braces  = re->program[2];
+	ctx.Total_Paren = re->program[1];
+	ctx.Num_Braces  = re->program[2];
 
 	// Reset the recursion detection flag
-	eContext.Recursion_Limit_Exceeded = false;
+	ctx.Recursion_Limit_Exceeded = false;
 
 	// Allocate memory for {m,n} construct counting variables if need be.
-	if (eContext.Num_Braces > 0) {
-		eContext.BraceCounts = std::make_unique<uint32_t[]>(eContext.Num_Braces);
+	if (ctx.Num_Braces > 0) {
+		ctx.BraceCounts = std::make_unique<uint32_t[]>(ctx.Num_Braces);
 	}
 
 	/* Initialize the first nine (9) capturing parentheses start and end
@@ -1091,11 +1112,14 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 	   crashes when later trying to reference captured parens that do not exist
 	   in the compiled regex.  We only need to do the first nine since users
 	   can only specify \1, \2, ... \9. */
-	std::fill_n(re->startp.begin(), 9, start);
-	std::fill_n(re->endp.begin(), 9, start);
+	std::fill_n(match->startp.begin(), 9, start);
+	std::fill_n(match->endp.begin(), 9, start);
+
+	auto checked_return = [&ctx, match](bool value) {
+		match->hitStart = ctx.Hit_Start;
+		match->hitEnd   = ctx.Hit_End;
 
-	auto checked_return = [](bool value) {
-		if (eContext.Recursion_Limit_Exceeded) {
+		if (ctx.Recursion_Limit_Exceeded) {
 			return false;
 		}
 
@@ -1105,15 +1129,15 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 	if (!reverse) { // Forward Search
 		if (re->anchor) {
 			// Search is anchored at BOL
-			if (Attempt(re, start)) {
+			if (Attempt(ctx, re, match, start)) {
 				ret_val = true;
 				return checked_return(ret_val);
 			}
 
-			for (str = start; !EndOfString(str) && str != end && !eContext.Recursion_Limit_Exceeded; str++) {
+			for (str = start; str != end && !EndOfString(ctx, str) && !ctx.Recursion_Limit_Exceeded; str++) {
 
 				if (*str == '\n') {
-					if (Attempt(re, str + 1)) {
+					if (Attempt(ctx, re, match, str + 1)) {
 						ret_val = true;
 						break;
 					}
@@ -1125,10 +1149,10 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 
 		if (re->match_start != '\0') {
 			// We know what char match must start with.
-			for (str = start; !EndOfString(str) && str != end && !eContext.Recursion_Limit_Exceeded; str++) {
+			for (str = start; str != end && !EndOfString(ctx, str) && !ctx.Recursion_Limit_Exceeded; str++) {
 
 				if (*str == re->match_start) {
-					if (Attempt(re, str)) {
+					if (Attempt(ctx, re, match, str)) {
 						ret_val = true;
 						break;
 					}
@@ -1139,9 +1163,9 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 		}
 
 		// General case
-		for (str = start; !EndOfString(str) && str != end && !eContext.Recursion_Limit_Exceeded; str++) {
+		for (str = start; str != end && !EndOfString(ctx, str) && !ctx.Recursion_Limit_Exceeded; str++) {
 
-			if (Attempt(re, str)) {
+			if (Attempt(ctx, re, match, str)) {
 				ret_val = true;
 				break;
 			}
@@ -1149,11 +1173,11 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 
 		// Beware of a single $ matching \0
 #if 1 // NOTE(eteran): possible fix for issue #97
-		if (!eContext.Recursion_Limit_Exceeded && !ret_val && EndOfString(str)) {
+		if (!ctx.Recursion_Limit_Exceeded && !ret_val && ((ctx.End_Of_String != nullptr && str >= ctx.End_Of_String) || (str >= ctx.Real_End_Of_String && !more_text))) {
 #else
-		if (!eContext.Recursion_Limit_Exceeded && !ret_val && EndOfString(str) && str != end) {
+		if (!ctx.Recursion_Limit_Exceeded && !ret_val && EndOfString(ctx, str) && str != end) {
 #endif
-			if (Attempt(re, str)) {
+			if (Attempt(ctx, re, match, str)) {
 				ret_val = true;
 			}
 		}
@@ -1164,22 +1188,22 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 	// Search reverse, same as forward, but loops run backward
 
 	// Make sure that we don't start matching beyond the logical end
-	if (eContext.End_Of_String != nullptr && end > eContext.End_Of_String) {
-		end = eContext.End_Of_String;
+	if (ctx.End_Of_String != nullptr && end > ctx.End_Of_String) {
+		end = ctx.End_Of_String;
 	}
 
 	if (re->anchor) {
 		// Search is anchored at BOL
-		for (str = (end - 1); str >= start && !eContext.Recursion_Limit_Exceeded; str--) {
+		for (str = (end - 1); str >= start && !ctx.Recursion_Limit_Exceeded; str--) {
 			if (*str == '\n') {
-				if (Attempt(re, str + 1)) {
+				if (Attempt(ctx, re, match, str + 1)) {
 					ret_val = true;
 					return checked_return(ret_val);
 				}
 			}
 		}
 
-		if (!eContext.Recursion_Limit_Exceeded && Attempt(re, start)) {
+		if (!ctx.Recursion_Limit_Exceeded && Attempt(ctx, re, match, start)) {
 			ret_val = true;
 			return checked_return(ret_val);
 		}
@@ -1189,9 +1213,9 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 
 	if (re->match_start != '\0') {
 		// We know what char match must start with.
-		for (str = end; str >= start && !eContext.Recursion_Limit_Exceeded; str--) {
-			if (*str == re->match_start) {
-				if (Attempt(re, str)) {
+		for (str = end; str >= start && !ctx.Recursion_Limit_Exceeded; str--) {
+			if (str != ctx.Real_End_Of_String && *str == re->match_start) {
+				if (Attempt(ctx, re, match, str)) {
 					ret_val = true;
 					break;
 				}
@@ -1202,8 +1226,8 @@ bool Regex::ExecRE(const char *start, const char *end, bool reverse, int prev_ch
 	}
 
 	// General case
-	for (str = end; str >= start && !eContext.Recursion_Limit_Exceeded; str--) {
-		if (Attempt(re, str)) {
+	for (str = end; str >= start && !ctx.Recursion_Limit_Exceeded; str--) {
+		if (Attempt(ctx, re, match, str)) {
 			ret_val = true;
 			break;
 		}
@@ -13,9 +13,9 @@
 
 // #define ENABLE_CROSS_REGEX_BACKREF
 
-class Regex;
+struct RegexMatch;
 
-// Global work variables for 'ExecRE'.
+// Work variables for a single call to 'ExecRE'.
 
 template <size_t N>
 using array_iterator = typename std::array<const char *, N>::iterator;
@@ -36,7 +36,7 @@ struct ExecuteContext {
 	int Recursion_Count;                         // Recursion counter
 
 #ifdef ENABLE_CROSS_REGEX_BACKREF
-	Regex *Cross_Regex_Backref;
+	const RegexMatch *Cross_Regex_Backref;
 #endif
 	uint8_t Num_Braces;  // Number of general {m,n} constructs. {m,n} quantifiers of SIMPLE atoms are not included in this count.
 	uint8_t Total_Paren; // Parentheses, (),  counter.
@@ -45,9 +45,9 @@ struct ExecuteContext {
 	bool Prev_Is_Delim;
 	bool Succ_Is_Delim;
 	bool Recursion_Limit_Exceeded;       // Recursion limit exceeded flag
+	bool Hit_Start;                      // A look-behind wanted to see before Look_Behind_To
+	bool Hit_End;                        // Some part of the match looked at Real_End_Of_String
 	std::bitset<256> Current_Delimiters; // Current delimiter table
 };
 
-extern ExecuteContext eContext;
-
 #endif
@@ -87,9 +87,6 @@
 // Default table for determining whether a character is a word delimiter.
 std::bitset<256> Regex::Default_Delimiters;
 
-ExecuteContext eContext;
-ParseContext pContext;
-
 /* The "internal use only" fields in `Regex.h' are present to pass info from
  * `CompileRE' to `ExecRE' which permits the execute phase to run lots faster on
  * simple cases.  They are:
@@ -112,38 +109,41 @@ ParseContext pContext;
 /**
  * @brief Execute a `Regex` structure against a string.
  *
+ * @param match Receives the captured text if the regex matches.
  * @param string Text to search within
  * @param reverse If `true`, search backwards through the string.
  * @return `true` if the regex matches, `false` otherwise.
  */
-bool Regex::execute(std::string_view string, bool reverse) {
-	return execute(string, 0, reverse);
+bool Regex::execute(RegexMatch *match, std::string_view string, bool reverse) const {
+	return execute(match, string, 0, reverse);
 }
 
 /**
  * @brief Execute a `Regex` structure against a string starting at a specific offset.
  *
+ * @param match Receives the captured text if the regex matches.
  * @param string Text to search within
  * @param offset Offset into the string to begin search.
  * @param reverse If `true`, search backwards through the string.
  * @return `true` if the regex matches, `false` otherwise.
  */
-bool Regex::execute(std::string_view string, size_t offset, bool reverse) {
-	return execute(string, offset, nullptr, reverse);
+bool Regex::execute(RegexMatch *match, std::string_view string, size_t offset, bool reverse) const {
+	return execute(match, string, offset, nullptr, reverse);
 }
 
 /**
  * @brief Execute a `Regex` structure against a string starting at a specific offset,
  *        using a specific set of delimiters.
  *
+ * @param match Receives the captured text if the regex matches.
  * @param string Text to search within
  * @param offset Offset into the string to begin search.
  * @param delimiters Word delimiters to use (nullptr for default).
  * @param reverse If `true`, search backwards through the string.
  * @return `true` if the regex matches, `false` otherwise.
  */
-bool Regex::execute(std::string_view string, size_t offset, const char *delimiters, bool reverse) {
-	return execute(string, offset, string.size(), delimiters, reverse);
+bool Regex::execute(RegexMatch *match, std::string_view string, size_t offset, const char *delimiters, bool reverse) const {
+	return execute(match, string, offset, string.size(), delimiters, reverse);
 }
 
 /**
@@ -151,6 +151,7 @@ bool Regex::execute(std::string_view string, size_t offset, const char *delimite
  *        starting at a specific offset and ending at a specific end_offset,
  *        using a specific set of delimiters.
  *
+ * @param match Receives the captured text if the regex matches.
  * @param string Text to search within
  * @param offset Offset into the string to begin search.
  * @param end_offset Offset into the string to end search.
@@ -158,8 +159,9 @@ bool Regex::execute(std::string_view string, size_t offset, const char *delimite
  * @param reverse If `true`, search backwards through the string.
  * @return `true` if the regex matches, `false` otherwise.
  */
-bool Regex::execute(std::string_view string, size_t offset, size_t end_offset, const char *delimiters, bool reverse) {
+bool Regex::execute(RegexMatch *match, std::string_view string, size_t offset, size_t end_offset, const char *delimiters, bool reverse) const {
 	return execute(
+		match,
 		string,
 		offset,
 		end_offset,
@@ -175,6 +177,7 @@ bool Regex::execute(std::string_view string, size_t offset, size_t end_offset, c
  *    using a specific set of delimiters,
  *    and considering characters immediately before and after the substring.
  *
+ * @param match Receives the captured text if the regex matches.
  * @param string Text to search within
  * @param offset Offset into the string to begin search.
  * @param end_offset Offset into the string to end search.
@@ -184,10 +187,11 @@ bool Regex::execute(std::string_view string, size_t offset, size_t end_offset, c
  * @param reverse If `true`, search backwards through the string.
  * @return `true` if the regex matches, `false` otherwise.
  */
-bool Regex::execute(std::string_view string, size_t offset, size_t end_offset, int prev, int succ, const char *delimiters, bool reverse) {
+bool Regex::execute(RegexMatch *match, std::string_view string, size_t offset, size_t end_offset, int prev, int succ, const char *delimiters, bool reverse) const {
 	assert(offset <= end_offset);
 	assert(end_offset <= string.size());
 	return ExecRE(
+		match,
 		string.data() + offset,
 		string.data() + end_offset,
 		reverse,
@@ -19,6 +19,19 @@ enum RE_DEFAULT_FLAG {
 	/* RE_DEFAULT_MATCH_NEWLINE = 2    Currently not used. */
 };
 
+/* The result of a successful match. Kept apart from the compiled expression
+ * so that one `Regex` can be used by any number of matches (and threads) at
+ * the same time. */
+struct RegexMatch {
+	std::array<const char *, MaxSubExpr> startp = {};      /* Captured text starting locations. */
+	std::array<const char *, MaxSubExpr> endp   = {};      /* Captured text ending locations. */
+	const char *extentpBW                       = nullptr; /* Points to the maximum extent of text scanned by ExecRE in front of the string to achieve a match (needed because of positive look-behind.) */
+	const char *extentpFW                       = nullptr; /* Points to the maximum extent of text scanned by ExecRE to achieve a match (needed because of positive look-ahead.) */
+	size_t top_branch                           = 0;       /* Zero-based index of the top branch that matches. Used by syntax highlighting only. */
+	bool hitStart                               = false;   /* A look-behind wanted to see text before look_behind_to. Set whether or not the search succeeds. */
+	bool hitEnd                                 = false;   /* The search looked at the physical end of the string, so it might have gone differently had the string been longer. Set whether or not the search succeeds. */
+};
+
 class Regex {
 public:
 	Regex(std::string_view exp, int defaultFlags);
@@ -27,26 +40,22 @@ public:
 	~Regex()                        = default;
 
 public:
-	bool ExecRE(const char *start, const char *end, bool reverse, int prev_char, int succ_char, const char *delimiters, const char *look_behind_to, const char *match_to, const char *string_end);
-	bool execute(std::string_view string, bool reverse = false);
-	bool execute(std::string_view string, size_t offset, bool reverse = false);
-	bool execute(std::string_view string, size_t offset, const char *delimiters, bool reverse = false);
-	bool execute(std::string_view string, size_t offset, size_t end_offset, const char *delimiters, bool reverse = false);
-	bool execute(std::string_view string, size_t offset, size_t end_offset, int prev, int succ, const char *delimiters, bool reverse = false);
-	bool SubstituteRE(std::string_view source, std::string &dest) const;
+	bool ExecRE(RegexMatch *match, const char *start, const char *end, bool reverse, int prev_char, int succ_char, const char *delimiters, const char *look_behind_to, const char *match_to, const char *string_end) const;
+	bool execute(RegexMatch *match, std::string_view string, bool reverse = false) const;
+	bool execute(RegexMatch *match, std::string_view string, size_t offset, bool reverse = false) const;
+	bool execute(RegexMatch *match, std::string_view string, size_t offset, const char *delimiters, bool reverse = false) const;
+	bool execute(RegexMatch *match, std::string_view string, size_t offset, size_t end_offset, const char *delimiters, bool reverse = false) const;
+	bool execute(RegexMatch *match, std::string_view string, size_t offset, size_t end_offset, int prev, int succ, const char *delimiters, bool reverse = false) const;
+	bool SubstituteRE(const RegexMatch &match, std::string_view source, std::string &dest) const;
 	bool isValid() const noexcept;
 
 public:
 	static void SetDefaultWordDelimiters(std::string_view delimiters);
 
 public:
-	std::array<const char *, MaxSubExpr> startp = {};      /* Captured text starting locations. */
-	std::array<const char *, MaxSubExpr> endp   = {};      /* Captured text ending locations. */
-	const char *extentpBW                       = nullptr; /* Points to the maximum extent of text scanned by ExecRE in front of the string to achieve a match (needed because of positive look-behind.) */
-	const char *extentpFW                       = nullptr; /* Points to the maximum extent of text scanned by ExecRE to achieve a match (needed because of positive look-ahead.) */
-	size_t top_branch                           = 0;       /* Zero-based index of the top branch that matches. Used by syntax highlighting only. */
-	char match_start                            = '\0';    /* Internal use only. */
-	char anchor                                 = '\0';    /* Internal use only. */
+	// These are only ever written by the constructor
+	char match_start = '\0'; /* Internal use only. */
+	char anchor      = '\0'; /* Internal use only. */
 	std::vector<uint8_t> program;
 
 public:
@@ -0,0 +1,89 @@
+
+#include "RegexCache.h"
+#include "Regex.h"
+
+#include <cassert>
+
+/**
+ * @brief Constructs a cache which holds at most `capacity` compiled expressions.
+ *
+ * @param capacity The maximum number of expressions to keep.
+ */
+RegexCache::RegexCache(size_t capacity)
+	: capacity_(capacity) {
+	assert(capacity_ != 0);
+}
+
+/**
+ * @brief Returns the compiled form of `exp`, compiling it only if it isn't
+ * already in the cache. Expressions which fail to compile are not cached.
+ *
+ * @param exp The regular expression.
+ * @param defaultFlags The flags to compile the expression with.
+ * @return The compiled expression. It remains valid for as long as the caller
+ * holds on to it, even if it is evicted from the cache in the meantime.
+ *
+ * @note Throws RegexError if the expression fails to compile.
+ */
+std::shared_ptr<const Regex> RegexCache::get(std::string_view exp, int defaultFlags) {
+
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	auto it = index_.find(std::make_pair(exp, defaultFlags));
+	if (it != index_.end()) {
+		++statistics_.hits;
+		entries_.splice(entries_.begin(), entries_, it->second);
+		return it->second->regex;
+	}
+
+	++statistics_.misses;
+	auto regex = std::make_shared<Regex>(exp, defaultFlags);
+
+	if (entries_.size() == capacity_) {
+		index_.erase(entries_.back().key);
+		entries_.pop_back();
+		++statistics_.evictions;
+	}
+
+	entries_.push_front(Entry{Key(exp, defaultFlags), regex});
+	index_.emplace(entries_.front().key, entries_.begin());
+	return regex;
+}
+
+/**
+ * @brief Returns the hit, miss and eviction counts for this cache.
+ *
+ * @return The cache statistics.
+ */
+RegexCache::Statistics RegexCache::statistics() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return statistics_;
+}
+
+/**
+ * @brief Returns the number of expressions currently in the cache.
+ *
+ * @return The number of cached expressions.
+ */
+size_t RegexCache::size() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return entries_.size();
+}
+
+/**
+ * @brief Returns the maximum number of expressions the cache will hold.
+ *
+ * @return The capacity of the cache.
+ */
+size_t RegexCache::capacity() const noexcept {
+	return capacity_;
+}
+
+/**
+ * @brief Removes every expression from the cache. The statistics are kept.
+ */
+void RegexCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	index_.clear();
+	entries_.clear();
+}
@@ -0,0 +1,75 @@
+
+#ifndef REGEX_CACHE_H_
+#define REGEX_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+class Regex;
+
+/**
+ * @brief A bounded, least recently used, cache of compiled regular expressions.
+ * Compiling a regex is far more expensive than most of the searches that use
+ * it, and callers such as replace-all tend to compile the same few expressions
+ * over and over again.
+ */
+class RegexCache {
+public:
+	static constexpr size_t DefaultCapacity = 64;
+
+public:
+	struct Statistics {
+		uint64_t hits      = 0;
+		uint64_t misses    = 0;
+		uint64_t evictions = 0;
+	};
+
+public:
+	explicit RegexCache(size_t capacity = DefaultCapacity);
+	RegexCache(const RegexCache &)            = delete;
+	RegexCache &operator=(const RegexCache &) = delete;
+	~RegexCache()                             = default;
+
+public:
+	std::shared_ptr<const Regex> get(std::string_view exp, int defaultFlags);
+	Statistics statistics() const;
+	size_t size() const;
+	size_t capacity() const noexcept;
+	void clear();
+
+private:
+	using Key = std::pair<std::string, int>;
+
+	struct KeyCompare {
+		using is_transparent = void;
+
+		template <class L, class R>
+		bool operator()(const L &lhs, const R &rhs) const noexcept {
+			return std::tie(lhs.second, lhs.first) < std::tie(rhs.second, rhs.first);
+		}
+	};
+
+	struct Entry {
+		Key key;
+		std::shared_ptr<const Regex> regex;
+	};
+
+	using List = std::list<Entry>;
+
+private:
+	mutable std::mutex mutex_;
+	size_t capacity_;
+	List entries_; // most recently used first
+	std::map<Key, List::iterator, KeyCompare> index_;
+	Statistics statistics_;
+};
+
+#endif
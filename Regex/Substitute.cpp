@@ -10,11 +10,12 @@
 /**
  * @brief Perform substitutions after a `Regex` match.
  *
+ * @param match The result of the match to substitute from.
  * @param source The source string to perform substitutions on.
  * @param dest The destination string where substitutions will be written.
  * @return `true` if substitutions were successful, `false` if the regex is invalid or an error occurred.
  */
-bool Regex::SubstituteRE(std::string_view source, std::string &dest) const {
+bool Regex::SubstituteRE(const RegexMatch &match, std::string_view source, std::string &dest) const {
 
 	constexpr auto InvalidParenNumber = static_cast<size_t>(-1);
 
@@ -83,14 +84,14 @@ bool Regex::SubstituteRE(std::string_view source, std::string &dest) const {
 
 		if (paren_no == InvalidParenNumber) { // Ordinary character.
 			*out++ = ch;
-		} else if (re->startp[paren_no] != nullptr && re->endp[paren_no]) {
+		} else if (match.startp[paren_no] != nullptr && match.endp[paren_no]) {
 
 			/* The tokens \u and \l only modify the first character while the
 			 * tokens \U and \L modify the entire string. */
 			switch (changeCase) {
 			case 'u': {
 				int count = 0;
-				std::transform(re->startp[paren_no], re->endp[paren_no], out, [&count](char ch) -> int {
+				std::transform(match.startp[paren_no], match.endp[paren_no], out, [&count](char ch) -> int {
 					if (count++ == 0) {
 						return safe_toupper(ch);
 					}
@@ -99,13 +100,13 @@ bool Regex::SubstituteRE(std::string_view source, std::string &dest) const {
 				});
 			} break;
 			case 'U':
-				std::transform(re->startp[paren_no], re->endp[paren_no], out, [](char ch) {
+				std::transform(match.startp[paren_no], match.endp[paren_no], out, [](char ch) {
 					return safe_toupper(ch);
 				});
 				break;
 			case 'l': {
 				int count = 0;
-				std::transform(re->startp[paren_no], re->endp[paren_no], out, [&count](char ch) -> int {
+				std::transform(match.startp[paren_no], match.endp[paren_no], out, [&count](char ch) -> int {
 					if (count++ == 0) {
 						return safe_tolower(ch);
 					}
@@ -114,12 +115,12 @@ bool Regex::SubstituteRE(std::string_view source, std::string &dest) const {
 				});
 			} break;
 			case 'L':
-				std::transform(re->startp[paren_no], re->endp[paren_no], out, [](char ch) {
+				std::transform(match.startp[paren_no], match.endp[paren_no], out, [](char ch) {
 					return safe_tolower(ch);
 				});
 				break;
 			default:
-				std::copy(re->startp[paren_no], re->endp[paren_no], out);
+				std::copy(match.startp[paren_no], match.endp[paren_no], out);
 				break;
 			}
 		}
@@ -1,8 +1,13 @@
 
 #include "Decompile.h"
 #include "Regex.h"
+#include "RegexCache.h"
 
+#include <atomic>
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace {
 
@@ -12,9 +17,10 @@ struct Test {
 };
 
 int TextRegexMatch(std::string_view regex, std::string_view input) {
-	Regex re(regex, RE_DEFAULT_STANDARD);
+	const Regex re(regex, RE_DEFAULT_STANDARD);
+	RegexMatch match;
 
-	if (re.execute(input)) {
+	if (re.execute(&match, input)) {
 		return 0;
 	}
 
@@ -834,6 +840,91 @@ int main() {
 		return -1;
 	}
 
+	{
+		RegexCache cache(2);
+		RegexMatch match;
+
+		const std::shared_ptr<const Regex> first = cache.get("[0-9]+", RE_DEFAULT_STANDARD);
+		if (cache.get("[0-9]+", RE_DEFAULT_STANDARD) != first || cache.statistics().hits != 1 || cache.statistics().misses != 1) {
+			std::cerr << "ERROR    : Failed to reuse cached regex\n";
+			return -1;
+		}
+
+		if (cache.get("[0-9]+", RE_DEFAULT_CASE_INSENSITIVE) == first) {
+			std::cerr << "ERROR    : Failed to distinguish regex flags in cache\n";
+			return -1;
+		}
+
+		cache.get("[a-z]+", RE_DEFAULT_STANDARD);
+		if (cache.size() != 2 || cache.statistics().evictions != 1 || !first->execute(&match, "abc123")) {
+			std::cerr << "ERROR    : Failed to evict least recently used regex\n";
+			return -1;
+		}
+
+		try {
+			cache.get("(", RE_DEFAULT_STANDARD);
+			std::cerr << "ERROR    : Failed to report invalid regex from cache\n";
+			return -1;
+		} catch (const RegexError &) {
+		}
+	}
+
+	{
+		// searching "abc" + "def" one piece at a time, the way a split text buffer is searched
+		const std::string first  = "abc";
+		const std::string second = "def";
+		const char *firstEnd     = first.data() + first.size();
+		const char *secondEnd    = second.data() + second.size();
+		RegexMatch match;
+
+		const Regex inside("b", RE_DEFAULT_STANDARD);
+		if (!inside.ExecRE(&match, first.data(), firstEnd, false, -1, 'd', nullptr, first.data(), nullptr, firstEnd) || match.hitStart || match.hitEnd) {
+			std::cerr << "ERROR    : Failed to match within the first piece\n";
+			return -1;
+		}
+
+		const Regex across("cd", RE_DEFAULT_STANDARD);
+		if (across.ExecRE(&match, first.data(), firstEnd, false, -1, 'd', nullptr, first.data(), nullptr, firstEnd) || !match.hitEnd) {
+			std::cerr << "ERROR    : Failed to report a match attempt reaching the end of the first piece\n";
+			return -1;
+		}
+
+		const Regex behind("(?<=c)d", RE_DEFAULT_STANDARD);
+		if (behind.ExecRE(&match, second.data(), secondEnd, false, 'c', -1, nullptr, second.data(), nullptr, secondEnd) || !match.hitStart) {
+			std::cerr << "ERROR    : Failed to report a match attempt looking behind the second piece\n";
+			return -1;
+		}
+	}
+
+	{
+		const Regex re(R"(([a-z]+)=(\d+))", RE_DEFAULT_STANDARD);
+		std::atomic<int> failures{0};
+		std::vector<std::thread> threads;
+
+		for (int i = 0; i < 4; ++i) {
+			threads.emplace_back([&re, &failures, i]() {
+				const std::string input = "key" + std::string(static_cast<size_t>(i + 1), 'x') + "=" + std::to_string(i * 1000);
+
+				for (int n = 0; n < 1000; ++n) {
+					RegexMatch match;
+					std::string result;
+					if (!re.execute(&match, input) || !re.SubstituteRE(match, "\\2:\\1", result) || result != std::to_string(i * 1000) + ":" + input.substr(0, input.find('='))) {
+						++failures;
+					}
+				}
+			});
+		}
+
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+
+		if (failures != 0) {
+			std::cerr << "ERROR    : Failed to match the same regex from multiple threads\n";
+			return -1;
+		}
+	}
+
 #if 0 // testing "catastrophic backtracking"
     if (TextRegexMatch(R"((\\?.)*\\\n)", R"(Ada:Default\n\tAwk:Default\n\tC++:Default\n\tC:Default\n\tCSS:Default\n\tCsh:Default\n\tFortran:Default\n\tJava:Default\n\tJavaScript:Default\n\tLaTeX:Default\n\tLex:Default\n\tMakefile:Default\n\tMatlab:Default\n\tNEdit Macro:Default\n\tPascal:Default\n\tPerl:Default\n\tPostScript:Default\n\tPython:Default\n\tRegex:Default\n\tSGML HTML:Default\n\tSQL:Default\n\tSh Ksh Bash:Default\n\tTcl:Default\n\tVHDL:Default\n\tVerilog:Default\n\tXML:Default\n\tX Resources:Default\n\tYacc:Default)") != 0) {
 		std::cerr << "ERROR    : Failed to X resources match\n";
@@ -128,6 +128,7 @@ bool sortTabs;
 bool splitHorizontally;
 bool statisticsLine;
 bool stickyCaseSenseButton;
+bool syncOnSave;
 bool tabBar;
 bool tabBarHideOne;
 bool toolTips;
@@ -380,6 +381,7 @@ void Load(bool isServer) {
 	titleFormat                  = settings.value(QStringLiteral("nedit.titleFormat"), QStringLiteral("{%c} [%s] %f (%S) - %d")).toString();
 	undoModifiesSelection        = settings.value(QStringLiteral("nedit.undoModifiesSelection"), true).toBool();
 	splitHorizontally            = settings.value(QStringLiteral("nedit.splitHorizontally"), false).toBool();
+	syncOnSave                   = settings.value(QStringLiteral("nedit.syncOnSave"), false).toBool();
 	truncateLongNamesInTabs      = settings.value(QStringLiteral("nedit.truncateLongNamesInTabs"), 0).toInt();
 	focusOnRaise                 = settings.value(QStringLiteral("nedit.focusOnRaise"), false).toBool();
 	forceOSConversion            = settings.value(QStringLiteral("nedit.forceOSConversion"), true).toBool();
@@ -482,6 +484,7 @@ void Import(const QString &filename) {
 	titleFormat                  = settings.value(QStringLiteral("nedit.titleFormat"), titleFormat).toString();
 	undoModifiesSelection        = settings.value(QStringLiteral("nedit.undoModifiesSelection"), undoModifiesSelection).toBool();
 	splitHorizontally            = settings.value(QStringLiteral("nedit.splitHorizontally"), splitHorizontally).toBool();
+	syncOnSave                   = settings.value(QStringLiteral("nedit.syncOnSave"), syncOnSave).toBool();
 	truncateLongNamesInTabs      = settings.value(QStringLiteral("nedit.truncateLongNamesInTabs"), truncateLongNamesInTabs).toInt();
 	focusOnRaise                 = settings.value(QStringLiteral("nedit.focusOnRaise"), focusOnRaise).toBool();
 	forceOSConversion            = settings.value(QStringLiteral("nedit.forceOSConversion"), forceOSConversion).toBool();
@@ -569,6 +572,7 @@ bool Save() {
 	settings.setValue(QStringLiteral("nedit.titleFormat"), titleFormat);
 	settings.setValue(QStringLiteral("nedit.undoModifiesSelection"), undoModifiesSelection);
 	settings.setValue(QStringLiteral("nedit.splitHorizontally"), splitHorizontally);
+	settings.setValue(QStringLiteral("nedit.syncOnSave"), syncOnSave);
 	settings.setValue(QStringLiteral("nedit.truncateLongNamesInTabs"), truncateLongNamesInTabs);
 	settings.setValue(QStringLiteral("nedit.focusOnRaise"), focusOnRaise);
 	settings.setValue(QStringLiteral("nedit.forceOSConversion"), forceOSConversion);
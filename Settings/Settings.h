@@ -115,6 +115,7 @@ extern bool stickyCaseSenseButton;
 extern bool typingHidesPointer;
 extern bool undoModifiesSelection;
 extern bool splitHorizontally;
+extern bool syncOnSave;
 extern int truncateLongNamesInTabs;
 extern int autoScrollVPadding;
 extern int maxPrevOpenFiles;
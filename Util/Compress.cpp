@@ -0,0 +1,217 @@
+
+#include "Util/Compress.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/* A small, fast block compressor producing the LZ4 block format: a series of
+ * sequences, each a run of literal bytes followed by a back reference to an
+ * earlier copy of the bytes which come next. It trades compression ratio for
+ * speed, which suits text that is compressed once and rarely read back. */
+
+namespace {
+
+// the shortest back reference worth encoding
+constexpr size_t MinMatch = 4;
+
+// the format requires the last bytes of a block to be literals
+constexpr size_t LastLiterals = 5;
+
+// ... and the last back reference to start at least this far from the end
+constexpr size_t MatchFindLimit = 12;
+
+// back references are 16 bits
+constexpr size_t MaxOffset = 65535;
+
+// the number of bits in the hash of the next 4 bytes, used to find earlier copies of them
+constexpr int HashLog = 14;
+
+constexpr size_t NoPosition = static_cast<size_t>(-1);
+
+uint32_t Read32(const char *ptr) noexcept {
+	uint32_t value;
+	std::memcpy(&value, ptr, sizeof(value));
+	return value;
+}
+
+size_t Hash(uint32_t value) noexcept {
+	return (value * 2654435761u) >> (32 - HashLog);
+}
+
+void WriteLength(std::string &output, size_t length) {
+	while (length >= 255) {
+		output.push_back(static_cast<char>(255));
+		length -= 255;
+	}
+
+	output.push_back(static_cast<char>(length));
+}
+
+bool ReadLength(std::string_view input, size_t &pos, size_t &length) {
+	while (pos < input.size()) {
+		const auto byte = static_cast<uint8_t>(input[pos++]);
+		length += byte;
+		if (byte != 255) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Appends a sequence to `output`. A `matchLength` of 0 marks the last
+ * sequence, which only has literals.
+ */
+void WriteSequence(std::string &output, const char *literals, size_t literalLength, size_t offset, size_t matchLength) {
+
+	const size_t matchCode = (matchLength != 0) ? matchLength - MinMatch : 0;
+
+	output.push_back(static_cast<char>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15)));
+	if (literalLength >= 15) {
+		WriteLength(output, literalLength - 15);
+	}
+
+	output.append(literals, literalLength);
+
+	if (matchLength != 0) {
+		output.push_back(static_cast<char>(offset & 0xff));
+		output.push_back(static_cast<char>(offset >> 8));
+		if (matchCode >= 15) {
+			WriteLength(output, matchCode - 15);
+		}
+	}
+}
+
+}
+
+/**
+ * @brief Compresses `input` as a single block.
+ *
+ * @param input The data to compress.
+ * @return The compressed data, which may be larger than `input` if it doesn't
+ * compress well.
+ */
+std::string CompressBlock(std::string_view input) {
+
+	const char *const base = input.data();
+	const size_t length    = input.size();
+
+	std::string output;
+	output.reserve(length / 2 + 16);
+
+	size_t anchor = 0; // the start of the literals which haven't been written yet
+
+	if (length > MatchFindLimit) {
+		std::vector<size_t> table(size_t(1) << HashLog, NoPosition);
+
+		const size_t matchLimit  = length - LastLiterals;
+		const size_t searchLimit = length - MatchFindLimit;
+
+		size_t pos = 0;
+		while (pos <= searchLimit) {
+			const uint32_t sequence = Read32(base + pos);
+			const size_t hash       = Hash(sequence);
+			const size_t candidate  = table[hash];
+			table[hash]             = pos;
+
+			if (candidate == NoPosition || pos - candidate > MaxOffset || Read32(base + candidate) != sequence) {
+				// skip ahead faster the longer it has been since the last match
+				pos += 1 + ((pos - anchor) >> 6);
+				continue;
+			}
+
+			// extend the match backwards over the pending literals, then forwards
+			size_t start = pos;
+			size_t ref   = candidate;
+			while (start > anchor && ref > 0 && base[start - 1] == base[ref - 1]) {
+				--start;
+				--ref;
+			}
+
+			size_t end    = pos + MinMatch;
+			size_t refEnd = candidate + MinMatch;
+			while (end < matchLimit && base[end] == base[refEnd]) {
+				++end;
+				++refEnd;
+			}
+
+			WriteSequence(output, base + anchor, start - anchor, start - ref, end - start);
+			anchor = end;
+			pos    = end;
+		}
+	}
+
+	WriteSequence(output, base + anchor, length - anchor, 0, 0);
+	return output;
+}
+
+/**
+ * @brief Decompresses a block produced by CompressBlock.
+ *
+ * @param input The compressed data.
+ * @param output Where to put the decompressed data.
+ * @param size The size of the decompressed data.
+ * @return true if `input` was a valid block which decompressed to exactly
+ * `size` bytes, false otherwise.
+ */
+bool DecompressBlock(std::string_view input, char *output, size_t size) {
+
+	size_t in  = 0;
+	size_t out = 0;
+
+	while (in < input.size()) {
+		const auto token = static_cast<uint8_t>(input[in++]);
+
+		size_t literalLength = token >> 4;
+		if (literalLength == 15 && !ReadLength(input, in, literalLength)) {
+			return false;
+		}
+
+		if (literalLength > input.size() - in || literalLength > size - out) {
+			return false;
+		}
+
+		std::memcpy(output + out, input.data() + in, literalLength);
+		in += literalLength;
+		out += literalLength;
+
+		// the last sequence has no back reference
+		if (in == input.size()) {
+			break;
+		}
+
+		if (input.size() - in < 2) {
+			return false;
+		}
+
+		const size_t offset = static_cast<uint8_t>(input[in]) | (static_cast<uint8_t>(input[in + 1]) << 8);
+		in += 2;
+
+		if (offset == 0 || offset > out) {
+			return false;
+		}
+
+		size_t matchLength = token & 0x0f;
+		if (matchLength == 15 && !ReadLength(input, in, matchLength)) {
+			return false;
+		}
+
+		matchLength += MinMatch;
+		if (matchLength > size - out) {
+			return false;
+		}
+
+		// NOTE: the copy may overlap itself, which repeats the bytes, so it is done a byte at a time
+		const char *ref = output + out - offset;
+		for (size_t i = 0; i < matchLength; ++i) {
+			output[out + i] = ref[i];
+		}
+
+		out += matchLength;
+	}
+
+	return out == size;
+}
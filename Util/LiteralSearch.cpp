@@ -0,0 +1,499 @@
+
+#include "Util/LiteralSearch.h"
+#include "Util/Compiler.h"
+#include "Util/utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LITERAL_SEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(LITERAL_SEARCH_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LITERAL_SEARCH_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#if !defined(LITERAL_SEARCH_SSE2)
+// without SIMD, needles at least this long skip through the haystack instead
+// of scanning it. With SIMD, the filtered scan is used for every needle
+constexpr size_t HorspoolThreshold = 4;
+#endif
+
+/**
+ * @brief Returns the index of the lowest set bit of `mask`, which must not be zero.
+ *
+ * @param mask The mask to examine.
+ * @return The index of the lowest set bit.
+ */
+FORCE_INLINE int LowestBit(uint32_t mask) noexcept {
+#if defined(__GNUC__)
+	return __builtin_ctz(mask);
+#else
+	int n = 0;
+	while (!(mask & 1u)) {
+		mask >>= 1;
+		++n;
+	}
+	return n;
+#endif
+}
+
+/**
+ * @brief Returns the index of the highest set bit of `mask`, which must not be zero.
+ *
+ * @param mask The mask to examine.
+ * @return The index of the highest set bit.
+ */
+FORCE_INLINE int HighestBit(uint32_t mask) noexcept {
+#if defined(__GNUC__)
+	return 31 - __builtin_clz(mask);
+#else
+	int n = 31;
+	while (!(mask & 0x80000000u)) {
+		mask <<= 1;
+		--n;
+	}
+	return n;
+#endif
+}
+
+#if defined(LITERAL_SEARCH_AVX2)
+/**
+ * @brief Returns true if the CPU we are running on supports AVX2.
+ *
+ * @return true if AVX2 may be used, false otherwise.
+ */
+bool HasAVX2() noexcept {
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+}
+#endif
+
+#if defined(LITERAL_SEARCH_SSE2)
+/**
+ * @brief Finds the lowest position in [from, to) at which `search` matches,
+ * filtering 16 positions at a time on the first and last characters of the needle.
+ * Every position in [from, to) must leave room for a full needle.
+ *
+ * @param search The search to perform.
+ * @param s The haystack.
+ * @param from The lowest position to consider.
+ * @param to One past the highest position to consider.
+ * @param first The upper and lower case forms of the first character of the needle.
+ * @param last The upper and lower case forms of the last character of the needle.
+ * @return The position of the match, or LiteralSearch::npos.
+ */
+size_t ForwardSSE2(const LiteralSearch &search, const char *s, size_t from, size_t to, const char first[2], const char last[2]) noexcept {
+
+	const size_t m       = search.size();
+	const __m128i firstU = _mm_set1_epi8(first[0]);
+	const __m128i firstL = _mm_set1_epi8(first[1]);
+	const __m128i lastU  = _mm_set1_epi8(last[0]);
+	const __m128i lastL  = _mm_set1_epi8(last[1]);
+
+	size_t i = from;
+	for (; i + 16 <= to; i += 16) {
+		const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+		const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + m - 1));
+		const __m128i eqF  = _mm_or_si128(_mm_cmpeq_epi8(head, firstU), _mm_cmpeq_epi8(head, firstL));
+		const __m128i eqL  = _mm_or_si128(_mm_cmpeq_epi8(tail, lastU), _mm_cmpeq_epi8(tail, lastL));
+
+		auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(eqF, eqL)));
+		while (mask) {
+			const size_t pos = i + static_cast<size_t>(LowestBit(mask));
+			if (search.matchesAt(s + pos)) {
+				return pos;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	for (; i < to; ++i) {
+		if (search.matchesAt(s + i)) {
+			return i;
+		}
+	}
+
+	return LiteralSearch::npos;
+}
+
+/**
+ * @brief Finds the highest position in [from, to) at which `search` matches,
+ * filtering 16 positions at a time on the first and last characters of the needle.
+ * Every position in [from, to) must leave room for a full needle.
+ *
+ * @param search The search to perform.
+ * @param s The haystack.
+ * @param from The lowest position to consider.
+ * @param to One past the highest position to consider.
+ * @param first The upper and lower case forms of the first character of the needle.
+ * @param last The upper and lower case forms of the last character of the needle.
+ * @return The position of the match, or LiteralSearch::npos.
+ */
+size_t BackwardSSE2(const LiteralSearch &search, const char *s, size_t from, size_t to, const char first[2], const char last[2]) noexcept {
+
+	const size_t m       = search.size();
+	const __m128i firstU = _mm_set1_epi8(first[0]);
+	const __m128i firstL = _mm_set1_epi8(first[1]);
+	const __m128i lastU  = _mm_set1_epi8(last[0]);
+	const __m128i lastL  = _mm_set1_epi8(last[1]);
+
+	size_t i = to;
+	for (; i >= from + 16; i -= 16) {
+		const size_t base  = i - 16;
+		const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + base));
+		const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + base + m - 1));
+		const __m128i eqF  = _mm_or_si128(_mm_cmpeq_epi8(head, firstU), _mm_cmpeq_epi8(head, firstL));
+		const __m128i eqL  = _mm_or_si128(_mm_cmpeq_epi8(tail, lastU), _mm_cmpeq_epi8(tail, lastL));
+
+		auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(eqF, eqL)));
+		while (mask) {
+			const int bit    = HighestBit(mask);
+			const size_t pos = base + static_cast<size_t>(bit);
+			if (search.matchesAt(s + pos)) {
+				return pos;
+			}
+			mask &= ~(1u << bit);
+		}
+	}
+
+	while (i > from) {
+		--i;
+		if (search.matchesAt(s + i)) {
+			return i;
+		}
+	}
+
+	return LiteralSearch::npos;
+}
+#endif
+
+#if defined(LITERAL_SEARCH_AVX2)
+/**
+ * @brief The AVX2 version of ForwardSSE2, filtering 32 positions at a time.
+ * Only call this if HasAVX2() returns true.
+ */
+__attribute__((target("avx2"))) size_t ForwardAVX2(const LiteralSearch &search, const char *s, size_t from, size_t to, const char first[2], const char last[2]) noexcept {
+
+	const size_t m       = search.size();
+	const __m256i firstU = _mm256_set1_epi8(first[0]);
+	const __m256i firstL = _mm256_set1_epi8(first[1]);
+	const __m256i lastU  = _mm256_set1_epi8(last[0]);
+	const __m256i lastL  = _mm256_set1_epi8(last[1]);
+
+	size_t i = from;
+	for (; i + 32 <= to; i += 32) {
+		const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+		const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + m - 1));
+		const __m256i eqF  = _mm256_or_si256(_mm256_cmpeq_epi8(head, firstU), _mm256_cmpeq_epi8(head, firstL));
+		const __m256i eqL  = _mm256_or_si256(_mm256_cmpeq_epi8(tail, lastU), _mm256_cmpeq_epi8(tail, lastL));
+
+		auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(eqF, eqL)));
+		while (mask) {
+			const size_t pos = i + static_cast<size_t>(LowestBit(mask));
+			if (search.matchesAt(s + pos)) {
+				return pos;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	return ForwardSSE2(search, s, i, to, first, last);
+}
+
+/**
+ * @brief The AVX2 version of BackwardSSE2, filtering 32 positions at a time.
+ * Only call this if HasAVX2() returns true.
+ */
+__attribute__((target("avx2"))) size_t BackwardAVX2(const LiteralSearch &search, const char *s, size_t from, size_t to, const char first[2], const char last[2]) noexcept {
+
+	const size_t m       = search.size();
+	const __m256i firstU = _mm256_set1_epi8(first[0]);
+	const __m256i firstL = _mm256_set1_epi8(first[1]);
+	const __m256i lastU  = _mm256_set1_epi8(last[0]);
+	const __m256i lastL  = _mm256_set1_epi8(last[1]);
+
+	size_t i = to;
+	for (; i >= from + 32; i -= 32) {
+		const size_t base  = i - 32;
+		const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + base));
+		const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + base + m - 1));
+		const __m256i eqF  = _mm256_or_si256(_mm256_cmpeq_epi8(head, firstU), _mm256_cmpeq_epi8(head, firstL));
+		const __m256i eqL  = _mm256_or_si256(_mm256_cmpeq_epi8(tail, lastU), _mm256_cmpeq_epi8(tail, lastL));
+
+		auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(eqF, eqL)));
+		while (mask) {
+			const int bit    = HighestBit(mask);
+			const size_t pos = base + static_cast<size_t>(bit);
+			if (search.matchesAt(s + pos)) {
+				return pos;
+			}
+			mask &= ~(1u << bit);
+		}
+	}
+
+	return BackwardSSE2(search, s, from, i, first, last);
+}
+#endif
+
+}
+
+/**
+ * @brief Constructor for LiteralSearch.
+ *
+ * @param needle The string to search for, which must not be empty.
+ * @param caseSensitive If false, letters match regardless of their case.
+ */
+LiteralSearch::LiteralSearch(std::string_view needle, bool caseSensitive)
+	: upper_(needle), lower_(needle), caseSensitive_(caseSensitive) {
+
+	if (!caseSensitive_) {
+		std::transform(upper_.begin(), upper_.end(), upper_.begin(), [](char ch) { return static_cast<char>(safe_toupper(ch)); });
+		std::transform(lower_.begin(), lower_.end(), lower_.begin(), [](char ch) { return static_cast<char>(safe_tolower(ch)); });
+	}
+
+#if !defined(LITERAL_SEARCH_SSE2)
+	const size_t m = needle.size();
+	const auto max = static_cast<uint32_t>(std::min<size_t>(m, std::numeric_limits<uint32_t>::max()));
+
+	skipFW_.fill(max);
+	skipBW_.fill(max);
+
+	// a character's shift is the distance to its closest occurrence in the needle
+	for (size_t i = 0; i + 1 < m; ++i) {
+		const auto shift                         = static_cast<uint32_t>(std::min<size_t>(m - 1 - i, max));
+		skipFW_[static_cast<uint8_t>(upper_[i])] = shift;
+		skipFW_[static_cast<uint8_t>(lower_[i])] = shift;
+	}
+
+	for (size_t i = m - 1; i > 0; --i) {
+		const auto shift                         = static_cast<uint32_t>(std::min<size_t>(i, max));
+		skipBW_[static_cast<uint8_t>(upper_[i])] = shift;
+		skipBW_[static_cast<uint8_t>(lower_[i])] = shift;
+	}
+#endif
+}
+
+/**
+ * @brief Returns the length of the needle.
+ *
+ * @return The length of the needle.
+ */
+size_t LiteralSearch::size() const noexcept {
+	return upper_.size();
+}
+
+/**
+ * @brief Returns true if the needle matches the text starting at `ptr`, which
+ * must have room for at least size() characters.
+ *
+ * @param ptr The text to compare against.
+ * @return true if the needle matches, false otherwise.
+ */
+bool LiteralSearch::matchesAt(const char *ptr) const noexcept {
+
+	if (caseSensitive_) {
+		return std::memcmp(ptr, upper_.data(), upper_.size()) == 0;
+	}
+
+	for (size_t i = 0; i < upper_.size(); ++i) {
+		if (ptr[i] != upper_[i] && ptr[i] != lower_[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Finds the first match which starts in [from, to).
+ *
+ * @param haystack The text to search.
+ * @param from The lowest starting position to consider.
+ * @param to One past the highest starting position to consider.
+ * @return The position of the match, or npos if there is none.
+ */
+size_t LiteralSearch::forward(std::string_view haystack, size_t from, size_t to) const noexcept {
+
+	const size_t m = size();
+	if (m == 0 || m > haystack.size()) {
+		return npos;
+	}
+
+	// don't consider any position which doesn't leave room for the whole needle
+	to = std::min(to, haystack.size() - m + 1);
+	if (from >= to) {
+		return npos;
+	}
+
+#if defined(LITERAL_SEARCH_SSE2)
+	const char first[2] = {upper_.front(), lower_.front()};
+	const char last[2]  = {upper_.back(), lower_.back()};
+#if defined(LITERAL_SEARCH_AVX2)
+	if (HasAVX2()) {
+		return ForwardAVX2(*this, haystack.data(), from, to, first, last);
+	}
+#endif
+	return ForwardSSE2(*this, haystack.data(), from, to, first, last);
+#else
+	if (m >= HorspoolThreshold) {
+		return forwardHorspool(haystack.data(), from, to);
+	}
+
+	return forwardScalar(haystack.data(), from, to);
+#endif
+}
+
+/**
+ * @brief Finds the last match which starts in [from, to).
+ *
+ * @param haystack The text to search.
+ * @param from The lowest starting position to consider.
+ * @param to One past the highest starting position to consider.
+ * @return The position of the match, or npos if there is none.
+ */
+size_t LiteralSearch::backward(std::string_view haystack, size_t from, size_t to) const noexcept {
+
+	const size_t m = size();
+	if (m == 0 || m > haystack.size()) {
+		return npos;
+	}
+
+	// don't consider any position which doesn't leave room for the whole needle
+	to = std::min(to, haystack.size() - m + 1);
+	if (from >= to) {
+		return npos;
+	}
+
+#if defined(LITERAL_SEARCH_SSE2)
+	const char first[2] = {upper_.front(), lower_.front()};
+	const char last[2]  = {upper_.back(), lower_.back()};
+#if defined(LITERAL_SEARCH_AVX2)
+	if (HasAVX2()) {
+		return BackwardAVX2(*this, haystack.data(), from, to, first, last);
+	}
+#endif
+	return BackwardSSE2(*this, haystack.data(), from, to, first, last);
+#else
+	if (m >= HorspoolThreshold) {
+		return backwardHorspool(haystack.data(), from, to);
+	}
+
+	return backwardScalar(haystack.data(), from, to);
+#endif
+}
+
+#if !defined(LITERAL_SEARCH_SSE2)
+/**
+ * @brief Boyer-Moore-Horspool search for the first match starting in [from, to).
+ *
+ * @param haystack The text to search.
+ * @param from The lowest starting position to consider.
+ * @param to One past the highest starting position to consider.
+ * @return The position of the match, or npos if there is none.
+ */
+size_t LiteralSearch::forwardHorspool(const char *haystack, size_t from, size_t to) const noexcept {
+
+	const size_t m = size();
+
+	for (size_t i = from; i < to; i += skipFW_[static_cast<uint8_t>(haystack[i + m - 1])]) {
+		if (matchesAt(haystack + i)) {
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+/**
+ * @brief Boyer-Moore-Horspool search for the last match starting in [from, to).
+ *
+ * @param haystack The text to search.
+ * @param from The lowest starting position to consider.
+ * @param to One past the highest starting position to consider.
+ * @return The position of the match, or npos if there is none.
+ */
+size_t LiteralSearch::backwardHorspool(const char *haystack, size_t from, size_t to) const noexcept {
+
+	size_t i = to - 1;
+	while (true) {
+		if (matchesAt(haystack + i)) {
+			return i;
+		}
+
+		const size_t shift = skipBW_[static_cast<uint8_t>(haystack[i])];
+		if (i < from + shift) {
+			return npos;
+		}
+
+		i -= shift;
+	}
+}
+#endif
+
+/**
+ * @brief Portable search for the first match starting in [from, to).
+ *
+ * @param haystack The text to search.
+ * @param from The lowest starting position to consider.
+ * @param to One past the highest starting position to consider.
+ * @return The position of the match, or npos if there is none.
+ */
+size_t LiteralSearch::forwardScalar(const char *haystack, size_t from, size_t to) const noexcept {
+
+	if (caseSensitive_) {
+		// let the C library find candidates, it is usually vectorized
+		const char *p   = haystack + from;
+		const char *end = haystack + to;
+		while ((p = static_cast<const char *>(std::memchr(p, upper_.front(), static_cast<size_t>(end - p)))) != nullptr) {
+			if (matchesAt(p)) {
+				return static_cast<size_t>(p - haystack);
+			}
+
+			if (++p == end) {
+				break;
+			}
+		}
+
+		return npos;
+	}
+
+	const char upper = upper_.front();
+	const char lower = lower_.front();
+
+	for (size_t i = from; i < to; ++i) {
+		if ((haystack[i] == upper || haystack[i] == lower) && matchesAt(haystack + i)) {
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+/**
+ * @brief Portable search for the last match starting in [from, to).
+ *
+ * @param haystack The text to search.
+ * @param from The lowest starting position to consider.
+ * @param to One past the highest starting position to consider.
+ * @return The position of the match, or npos if there is none.
+ */
+size_t LiteralSearch::backwardScalar(const char *haystack, size_t from, size_t to) const noexcept {
+
+	const char upper = upper_.front();
+	const char lower = lower_.front();
+
+	for (size_t i = to; i > from; --i) {
+		if ((haystack[i - 1] == upper || haystack[i - 1] == lower) && matchesAt(haystack + i - 1)) {
+			return i - 1;
+		}
+	}
+
+	return npos;
+}
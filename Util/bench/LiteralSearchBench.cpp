@@ -0,0 +1,167 @@
+
+#include "Util/LiteralSearch.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+
+/**
+ * @brief The literal search that NEdit used before LiteralSearch, kept as the
+ * baseline to compare against. It tries every position, comparing each
+ * character against the upper and lower case forms of the needle.
+ */
+size_t NaiveSearch(std::string_view haystack, const std::string &ucString, const std::string &lcString, size_t from) {
+
+	for (size_t i = from; i < haystack.size(); ++i) {
+		if (haystack[i] == ucString[0] || haystack[i] == lcString[0]) {
+			size_t n = 0;
+			while (i + n < haystack.size() && (haystack[i + n] == ucString[n] || haystack[i + n] == lcString[n])) {
+				if (++n == ucString.size()) {
+					return i;
+				}
+			}
+		}
+	}
+
+	return std::string_view::npos;
+}
+
+/**
+ * @brief Builds a corpus of `size` bytes of word-like text. The words never
+ * contain 'q' or 'z', so needles containing them are only found where they
+ * were planted.
+ */
+std::string MakeCorpus(size_t size) {
+
+	static const char *const words[] = {
+		"the", "of", "and", "to", "in", "is", "that", "for", "it", "as", "was", "with", "be", "by", "on",
+		"not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "had", "they",
+		"you", "were", "their", "one", "all", "we", "can", "her", "has", "there", "been", "if", "more", "when",
+		"will", "would", "who", "so", "no", "buffer", "text", "window", "search", "Replace", "Editor", "macro"};
+
+	std::mt19937 rng(42);
+	std::string corpus;
+	corpus.reserve(size + 16);
+
+	size_t column = 0;
+	while (corpus.size() < size) {
+		const char *word = words[rng() % std::size(words)];
+		corpus += word;
+		column += std::char_traits<char>::length(word);
+		if (column > 72) {
+			corpus += '\n';
+			column = 0;
+		} else {
+			corpus += ' ';
+			++column;
+		}
+	}
+
+	corpus.resize(size);
+
+	// plant a few matches towards the end, so every search has to cover most of the text
+	const char *const planted[] = {"zqz", "Quartz Zebra", "a quiet zone within a long and mostly ordinary sentence"};
+	for (size_t i = 0; i < std::size(planted); ++i) {
+		corpus.replace(size - (i + 1) * size / 64, std::char_traits<char>::length(planted[i]), planted[i]);
+	}
+
+	return corpus;
+}
+
+/**
+ * @brief Times finding every occurrence of `needle` in `corpus`, the way
+ * "Replace All" does, with both implementations.
+ */
+bool Benchmark(std::string_view corpus, const std::string &needle, bool caseSensitive) {
+
+	using Clock = std::chrono::steady_clock;
+
+	std::string ucString = needle;
+	std::string lcString = needle;
+	if (!caseSensitive) {
+		for (size_t i = 0; i < needle.size(); ++i) {
+			ucString[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(needle[i])));
+			lcString[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(needle[i])));
+		}
+	}
+
+	size_t naiveCount       = 0;
+	const auto naiveStart   = Clock::now();
+	for (size_t pos = NaiveSearch(corpus, ucString, lcString, 0); pos != std::string_view::npos; pos = NaiveSearch(corpus, ucString, lcString, pos + 1)) {
+		++naiveCount;
+	}
+	const auto naiveElapsed = std::chrono::duration<double>(Clock::now() - naiveStart).count();
+
+	const LiteralSearch search(needle, caseSensitive);
+	size_t fastCount       = 0;
+	const auto fastStart   = Clock::now();
+	for (size_t pos = search.forward(corpus, 0, corpus.size()); pos != LiteralSearch::npos; pos = search.forward(corpus, pos + 1, corpus.size())) {
+		++fastCount;
+	}
+	const auto fastElapsed = std::chrono::duration<double>(Clock::now() - fastStart).count();
+
+	const double megabytes = static_cast<double>(corpus.size()) / (1024.0 * 1024.0);
+
+	std::printf("%-58s %-11s %8zu %10.0f %10.0f %8.1fx\n",
+				needle.c_str(),
+				caseSensitive ? "sensitive" : "insensitive",
+				fastCount,
+				megabytes / naiveElapsed,
+				megabytes / fastElapsed,
+				naiveElapsed / fastElapsed);
+
+	if (naiveCount != fastCount) {
+		std::fprintf(stderr, "ERROR    : found %zu matches, expected %zu\n", fastCount, naiveCount);
+		return false;
+	}
+
+	return true;
+}
+
+}
+
+/**
+ * @brief Usage: nedit-literal-search-bench [size in MiB | file]
+ */
+int main(int argc, char *argv[]) {
+
+	std::string corpus;
+
+	if (argc > 1 && std::strtoul(argv[1], nullptr, 10) == 0) {
+		std::ifstream file(argv[1], std::ios::binary);
+		if (!file) {
+			std::fprintf(stderr, "ERROR    : could not open %s\n", argv[1]);
+			return -1;
+		}
+		corpus.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	} else {
+		const size_t megabytes = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 256;
+		corpus                 = MakeCorpus(megabytes * 1024 * 1024);
+	}
+
+	std::printf("%-58s %-11s %8s %10s %10s %9s\n", "needle", "case", "matches", "naive MB/s", "new MB/s", "speedup");
+
+	static const char *const needles[] = {
+		"zqz",
+		"Quartz Zebra",
+		"a quiet zone within a long and mostly ordinary sentence",
+		"the",
+		"window search",
+	};
+
+	bool ok = true;
+	for (const char *needle : needles) {
+		ok = Benchmark(corpus, needle, true) && ok;
+		ok = Benchmark(corpus, needle, false) && ok;
+	}
+
+	return ok ? 0 : -1;
+}
@@ -0,0 +1,11 @@
+#ifndef UTIL_COMPRESS_H_
+#define UTIL_COMPRESS_H_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+std::string CompressBlock(std::string_view input);
+bool DecompressBlock(std::string_view input, char *output, size_t size);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef LITERAL_SEARCH_H_
+#define LITERAL_SEARCH_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief A precompiled search for a literal string, optionally ignoring case.
+ *
+ * Where SSE2 or AVX2 is available, needles of every length are found by
+ * filtering candidate positions on their first and last bytes, many positions
+ * at a time; measured on ordinary text, this beats skipping even for long
+ * needles, whose common letters only allow short skips. Without SIMD, long
+ * needles use Boyer-Moore-Horspool skipping and short ones a plain scan.
+ * Both directions only report matches which lie entirely within the haystack.
+ */
+class LiteralSearch {
+public:
+	static constexpr size_t npos = std::string_view::npos;
+
+public:
+	LiteralSearch(std::string_view needle, bool caseSensitive);
+
+public:
+	size_t forward(std::string_view haystack, size_t from, size_t to) const noexcept;
+	size_t backward(std::string_view haystack, size_t from, size_t to) const noexcept;
+	size_t size() const noexcept;
+	bool matchesAt(const char *ptr) const noexcept;
+
+private:
+	size_t forwardHorspool(const char *haystack, size_t from, size_t to) const noexcept;
+	size_t backwardHorspool(const char *haystack, size_t from, size_t to) const noexcept;
+	size_t forwardScalar(const char *haystack, size_t from, size_t to) const noexcept;
+	size_t backwardScalar(const char *haystack, size_t from, size_t to) const noexcept;
+
+private:
+	std::string upper_;                // the needle with every character upper cased (or as-is for case sensitive searches)
+	std::string lower_;                // the needle with every character lower cased (or as-is for case sensitive searches)
+	bool caseSensitive_;               // if false, a character matches if it equals either the upper or lower case form
+	std::array<uint32_t, 256> skipFW_; // Horspool shifts, keyed on the last character of the window (only filled in without SIMD)
+	std::array<uint32_t, 256> skipBW_; // Horspool shifts, keyed on the first character of the window (only filled in without SIMD)
+};
+
+#endif
@@ -0,0 +1,151 @@
+
+#include "Util/Compress.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// the size from which undo records are compressed
+constexpr size_t CompressThreshold = 4096;
+
+std::string RandomBytes(size_t size, uint32_t seed) {
+	std::mt19937 rng(seed);
+	std::string result(size, '\0');
+	for (char &ch : result) {
+		ch = static_cast<char>(rng() & 0xff);
+	}
+	return result;
+}
+
+std::string RepetitiveText(size_t size) {
+	static constexpr std::string_view line = "for (int i = 0; i < count; ++i) {\n\tsum += values[i];\n}\n";
+
+	std::string result;
+	result.reserve(size);
+	while (result.size() < size) {
+		result.append(line.substr(0, std::min(line.size(), size - result.size())));
+	}
+	return result;
+}
+
+bool RoundTrip(std::string_view input) {
+	const std::string compressed = CompressBlock(input);
+
+	std::string output(input.size(), '\0');
+	return DecompressBlock(compressed, &output[0], output.size()) && output == input;
+}
+
+}
+
+int main() {
+
+	const std::string inputs[] = {
+		std::string(),
+		std::string("a"),
+		std::string(12, 'x'),
+		std::string(13, 'x'),
+		RepetitiveText(CompressThreshold - 1),
+		RepetitiveText(CompressThreshold),
+		RepetitiveText(CompressThreshold + 1),
+		RepetitiveText(1048576),
+		std::string(100000, '\0'),
+		RandomBytes(CompressThreshold - 1, 1),
+		RandomBytes(CompressThreshold + 1, 2),
+		RandomBytes(1048576, 3),
+		RepetitiveText(1000) + RandomBytes(70000, 4) + RepetitiveText(1000),
+	};
+
+	for (const std::string &input : inputs) {
+		if (!RoundTrip(input)) {
+			std::cerr << "ERROR    : Failed to round trip " << input.size() << " bytes\n";
+			return -1;
+		}
+	}
+
+	{
+		const std::string input = RepetitiveText(CompressThreshold * 4);
+		if (CompressBlock(input).size() >= input.size() / 4) {
+			std::cerr << "ERROR    : Failed to compress repetitive text\n";
+			return -1;
+		}
+	}
+
+	{
+		// incompressible data may only grow by the size of the sequence headers
+		const std::string input = RandomBytes(CompressThreshold * 4, 5);
+		if (CompressBlock(input).size() > input.size() + input.size() / 255 + 16) {
+			std::cerr << "ERROR    : Incompressible data grew too much\n";
+			return -1;
+		}
+	}
+
+	{
+		const std::string input      = RepetitiveText(CompressThreshold * 2);
+		const std::string compressed = CompressBlock(input);
+		std::string output(input.size(), '\0');
+
+		for (size_t length = 0; length < compressed.size(); ++length) {
+			if (DecompressBlock(std::string_view(compressed).substr(0, length), &output[0], output.size())) {
+				std::cerr << "ERROR    : Accepted a block truncated to " << length << " bytes\n";
+				return -1;
+			}
+		}
+
+		if (DecompressBlock(compressed, &output[0], output.size() - 1)) {
+			std::cerr << "ERROR    : Accepted a block larger than the output\n";
+			return -1;
+		}
+
+		std::string larger(input.size() + 1, '\0');
+		if (DecompressBlock(compressed, &larger[0], larger.size())) {
+			std::cerr << "ERROR    : Accepted a block smaller than the output\n";
+			return -1;
+		}
+	}
+
+	{
+		// a back reference to before the start of the output
+		const std::string corrupt("\x14" "a" "\x05\x00" "\x00", 5);
+		char output[64];
+		if (DecompressBlock(corrupt, output, 6)) {
+			std::cerr << "ERROR    : Accepted a back reference before the start of the output\n";
+			return -1;
+		}
+
+		// a back reference with an offset of zero
+		const std::string zero("\x14" "a" "\x00\x00" "\x00", 5);
+		if (DecompressBlock(zero, output, 6)) {
+			std::cerr << "ERROR    : Accepted a back reference with no offset\n";
+			return -1;
+		}
+
+		// a length which runs off the end of the block
+		const std::string length("\xf0\xff\xff", 3);
+		if (DecompressBlock(length, output, sizeof(output))) {
+			std::cerr << "ERROR    : Accepted a length which runs off the end of the block\n";
+			return -1;
+		}
+	}
+
+	{
+		// corrupting any byte must not overrun the output, and usually gets noticed
+		const std::string input      = RepetitiveText(CompressThreshold * 2);
+		const std::string compressed = CompressBlock(input);
+		std::mt19937 rng(6);
+
+		for (int i = 0; i < 10000; ++i) {
+			std::string corrupt = compressed;
+			corrupt[rng() % corrupt.size()] ^= static_cast<char>(1 + rng() % 255);
+
+			std::string output(input.size(), '\0');
+			DecompressBlock(corrupt, &output[0], output.size());
+		}
+	}
+
+	std::cout << "SUCCESS\n";
+}
@@ -0,0 +1,378 @@
+
+#include "BackgroundHighlighter.h"
+#include "Highlight.h"
+#include "HighlightData.h"
+#include "TextBuffer.h"
+#include "WindowHighlightData.h"
+
+#include <QThreadPool>
+
+#include <gsl/gsl_util>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// how much text the worker parses between checks for cancellation and publishing its results
+constexpr int64_t ChunkSize = 262144;
+
+// how often (msec) the GUI thread copies the worker's results into the style buffer
+constexpr int PollInterval = 20;
+
+// how long (msec) the document must be left alone after an edit before the worker is restarted
+constexpr int RestartDelay = 250;
+
+// how much text ahead of the requested position a provisional parse covers
+constexpr int64_t ProvisionalChunkSize = 16384;
+
+// a provisional parse starts at an exact restart point when there is one within this distance
+constexpr int64_t ProvisionalReach = 65536;
+
+}
+
+/**
+ * @brief Constructor for BackgroundHighlighter. Starts parsing immediately.
+ *
+ * @param highlightData The highlight data which owns this object, and whose style buffer is filled in.
+ * @param buffer The document's text buffer.
+ * @param delimiters The document's word delimiters.
+ * @param start The position to start parsing from. Must be a position where a
+ * parse at the top level of the pattern set gives the correct result, such as
+ * the start of the document, or the frontier of an earlier BackgroundHighlighter.
+ */
+BackgroundHighlighter::BackgroundHighlighter(WindowHighlightData *highlightData, TextBuffer *buffer, QString delimiters, TextCursor start)
+	: highlightData_(highlightData), buffer_(buffer), delimiters_(std::move(delimiters)), applied_(to_integer(start)) {
+
+	restartPoints_.push_back(applied_);
+
+	pollTimer_.setInterval(PollInterval);
+	QObject::connect(&pollTimer_, &QTimer::timeout, [this]() {
+		poll();
+	});
+
+	restartTimer_.setInterval(RestartDelay);
+	restartTimer_.setSingleShot(true);
+	QObject::connect(&restartTimer_, &QTimer::timeout, [this]() {
+		restart();
+	});
+
+	restart();
+}
+
+/**
+ * @brief Destructor for BackgroundHighlighter. Waits for the worker to reach
+ * the end of its current chunk, since it is using the highlight patterns.
+ */
+BackgroundHighlighter::~BackgroundHighlighter() {
+
+	if (run_) {
+		std::unique_lock<std::mutex> lock(run_->mutex);
+		run_->canceled = true;
+		run_->stoppedCondition.wait(lock, [this]() { return !run_->running; });
+	}
+}
+
+/**
+ * @brief Returns true once the whole document has been parsed.
+ *
+ * @return true if the parse is complete, false otherwise.
+ */
+bool BackgroundHighlighter::isFinished() const noexcept {
+	return finished_;
+}
+
+/**
+ * @brief Returns true if the pass 1 styles at `pos` are exact.
+ *
+ * @param pos The position to check.
+ * @return true if the position has been parsed, false otherwise.
+ */
+bool BackgroundHighlighter::isParsed(TextCursor pos) const noexcept {
+	return finished_ || to_integer(pos) < applied_;
+}
+
+/**
+ * @brief Returns the position up to which the style buffer holds exact pass 1
+ * styles. Parsing may be resumed from this position.
+ *
+ * @return The position of the frontier.
+ */
+TextCursor BackgroundHighlighter::frontier() const noexcept {
+	return TextCursor(applied_);
+}
+
+/**
+ * @brief Gives the text at `pos` a provisional pass 1 parse if the worker has
+ * not reached it yet. It starts at the frontier when that is close enough to
+ * be exact, and otherwise at the beginning of a line one context distance
+ * back, which is usually right. The worker's results replace it later.
+ *
+ * @param pos The position which is about to be displayed.
+ */
+void BackgroundHighlighter::parseAhead(TextCursor pos) {
+
+	const int64_t p = to_integer(pos);
+
+	if (isParsed(pos) || (p >= provisionalBegin_ && p < provisionalEnd_)) {
+		return;
+	}
+
+	// carry on from the end of the last provisional parse if possible, which stopped at the top level
+	TextCursor beginParse;
+	if (provisionalEnd_ > provisionalBegin_ && p >= provisionalEnd_ && p - provisionalEnd_ <= ProvisionalReach) {
+		beginParse = TextCursor(provisionalEnd_);
+	} else if (p - applied_ <= ProvisionalReach) {
+		beginParse = TextCursor(applied_);
+	} else {
+		beginParse = std::max(TextCursor(applied_), buffer_->BufStartOfLine(Highlight::BackwardOneContext(buffer_, highlightData_->contextRequirements, pos)));
+	}
+
+	const TextCursor endParse  = std::min(buffer_->BufEndOfBuffer(), pos + ProvisionalChunkSize);
+	const TextCursor endSafety = Highlight::ForwardOneContext(buffer_, highlightData_->contextRequirements, endParse);
+
+	const std::string str = buffer_->BufGetRange(beginParse, endSafety);
+	std::basic_string<uint8_t> styles(str.size(), UNFINISHED_STYLE);
+
+	int prev_char = Highlight::GetPrevChar(buffer_, beginParse);
+	Highlight::ParseContext ctx;
+	ctx.prev_char         = &prev_char;
+	ctx.delimiters        = delimiters_;
+	ctx.text              = str;
+	const char *stringPtr = str.data();
+	uint8_t *stylePtr     = styles.data();
+
+	const HighlightData *patterns = &highlightData_->pass1Patterns[0];
+	Highlight::ParseString(patterns, stringPtr, stylePtr, endParse - beginParse, &ctx, nullptr, nullptr);
+
+	const int64_t length = endParse - beginParse;
+	highlightData_->styleBuffer->BufReplace(beginParse, endParse, UTextBuffer::view_type(styles.data(), static_cast<size_t>(length)));
+
+	// remember where the parse was last at the top level after `pos`, so that it can be continued from there
+	const int64_t offset = p - to_integer(beginParse);
+	int64_t topLevel     = length;
+	while (topLevel > offset + 1 && styles[static_cast<size_t>(topLevel - 1)] != patterns->style) {
+		--topLevel;
+	}
+
+	if (styles[static_cast<size_t>(topLevel - 1)] != patterns->style) {
+		topLevel = length;
+	}
+
+	if (to_integer(beginParse) != provisionalEnd_) {
+		provisionalBegin_ = to_integer(beginParse);
+	}
+
+	provisionalEnd_ = to_integer(beginParse) + topLevel;
+}
+
+/**
+ * @brief Notifies the highlighter that the document's text changed at `pos`.
+ * The worker is stopped, everything from the last chunk boundary which the
+ * edit can't affect onwards is considered unparsed again, and the worker is
+ * restarted from there once the user stops typing. Meanwhile, the edited text
+ * is given a provisional parse.
+ *
+ * @param pos The position of the modification.
+ * @param nInserted The number of characters inserted at `pos`.
+ */
+void BackgroundHighlighter::textModified(TextCursor pos, int64_t nInserted) {
+
+	if (finished_) {
+		return;
+	}
+
+	cancel();
+
+	editBegin_ = std::min<int64_t>(editBegin_, to_integer(pos));
+	editTail_  = std::min<int64_t>(editTail_, buffer_->length() - (to_integer(pos) + nInserted));
+
+	const int64_t safePos = to_integer(Highlight::BackwardOneContext(buffer_, highlightData_->contextRequirements, pos));
+	restartPoints_.erase(std::upper_bound(restartPoints_.begin(), restartPoints_.end(), safePos), restartPoints_.end());
+	if (restartPoints_.empty()) {
+		restartPoints_.push_back(0);
+	}
+
+	applied_          = restartPoints_.back();
+	provisionalBegin_ = 0;
+	provisionalEnd_   = 0;
+
+	if (pos < buffer_->BufEndOfBuffer()) {
+		parseAhead(pos);
+	}
+
+	restartTimer_.start();
+}
+
+/**
+ * @brief Tells the worker to stop, and discards any results it has not
+ * delivered yet.
+ */
+void BackgroundHighlighter::cancel() {
+
+	pollTimer_.stop();
+
+	if (run_) {
+		std::lock_guard<std::mutex> lock(run_->mutex);
+		run_->canceled = true;
+	}
+}
+
+/**
+ * @brief Starts a worker parsing an up to date snapshot of the document from
+ * the frontier. If the previous worker hasn't noticed that it was canceled yet,
+ * this is tried again later instead of waiting for it.
+ */
+void BackgroundHighlighter::restart() {
+
+	if (run_) {
+		std::lock_guard<std::mutex> lock(run_->mutex);
+		if (run_->running) {
+			restartTimer_.start();
+			return;
+		}
+	}
+
+	auto run = std::make_shared<Run>();
+
+	if (run_) {
+		// the old worker is done with its snapshot, so only the edited text has to be copied into it
+		run->text   = std::move(run_->text);
+		run->styles = std::move(run_->styles);
+
+		const auto oldEnd        = static_cast<int64_t>(run->text.size()) - editTail_;
+		const std::string edited = buffer_->BufGetRange(TextCursor(editBegin_), buffer_->BufEndOfBuffer() - editTail_);
+		run->text.replace(static_cast<size_t>(editBegin_), static_cast<size_t>(oldEnd - editBegin_), edited);
+
+		// NOTE: the worker writes the styles from `start` onwards before reading them, so they don't need resetting
+		run->styles.resize(run->text.size(), UNFINISHED_STYLE);
+	} else {
+		run->text   = buffer_->BufGetAll();
+		run->styles = std::basic_string<uint8_t>(run->text.size(), UNFINISHED_STYLE);
+	}
+
+	editBegin_      = static_cast<int64_t>(run->text.size());
+	editTail_       = static_cast<int64_t>(run->text.size());
+	run->delimiters = delimiters_;
+	run->start      = applied_;
+	run->parsed     = applied_;
+	run_            = run;
+
+	// NOTE: the worker only checks that it wasn't canceled before using the patterns
+	QThreadPool::globalInstance()->start([run, patterns = &highlightData_->pass1Patterns[0]]() {
+		parse(run, patterns);
+	});
+
+	pollTimer_.start();
+}
+
+/**
+ * @brief Copies the chunks which the worker has finished into the style buffer.
+ */
+void BackgroundHighlighter::poll() {
+
+	int64_t parsed;
+	bool finished;
+
+	{
+		std::lock_guard<std::mutex> lock(run_->mutex);
+		parsed   = run_->parsed;
+		finished = run_->finished;
+	}
+
+	// NOTE: the worker never writes to styles before `parsed` again, so they can be read without the lock
+	if (parsed > applied_) {
+		auto view = UTextBuffer::view_type(&run_->styles[static_cast<size_t>(applied_)], static_cast<size_t>(parsed - applied_));
+		highlightData_->styleBuffer->BufReplace(TextCursor(applied_), TextCursor(parsed), view);
+		applied_ = parsed;
+		restartPoints_.push_back(parsed);
+	}
+
+	if (finished) {
+		pollTimer_.stop();
+		restartPoints_.clear();
+		run_      = nullptr;
+		finished_ = true;
+	}
+}
+
+/**
+ * @brief The body of the worker. Parses the snapshot with the pass 1 patterns
+ * one chunk at a time, publishing each chunk as it is completed.
+ *
+ * @param run The snapshot to parse, and where to put the results.
+ * @param patterns The pass 1 patterns.
+ */
+void BackgroundHighlighter::parse(const std::shared_ptr<Run> &run, const HighlightData *patterns) {
+
+	{
+		std::lock_guard<std::mutex> lock(run->mutex);
+		if (run->canceled) {
+			return;
+		}
+		run->running = true;
+	}
+
+	auto _ = gsl::finally([&run]() {
+		{
+			std::lock_guard<std::mutex> lock(run->mutex);
+			run->running = false;
+		}
+		run->stoppedCondition.notify_all();
+	});
+
+	const auto length = static_cast<int64_t>(run->text.size());
+	int64_t pos       = run->start;
+	int64_t chunkSize = ChunkSize;
+
+	while (pos < length) {
+
+		{
+			std::lock_guard<std::mutex> lock(run->mutex);
+			if (run->canceled) {
+				return;
+			}
+		}
+
+		const int64_t end = std::min(length, pos + chunkSize);
+
+		// NOTE: the whole snapshot is the context, so matches may look beyond the end of the chunk
+		int prev_char = (pos == 0) ? -1 : run->text[static_cast<size_t>(pos - 1)];
+		Highlight::ParseContext ctx;
+		ctx.prev_char         = &prev_char;
+		ctx.delimiters        = run->delimiters;
+		ctx.text              = run->text;
+		const char *stringPtr = &run->text[static_cast<size_t>(pos)];
+		uint8_t *stylePtr     = &run->styles[static_cast<size_t>(pos)];
+
+		Highlight::ParseString(patterns, stringPtr, stylePtr, end - pos, &ctx, nullptr, nullptr);
+
+		/* A construct which is still open at the end of the chunk may be
+		   parsed differently once more of the text is visible, so the chunk
+		   ends after the last character which was styled at the top level,
+		   and the next one starts there. If there is no such character, the
+		   chunk is parsed again with more text */
+		int64_t next = end;
+		if (end < length) {
+			while (next > pos && run->styles[static_cast<size_t>(next - 1)] != patterns->style) {
+				--next;
+			}
+
+			if (next == pos) {
+				chunkSize *= 2;
+				continue;
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(run->mutex);
+			run->parsed = next;
+		}
+
+		pos       = next;
+		chunkSize = ChunkSize;
+	}
+
+	std::lock_guard<std::mutex> lock(run->mutex);
+	run->finished = true;
+}
@@ -0,0 +1,84 @@
+
+#ifndef BACKGROUND_HIGHLIGHTER_H_
+#define BACKGROUND_HIGHLIGHTER_H_
+
+#include "TextBufferFwd.h"
+#include "TextCursor.h"
+
+#include <QString>
+#include <QTimer>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct HighlightData;
+struct WindowHighlightData;
+
+/**
+ * @brief Performs the initial pass 1 parse of a large document on a worker
+ * thread, so that opening it doesn't freeze the GUI.
+ *
+ * The worker parses a snapshot of the text in chunks. Each chunk ends just
+ * after the last character which was styled at the top level of the pattern
+ * set, which is a point where the parse can be resumed exactly, and the
+ * finished chunks are copied into the style buffer on the GUI thread. Text
+ * which is displayed before the worker reaches it is given a provisional
+ * parse, which the worker's results replace when they arrive. If the document
+ * is edited while the worker is busy, it is restarted from the last chunk
+ * boundary before the edit, with the old snapshot patched up to date.
+ */
+class BackgroundHighlighter {
+public:
+	BackgroundHighlighter(WindowHighlightData *highlightData, TextBuffer *buffer, QString delimiters, TextCursor start);
+	BackgroundHighlighter(const BackgroundHighlighter &)            = delete;
+	BackgroundHighlighter &operator=(const BackgroundHighlighter &) = delete;
+	~BackgroundHighlighter();
+
+public:
+	bool isFinished() const noexcept;
+	bool isParsed(TextCursor pos) const noexcept;
+	TextCursor frontier() const noexcept;
+	void parseAhead(TextCursor pos);
+	void textModified(TextCursor pos, int64_t nInserted);
+
+private:
+	struct Run {
+		std::mutex mutex;
+		std::condition_variable stoppedCondition;
+		std::string text;                  // snapshot of the document's text, only read by the worker
+		std::basic_string<uint8_t> styles; // styles for the snapshot, only written by the worker beyond `parsed`
+		QString delimiters;                // the document's word delimiters at the time of the snapshot
+		int64_t start  = 0;                // where the worker begins parsing
+		int64_t parsed = 0;                // styles before this position are final
+		bool canceled  = false;            // the worker should stop at the next chunk boundary
+		bool running   = false;            // the worker is currently parsing
+		bool finished  = false;            // the worker parsed to the end of the snapshot
+	};
+
+private:
+	static void parse(const std::shared_ptr<Run> &run, const HighlightData *patterns);
+	void cancel();
+	void poll();
+	void restart();
+
+private:
+	WindowHighlightData *highlightData_;
+	TextBuffer *buffer_;
+	QString delimiters_;
+	std::shared_ptr<Run> run_;
+	std::vector<int64_t> restartPoints_; // chunk boundaries applied so far, in increasing order
+	int64_t applied_          = 0;       // styles before this position have been copied into the style buffer
+	int64_t provisionalBegin_ = 0;       // the range most recently given a provisional parse
+	int64_t provisionalEnd_   = 0;
+	int64_t editBegin_        = 0;       // the text before this position is unchanged since the last snapshot
+	int64_t editTail_         = 0;       // this many characters at the end of the text are unchanged since the last snapshot
+	bool finished_            = false;
+	QTimer pollTimer_;
+	QTimer restartTimer_;
+};
+
+#endif
@@ -0,0 +1,216 @@
+
+#include "BatchReplace.h"
+#include "DocumentWidget.h"
+#include "Search.h"
+#include "TextArea.h"
+#include "TextBuffer.h"
+#include "WindowMenuEvent.h"
+
+#include <QCoreApplication>
+#include <QProgressDialog>
+#include <QThread>
+
+#include <chrono>
+#include <utility>
+
+namespace {
+
+// how long the GUI thread waits for a worker before servicing events again
+constexpr std::chrono::milliseconds PollInterval(50);
+
+// batches which finish faster than this never show the progress dialog
+constexpr int ProgressDelay = 500;
+
+}
+
+/**
+ * @brief Constructor for BatchReplace.
+ *
+ * @param searchString The string to search for.
+ * @param replaceString The string to replace each match with.
+ * @param searchType The type of search to perform.
+ */
+BatchReplace::BatchReplace(QString searchString, QString replaceString, SearchType searchType)
+	: searchString_(std::move(searchString)), replaceString_(std::move(replaceString)), searchType_(searchType) {
+	pool_.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+/**
+ * @brief Destructor for BatchReplace.
+ */
+BatchReplace::~BatchReplace() {
+
+	canceled_ = true;
+	pool_.waitForDone();
+
+	for (const std::unique_ptr<Task> &task : tasks_) {
+		if (task->document) {
+			task->document->buffer()->BufRemoveModifyCB(modifiedCallback, task.get());
+		}
+	}
+}
+
+/**
+ * @brief Adds a document to the batch, taking a snapshot of its current text.
+ *
+ * @param document The document to perform the replacement in.
+ */
+void BatchReplace::addDocument(DocumentWidget *document) {
+
+	auto task        = std::make_unique<Task>();
+	task->document   = document;
+	task->text       = document->buffer()->BufGetAll();
+	task->delimiters = document->getWindowDelimiters();
+
+	// if the document changes before the results are in, they are stale
+	document->buffer()->BufAddModifyCB(modifiedCallback, task.get());
+
+	tasks_.push_back(std::move(task));
+}
+
+/**
+ * @brief Returns true if no documents have been added to the batch.
+ *
+ * @return true if the batch is empty, false otherwise.
+ */
+bool BatchReplace::empty() const noexcept {
+	return tasks_.empty();
+}
+
+/**
+ * @brief Returns true if the user canceled the batch while it was running.
+ *
+ * @return true if the batch was canceled, false otherwise.
+ */
+bool BatchReplace::wasCanceled() const noexcept {
+	return canceled_;
+}
+
+/**
+ * @brief Performs the replacement in every document of the batch. Documents
+ * are applied as their workers finish, and a progress dialog which allows the
+ * user to cancel the remaining documents is shown if it takes a while.
+ *
+ * @param parent The parent widget for the progress dialog.
+ * @return The number of documents in which a replacement was made.
+ */
+size_t BatchReplace::run(QWidget *parent) {
+
+	const int count = static_cast<int>(tasks_.size());
+
+	QProgressDialog progress(QObject::tr("Replacing in %n file(s)...", nullptr, count), QObject::tr("Cancel"), 0, count, parent);
+	progress.setWindowTitle(QObject::tr("Multi-File Replacement"));
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setMinimumDuration(ProgressDelay);
+
+	for (const std::unique_ptr<Task> &task : tasks_) {
+		// NOTE: each worker gets its own copy of the strings
+		pool_.start([this, task = task.get(), searchString = searchString_, replaceString = replaceString_, searchType = searchType_]() {
+			if (!canceled_) {
+				task->replacement = Search::ReplaceAllInString(
+					task->text,
+					searchString,
+					replaceString,
+					searchType,
+					&task->copyStart,
+					&task->copyEnd,
+					task->delimiters);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				finished_.push_back(task);
+			}
+
+			finishedCondition_.notify_one();
+		});
+	}
+
+	size_t replaced = 0;
+	int done        = 0;
+
+	while (done < count) {
+		std::vector<Task *> finished;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			finishedCondition_.wait_for(lock, PollInterval, [this]() { return !finished_.empty(); });
+			finished.swap(finished_);
+		}
+
+		for (Task *task : finished) {
+			if (!canceled_ && apply(task)) {
+				++replaced;
+			}
+
+			// the snapshot is no longer needed, so don't hold on to it
+			task->text        = std::string();
+			task->replacement = std::nullopt;
+			++done;
+		}
+
+		progress.setValue(done);
+		QCoreApplication::processEvents();
+
+		if (progress.wasCanceled()) {
+			canceled_ = true;
+		}
+	}
+
+	return replaced;
+}
+
+/**
+ * @brief Applies the result of a finished task to its document.
+ *
+ * @param task The finished task.
+ * @return true if a replacement was made, false otherwise.
+ */
+bool BatchReplace::apply(Task *task) const {
+
+	DocumentWidget *document = task->document;
+
+	// the document was closed, or edited, while the worker was busy
+	if (!document || task->modified) {
+		return false;
+	}
+
+	EmitEvent("replace_all", searchString_, replaceString_, ToString(searchType_));
+
+	if (!task->replacement) {
+		return false;
+	}
+
+	const auto insertLength = static_cast<int64_t>(task->replacement->size());
+
+	// replace the contents of the text widget with the substituted text
+	document->buffer()->BufReplace(TextCursor(task->copyStart), TextCursor(task->copyEnd), *task->replacement);
+
+	// Move the cursor to the end of the last replacement
+	if (TextArea *area = document->firstPane()) {
+		area->TextSetCursorPos(TextCursor(task->copyStart + insertLength));
+	}
+
+	return true;
+}
+
+/**
+ * @brief Marks a task as stale when its document's text changes.
+ *
+ * @param pos The position of the modification.
+ * @param nInserted The number of characters inserted.
+ * @param nDeleted The number of characters deleted.
+ * @param nRestyled The number of characters restyled.
+ * @param deletedText The text that was deleted.
+ * @param user The task that the callback was registered for.
+ */
+void BatchReplace::modifiedCallback(TextCursor pos, int64_t nInserted, int64_t nDeleted, int64_t nRestyled, std::string_view deletedText, void *user) {
+
+	Q_UNUSED(pos)
+	Q_UNUSED(nRestyled)
+	Q_UNUSED(deletedText)
+
+	if (nInserted != 0 || nDeleted != 0) {
+		static_cast<Task *>(user)->modified = true;
+	}
+}
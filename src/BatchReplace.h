@@ -0,0 +1,75 @@
+
+#ifndef BATCH_REPLACE_H_
+#define BATCH_REPLACE_H_
+
+#include "SearchType.h"
+#include "TextCursor.h"
+
+#include <QPointer>
+#include <QString>
+#include <QThreadPool>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class DocumentWidget;
+class QWidget;
+
+/**
+ * @brief Performs a "Replace All" across several documents at once.
+ *
+ * The text of each document is copied on the GUI thread, searched and
+ * substituted on a pool of worker threads, and then applied back on the GUI
+ * thread as a single BufReplace, and so a single undo step, per document.
+ */
+class BatchReplace {
+public:
+	BatchReplace(QString searchString, QString replaceString, SearchType searchType);
+	BatchReplace(const BatchReplace &)            = delete;
+	BatchReplace &operator=(const BatchReplace &) = delete;
+	~BatchReplace();
+
+public:
+	void addDocument(DocumentWidget *document);
+	size_t run(QWidget *parent);
+	bool empty() const noexcept;
+	bool wasCanceled() const noexcept;
+
+private:
+	struct Task {
+		QPointer<DocumentWidget> document;
+		std::string text;                       // snapshot of the document's text, only read by the worker
+		QString delimiters;                     // the document's word delimiters at the time of the snapshot
+		std::optional<std::string> replacement; // filled in by the worker
+		int64_t copyStart = 0;                  // filled in by the worker
+		int64_t copyEnd   = 0;                  // filled in by the worker
+		bool modified     = false;              // the document was edited after the snapshot was taken
+	};
+
+private:
+	static void modifiedCallback(TextCursor pos, int64_t nInserted, int64_t nDeleted, int64_t nRestyled, std::string_view deletedText, void *user);
+	bool apply(Task *task) const;
+
+private:
+	QString searchString_;
+	QString replaceString_;
+	SearchType searchType_;
+	std::vector<std::unique_ptr<Task>> tasks_;
+	std::atomic<bool> canceled_{false};
+	std::mutex mutex_;
+	std::condition_variable finishedCondition_;
+	std::vector<Task *> finished_; // tasks completed by the workers, but not yet applied
+
+	// the pool's destructor waits for running tasks, which lock mutex_ and
+	// append to finished_, so it is declared after them
+	QThreadPool pool_;
+};
+
+#endif
@@ -1,11 +1,13 @@
 
 #include "DialogMultiReplace.h"
+#include "BatchReplace.h"
 #include "DialogReplace.h"
 #include "DocumentModel.h"
 #include "DocumentWidget.h"
-#include "MainWindow.h"
 #include "Preferences.h"
+#include "Search.h"
 
+#include <QApplication>
 #include <QMessageBox>
 
 /**
@@ -97,10 +99,9 @@ void DialogMultiReplace::buttonReplace_clicked() {
 	// Set the initial focus of the dialog back to the search string
 	replace_->ui.textFind->setFocus();
 
-	bool replaceFailed  = true;
-	bool noWritableLeft = true;
+	BatchReplace batch(fields->searchString, fields->replaceString, fields->searchType);
 
-	// Perform the replacements and mark the selected files (history)
+	// Collect the selected files, taking a snapshot of each one's text
 	for (const QModelIndex index : selections) {
 		if (DocumentWidget *writeableDocument = model_->itemFromIndex(index)) {
 
@@ -108,26 +109,20 @@ void DialogMultiReplace::buttonReplace_clicked() {
 			 * file status has changed or the file was locked in the mean time,
 			 * we just skip the window. */
 			if (!writeableDocument->lockReasons().isAnyLocked()) {
-				noWritableLeft                    = false;
-				writeableDocument->multiFileBusy_ = true; // Avoid multi-beep/dialog
-				writeableDocument->replaceFailed_ = false;
-
-				if (MainWindow *win = MainWindow::fromDocument(writeableDocument)) {
-					win->action_Replace_All(
-						writeableDocument,
-						fields->searchString,
-						fields->replaceString,
-						fields->searchType);
-				}
-
-				writeableDocument->multiFileBusy_ = false;
-				if (!writeableDocument->replaceFailed_) {
-					replaceFailed = false;
-				}
+				batch.addDocument(writeableDocument);
 			}
 		}
 	}
 
+	const bool noWritableLeft = batch.empty();
+	bool replaceFailed        = true;
+
+	// Perform the replacements (in parallel) and mark the selected files (history)
+	if (!noWritableLeft && !fields->searchString.isEmpty()) {
+		Search::SaveSearchHistory(fields->searchString, fields->replaceString, fields->searchType, /*isIncremental=*/false);
+		replaceFailed = (batch.run(this) == 0);
+	}
+
 	if (!replace_->keepDialog()) {
 		replace_->hide();
 	}
@@ -136,7 +131,7 @@ void DialogMultiReplace::buttonReplace_clicked() {
 
 	/* We suppressed multiple beeps/dialogs. If there wasn't any file in
 	   which the replacement succeeded, we should still warn the user */
-	if (replaceFailed) {
+	if (replaceFailed && !batch.wasCanceled()) {
 		if (Preferences::GetPrefSearchDialogs()) {
 			if (noWritableLeft) {
 				QMessageBox::information(this, tr("Read-only Files"), tr("All selected files have become read-only."));
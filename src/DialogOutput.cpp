@@ -21,3 +21,13 @@ DialogOutput::DialogOutput(QWidget *parent, Qt::WindowFlags f)
 void DialogOutput::setText(const QString &text) {
 	ui.plainTextEdit->setPlainText(text);
 }
+
+/**
+ * @brief Adds text to the end of the dialog's plain text edit area.
+ *
+ * @param text The text to be added.
+ */
+void DialogOutput::appendText(const QString &text) {
+	ui.plainTextEdit->moveCursor(QTextCursor::End);
+	ui.plainTextEdit->insertPlainText(text);
+}
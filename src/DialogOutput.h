@@ -14,6 +14,7 @@ public:
 
 public:
 	void setText(const QString &text);
+	void appendText(const QString &text);
 
 private:
 	Ui::DialogOutput ui;
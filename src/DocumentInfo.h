@@ -38,6 +38,13 @@ struct DocumentInfo {
 	std::shared_ptr<TextBuffer> buffer;                            // holds the text being edited
 	int autoSaveCharCount               = 0;                       // count of single characters typed since last backup file generated
 	int autoSaveOpCount                 = 0;                       // count of editing operations
+	size_t undoMemoryUsed               = 0;                       // bytes of memory used by the undo list
+	size_t undoDiskUsed                 = 0;                       // bytes of temporary files used by the undo list
+	size_t redoDiskUsed                 = 0;                       // bytes of temporary files used by the redo list
+	uint64_t undoSequence               = 0;                       // sequence number of the most recently created undo or redo record
+	uint64_t savedSequence              = 0;                       // sequence number of the record which restores the file to its unmodified state, 0 if none
+	uint64_t extendSequence             = 0;                       // sequence number of a record which insertions at its end are added to, 0 if none
+	bool extendingUndo                  = false;                   // the modification being made is shell command output, which may be added to the record named by extendSequence
 	bool filenameSet                    = false;                   // is the window still "Untitled"?
 	bool fileChanged                    = false;                   // has window been modified?
 	bool autoSave                       = false;                   // is autosave turned on?
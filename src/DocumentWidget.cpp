@@ -8,6 +8,7 @@
 #include "DialogReplace.h"
 #include "DragEndEvent.h"
 #include "EditFlags.h"
+#include "FileWatcher.h"
 #include "Font.h"
 #include "Highlight.h"
 #include "HighlightData.h"
@@ -42,7 +43,9 @@
 
 #include <QButtonGroup>
 #include <QClipboard>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QRadioButton>
@@ -53,6 +56,17 @@
 #include <qplatformdefs.h>
 
 #include <chrono>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#include <sys/xattr.h>
+#endif
 
 #if defined(Q_OS_WIN)
 #define FDOPEN _fdopen
@@ -71,15 +85,28 @@
  * controlling and communicating with the process */
 struct ShellCommandData {
 	QTimer bannerTimer;
+	QTimer flushTimer;
 	QByteArray standardError;
+	QByteArray standardInput; // input which doesn't come from a buffer
 	QByteArray standardOutput;
 	QProcess *process;
 	TextArea *area;
+	QPointer<DialogOutput> dialog;           // where output which isn't accumulated is shown, if it goes to a dialog
+	std::shared_ptr<TextBuffer> inputBuffer;  // where input comes from, while there is more of it to write
+	std::shared_ptr<TextBuffer> outputBuffer; // where output which isn't accumulated is inserted, while the command runs
+	TextCursor inputPos;                      // the next character of inputBuffer to write
+	TextCursor inputEnd;
 	TextCursor leftPos;
 	TextCursor rightPos;
 	CommandSource source;
+	int64_t inputOffset; // the next byte of standardInput to write
 	int flags;
+	int dialogLength; // characters shown in the dialog so far
+	int heldNewlines; // trailing newlines not yet shown in the dialog
 	bool bannerIsUp;
+	bool inputClosed;     // all of the input has been written
+	bool outputShown;     // some output which isn't accumulated has been shown
+	bool insertingOutput; // output is being inserted, which moves leftPos and rightPos itself
 };
 
 DocumentWidget *DocumentWidget::LastCreated = nullptr;
@@ -92,8 +119,30 @@ constexpr int MaxPanes = 6;
 // how long to wait (msec) before putting up Shell Command Executing... banner
 constexpr int BannerWaitTime = 6000;
 
+// how long to collect (msec) shell command output which isn't accumulated before showing it
+constexpr int OutputFlushInterval = 100;
+
+// longest incomplete line of shell command output to hold back until the rest of it arrives
+constexpr int MaxHeldOutput = 65536;
+
+// most characters of shell command output to show in a dialog
+constexpr int MaxMessageLength = 4096;
+
+// size of the pieces in which input is written to a shell command, which is
+// given another piece whenever less than this is waiting to be written
+constexpr int64_t InputChunkSize = 65536;
+
 constexpr int FlashInterval = 1500;
 
+// Size of the blocks in which documents are written when their line endings need converting
+constexpr size_t SaveBlockSize = 65536;
+
+// Saves which take longer than this many milliseconds report their throughput
+constexpr qint64 SlowSaveThreshold = 250;
+
+// Documents at least this large are syntax highlighted in the background
+constexpr int64_t BackgroundHighlightThreshold = 1048576;
+
 enum : uint8_t {
 	ACCUMULATE        = 1,
 	ERROR_DIALOGS     = 2,
@@ -268,6 +317,78 @@ void MaintainPosition(TextCursor &position, TextCursor modPos, int64_t nInserted
 	}
 }
 
+/**
+ * @brief Keeps the part of a buffer which is still to be written to a shell
+ * command in place while the buffer is modified.
+ *
+ * @param pos The position in the text buffer where the modification occurred.
+ * @param nInserted The number of characters inserted.
+ * @param nDeleted The number of characters deleted.
+ * @param nRestyled The number of characters restyled.
+ * @param deletedText The text that was deleted during the modification.
+ * @param user The ShellCommandData of the command.
+ */
+void ShellInputModifiedCallback(TextCursor pos, int64_t nInserted, int64_t nDeleted, int64_t nRestyled, std::string_view deletedText, void *user) {
+
+	Q_UNUSED(nRestyled)
+	Q_UNUSED(deletedText)
+
+	auto cmdData = static_cast<ShellCommandData *>(user);
+	MaintainPosition(cmdData->inputPos, pos, nInserted, nDeleted);
+	MaintainPosition(cmdData->inputEnd, pos, nInserted, nDeleted);
+}
+
+/**
+ * @brief Keeps the place where the output of a shell command is inserted, as
+ * it arrives, in place while the buffer is modified by something else.
+ *
+ * @param pos The position in the text buffer where the modification occurred.
+ * @param nInserted The number of characters inserted.
+ * @param nDeleted The number of characters deleted.
+ * @param nRestyled The number of characters restyled.
+ * @param deletedText The text that was deleted during the modification.
+ * @param user The ShellCommandData of the command.
+ */
+void ShellOutputModifiedCallback(TextCursor pos, int64_t nInserted, int64_t nDeleted, int64_t nRestyled, std::string_view deletedText, void *user) {
+
+	Q_UNUSED(nRestyled)
+	Q_UNUSED(deletedText)
+
+	auto cmdData = static_cast<ShellCommandData *>(user);
+	if (cmdData->insertingOutput) {
+		return;
+	}
+
+	MaintainPosition(cmdData->leftPos, pos, nInserted, nDeleted);
+	MaintainPosition(cmdData->rightPos, pos, nInserted, nDeleted);
+}
+
+/**
+ * @brief Get the primary selection of a buffer as shell command input.
+ *
+ * @param buffer The buffer.
+ * @param range Receives the range of the selection, if the command can read it
+ * straight from the buffer.
+ * @param text Receives a copy of the text of the selection otherwise, as for a
+ * rectangular selection.
+ * @return `true` if there is a selection, `false` otherwise.
+ */
+bool GetSelectionInput(const TextBuffer *buffer, TextRange *range, QString *text) {
+
+	if (!buffer->primary.hasSelection()) {
+		return false;
+	}
+
+	if (buffer->primary.isRectangular()) {
+		*text = QString::fromStdString(buffer->BufGetSelectionText());
+		return !text->isEmpty();
+	}
+
+	range->start = buffer->primary.start();
+	range->end   = buffer->primary.end();
+	return range->start != range->end;
+}
+
 /**
  * @brief Maintain the selection across buffer modifications.
  *
@@ -398,6 +519,334 @@ QString EscapeCommand(const QString &command, const QString &fullName, int64_t l
 	return ret;
 }
 
+/**
+ * @brief Maps the contents of a file into memory and passes them to `func`
+ * without making an intermediate copy. The mapping is private (copy-on-write),
+ * so line ending conversion happens in place, in one streaming pass, and only
+ * ever dirties our own copy of the pages that it actually changes. The file
+ * itself is never modified.
+ *
+ * @param file The file to read, which must already be open for reading.
+ * @param format If not null, receives the detected format of the file, and DOS
+ * and Macintosh line endings are converted to Unix line endings.
+ * @param func Called with the (possibly converted) contents of the file. The
+ * contents are only valid for the duration of the call.
+ * @return `true` on success, `false` if the file could not be mapped.
+ */
+template <class Func>
+bool MapFileContents(QFile &file, FileFormats *format, Func &&func) {
+
+	const qint64 size = file.size();
+	if (size == 0) {
+		if (format) {
+			*format = FileFormats::Unix;
+		}
+
+		func(std::string_view());
+		return true;
+	}
+
+	uchar *memory = file.map(0, size, QFileDevice::MapPrivateOption);
+	if (!memory) {
+		return false;
+	}
+
+	auto _ = gsl::finally([&file, memory] { file.unmap(memory); });
+
+#ifdef Q_OS_UNIX
+	// we touch each page exactly once, front to back
+	::posix_madvise(memory, static_cast<size_t>(size), POSIX_MADV_SEQUENTIAL);
+#endif
+
+	auto text     = reinterpret_cast<char *>(memory);
+	qint64 length = size;
+
+	if (format) {
+		*format = FormatOfFile(std::string_view(text, static_cast<size_t>(length)));
+		switch (*format) {
+		case FileFormats::Dos:
+			ConvertFromDos(text, &length, nullptr);
+			break;
+		case FileFormats::Mac:
+			ConvertFromMac(text, length);
+			break;
+		case FileFormats::Unix:
+			break;
+		}
+	}
+
+	func(std::string_view(text, static_cast<size_t>(length)));
+	return true;
+}
+
+/**
+ * @brief Streams the contents of a text buffer to `device`, converting line
+ * endings to `format` on the fly. The text is written straight from the
+ * buffer's storage, staged through a small block only when it needs
+ * converting, so no copy of the whole document is ever made.
+ *
+ * @param buffer The buffer to write.
+ * @param device The device to write to.
+ * @param format The line ending format to write.
+ * @return The number of bytes written, or -1 if writing failed.
+ */
+qint64 WriteBufferContents(const TextBuffer *buffer, QIODevice *device, FileFormats format) {
+
+	std::string block;
+	block.reserve(SaveBlockSize + 2);
+
+	qint64 written = 0;
+	bool ok        = true;
+
+	auto write = [device, &written, &ok](std::string_view data) {
+		if (device->write(data.data(), ssize(data)) != ssize(data)) {
+			ok = false;
+		} else {
+			written += ssize(data);
+		}
+
+		return ok;
+	};
+
+	buffer->BufForEachSegment(buffer->BufStartOfBuffer(), buffer->BufEndOfBuffer(), [&](std::string_view piece) {
+		switch (format) {
+		case FileFormats::Unix:
+			return write(piece);
+		case FileFormats::Mac:
+			while (!piece.empty()) {
+				const size_t n     = std::min(piece.size(), SaveBlockSize - block.size());
+				const size_t first = block.size();
+				block.append(piece.data(), n);
+				std::replace(block.begin() + static_cast<ptrdiff_t>(first), block.end(), '\n', '\r');
+				piece.remove_prefix(n);
+
+				if (block.size() >= SaveBlockSize) {
+					if (!write(block)) {
+						return false;
+					}
+					block.clear();
+				}
+			}
+			return true;
+		case FileFormats::Dos:
+			while (!piece.empty()) {
+				const size_t eol = piece.find('\n');
+				const size_t n   = std::min(eol == std::string_view::npos ? piece.size() : eol, SaveBlockSize - block.size());
+				block.append(piece.data(), n);
+				piece.remove_prefix(n);
+
+				if (!piece.empty() && piece.front() == '\n') {
+					block.append("\r\n");
+					piece.remove_prefix(1);
+				}
+
+				if (block.size() >= SaveBlockSize) {
+					if (!write(block)) {
+						return false;
+					}
+					block.clear();
+				}
+			}
+			return true;
+		}
+
+		return true;
+	});
+
+	if (ok && !block.empty()) {
+		write(block);
+	}
+
+	return ok ? written : -1;
+}
+
+/**
+ * @brief Forces the data written to `file` out to the underlying storage.
+ *
+ * @param file The file to synchronize.
+ * @return `true` on success, `false` otherwise.
+ */
+bool SyncToDisk(QFileDevice *file) {
+
+	if (!file->flush()) {
+		return false;
+	}
+
+#if defined(Q_OS_MACOS)
+	return ::fsync(file->handle()) == 0;
+#elif defined(Q_OS_UNIX)
+	return ::fdatasync(file->handle()) == 0;
+#else
+	return true;
+#endif
+}
+
+/**
+ * @brief Forces the directory entry of a file out to the underlying storage,
+ * so that a rename which replaced the file survives a crash.
+ *
+ * @param filename The file whose directory to synchronize.
+ * @return `true` on success, `false` otherwise.
+ */
+bool SyncDirectory(const QString &filename) {
+#if defined(Q_OS_UNIX)
+	const QByteArray directory = QFileInfo(filename).absolutePath().toUtf8();
+
+	const int fd = QT_OPEN(directory.data(), O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	const bool synced = (::fsync(fd) == 0);
+	QT_CLOSE(fd);
+	return synced;
+#else
+	Q_UNUSED(filename)
+	return true;
+#endif
+}
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+// the extended attribute calls differ between Linux and macOS, these don't follow symbolic links on either
+ssize_t ListAttributes(const char *path, char *names, size_t size) {
+#if defined(Q_OS_LINUX)
+	return ::llistxattr(path, names, size);
+#else
+	return ::listxattr(path, names, size, XATTR_NOFOLLOW);
+#endif
+}
+
+ssize_t GetAttribute(const char *path, const char *name, char *value, size_t size) {
+#if defined(Q_OS_LINUX)
+	return ::lgetxattr(path, name, value, size);
+#else
+	return ::getxattr(path, name, value, size, 0, XATTR_NOFOLLOW);
+#endif
+}
+
+int SetAttribute(int fd, const char *name, const char *value, size_t size) {
+#if defined(Q_OS_LINUX)
+	return ::fsetxattr(fd, name, value, size, 0);
+#else
+	return ::fsetxattr(fd, name, value, size, 0, 0);
+#endif
+}
+#endif
+
+/**
+ * @brief Copies the extended attributes of a file, which include its access
+ * control list on most systems, to the file which is going to replace it.
+ *
+ * @param filename The file which is going to be replaced.
+ * @param fd The replacement file.
+ * @return `true` if the attributes were copied, or the file system doesn't
+ * support them, `false` otherwise.
+ */
+bool CopyExtendedAttributes(const QString &filename, int fd) {
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+	const QByteArray path = filename.toUtf8();
+
+	const ssize_t size = ListAttributes(path.data(), nullptr, 0);
+	if (size <= 0) {
+		return size == 0 || errno == ENOTSUP;
+	}
+
+	// if the list grows in the meantime, this fails and the file is overwritten in place
+	std::vector<char> names(static_cast<size_t>(size));
+	const ssize_t namesSize = ListAttributes(path.data(), names.data(), names.size());
+	if (namesSize == -1) {
+		return false;
+	}
+
+	for (const char *name = names.data(); name < names.data() + namesSize; name += std::strlen(name) + 1) {
+
+		const ssize_t length = GetAttribute(path.data(), name, nullptr, 0);
+		if (length == -1) {
+			return false;
+		}
+
+		std::vector<char> value(static_cast<size_t>(length));
+		const ssize_t valueSize = GetAttribute(path.data(), name, value.data(), value.size());
+		if (valueSize == -1) {
+			return false;
+		}
+
+		if (SetAttribute(fd, name, value.data(), static_cast<size_t>(valueSize)) != 0) {
+			/* NOTE: every file has an SELinux context, which an ordinary user
+			 * usually may not set. The replacement already has the context of
+			 * new files in the same directory, which is normally the same */
+			if (std::strcmp(name, "security.selinux") == 0) {
+				continue;
+			}
+
+			return false;
+		}
+	}
+
+	return true;
+#else
+	Q_UNUSED(filename)
+	Q_UNUSED(fd)
+	return true;
+#endif
+}
+
+/**
+ * @brief Creates a temporary file next to `filename` which can later be
+ * renamed over it, with the same permissions and ownership as the original.
+ *
+ * @param filename The file which is going to be replaced.
+ * @return The open temporary file, or nullptr if the file should be
+ * overwritten in place instead.
+ */
+std::unique_ptr<QTemporaryFile> CreateReplacementFile(const QString &filename) {
+#ifdef Q_OS_UNIX
+	QT_STATBUF statbuf;
+	if (QT_LSTAT(filename.toUtf8().data(), &statbuf) != 0) {
+		// there is nothing to protect, a new file is simply created in place
+		return nullptr;
+	}
+
+	/* renaming over a symbolic link, or one of several hard links, would
+	 * break the link, so those are always overwritten in place */
+	if (!S_ISREG(statbuf.st_mode) || statbuf.st_nlink != 1) {
+		return nullptr;
+	}
+
+	/* a rename only needs the directory to be writable, so a file which the
+	 * user can't write must go through opening it in place, which fails with
+	 * the usual error */
+	if (::access(filename.toUtf8().data(), W_OK) != 0) {
+		return nullptr;
+	}
+
+	auto file = std::make_unique<QTemporaryFile>(filename + QLatin1String(".XXXXXX"));
+	if (!file->open()) {
+		// most likely the file is writable, but its directory is not
+		return nullptr;
+	}
+
+	/* NOTE: ownership has to be set first, since changing it may
+	 * clear the set-user-ID and set-group-ID bits. If the replacement can't
+	 * look exactly like the original (for example, it belongs to somebody
+	 * else), we fall back to overwriting the original in place */
+	if (::fchown(file->handle(), statbuf.st_uid, statbuf.st_gid) != 0 || ::fchmod(file->handle(), statbuf.st_mode & 07777) != 0) {
+		return nullptr;
+	}
+
+	/* the access control list is copied last, since setting the mode would
+	 * change it. Without its attributes, the replacement would lose them */
+	if (!CopyExtendedAttributes(filename, file->handle())) {
+		return nullptr;
+	}
+
+	return file;
+#else
+	Q_UNUSED(filename)
+	return nullptr;
+#endif
+}
+
 }
 
 /**
@@ -701,6 +1150,8 @@ DocumentWidget::~DocumentWidget() {
 
 	I_(buffer)->BufRemoveModifyCB(ModifiedCallback, this);
 	I_(buffer)->BufRemoveModifyCB(Highlight::SyntaxHighlightModifyCallback, this);
+
+	FileWatcher::instance()->unwatch(this);
 }
 
 /**
@@ -1686,6 +2137,15 @@ void DocumentWidget::saveUndoInformation(TextCursor pos, int64_t nInserted, int6
 
 	const UndoTypes oldType = (!currentUndo || isUndo) ? UNDO_NOOP : currentUndo->type;
 
+	/* shell command output arriving a piece at a time is undone as a whole,
+	   unless the document has been saved since the last piece, so that the
+	   user can still undo back to the saved state */
+	if (I_(extendingUndo) && I_(fileChanged) && I_(extendSequence) != 0 && !isRedo && oldType != UNDO_NOOP && currentUndo->sequence == I_(extendSequence) && nDeleted == 0 && pos == currentUndo->endPos) {
+		currentUndo->endPos += nInserted;
+		++I_(autoSaveOpCount);
+		return;
+	}
+
 	/*
 	** Check for continuations of single character operations.  These are
 	** accumulated so a whole insertion or deletion can be undone, rather
@@ -1702,23 +2162,23 @@ void DocumentWidget::saveUndoInformation(TextCursor pos, int64_t nInserted, int6
 			return;
 		}
 
+		/* the deleted text can't be added to a record whose saved text
+		   can't be read back, so a new record is started instead */
+
 		// overstrike mode replacement
-		if ((oldType == ONE_CHAR_REPLACE && newType == ONE_CHAR_REPLACE) && (pos == currentUndo->endPos)) {
-			appendDeletedText(deletedText, nDeleted, Direction::Forward);
+		if ((oldType == ONE_CHAR_REPLACE && newType == ONE_CHAR_REPLACE) && (pos == currentUndo->endPos) && appendDeletedText(deletedText, Direction::Forward)) {
 			++currentUndo->endPos;
 			++I_(autoSaveCharCount);
 			return;
 		}
 
 		// forward delete
-		if ((oldType == ONE_CHAR_DELETE && newType == ONE_CHAR_DELETE) && (pos == currentUndo->startPos)) {
-			appendDeletedText(deletedText, nDeleted, Direction::Forward);
+		if ((oldType == ONE_CHAR_DELETE && newType == ONE_CHAR_DELETE) && (pos == currentUndo->startPos) && appendDeletedText(deletedText, Direction::Forward)) {
 			return;
 		}
 
 		// reverse delete
-		if ((oldType == ONE_CHAR_DELETE && newType == ONE_CHAR_DELETE) && (pos == currentUndo->startPos - 1)) {
-			appendDeletedText(deletedText, nDeleted, Direction::Backward);
+		if ((oldType == ONE_CHAR_DELETE && newType == ONE_CHAR_DELETE) && (pos == currentUndo->startPos - 1) && appendDeletedText(deletedText, Direction::Backward)) {
 			--currentUndo->startPos;
 			--currentUndo->endPos;
 			return;
@@ -1733,29 +2193,18 @@ void DocumentWidget::saveUndoInformation(TextCursor pos, int64_t nInserted, int6
 
 	// if text was deleted, save it
 	if (nDeleted > 0) {
-		undo.oldText = std::string(deletedText);
+		undo.oldText = UndoText(deletedText);
 	}
 
 	// increment the operation count for the autosave feature
 	++I_(autoSaveOpCount);
 
-	/* if the this is currently unmodified, remove the previous
-	   restoresToSaved marker, and set it on this record */
-
-	// TODO(eteran): there probably is some data structure we could use
-	// to avoid having to loop here.
-	// as we have more entries in the undo/redo lists, the longer these loops
-	// get
+	/* number the record, and if the document is currently unmodified, make
+	   this the record which restores it to that state. Only one record can
+	   do that at a time, so this replaces any earlier one */
+	undo.sequence = ++I_(undoSequence);
 	if (!I_(fileChanged)) {
-		undo.restoresToSaved = true;
-
-		for (UndoInfo &u : I_(undo)) {
-			u.restoresToSaved = false;
-		}
-
-		for (UndoInfo &u : I_(redo)) {
-			u.restoresToSaved = false;
-		}
+		I_(savedSequence) = undo.sequence;
 	}
 
 	/* Add the new record to the undo list unless saveUndoInformation is
@@ -1776,6 +2225,8 @@ void DocumentWidget::saveUndoInformation(TextCursor pos, int64_t nInserted, int6
 void DocumentWidget::clearUndoList() {
 
 	I_(undo).clear();
+	I_(undoMemoryUsed) = 0;
+	I_(undoDiskUsed)   = 0;
 	Q_EMIT canUndoChanged(!I_(undo).empty());
 }
 
@@ -1787,6 +2238,7 @@ void DocumentWidget::clearUndoList() {
 void DocumentWidget::clearRedoList() {
 
 	I_(redo).clear();
+	I_(redoDiskUsed) = 0;
 	Q_EMIT canRedoChanged(!I_(redo).empty());
 }
 
@@ -1798,57 +2250,78 @@ void DocumentWidget::clearRedoList() {
  * work with more than one character.
  *
  * @param deletedText The text that was deleted.
- * @param deletedLen The length of the deleted text.
  * @param direction The direction in which the text was deleted (forward or backward).
+ * @return `true` if the text was added, `false` if the record's saved text
+ * could not be recovered, in which case the record is unchanged.
  */
-void DocumentWidget::appendDeletedText(std::string_view deletedText, int64_t deletedLen, Direction direction) {
+bool DocumentWidget::appendDeletedText(std::string_view deletedText, Direction direction) {
 	UndoInfo &undo = I_(undo).front();
+	I_(undoMemoryUsed) -= undo.memoryUsage();
+	I_(undoDiskUsed) -= undo.diskUsage();
 
-	// re-allocate, adding space for the new character(s)
-	std::string comboText;
-	comboText.reserve(undo.oldText.size() + static_cast<size_t>(deletedLen));
+	// add the new character(s) to the already deleted text
+	const bool added = (direction == Direction::Forward) ? undo.oldText.append(deletedText) : undo.oldText.prepend(deletedText);
 
-	// copy the new character and the already deleted text to the new memory
-	if (direction == Direction::Forward) {
-		comboText.append(undo.oldText);
-		comboText.append(deletedText.begin(), deletedText.end());
-	} else {
-		comboText.append(deletedText.begin(), deletedText.end());
-		comboText.append(undo.oldText);
-	}
-
-	// replace the old saved text and attach the new
-	undo.oldText = std::move(comboText);
+	I_(undoMemoryUsed) += undo.memoryUsage();
+	I_(undoDiskUsed) += undo.diskUsage();
+	return added;
 }
 
 /**
  * @brief Add an undo item to the undo list.
  * This function adds an undo item to the undo list, ensuring that the
  * undo list does not exceed the defined limits. If the undo list exceeds
- * the limit, it trims the list to a specified length.
+ * the limits, the oldest items are discarded. The previous item can no longer
+ * be extended by further typing, so its text is packed.
  *
  * @param undo The UndoInfo object containing the undo information to be added.
  */
 void DocumentWidget::addUndoItem(UndoInfo &&undo) {
 
+	if (!I_(undo).empty()) {
+		UndoInfo &previous = I_(undo).front();
+		I_(undoMemoryUsed) -= previous.memoryUsage();
+		I_(undoDiskUsed) -= previous.diskUsage();
+		previous.oldText.pack();
+		I_(undoMemoryUsed) += previous.memoryUsage();
+		I_(undoDiskUsed) += previous.diskUsage();
+	}
+
 	I_(undo).emplace_front(std::move(undo));
+	I_(undoMemoryUsed) += I_(undo).front().memoryUsage();
+	I_(undoDiskUsed) += I_(undo).front().diskUsage();
 
 	// Trim the list if it exceeds any of the limits
-	if (I_(undo).size() > UNDO_OP_LIMIT) {
-		trimUndoList(UNDO_OP_TRIMTO);
+	if (I_(undoMemoryUsed) > UNDO_MEMORY_LIMIT || I_(undoDiskUsed) + I_(redoDiskUsed) > UNDO_DISK_LIMIT) {
+		trimUndoList(UNDO_MEMORY_TRIMTO, UNDO_DISK_TRIMTO);
 	}
 
 	Q_EMIT canUndoChanged(!I_(undo).empty());
 }
 
 /**
- * @brief Add a redo item to the redo list.
+ * @brief Add a redo item to the redo list. Its temporary files count against
+ * the same limit as the undo list's, and if they exceed it, the undo list is
+ * trimmed first.
  *
  * @param redo The UndoInfo object containing the redo information to be added.
  */
 void DocumentWidget::addRedoItem(UndoInfo &&redo) {
 
+	if (!I_(redo).empty()) {
+		UndoInfo &previous = I_(redo).front();
+		I_(redoDiskUsed) -= previous.diskUsage();
+		previous.oldText.pack();
+		I_(redoDiskUsed) += previous.diskUsage();
+	}
+
 	I_(redo).emplace_front(std::move(redo));
+	I_(redoDiskUsed) += I_(redo).front().diskUsage();
+
+	if (I_(undoDiskUsed) + I_(redoDiskUsed) > UNDO_DISK_LIMIT) {
+		trimUndoList(UNDO_MEMORY_TRIMTO, UNDO_DISK_TRIMTO);
+	}
+
 	Q_EMIT canRedoChanged(!I_(redo).empty());
 }
 
@@ -1861,6 +2334,8 @@ void DocumentWidget::removeUndoItem() {
 		return;
 	}
 
+	I_(undoMemoryUsed) -= I_(undo).front().memoryUsage();
+	I_(undoDiskUsed) -= I_(undo).front().diskUsage();
 	I_(undo).pop_front();
 	Q_EMIT canUndoChanged(!I_(undo).empty());
 }
@@ -1874,26 +2349,33 @@ void DocumentWidget::removeRedoItem() {
 		return;
 	}
 
+	I_(redoDiskUsed) -= I_(redo).front().diskUsage();
 	I_(redo).pop_front();
 	Q_EMIT canRedoChanged(!I_(redo).empty());
 }
 
 /**
- * @brief Trim the undo list to a specified maximum length.
+ * @brief Trim the undo list, discarding the oldest items until it uses no
+ * more than the given amounts of memory and disk space. The disk space used
+ * by the redo list counts too, and if discarding undo items isn't enough, the
+ * redo items furthest from the current state are discarded as well. The most
+ * recent item of each list is always kept.
  *
- * @param maxLength The maximum length to which the undo list should be trimmed.
+ * @param memoryLimit The number of bytes of memory the undo list may use.
+ * @param diskLimit The number of bytes of temporary files both lists may use.
  */
-void DocumentWidget::trimUndoList(size_t maxLength) {
+void DocumentWidget::trimUndoList(size_t memoryLimit, size_t diskLimit) {
 
-	if (I_(undo).size() <= maxLength) {
-		return;
+	while (I_(undo).size() > 1 && (I_(undoMemoryUsed) > memoryLimit || I_(undoDiskUsed) + I_(redoDiskUsed) > diskLimit)) {
+		I_(undoMemoryUsed) -= I_(undo).back().memoryUsage();
+		I_(undoDiskUsed) -= I_(undo).back().diskUsage();
+		I_(undo).pop_back();
 	}
 
-	auto it = I_(undo).begin();
-	std::advance(it, maxLength);
-
-	// Trim off all subsequent entries
-	I_(undo).erase(it, I_(undo).end());
+	while (I_(redo).size() > 1 && I_(undoDiskUsed) + I_(redoDiskUsed) > diskLimit) {
+		I_(redoDiskUsed) -= I_(redo).back().diskUsage();
+		I_(redo).pop_back();
+	}
 }
 
 /**
@@ -1912,6 +2394,13 @@ void DocumentWidget::undo() {
 
 	UndoInfo &undo = I_(undo).front();
 
+	// if the saved text is lost, leave both the document and the record alone
+	const std::optional<std::string> oldText = undo.oldText.str();
+	if (!oldText) {
+		QApplication::beep();
+		return;
+	}
+
 	/* BufReplaceEx will eventually call SaveUndoInformation.  This is mostly
 	   good because it makes accumulating redo operations easier, however
 	   SaveUndoInformation needs to know that it is being called in the context
@@ -1920,7 +2409,7 @@ void DocumentWidget::undo() {
 	undo.inUndo = true;
 
 	// use the saved undo information to reverse changes
-	I_(buffer)->BufReplace(undo.startPos, undo.endPos, undo.oldText);
+	I_(buffer)->BufReplace(undo.startPos, undo.endPos, *oldText);
 
 	const auto restoredTextLength = static_cast<int64_t>(undo.oldText.size());
 	if (!I_(buffer)->primary.hasSelection() || Preferences::GetPrefUndoModifiesSelection()) {
@@ -1947,7 +2436,7 @@ void DocumentWidget::undo() {
 	   when the change being undone was originally made.  Also, remove
 	   the backup file, since the text in the buffer is now identical to
 	   the original file */
-	if (undo.restoresToSaved) {
+	if (undo.sequence == I_(savedSequence)) {
 		setWindowModified(false);
 		removeBackupFile();
 	}
@@ -1972,13 +2461,20 @@ void DocumentWidget::redo() {
 
 	UndoInfo &redo = I_(redo).front();
 
+	// if the saved text is lost, leave both the document and the record alone
+	const std::optional<std::string> oldText = redo.oldText.str();
+	if (!oldText) {
+		QApplication::beep();
+		return;
+	}
+
 	/* BufReplaceEx will eventually call SaveUndoInformation.  To indicate
 	   to SaveUndoInformation that this is the context of a redo operation,
 	   we set the inUndo indicator in the redo record */
 	redo.inUndo = true;
 
 	// use the saved redo information to reverse changes
-	I_(buffer)->BufReplace(redo.startPos, redo.endPos, redo.oldText);
+	I_(buffer)->BufReplace(redo.startPos, redo.endPos, *oldText);
 
 	const auto restoredTextLength = static_cast<int64_t>(redo.oldText.size());
 	if (!I_(buffer)->primary.hasSelection() || Preferences::GetPrefUndoModifiesSelection()) {
@@ -2006,7 +2502,7 @@ void DocumentWidget::redo() {
 	   when the change being redone was originally made. Also, remove
 	   the backup file, since the text in the buffer is now identical to
 	   the original file */
-	if (redo.restoresToSaved) {
+	if (redo.sequence == I_(savedSequence)) {
 		setWindowModified(/*modified=*/false);
 		removeBackupFile();
 	}
@@ -2083,13 +2579,13 @@ QString DocumentWidget::backupFileName() const {
  */
 void DocumentWidget::checkForChangesToFile() {
 
-	/* Maximum frequency of checking for external modifications. The periodic
-	 * check is only performed on buffer modification, and the check interval is
-	 * only to prevent checking on every keystroke in case of a file system which
-	 * is slow to process stat requests (which I'm not sure exists) */
+	/* Maximum frequency of checking for external modifications of files which
+	 * can't be watched. The periodic check is only performed on buffer
+	 * modification, and the check interval is only to prevent checking on
+	 * every keystroke in case of a file system which is slow to process stat
+	 * requests, such as NFS */
 	constexpr auto CheckInterval = std::chrono::milliseconds(3000);
 
-	// TODO(eteran): 2.0, this concept can probably be reworked in terms of QFileSystemWatcher
 	static QPointer<DocumentWidget> lastCheckWindow;
 	static std::chrono::high_resolution_clock::time_point lastCheckTime;
 
@@ -2097,14 +2593,25 @@ void DocumentWidget::checkForChangesToFile() {
 		return;
 	}
 
-	// If last check was very recent, don't impact performance
-	auto timestamp = std::chrono::high_resolution_clock::now();
-	if (this == lastCheckWindow && (timestamp - lastCheckTime) < CheckInterval) {
-		return;
-	}
+	const QString fullname = fullPath();
+
+	/* A watched file only needs to be looked at when it is reported to have
+	 * changed, anything else is polled, but not too often */
+	FileWatcher *watcher = FileWatcher::instance();
+	if (watcher->watch(this, fullname)) {
+		if (!watcher->changePending(this)) {
+			return;
+		}
+	} else {
+		// If last check was very recent, don't impact performance
+		auto timestamp = std::chrono::high_resolution_clock::now();
+		if (this == lastCheckWindow && (timestamp - lastCheckTime) < CheckInterval) {
+			return;
+		}
 
-	lastCheckWindow = this;
-	lastCheckTime   = timestamp;
+		lastCheckWindow = this;
+		lastCheckTime   = timestamp;
+	}
 
 	MainWindow *win = MainWindow::fromDocument(this);
 	if (!win) {
@@ -2117,8 +2624,12 @@ void DocumentWidget::checkForChangesToFile() {
 	 */
 	const bool silent = (!isTopDocument() || !win->isVisible());
 
+	// A silent check can't warn about a change, so leave it pending until one can
+	if (!silent) {
+		watcher->clearPending(this);
+	}
+
 	// Get the file mode and modification time
-	const QString fullname = fullPath();
 
 	QT_STATBUF statbuf;
 	if (QT_STAT(fullname.toUtf8().data(), &statbuf) != 0) {
@@ -2520,20 +3031,18 @@ bool DocumentWidget::writeBackupFile() {
 		return false;
 	}
 
-	// get the text buffer contents
-	std::string fileString = I_(buffer)->BufGetAll();
+	auto _ = gsl::finally([fp] { ::fclose(fp); });
+
+	// write out the file, straight from the text buffer
+	I_(buffer)->BufForEachSegment(I_(buffer)->BufStartOfBuffer(), I_(buffer)->BufEndOfBuffer(), [fp](std::string_view piece) {
+		return ::fwrite(piece.data(), 1, piece.size(), fp) == piece.size();
+	});
 
 	// add a terminating newline if the file doesn't already have one
-	if (Preferences::GetPrefAppendLF()) {
-		if (!fileString.empty() && fileString.back() != '\n') {
-			fileString.append("\n");
-		}
+	if (Preferences::GetPrefAppendLF() && !I_(buffer)->BufIsEmpty() && I_(buffer)->back() != '\n') {
+		::fputc('\n', fp);
 	}
 
-	auto _ = gsl::finally([fp] { ::fclose(fp); });
-
-	// write out the file
-	::fwrite(fileString.data(), 1, fileString.size(), fp);
 	if (::ferror(fp)) {
 		QMessageBox::critical(
 			this,
@@ -2647,13 +3156,22 @@ bool DocumentWidget::doSave() {
 		I_(buffer)->BufAppend('\n');
 	}
 
-	// open the file
-	QFile file(fullname);
-	if (!file.open(QIODevice::WriteOnly)) {
+	QElapsedTimer timer;
+	timer.start();
+
+	/* Where possible, write to a temporary file next to the original and
+	 * rename it over the original once everything has been written, so that
+	 * a failed or interrupted save never leaves the user with a truncated
+	 * file. Otherwise, open the file itself */
+	std::unique_ptr<QTemporaryFile> replacement = CreateReplacementFile(fullname);
+	QFile original(fullname);
+	QFile *file = replacement ? replacement.get() : &original;
+
+	if (!replacement && !original.open(QIODevice::WriteOnly)) {
 		QMessageBox messageBox(this);
 		messageBox.setWindowTitle(tr("Error saving File"));
 		messageBox.setIcon(QMessageBox::Warning);
-		messageBox.setText(tr("Unable to save %1:\n%2\n\nSave as a new file?").arg(I_(filename), file.errorString()));
+		messageBox.setText(tr("Unable to save %1:\n%2\n\nSave as a new file?").arg(I_(filename), original.errorString()));
 
 		QPushButton *buttonSaveAs = messageBox.addButton(tr("Save As..."), QMessageBox::AcceptRole);
 		QPushButton *buttonCancel = messageBox.addButton(QMessageBox::Cancel);
@@ -2668,29 +3186,49 @@ bool DocumentWidget::doSave() {
 		return false;
 	}
 
-	// get the text buffer contents and its length
-	std::string text = I_(buffer)->BufGetAll();
+	// write to the file, reconverting to DOS or Macintosh format as we go
+	const qint64 written = WriteBufferContents(I_(buffer), file, I_(fileFormat));
 
-	// If the file is to be saved in DOS or Macintosh format, reconvert
-	switch (I_(fileFormat)) {
-	case FileFormats::Dos:
-		ConvertToDos(text);
-		break;
-	case FileFormats::Mac:
-		ConvertToMac(text);
-		break;
-	default:
-		break;
+	QString errorString;
+	if (written == -1) {
+		errorString = file->errorString();
+	} else if (Preferences::GetPrefSyncOnSave() && !SyncToDisk(file)) {
+		errorString = ErrorString(errno);
+	} else if (replacement) {
+		if (!replacement->flush()) {
+			errorString = replacement->errorString();
+		} else if (::rename(replacement->fileName().toUtf8().data(), fullname.toUtf8().data()) != 0) {
+			errorString = ErrorString(errno);
+		} else {
+			replacement->setAutoRemove(false);
+
+			// the file is saved either way, but the rename may not survive a crash until its directory is synchronized
+			if (Preferences::GetPrefSyncOnSave() && !SyncDirectory(fullname)) {
+				qWarning("NEdit: could not synchronize the directory of %s: %s", qPrintable(fullname), qPrintable(ErrorString(errno)));
+			}
+		}
 	}
 
-	// write to the file
-	if (file.write(text.data(), ssize(text)) == -1) {
-		QMessageBox::critical(this, tr("Error saving File"), tr("%1 not saved:\n%2").arg(I_(filename), file.errorString()));
-		file.close();
-		file.remove();
+	if (!errorString.isNull()) {
+		QMessageBox::critical(this, tr("Error saving File"), tr("%1 not saved:\n%2").arg(I_(filename), errorString));
+
+		// a failed replacement is simply discarded, leaving the original untouched
+		if (!replacement) {
+			original.close();
+			original.remove();
+		}
 		return false;
 	}
 
+	const qint64 elapsed = timer.elapsed();
+	if (elapsed >= SlowSaveThreshold) {
+		qDebug("NEdit: saving %s took %lld ms (%lld bytes, %.1f MiB/s)",
+			   qPrintable(fullname),
+			   elapsed,
+			   written,
+			   static_cast<double>(written) / (1024.0 * 1024.0) / (static_cast<double>(elapsed) / 1000.0));
+	}
+
 	// success, file was written
 	setWindowModified(false);
 
@@ -2701,6 +3239,9 @@ bool DocumentWidget::doSave() {
 		I_(fileMissing)      = false;
 		I_(statbuf).st_dev   = statbuf.st_dev;
 		I_(statbuf).st_ino   = statbuf.st_ino;
+
+		// the file may not have existed when it was last watched, so start over
+		FileWatcher::instance()->unwatch(this);
 	} else {
 		// This needs to produce an error message -- the file can't be accessed!
 		I_(statbuf).st_mtime = 0;
@@ -3370,65 +3911,42 @@ bool DocumentWidget::doOpen(const QString &name, const QString &path, int flags)
 	}
 #endif
 
-	if (statbuf.st_size > (0x100000000ll)) {
-		I_(filenameSet) = false; // Temp. prevent check for changes.
-		QMessageBox::critical(this, tr("Error opening File"), tr("File size too large %1").arg(name));
-		I_(filenameSet) = true;
-		return false;
-	}
-
-	// Allocate space for the whole contents of the file (unfortunately)
+	// The file is copied exactly once, straight from its mapping into the buffer
 	try {
 		QFile file;
 		// TODO(eteran): error checking on this open?
 		file.open(fp, QIODevice::ReadOnly);
 
-		std::string text;
-
-		if (file.size() != 0) {
-			uchar *memory = file.map(0, file.size());
-			if (!memory) {
-				I_(filenameSet) = false; // Temp. prevent check for changes.
-				QMessageBox::critical(this, tr("Error while opening File"), tr("Error reading %1\n%2").arg(name, file.errorString()));
-				I_(filenameSet) = true;
-				return false;
-			}
-
-			text = std::string{reinterpret_cast<char *>(memory), static_cast<size_t>(file.size())};
-			file.unmap(memory);
-		}
+		// Detect and convert DOS and Macintosh format files
+		FileFormats format = I_(fileFormat);
+		FileFormats *const detectFormat = Preferences::GetPrefForceOSConversion() ? &format : nullptr;
+
+		const bool mapped = MapFileContents(file, detectFormat, [this, &statbuf, &format](std::string_view text) {
+			/* Any errors that happen after this point leave the window in a
+			 * "broken" state, and thus RevertToSaved will abandon the window if
+			 * I_(fileMissing) is `false` and doOpen fails. */
+			I_(statbuf).st_mode  = statbuf.st_mode;
+			I_(statbuf).st_uid   = statbuf.st_uid;
+			I_(statbuf).st_gid   = statbuf.st_gid;
+			I_(statbuf).st_mtime = statbuf.st_mtime;
+			I_(statbuf).st_dev   = statbuf.st_dev;
+			I_(statbuf).st_ino   = statbuf.st_ino;
+			I_(fileMissing)      = false;
+			I_(fileFormat)       = format;
 
-		/* Any errors that happen after this point leave the window in a
-		 * "broken" state, and thus RevertToSaved will abandon the window if
-		 * I_(fileMissing) is `false` and doOpen fails. */
-		I_(statbuf).st_mode  = statbuf.st_mode;
-		I_(statbuf).st_uid   = statbuf.st_uid;
-		I_(statbuf).st_gid   = statbuf.st_gid;
-		I_(statbuf).st_mtime = statbuf.st_mtime;
-		I_(statbuf).st_dev   = statbuf.st_dev;
-		I_(statbuf).st_ino   = statbuf.st_ino;
-		I_(fileMissing)      = false;
+			// Display the file contents in the text widget
+			I_(ignoreModify) = true;
+			I_(buffer)->BufSetAll(text);
+			I_(ignoreModify) = false;
+		});
 
-		// Detect and convert DOS and Macintosh format files
-		if (Preferences::GetPrefForceOSConversion()) {
-			I_(fileFormat) = FormatOfFile(text);
-			switch (I_(fileFormat)) {
-			case FileFormats::Dos:
-				ConvertFromDos(text);
-				break;
-			case FileFormats::Mac:
-				ConvertFromMac(text);
-				break;
-			case FileFormats::Unix:
-				break;
-			}
+		if (!mapped) {
+			I_(filenameSet) = false; // Temp. prevent check for changes.
+			QMessageBox::critical(this, tr("Error while opening File"), tr("Error reading %1\n%2").arg(name, file.errorString()));
+			I_(filenameSet) = true;
+			return false;
 		}
 
-		// Display the file contents in the text widget
-		I_(ignoreModify) = true;
-		I_(buffer)->BufSetAll(text);
-		I_(ignoreModify) = false;
-
 		// Set window title and file changed flag
 		if ((flags & EditFlags::PREF_READ_ONLY) != 0) {
 			I_(lockReasons).setUserLocked(true);
@@ -3597,10 +4115,10 @@ void DocumentWidget::executeNewlineMacro(SmartIndentEvent *event) {
 
 		++(winData->inNewLineMacro);
 
+		// Don't allow preemption or time limit.  Must get return value
 		std::shared_ptr<MacroContext> continuation;
-		int stat = ExecuteMacro(this, winData->newlineMacro.get(), args, &result, continuation, &errMsg);
+		int stat = ExecuteMacro(this, winData->newlineMacro.get(), args, &result, continuation, &errMsg, UnlimitedMacroTimeSlice);
 
-		// Don't allow preemption or time limit.  Must get return value
 		while (stat == MACRO_TIME_LIMIT) {
 			stat = continueMacro(continuation, &result, &errMsg);
 		}
@@ -3688,7 +4206,7 @@ void DocumentWidget::executeModMacro(SmartIndentEvent *event) {
 		++(winData->inModMacro);
 
 		std::shared_ptr<MacroContext> continuation;
-		int stat = ExecuteMacro(this, winData->modMacro.get(), args, &result, continuation, &errMsg);
+		int stat = ExecuteMacro(this, winData->modMacro.get(), args, &result, continuation, &errMsg, UnlimitedMacroTimeSlice);
 
 		while (stat == MACRO_TIME_LIMIT) {
 			stat = continueMacro(continuation, &result, &errMsg);
@@ -3778,37 +4296,19 @@ void DocumentWidget::includeFile(const QString &name) {
 		return;
 	}
 
-	// TODO(eteran): this code is *almost* identical to a block of code in doOpen, we should
-	// abstract this out into a function and reuse it.
 	QFile file(name);
 	if (!file.open(QFile::ReadOnly)) {
 		QMessageBox::critical(this, tr("Error opening File"), file.errorString());
 		return;
 	}
 
-	if (file.size() != 0) {
-		uchar *memory = file.map(0, file.size());
-		if (!memory) {
-			QMessageBox::critical(this, tr("Error opening File"), file.errorString());
+	// Detect and convert DOS and Macintosh format files
+	FileFormats format;
+	const bool mapped = MapFileContents(file, &format, [this](std::string_view text) {
+		if (text.empty()) {
 			return;
 		}
 
-		auto text = std::string{reinterpret_cast<char *>(memory), static_cast<size_t>(file.size())};
-		file.unmap(memory);
-
-		// Detect and convert DOS and Macintosh format files
-		switch (FormatOfFile(text)) {
-		case FileFormats::Dos:
-			ConvertFromDos(text);
-			break;
-		case FileFormats::Mac:
-			ConvertFromMac(text);
-			break;
-		case FileFormats::Unix:
-			//  Default is Unix, no conversion necessary.
-			break;
-		}
-
 		/* insert the contents of the file in the selection or at the insert
 		   position in the window if no selection exists */
 		if (I_(buffer)->primary.hasSelection()) {
@@ -3818,6 +4318,10 @@ void DocumentWidget::includeFile(const QString &name) {
 				I_(buffer)->BufInsert(win->lastFocus()->cursorPos(), text);
 			}
 		}
+	});
+
+	if (!mapped) {
+		QMessageBox::critical(this, tr("Error opening File"), file.errorString());
 	}
 }
 
@@ -4163,6 +4667,7 @@ void DocumentWidget::executeShellCommand(TextArea *area, const QString &command,
 		area,
 		substitutedCommand,
 		QString(),
+		TextRange(),
 		flags,
 		range.start,
 		range.end,
@@ -4365,6 +4870,8 @@ void DocumentWidget::beginSmartIndent(Verbosity verbosity) {
 		return;
 	}
 
+	siData->newlineMacro->name = QStringLiteral("smart indent newline (%1)").arg(modeName).toStdString();
+
 	if (indentMacros->modMacro.isNull()) {
 		siData->modMacro = nullptr;
 	} else {
@@ -4375,6 +4882,8 @@ void DocumentWidget::beginSmartIndent(Verbosity verbosity) {
 			Preferences::ReportError(this, indentMacros->modMacro, stoppedAt, tr("smart indent modify macro"), errMsg);
 			return;
 		}
+
+		siData->modMacro->name = QStringLiteral("smart indent modify (%1)").arg(modeName).toStdString();
 	}
 
 	I_(smartIndentData) = std::move(siData);
@@ -4736,8 +5245,11 @@ void DocumentWidget::unloadLanguageModeTipsFile() {
  * @param area The text area in which to execute the command.
  * @param command The shell command to execute.
  * @param input The input string to feed to the command.
+ * @param inputRange The range of this document's buffer to feed to the command
+ * instead, if it isn't empty. It is read as the command consumes it, rather
+ * than copied.
  * @param flags Flags to control the behavior of the command execution. On of:
- * 	   - ACCUMULATE: Accumulate output until the command completes.
+ * 	   - ACCUMULATE: Accumulate output until the command completes, otherwise it is shown as it arrives.
  * 	   - ERROR_DIALOGS: Show error dialogs for stderr output and failed exit status.
  * 	   - REPLACE_SELECTION: Replace the current selection in the text area with the command output.
  * 	   - RELOAD_FILE_AFTER: Reload the file after the command completes.
@@ -4751,7 +5263,7 @@ void DocumentWidget::unloadLanguageModeTipsFile() {
  * @note REPLACE_SELECTION, ERROR_DIALOGS, and OUTPUT_TO_STRING can only be used
  * along with ACCUMULATE (these operations can't be done incrementally).
  */
-void DocumentWidget::issueCommand(MainWindow *window, TextArea *area, const QString &command, const QString &input, int flags, TextCursor replaceLeft, TextCursor replaceRight, CommandSource source) {
+void DocumentWidget::issueCommand(MainWindow *window, TextArea *area, const QString &command, const QString &input, TextRange inputRange, int flags, TextCursor replaceLeft, TextCursor replaceRight, CommandSource source) {
 
 	// verify consistency of input parameters
 	if ((flags & ERROR_DIALOGS || flags & REPLACE_SELECTION || flags & OUTPUT_TO_STRING) && !(flags & ACCUMULATE)) {
@@ -4810,6 +5322,11 @@ void DocumentWidget::issueCommand(MainWindow *window, TextArea *area, const QStr
 			if (shellCmdData_) {
 				const QByteArray dataAll = shellCmdData_->process->readAll();
 				shellCmdData_->standardOutput.append(dataAll);
+
+				// output which isn't accumulated is collected for a moment, then shown
+				if (!(shellCmdData_->flags & ACCUMULATE) && !shellCmdData_->flushTimer.isActive()) {
+					shellCmdData_->flushTimer.start();
+				}
 			}
 		});
 	}
@@ -4824,27 +5341,59 @@ void DocumentWidget::issueCommand(MainWindow *window, TextArea *area, const QStr
 	// if so, then the args looks very different. It needs to be something like this:
 	// powershell.exe -ExecutionPolicy Bypass -Command "{code}"
 
-	// if there's nothing to write to the process' stdin, close it now, otherwise
-	// write it to the process
-	if (!input.isEmpty()) {
-		process->write(input.toLocal8Bit());
-	}
-
-	process->closeWriteChannel();
-
 	/* Create a data structure for passing process information around
 	   amongst the callback routines which will process i/o and completion */
-	auto cmdData        = std::make_unique<ShellCommandData>();
-	cmdData->process    = process;
-	cmdData->flags      = flags;
-	cmdData->area       = area;
-	cmdData->bannerIsUp = false;
-	cmdData->source     = source;
-	cmdData->leftPos    = replaceLeft;
-	cmdData->rightPos   = replaceRight;
+	auto cmdData          = std::make_unique<ShellCommandData>();
+	cmdData->process      = process;
+	cmdData->flags        = flags;
+	cmdData->area         = area;
+	cmdData->bannerIsUp   = false;
+	cmdData->inputClosed     = false;
+	cmdData->outputShown     = false;
+	cmdData->insertingOutput = false;
+	cmdData->inputOffset     = 0;
+	cmdData->dialogLength    = 0;
+	cmdData->heldNewlines    = 0;
+	cmdData->source          = source;
+	cmdData->leftPos         = replaceLeft;
+	cmdData->rightPos        = replaceRight;
+
+	/* The input is written a piece at a time, as the process consumes it. A
+	   range of the buffer is followed through any edits made in the meantime */
+	if (inputRange.start != inputRange.end) {
+		cmdData->inputBuffer = I_(buffer);
+		cmdData->inputPos    = inputRange.start;
+		cmdData->inputEnd    = inputRange.end;
+		cmdData->inputBuffer->BufAddModifyCB(ShellInputModifiedCallback, cmdData.get());
+	} else {
+		cmdData->standardInput = input.toLocal8Bit();
+	}
+
+	/* Output which is inserted as it arrives goes where the text to replace
+	   was, wherever other edits made in the meantime have moved that to */
+	if (!(flags & (ACCUMULATE | OUTPUT_TO_DIALOG))) {
+		if (DocumentWidget *target = fromArea(area)) {
+			cmdData->outputBuffer = target->info_->buffer;
+			cmdData->outputBuffer->BufAddModifyCB(ShellOutputModifiedCallback, cmdData.get());
+		}
+	}
 
 	document->shellCmdData_ = std::move(cmdData);
 
+	connect(process, &QProcess::bytesWritten, document, [document]() {
+		document->writeShellInput();
+	});
+
+	document->writeShellInput();
+
+	if (!(flags & ACCUMULATE)) {
+		connect(&document->shellCmdData_->flushTimer, &QTimer::timeout, document, [document]() {
+			document->flushShellOutput(/*finished=*/false);
+		});
+		document->shellCmdData_->flushTimer.setSingleShot(true);
+		document->shellCmdData_->flushTimer.setInterval(OutputFlushInterval);
+	}
+
 	// Set up timer proc for putting up banner when process takes too long
 	if (source == CommandSource::User) {
 		connect(&document->shellCmdData_->bannerTimer, &QTimer::timeout, document, &DocumentWidget::shellBannerTimeoutProc);
@@ -4882,6 +5431,7 @@ void DocumentWidget::processFinished(int exitCode, QProcess::ExitStatus exitStat
 
 	// Cancel pending timeouts
 	shellCmdData_->bannerTimer.stop();
+	shellCmdData_->flushTimer.stop();
 
 	// Clean up waiting-for-shell-command-to-complete mode
 	if (shellCmdData_->source == CommandSource::User) {
@@ -4894,6 +5444,19 @@ void DocumentWidget::processFinished(int exitCode, QProcess::ExitStatus exitStat
 
 	// when this function ends, do some cleanup
 	auto _ = gsl::finally([this, fromMacro] {
+		closeShellInput();
+
+		// output arriving later is no longer part of this command's undo record
+		if (!(shellCmdData_->flags & ACCUMULATE)) {
+			if (DocumentWidget *target = fromArea(shellCmdData_->area)) {
+				target->info_->extendSequence = 0;
+			}
+		}
+
+		if (shellCmdData_->outputBuffer) {
+			shellCmdData_->outputBuffer->BufRemoveModifyCB(ShellOutputModifiedCallback, shellCmdData_.get());
+		}
+
 		delete shellCmdData_->process;
 		shellCmdData_ = nullptr;
 
@@ -4903,7 +5466,7 @@ void DocumentWidget::processFinished(int exitCode, QProcess::ExitStatus exitStat
 	});
 
 	QString errText;
-	std::string outText;
+	std::string_view outText; // refers to the output held in shellCmdData_, rather than copying it
 
 	// If the process was killed or became inaccessible, give up
 	if (exitStatus != QProcess::NormalExit) {
@@ -4923,15 +5486,18 @@ void DocumentWidget::processFinished(int exitCode, QProcess::ExitStatus exitStat
 
 		const QByteArray dataOut = shellCmdData_->process->readAllStandardOutput();
 		shellCmdData_->standardOutput.append(dataOut);
-		outText = std::string(shellCmdData_->standardOutput.data(), shellCmdData_->standardOutput.size());
+		outText = std::string_view(shellCmdData_->standardOutput.constData(), static_cast<size_t>(shellCmdData_->standardOutput.size()));
 	} else {
 
 		const QByteArray dataAll = shellCmdData_->process->readAll();
 		shellCmdData_->standardOutput.append(dataAll);
-		outText = std::string(shellCmdData_->standardOutput.data(), shellCmdData_->standardOutput.size());
+
+		// output which isn't accumulated has been shown as it arrived, except for this
+		if (shellCmdData_->flags & ACCUMULATE) {
+			outText = std::string_view(shellCmdData_->standardOutput.constData(), static_cast<size_t>(shellCmdData_->standardOutput.size()));
+		}
 	}
 
-	static constexpr int MaxMessageLength = 4096;
 	static const QRegularExpression trailingNewlines(QStringLiteral("\\n+$"));
 
 	/* Present error and stderr-information dialogs.  If a command returned
@@ -4995,7 +5561,9 @@ void DocumentWidget::processFinished(int exitCode, QProcess::ExitStatus exitStat
 		/* If output is to a dialog, present the dialog.  Otherwise insert the
 		   (remaining) output in the text widget as requested, and move the
 		   insert point to the end */
-		if (shellCmdData_->flags & OUTPUT_TO_DIALOG) {
+		if (!(shellCmdData_->flags & ACCUMULATE)) {
+			flushShellOutput(/*finished=*/true);
+		} else if (shellCmdData_->flags & OUTPUT_TO_DIALOG) {
 			auto dialogOutText = QString::fromLocal8Bit(outText.data(), std::min<size_t>(MaxMessageLength, outText.size()));
 			dialogOutText.remove(trailingNewlines);
 
@@ -5033,6 +5601,154 @@ void DocumentWidget::processFinished(int exitCode, QProcess::ExitStatus exitStat
 	}
 }
 
+/**
+ * @brief Write the next pieces of input to the running shell command, as long
+ * as it isn't too far behind in reading it, and close its input once all of
+ * it has been written.
+ */
+void DocumentWidget::writeShellInput() {
+
+	if (!shellCmdData_) {
+		return;
+	}
+
+	QProcess *process = shellCmdData_->process;
+
+	while (!shellCmdData_->inputClosed && process->bytesToWrite() < InputChunkSize) {
+
+		// nothing more can be written to a process which has gone away
+		if (process->state() == QProcess::NotRunning) {
+			closeShellInput();
+			break;
+		}
+
+		if (shellCmdData_->inputBuffer && shellCmdData_->inputPos < shellCmdData_->inputEnd) {
+			const TextCursor end = std::min(shellCmdData_->inputEnd, shellCmdData_->inputPos + InputChunkSize);
+
+			shellCmdData_->inputBuffer->BufForEachSegment(shellCmdData_->inputPos, end, [process](std::string_view piece) {
+				process->write(piece.data(), ssize(piece));
+			});
+
+			shellCmdData_->inputPos = end;
+		} else if (shellCmdData_->inputOffset < shellCmdData_->standardInput.size()) {
+			const int64_t n = std::min<int64_t>(InputChunkSize, shellCmdData_->standardInput.size() - shellCmdData_->inputOffset);
+			process->write(shellCmdData_->standardInput.constData() + shellCmdData_->inputOffset, n);
+			shellCmdData_->inputOffset += n;
+		} else {
+			closeShellInput();
+		}
+	}
+}
+
+/**
+ * @brief Close the input of the running shell command, and stop following the
+ * part of the buffer it was reading.
+ */
+void DocumentWidget::closeShellInput() {
+
+	if (!shellCmdData_ || shellCmdData_->inputClosed) {
+		return;
+	}
+
+	shellCmdData_->inputClosed = true;
+	shellCmdData_->process->closeWriteChannel();
+
+	if (shellCmdData_->inputBuffer) {
+		shellCmdData_->inputBuffer->BufRemoveModifyCB(ShellInputModifiedCallback, shellCmdData_.get());
+		shellCmdData_->inputBuffer = nullptr;
+	}
+
+	shellCmdData_->standardInput = QByteArray();
+}
+
+/**
+ * @brief Show the output of a shell command which isn't accumulated, as it
+ * arrives. Only whole lines are shown, unless a line gets very long or the
+ * command has finished, so that neither lines nor characters are split up.
+ * The output inserted into a buffer is undone as a whole.
+ *
+ * @param finished `true` if the command has finished and this is the last of
+ * its output.
+ */
+void DocumentWidget::flushShellOutput(bool finished) {
+
+	if (!shellCmdData_) {
+		return;
+	}
+
+	QByteArray &output = shellCmdData_->standardOutput;
+
+	auto length = output.size();
+	if (!finished) {
+		const auto lastNewline = output.lastIndexOf('\n');
+		if (lastNewline != -1) {
+			length = lastNewline + 1;
+		} else if (length < MaxHeldOutput) {
+			length = 0;
+		}
+	}
+
+	// when a command produces nothing, the text it was to replace is still removed
+	if (length == 0 && (!finished || shellCmdData_->outputShown)) {
+		return;
+	}
+
+	const std::string_view text(output.constData(), static_cast<size_t>(length));
+
+	if (shellCmdData_->flags & OUTPUT_TO_DIALOG) {
+
+		// NOTE: trailing newlines are held back, so that the dialog doesn't end with blank lines
+		QString dialogText = QString(shellCmdData_->heldNewlines, QLatin1Char('\n')) + QString::fromLocal8Bit(text.data(), static_cast<int>(text.size()));
+
+		auto trimmed = dialogText.size();
+		while (trimmed > 0 && dialogText[trimmed - 1] == QLatin1Char('\n')) {
+			--trimmed;
+		}
+
+		shellCmdData_->heldNewlines = static_cast<int>(dialogText.size() - trimmed);
+		dialogText.truncate(std::min<int>(trimmed, std::max(0, MaxMessageLength - shellCmdData_->dialogLength)));
+
+		if (!dialogText.isEmpty()) {
+			if (!shellCmdData_->dialog) {
+				shellCmdData_->dialog = new DialogOutput(this);
+				shellCmdData_->dialog->show();
+			}
+
+			shellCmdData_->dialog->appendText(dialogText);
+			shellCmdData_->dialogLength += dialogText.size();
+		}
+	} else if (TextArea *area = shellCmdData_->area) {
+
+		TextBuffer *buf        = area->buffer();
+		DocumentWidget *target = fromArea(area);
+
+		// only the output itself may be added to the undo record of earlier output
+		shellCmdData_->insertingOutput = true;
+		if (target) {
+			target->info_->extendingUndo = true;
+		}
+
+		SafeReplace(buf, &shellCmdData_->leftPos, &shellCmdData_->rightPos, text);
+
+		shellCmdData_->insertingOutput = false;
+		if (target) {
+			target->info_->extendingUndo = false;
+		}
+
+		shellCmdData_->leftPos += ssize(text);
+		shellCmdData_->rightPos = shellCmdData_->leftPos;
+		area->TextSetCursorPos(shellCmdData_->leftPos);
+
+		// the next piece of output is added to the undo record of this one
+		if (target && !target->info_->undo.empty()) {
+			target->info_->extendSequence = target->info_->undo.front().sequence;
+		}
+	}
+
+	shellCmdData_->outputShown = true;
+	output.remove(0, length);
+}
+
 /**
  * @brief Abort the currently running shell command, if any.
  *
@@ -5105,6 +5821,7 @@ void DocumentWidget::execCursorLine(TextArea *area, CommandSource source) {
 		area,
 		substitutedCommand,
 		QString(),
+		TextRange(),
 		0,
 		insertPos + 1,
 		insertPos + 1,
@@ -5137,8 +5854,9 @@ void DocumentWidget::filterSelection(const QString &command, CommandSource sourc
 
 	/* Get the selection and the range in character positions that it
 	   occupies.  Beep and return if no selection */
-	const std::string text = I_(buffer)->BufGetSelectionText();
-	if (text.empty()) {
+	QString text;
+	TextRange inputRange;
+	if (!GetSelectionInput(I_(buffer).get(), &inputRange, &text)) {
 		QApplication::beep();
 		return;
 	}
@@ -5146,11 +5864,16 @@ void DocumentWidget::filterSelection(const QString &command, CommandSource sourc
 	const TextCursor left  = I_(buffer)->primary.start();
 	const TextCursor right = I_(buffer)->primary.end();
 
+	/* Only the input is streamed. The output is still accumulated, because the
+	   selection must stay intact until the command has finished: the user can
+	   cancel the replacement if the command reports errors, and a command
+	   which is killed must not leave the selection half replaced */
 	issueCommand(
 		win,
 		win->lastFocus(),
 		command,
-		QString::fromStdString(text),
+		text,
+		inputRange,
 		ACCUMULATE | ERROR_DIALOGS | REPLACE_SELECTION,
 		left,
 		right,
@@ -5207,31 +5930,32 @@ void DocumentWidget::doShellMenuCmd(MainWindow *inWindow, TextArea *area, const
 	const std::optional<Location> loc = area->positionToLineAndCol(pos);
 	const QString substitutedCommand  = EscapeCommand(command, fullPath(), loc ? loc->line : 0);
 
-	/* Get the command input as a text string.  If there is input, errors
-	  shouldn't be mixed in with output, so set flags to ERROR_DIALOGS */
-	std::string text;
+	/* Get the command input, as a range of the buffer, or as a text string
+	   for a rectangular selection.  If there is input, errors shouldn't be
+	   mixed in with output, so set flags to ERROR_DIALOGS */
+	QString text;
+	TextRange inputRange;
 	switch (input) {
 	case FROM_SELECTION:
-		text = I_(buffer)->BufGetSelectionText();
-		if (text.empty()) {
+		if (!GetSelectionInput(I_(buffer).get(), &inputRange, &text)) {
 			QApplication::beep();
 			return;
 		}
 		flags |= ACCUMULATE | ERROR_DIALOGS;
 		break;
 	case FROM_WINDOW:
-		text = I_(buffer)->BufGetAll();
+		inputRange.start = I_(buffer)->BufStartOfBuffer();
+		inputRange.end   = I_(buffer)->BufEndOfBuffer();
 		flags |= ACCUMULATE | ERROR_DIALOGS;
 		break;
 	case FROM_EITHER:
-		text = I_(buffer)->BufGetSelectionText();
-		if (text.empty()) {
-			text = I_(buffer)->BufGetAll();
+		if (!GetSelectionInput(I_(buffer).get(), &inputRange, &text)) {
+			inputRange.start = I_(buffer)->BufStartOfBuffer();
+			inputRange.end   = I_(buffer)->BufEndOfBuffer();
 		}
 		flags |= ACCUMULATE | ERROR_DIALOGS;
 		break;
 	case FROM_NONE:
-		text = std::string();
 		break;
 	}
 
@@ -5308,7 +6032,8 @@ void DocumentWidget::doShellMenuCmd(MainWindow *inWindow, TextArea *area, const
 		inWindow,
 		outWidget,
 		substitutedCommand,
-		QString::fromStdString(text),
+		text,
+		inputRange,
 		flags,
 		range.start,
 		range.end,
@@ -5344,6 +6069,7 @@ void DocumentWidget::shellCmdToMacroString(const QString &command, const QString
 		nullptr,
 		command,
 		input,
+		TextRange(),
 		ACCUMULATE | OUTPUT_TO_STRING,
 		TextCursor(),
 		TextCursor(),
@@ -5396,6 +6122,8 @@ void DocumentWidget::repeatMacro(const QString &macro, int how) {
 		return;
 	}
 
+	prog->name = "repeat";
+
 	// run the executable program
 	runMacro(prog);
 }
@@ -5831,6 +6559,13 @@ void DocumentWidget::updateHighlightStyles() {
 	   by swapping it with the empty one in highlightData */
 	newHighlightData->styleBuffer = std::move(oldHighlightData->styleBuffer);
 
+	// carry on with the background parse where the old one got to, using the new patterns
+	if (const std::unique_ptr<BackgroundHighlighter> &background = oldHighlightData->backgroundHighlighter) {
+		if (!background->isFinished()) {
+			newHighlightData->backgroundHighlighter = std::make_unique<BackgroundHighlighter>(newHighlightData.get(), I_(buffer).get(), documentDelimiters(), background->frontier());
+		}
+	}
+
 	highlightData_ = std::move(newHighlightData);
 
 	/* Attach new highlight information to text widgets in each pane
@@ -6117,6 +6852,14 @@ void DocumentWidget::handleUnparsedRegion(UTextBuffer *styleBuf, TextCursor pos)
 	const ReparseContext &context                         = highlightData->contextRequirements;
 	const std::unique_ptr<HighlightData[]> &pass2Patterns = highlightData->pass2Patterns;
 
+	// text which the background highlighter hasn't reached yet needs pass 1 first
+	if (const std::unique_ptr<BackgroundHighlighter> &background = highlightData->backgroundHighlighter) {
+		background->parseAhead(pos);
+		if (styleBuf->BufGetCharacter(pos) != UNFINISHED_STYLE) {
+			return;
+		}
+	}
+
 	if (!pass2Patterns) {
 		return;
 	}
@@ -6229,16 +6972,20 @@ void DocumentWidget::startHighlighting(Verbosity verbosity) {
 		return;
 	}
 
-	// Prepare for a long delay, refresh display and put up a watch cursor
 	const QCursor prevCursor = cursor();
-	setCursor(Qt::WaitCursor);
-
-	const int64_t bufLength = I_(buffer)->length();
+	const int64_t bufLength  = I_(buffer)->length();
 
 	/* Parse the buffer with pass 1 patterns.  If there are none, initialize
-	   the style buffer to all UNFINISHED_STYLE to trigger parsing later */
+	   the style buffer to all UNFINISHED_STYLE to trigger parsing later.
+	   Large buffers are initialized the same way, and parsed in the
+	   background */
 	std::basic_string<uint8_t> style_buffer(static_cast<size_t>(bufLength), UNFINISHED_STYLE);
-	if (highlightData->pass1Patterns) {
+	if (highlightData->pass1Patterns && bufLength >= BackgroundHighlightThreshold) {
+		highlightData->backgroundHighlighter = std::make_unique<BackgroundHighlighter>(highlightData.get(), I_(buffer).get(), documentDelimiters(), TextCursor());
+	} else if (highlightData->pass1Patterns) {
+		// Prepare for a long delay, refresh display and put up a watch cursor
+		setCursor(Qt::WaitCursor);
+
 		uint8_t *stylePtr = style_buffer.data();
 
 		int prev_char = -1;
@@ -6882,6 +7629,8 @@ void DocumentWidget::replay() {
 			return;
 		}
 
+		prog->name = "learn/replay";
+
 		runMacro(prog);
 	}
 }
@@ -6962,6 +7711,8 @@ void DocumentWidget::doMacro(const QString &macro, const QString &errInName) {
 		return;
 	}
 
+	prog->name = errInName.toStdString();
+
 	// run the executable program (prog is freed upon completion)
 	runMacro(prog);
 }
@@ -7136,24 +7887,24 @@ void DocumentWidget::addMark(TextArea *area, QChar label) {
  * @param lineNum The line number to select, starting from 1.
  */
 void DocumentWidget::selectNumberedLine(TextArea *area, int64_t lineNum) {
-	int i;
-	TextCursor lineStart = {};
 
-	// count lines to find the start and end positions for the selection
+	// find the start and end positions for the selection
 	if (lineNum < 1) {
 		lineNum = 1;
 	}
 
-	auto lineEnd = TextCursor(-1);
+	// NOTE: both of these are answered by the buffer's line index for
+	// large buffers, so jumping to a line doesn't have to scan the whole file
+	const TextCursor bufferStart = I_(buffer)->BufStartOfBuffer();
+	const int64_t nLines         = I_(buffer)->BufCountLines(bufferStart, I_(buffer)->BufEndOfBuffer()) + 1;
 
-	for (i = 1; i <= lineNum && lineEnd < I_(buffer)->length(); i++) {
-		lineStart = lineEnd + 1;
-		lineEnd   = I_(buffer)->BufEndOfLine(lineStart);
-	}
+	TextCursor lineStart;
 
 	// highlight the line
-	if (i > lineNum) {
+	if (lineNum <= nLines) {
 		// Line was found
+		lineStart                = I_(buffer)->BufCountForwardNLines(bufferStart, lineNum - 1);
+		const TextCursor lineEnd = I_(buffer)->BufEndOfLine(lineStart);
 		if (lineEnd < I_(buffer)->length()) {
 			I_(buffer)->BufSelect(lineStart, lineEnd + 1);
 		} else {
@@ -7482,7 +8233,7 @@ void DocumentWidget::editTaggedLocation(TextArea *area, int i) {
 	int64_t endPos;
 
 	// search for the tags file search string in the newly opened file
-	if (!Tags::FakeRegexSearch(documentToSearch->buffer()->BufAsString(), Tags::TagSearch[i], &startPos, &endPos)) {
+	if (!Tags::FakeRegexSearch(documentToSearch->buffer(), Tags::TagSearch[i], &startPos, &endPos)) {
 		QMessageBox::warning(
 			this,
 			tr("Tag Error"),
@@ -48,6 +48,7 @@ struct ShellCommandData;
 struct SmartIndentData;
 struct SmartIndentEvent;
 struct StyleTableEntry;
+struct TextRange;
 struct WindowHighlightData;
 
 class QDir;
@@ -245,7 +246,7 @@ private:
 	void addRedoItem(UndoInfo &&redo);
 	void addUndoItem(UndoInfo &&undo);
 	void addWrapNewlines();
-	void appendDeletedText(std::string_view deletedText, int64_t deletedLen, Direction direction);
+	bool appendDeletedText(std::string_view deletedText, Direction direction);
 	void attachHighlightToWidget(TextArea *area);
 	void beginLearn();
 	void cancelLearning();
@@ -265,8 +266,11 @@ private:
 	void finishLearning();
 	void flashMatchingChar(TextArea *area);
 	void freeHighlightingData();
-	void issueCommand(MainWindow *window, TextArea *area, const QString &command, const QString &input, int flags, TextCursor replaceLeft, TextCursor replaceRight, CommandSource source);
+	void issueCommand(MainWindow *window, TextArea *area, const QString &command, const QString &input, TextRange inputRange, int flags, TextCursor replaceLeft, TextCursor replaceRight, CommandSource source);
 	void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+	void flushShellOutput(bool finished);
+	void writeShellInput();
+	void closeShellInput();
 	void reapplyLanguageMode(size_t mode, bool forceDefaults);
 	void redo();
 	void refreshMenuBar();
@@ -281,7 +285,7 @@ private:
 	void saveUndoInformation(TextCursor pos, int64_t nInserted, int64_t nDeleted, std::string_view deletedText);
 	void setModeMessage(const QString &message);
 	void setWindowModified(bool modified);
-	void trimUndoList(size_t maxLength);
+	void trimUndoList(size_t memoryLimit, size_t diskLimit);
 	void undo();
 	void unloadLanguageModeTipsFile();
 	void updateMarkTable(TextCursor pos, int64_t nInserted, int64_t nDeleted);
@@ -294,8 +298,6 @@ protected:
 
 public:
 	bool highlightSyntax_;                      // is syntax highlighting turned on?
-	bool multiFileBusy_ = false;                // suppresses multiple beeps/dialogs during multi-file replacements
-	bool replaceFailed_ = false;                // flags replacements failures during multi-file replacements
 	bool showStats_;                            // is stats line supposed to be shown
 	QString fontName_;                          // names of the text fonts in use
 	size_t languageMode_ = PLAIN_LANGUAGE_MODE; // identifies language mode currently selected in the window
@@ -0,0 +1,327 @@
+
+#include "FileWatcher.h"
+#include "DocumentWidget.h"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QStorageInfo>
+#include <QTimer>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// How long to collect changes for after the first one before telling documents about them
+constexpr int NotifyDelay = 250;
+
+// File systems on which a change made by another host isn't reported to us
+const QLatin1String NetworkFileSystems[] = {
+	QLatin1String("nfs"),
+	QLatin1String("nfs4"),
+	QLatin1String("cifs"),
+	QLatin1String("smbfs"),
+	QLatin1String("smb3"),
+	QLatin1String("ncpfs"),
+	QLatin1String("afs"),
+	QLatin1String("9p"),
+	QLatin1String("fuse.sshfs"),
+	QLatin1String("ceph"),
+	QLatin1String("glusterfs"),
+	QLatin1String("lustre"),
+	QLatin1String("gpfs")};
+
+}
+
+/**
+ * @brief Constructor for FileWatcher.
+ *
+ * @param parent The parent object.
+ */
+FileWatcher::FileWatcher(QObject *parent)
+	: QObject(parent) {
+
+	watcher_ = new QFileSystemWatcher(this);
+	connect(watcher_, &QFileSystemWatcher::fileChanged, this, &FileWatcher::fileChanged);
+	connect(watcher_, &QFileSystemWatcher::directoryChanged, this, &FileWatcher::directoryChanged);
+
+	notifyTimer_ = new QTimer(this);
+	notifyTimer_->setSingleShot(true);
+	notifyTimer_->setInterval(NotifyDelay);
+	connect(notifyTimer_, &QTimer::timeout, this, &FileWatcher::notifyDocuments);
+}
+
+/**
+ * @brief Get the singleton instance of FileWatcher.
+ *
+ * @return The instance.
+ */
+FileWatcher *FileWatcher::instance() {
+
+	// NOTE: owned by the application, so that the watcher goes away before the event loop it relies on does
+	static QPointer<FileWatcher> instance;
+	if (!instance) {
+		instance = new FileWatcher(QCoreApplication::instance());
+	}
+
+	return instance;
+}
+
+/**
+ * @brief Check whether changes to a file are reported by the file system it
+ * lives on.
+ *
+ * @param path The path of the file.
+ * @return `true` if changes are reported, `false` if the file must be polled.
+ */
+bool FileWatcher::reportsChanges(const QString &path) {
+
+	const QStorageInfo storage(QFileInfo(path).absolutePath());
+	if (!storage.isValid()) {
+		return false;
+	}
+
+	const QString type = QString::fromLatin1(storage.fileSystemType());
+	return std::none_of(std::begin(NetworkFileSystems), std::end(NetworkFileSystems), [&type](const QLatin1String &fs) {
+		return type == fs;
+	});
+}
+
+/**
+ * @brief Start watching the file of a document, or follow it to a new path.
+ * A document which is newly watched is considered to have a change pending,
+ * so that it looks at its file once.
+ *
+ * @param document The document.
+ * @param path The full path of its file.
+ * @return `true` if changes to the file are reported, `false` if the document
+ * must poll for them.
+ */
+bool FileWatcher::watch(DocumentWidget *document, const QString &path) {
+
+	auto it = documents_.find(document);
+	if (it != documents_.end()) {
+		if (it->second.path == path) {
+			return it->second.reliable;
+		}
+
+		unwatch(document);
+	}
+
+	Watch entry;
+	entry.path    = path;
+	entry.pending = true;
+
+	if (reportsChanges(path)) {
+		entry.reliable = watchedFiles_.contains(path) || addPath(path, watchedFiles_);
+	}
+
+	documents_.emplace(document, entry);
+	return entry.reliable;
+}
+
+/**
+ * @brief Stop watching the file of a document.
+ *
+ * @param document The document, which may be in the middle of being destroyed.
+ */
+void FileWatcher::unwatch(DocumentWidget *document) {
+
+	auto it = documents_.find(document);
+	if (it == documents_.end()) {
+		return;
+	}
+
+	const QString path = it->second.path;
+	documents_.erase(it);
+	release(path);
+}
+
+/**
+ * @brief Check whether the file of a document may have changed since the
+ * document last looked at it.
+ *
+ * @param document The document.
+ * @return `true` if a change was reported, or the document isn't watched.
+ */
+bool FileWatcher::changePending(DocumentWidget *document) const {
+
+	auto it = documents_.find(document);
+	return it == documents_.end() || it->second.pending;
+}
+
+/**
+ * @brief Record that a document has looked at its file.
+ *
+ * @param document The document.
+ */
+void FileWatcher::clearPending(DocumentWidget *document) {
+
+	auto it = documents_.find(document);
+	if (it != documents_.end()) {
+		it->second.pending = false;
+	}
+}
+
+/**
+ * @brief Start watching a file or directory.
+ *
+ * @param path The path to watch.
+ * @param paths The set of watched files or directories which it belongs to.
+ * @return `true` if the path is now watched, `false` otherwise.
+ */
+bool FileWatcher::addPath(const QString &path, QSet<QString> &paths) {
+
+	if (!watcher_->addPath(path)) {
+		return false;
+	}
+
+	paths.insert(path);
+	return true;
+}
+
+/**
+ * @brief Stop watching a file or directory.
+ *
+ * @param path The path to stop watching.
+ * @param paths The set of watched files or directories which it belongs to.
+ */
+void FileWatcher::removePath(const QString &path, QSet<QString> &paths) {
+
+	if (paths.remove(path)) {
+		watcher_->removePath(path);
+	}
+}
+
+/**
+ * @brief Stop watching a file, and the directory it is in, if no document
+ * needs them any more.
+ *
+ * @param path The path of the file.
+ */
+void FileWatcher::release(const QString &path) {
+
+	const QString directory = QFileInfo(path).absolutePath();
+
+	bool fileUsed      = false;
+	bool directoryUsed = false;
+	for (const auto &entry : documents_) {
+		if (entry.second.path == path) {
+			fileUsed = true;
+		}
+
+		if (QFileInfo(entry.second.path).absolutePath() == directory) {
+			directoryUsed = true;
+		}
+	}
+
+	if (!fileUsed) {
+		removePath(path, watchedFiles_);
+	}
+
+	if (!directoryUsed) {
+		removePath(directory, watchedDirectories_);
+	}
+}
+
+/**
+ * @brief Called when a watched file is modified, replaced or removed.
+ *
+ * @param path The path of the file.
+ */
+void FileWatcher::fileChanged(const QString &path) {
+
+	bool found = false;
+	for (auto &entry : documents_) {
+		if (entry.second.path == path) {
+			entry.second.pending = true;
+			found                = true;
+		}
+	}
+
+	// the notification may have been queued before the file was released
+	if (!found) {
+		return;
+	}
+
+	/* A file which is removed, or replaced by renaming another file over it
+	 * (as many programs save), is no longer watched. Watch the new file if
+	 * there is one, otherwise watch the directory for it to come back. Only
+	 * the watcher knows whether it dropped the file, so it is asked here */
+	if (!watcher_->files().contains(path)) {
+		watchedFiles_.remove(path);
+
+		if (QFileInfo::exists(path)) {
+			addPath(path, watchedFiles_);
+		} else {
+			const QString directory = QFileInfo(path).absolutePath();
+			if (!watchedDirectories_.contains(directory)) {
+				addPath(directory, watchedDirectories_);
+			}
+		}
+	}
+
+	scheduleNotify();
+}
+
+/**
+ * @brief Called when a directory containing a removed file changes, in case
+ * the file has been created again.
+ *
+ * @param path The path of the directory.
+ */
+void FileWatcher::directoryChanged(const QString &path) {
+
+	bool found = false;
+	for (auto &entry : documents_) {
+		Watch &watch = entry.second;
+		if (!watch.reliable || QFileInfo(watch.path).absolutePath() != path || watchedFiles_.contains(watch.path)) {
+			continue;
+		}
+
+		if (QFileInfo::exists(watch.path)) {
+			addPath(watch.path, watchedFiles_);
+		}
+
+		watch.pending = true;
+		found         = true;
+	}
+
+	if (found) {
+		scheduleNotify();
+	}
+}
+
+/**
+ * @brief Arranges for the documents to be told about changes shortly. The
+ * timer isn't restarted by later changes, so a file which is written more
+ * often than NotifyDelay still gets checked that often.
+ */
+void FileWatcher::scheduleNotify() {
+
+	if (!notifyTimer_->isActive()) {
+		notifyTimer_->start();
+	}
+}
+
+/**
+ * @brief Tell the documents whose files have changed to check them.
+ */
+void FileWatcher::notifyDocuments() {
+
+	std::vector<QPointer<DocumentWidget>> documents;
+	for (const auto &entry : documents_) {
+		if (entry.second.pending) {
+			documents.emplace_back(entry.first);
+		}
+	}
+
+	// NOTE: checking a file may show dialogs, during which other documents may be closed
+	for (const QPointer<DocumentWidget> &document : documents) {
+		if (document) {
+			document->checkForChangesToFile();
+		}
+	}
+}
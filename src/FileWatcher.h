@@ -0,0 +1,68 @@
+
+#ifndef FILE_WATCHER_H_
+#define FILE_WATCHER_H_
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+#include <unordered_map>
+
+class DocumentWidget;
+class QFileSystemWatcher;
+class QTimer;
+
+/**
+ * @brief Watches the files of all open documents for changes made by other
+ * programs, using a single QFileSystemWatcher (inotify on Linux).
+ *
+ * Change notifications are collected for a short while after the first one
+ * before the affected documents are told to check their files, so that a
+ * program which writes a file in many small pieces causes a single check
+ * rather than one per write, but one which never stops writing still causes
+ * regular checks.
+ * Files on file systems which are known not to report changes made on other
+ * hosts, such as NFS, are not considered to be reliably watched, and are left
+ * for the documents to poll.
+ */
+class FileWatcher : public QObject {
+	Q_OBJECT
+public:
+	static FileWatcher *instance();
+
+private:
+	explicit FileWatcher(QObject *parent = nullptr);
+	~FileWatcher() override = default;
+
+public:
+	bool watch(DocumentWidget *document, const QString &path);
+	void unwatch(DocumentWidget *document);
+	bool changePending(DocumentWidget *document) const;
+	void clearPending(DocumentWidget *document);
+
+private:
+	struct Watch {
+		QString path;
+		bool reliable = false; // changes to the file are reported
+		bool pending  = false; // the file may have changed since the document last looked at it
+	};
+
+private:
+	static bool reportsChanges(const QString &path);
+	void fileChanged(const QString &path);
+	void directoryChanged(const QString &path);
+	bool addPath(const QString &path, QSet<QString> &paths);
+	void release(const QString &path);
+	void removePath(const QString &path, QSet<QString> &paths);
+	void scheduleNotify();
+	void notifyDocuments();
+
+private:
+	QFileSystemWatcher *watcher_;
+	QTimer *notifyTimer_;
+	QSet<QString> watchedFiles_;       // the files watcher_ is watching, kept here since it only returns copies
+	QSet<QString> watchedDirectories_; // the directories watcher_ is watching
+	std::unordered_map<DocumentWidget *, Watch> documents_;
+};
+
+#endif
@@ -0,0 +1,84 @@
+
+#include "GlyphRunCache.h"
+
+#include <QFont>
+#include <QFontMetricsF>
+#include <QTransform>
+
+namespace {
+
+/**
+ * @brief Make the key of a run, which is its text prefixed with a character
+ * identifying the variant of the font it is drawn with.
+ *
+ * @param text The text of the run.
+ * @param font The font it is drawn with.
+ * @return The key.
+ */
+QString MakeKey(const QString &text, const QFont &font) {
+
+	const ushort variant = (font.bold() ? 1 : 0) | (font.italic() ? 2 : 0) | (font.underline() ? 4 : 0);
+
+	QString key;
+	key.reserve(text.size() + 1);
+	key.append(QChar(variant));
+	key.append(text);
+	return key;
+}
+
+}
+
+/**
+ * @brief Constructor for GlyphRunCache.
+ *
+ * @param capacity The total length of the runs to keep, in characters.
+ */
+GlyphRunCache::GlyphRunCache(int capacity) {
+	runs_.setMaxCost(capacity);
+}
+
+/**
+ * @brief Get the layout of a run of text, laying it out if it isn't cached.
+ *
+ * @param text The text of the run.
+ * @param font The font to draw it with.
+ * @param lineHeight The height of a display line, which the text is centered
+ * in vertically.
+ * @return The run, or nullptr if it is too long to cache. The pointer is
+ * invalidated by the next call of lookup() or clear().
+ */
+const GlyphRun *GlyphRunCache::lookup(const QString &text, const QFont &font, int lineHeight) {
+
+	const QString key = MakeKey(text, font);
+
+	if (const GlyphRun *run = runs_.object(key)) {
+		++hits_;
+		return run;
+	}
+
+	++misses_;
+
+	if (text.size() >= runs_.maxCost()) {
+		return nullptr;
+	}
+
+	// NOTE: this matches where QPainter::drawText puts text which is
+	// vertically centered in a rectangle
+	const QFontMetricsF fm(font);
+
+	auto run  = new GlyphRun;
+	run->top  = (lineHeight - (fm.ascent() + fm.descent())) / 2;
+	run->text = QStaticText(text);
+	run->text.setTextFormat(Qt::PlainText);
+	run->text.prepare(QTransform(), font);
+
+	runs_.insert(key, run, static_cast<int>(text.size()) + 1);
+	return run;
+}
+
+/**
+ * @brief Discard all of the cached runs.
+ */
+void GlyphRunCache::clear() {
+	runs_.clear();
+}
@@ -0,0 +1,54 @@
+
+#ifndef GLYPH_RUN_CACHE_H_
+#define GLYPH_RUN_CACHE_H_
+
+#include <QCache>
+#include <QStaticText>
+#include <QString>
+
+#include <cstdint>
+
+class QFont;
+
+/**
+ * @brief A run of text which has been laid out for drawing with a particular
+ * font, along with how far below the top of a display line it is drawn.
+ */
+struct GlyphRun {
+	QStaticText text;
+	qreal top = 0;
+};
+
+/**
+ * @brief Caches the layout of the runs of text which a TextArea draws, so that
+ * redrawing text which has already been drawn, such as when scrolling back
+ * over it, doesn't lay it out again.
+ *
+ * Runs are looked up by their text and the variant of the text area's font
+ * they are drawn with. The least recently used runs are discarded once their
+ * total length exceeds the capacity. The cache must be cleared whenever the
+ * text area's font or line height changes.
+ */
+class GlyphRunCache {
+public:
+	// The default capacity, in characters
+	static constexpr int DefaultCapacity = 65536;
+
+public:
+	explicit GlyphRunCache(int capacity = DefaultCapacity);
+
+public:
+	const GlyphRun *lookup(const QString &text, const QFont &font, int lineHeight);
+	void clear();
+
+public:
+	uint64_t hits() const noexcept { return hits_; }
+	uint64_t misses() const noexcept { return misses_; }
+
+private:
+	QCache<QString, GlyphRun> runs_;
+	uint64_t hits_   = 0;
+	uint64_t misses_ = 0;
+};
+
+#endif
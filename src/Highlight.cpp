@@ -215,19 +215,19 @@ void FillStyleString(const char *&string_ptr, uint8_t *&style_ptr, const char *t
 /**
  * @brief Recolor a subexpression in a regex match.
  * Change styles in the portion of `style_base` to `style` where a particular
- * sub-expression, `subexpr`, of regular expression `re` applies to the
+ * sub-expression, `subexpr`, of a regular expression match applies to the
  * corresponding portion of `string_base`.
  *
- * @param re The regex object containing the match information.
+ * @param match The result of the regex match.
  * @param subexpr The index of the subexpression to recolor.
  * @param style The style to apply to the subexpression.
  * @param string_base The base pointer to the original string.
  * @param style_base The base pointer to the style string.
  */
-void RecolorSubexpression(const std::unique_ptr<Regex> &re, size_t subexpr, uint8_t style, const char *string_base, uint8_t *style_base) {
+void RecolorSubexpression(const RegexMatch &match, size_t subexpr, uint8_t style, const char *string_base, uint8_t *style_base) {
 
-	const char *string_ptr = re->startp[subexpr];
-	const char *to_ptr     = re->endp[subexpr];
+	const char *string_ptr = match.startp[subexpr];
+	const char *to_ptr     = match.endp[subexpr];
 	uint8_t *style_ptr     = &style_base[string_ptr - string_base];
 
 	FillStyleString(string_ptr, style_ptr, to_ptr, style);
@@ -1216,6 +1216,16 @@ void SyntaxHighlightModifyCallback(TextCursor pos, int64_t nInserted, int64_t nD
 	   changes that are already scheduled for redraw */
 	styleBuffer->BufSelect(pos, pos + nInserted);
 
+	/* While the document is still being parsed in the background, the
+	   background highlighter takes care of the changed region, an incremental
+	   re-parse could run on into the unparsed text all the way to the end */
+	if (const std::unique_ptr<BackgroundHighlighter> &background = highlightData->backgroundHighlighter) {
+		if (!background->isFinished()) {
+			background->textModified(pos, nInserted);
+			return;
+		}
+	}
+
 	// Re-parse around the changed region
 	if (highlightData->pass1Patterns) {
 		IncrementalReparse(highlightData, document->buffer(), pos, nInserted);
@@ -1263,11 +1273,14 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 	uint8_t *stylePtr     = style_ptr;
 
 	const std::unique_ptr<Regex> &subPatternRE = pattern->subPatternRE;
+	RegexMatch match;
+	RegexMatch subMatch;
 
 	const QByteArray delimitersString = ctx->delimiters.toLatin1();
 	const char *delimitersPtr         = ctx->delimiters.isNull() ? nullptr : delimitersString.data();
 
 	while (subPatternRE->ExecRE(
+		&match,
 		stringPtr,
 		string_ptr + length + 1,
 		false,
@@ -1281,14 +1294,14 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 		/* Beware of the case where only one real branch exists, but that
 		   branch has sub-branches itself. In that case the top_branch refers
 		   to the matching sub-branch and must be ignored. */
-		size_t subIndex = (pattern->nSubBranches > 1) ? subPatternRE->top_branch : 0;
+		size_t subIndex = (pattern->nSubBranches > 1) ? match.top_branch : 0;
 
 		// Combination of all sub-patterns and end pattern matched
 		const char *const startingStringPtr = stringPtr;
 
 		/* Fill in the pattern style for the text that was skipped over before
 		   the match, and advance the pointers to the start of the pattern */
-		FillStyleString(stringPtr, stylePtr, subPatternRE->startp[0], pattern->style, ctx);
+		FillStyleString(stringPtr, stylePtr, match.startp[0], pattern->style, ctx);
 
 		/* If the combined pattern matched this pattern's end pattern, we're
 		   done.  Fill in the style string, update the pointers, color the
@@ -1298,7 +1311,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 
 		if (pattern->endRE) {
 			if (subIndex == 0) {
-				FillStyleString(stringPtr, stylePtr, subPatternRE->endp[0], pattern->style, ctx);
+				FillStyleString(stringPtr, stylePtr, match.endp[0], pattern->style, ctx);
 				subExecuted = false;
 
 				for (size_t i = 0; i < pattern->nSubPatterns; i++) {
@@ -1306,6 +1319,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 					if (subPat->colorOnly) {
 						if (!subExecuted) {
 							if (!pattern->endRE->ExecRE(
+									&subMatch,
 									savedStartPtr,
 									savedStartPtr + 1,
 									false,
@@ -1322,7 +1336,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 						}
 
 						for (const size_t subExpr : subPat->endSubexpressions) {
-							RecolorSubexpression(pattern->endRE, subExpr, subPat->style, string_ptr, style_ptr);
+							RecolorSubexpression(subMatch, subExpr, subPat->style, string_ptr, style_ptr);
 						}
 					}
 				}
@@ -1338,7 +1352,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 		   done.  Fill in the style string, update the pointers, and return */
 		if (pattern->errorRE) {
 			if (subIndex == 0) {
-				FillStyleString(stringPtr, stylePtr, subPatternRE->startp[0], pattern->style, ctx);
+				FillStyleString(stringPtr, stylePtr, match.startp[0], pattern->style, ctx);
 				string_ptr = stringPtr;
 				style_ptr  = stylePtr;
 				return false;
@@ -1351,7 +1365,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 
 		// the sub-pattern is a simple match, just color it
 		if (!subPat->subPatternRE) {
-			FillStyleString(stringPtr, stylePtr, subPatternRE->endp[0], /* subPat->startRE->endp[0],*/ subPat->style, ctx);
+			FillStyleString(stringPtr, stylePtr, match.endp[0], /* subPat->startRE->endp[0],*/ subPat->style, ctx);
 
 			// Parse the remainder of the sub-pattern
 		} else if (subPat->endRE) {
@@ -1364,7 +1378,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 				FillStyleString(
 					stringPtr,
 					stylePtr,
-					subPatternRE->endp[0], // subPat->startRE->endp[0],
+					match.endp[0], // subPat->startRE->endp[0],
 					subPat->style,
 					ctx);
 			}
@@ -1391,10 +1405,10 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 				subPat,
 				stringPtr,
 				stylePtr,
-				subPatternRE->endp[0] - stringPtr,
+				match.endp[0] - stringPtr,
 				ctx,
 				look_behind_to,
-				subPatternRE->endp[0]);
+				match.endp[0]);
 		}
 
 		/* If the sub-pattern has color-only sub-sub-patterns, add color
@@ -1405,6 +1419,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 			if (subSubPat->colorOnly) {
 				if (!subExecuted) {
 					if (!subPat->startRE->ExecRE(
+							&subMatch,
 							savedStartPtr,
 							savedStartPtr + 1,
 							false,
@@ -1421,7 +1436,7 @@ bool ParseString(const HighlightData *pattern, const char *&string_ptr, uint8_t
 				}
 
 				for (const size_t subExpr : subSubPat->startSubexpressions) {
-					RecolorSubexpression(subPat->startRE, subExpr, subSubPat->style, string_ptr, style_ptr);
+					RecolorSubexpression(subMatch, subExpr, subSubPat->style, string_ptr, style_ptr);
 				}
 			}
 		}
@@ -8,6 +8,7 @@
 #include "DocumentWidget.h"
 #include "Highlight.h"
 #include "HighlightPattern.h"
+#include "MacroProfile.h"
 #include "MainWindow.h"
 #include "Preferences.h"
 #include "RangesetTable.h"
@@ -33,6 +34,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <optional>
 #include <stack>
 
@@ -243,6 +245,10 @@ std::error_code make_error_code(MacroErrorCode e) {
 	return {static_cast<int>(e), category};
 }
 
+// strings at least this long are returned as slices of a shared copy of the
+// text they come from, rather than being copied
+constexpr size_t MinimumSliceLength = 65536;
+
 // Global symbols for returning values from built-in functions
 constexpr int ReturnGlobalNamesCount = 5;
 
@@ -377,6 +383,30 @@ std::error_code ReadArgument(const DataValue &dv, QString *result) {
 	return MacroErrorCode::UnknownObject;
 }
 
+/**
+ * @brief Checks if every character of a string is 7-bit ASCII, in which case
+ * its characters and bytes correspond, so it can be measured and sliced
+ * without converting it to a QString.
+ *
+ * @param dv The DataValue to check.
+ * @return `true` if the value is a string of 7-bit ASCII, `false` otherwise.
+ */
+bool IsAsciiString(const DataValue &dv) {
+
+	if (is_string_slice(dv)) {
+		return to_string_slice(dv).ascii;
+	}
+
+	if (!is_string(dv)) {
+		return false;
+	}
+
+	const std::string_view string = to_string_view(dv);
+	return std::all_of(string.begin(), string.end(), [](char ch) {
+		return static_cast<unsigned char>(ch) < 0x80;
+	});
+}
+
 /**
  * @brief Reads an argument from the provided DataValue and converts it the destination type.
  *
@@ -1651,6 +1681,11 @@ std::error_code backgroundMenuCommandMS(DocumentWidget *document, Arguments argu
 */
 std::error_code lengthMS(DocumentWidget * /*document*/, Arguments arguments, DataValue *result) {
 
+	if (!arguments.empty() && IsAsciiString(arguments[0])) {
+		*result = make_value(static_cast<int64_t>(to_string_view(arguments[0]).size()));
+		return MacroErrorCode::Success;
+	}
+
 	QString string;
 	if (const std::error_code ec = ReadArguments(arguments, 0, &string)) {
 		return ec;
@@ -1804,7 +1839,14 @@ std::error_code getRangeMS(DocumentWidget *document, Arguments arguments, DataVa
 		std::swap(from, to);
 	}
 
-	const std::string rangeText = buf->BufGetRange(TextCursor(from), TextCursor(to));
+	std::string rangeText = buf->BufGetRange(TextCursor(from), TextCursor(to));
+
+	// NOTE: large ranges are shared by every copy of the value rather than copied
+	if (rangeText.size() >= MinimumSliceLength) {
+		const size_t length = rangeText.size();
+		*result             = make_value(std::make_shared<const std::string>(std::move(rangeText)), 0, length);
+		return MacroErrorCode::Success;
+	}
 
 	*result = make_value(rangeText);
 	return MacroErrorCode::Success;
@@ -1990,14 +2032,26 @@ std::error_code substringMS(DocumentWidget * /*document*/, Arguments arguments,
 	}
 
 	int from;
+	int length;
 	QString string;
 
-	if (const std::error_code ec = ReadArguments(arguments, 0, &string, &from)) {
+	// NOTE: ASCII strings are sliced in place rather than converted
+	const bool ascii = IsAsciiString(arguments[0]);
+	if (ascii) {
+		length = static_cast<int>(to_string_view(arguments[0]).size());
+	} else {
+		if (const std::error_code ec = ReadArgument(arguments[0], &string)) {
+			return ec;
+		}
+
+		length = string.size();
+	}
+
+	if (const std::error_code ec = ReadArgument(arguments[1], &from)) {
 		return ec;
 	}
 
-	const int length = string.size();
-	int to           = string.size();
+	int to = length;
 
 	if (arguments.size() == 3) {
 		if (const std::error_code ec = ReadArgument(arguments[2], &to)) {
@@ -2027,8 +2081,23 @@ std::error_code substringMS(DocumentWidget * /*document*/, Arguments arguments,
 		to = from;
 	}
 
-	// Allocate a new string and copy the sub-string into it
-	*result = make_value(string.mid(from, to - from));
+	if (!ascii) {
+		// Allocate a new string and copy the sub-string into it
+		*result = make_value(string.mid(from, to - from));
+		return MacroErrorCode::Success;
+	}
+
+	const auto subLength = static_cast<size_t>(to - from);
+
+	if (is_string_slice(arguments[0]) && subLength >= MinimumSliceLength) {
+		StringSlice slice = to_string_slice(arguments[0]);
+		slice.offset += static_cast<size_t>(from);
+		slice.length = subLength;
+		*result      = make_value(slice);
+	} else {
+		*result = make_value(to_string_view(arguments[0]).substr(static_cast<size_t>(from), subLength));
+	}
+
 	return MacroErrorCode::Success;
 }
 
@@ -2177,43 +2246,37 @@ std::error_code appendFileMS(DocumentWidget *document, Arguments arguments, Data
 }
 
 /*
-** Built-in macro subroutine for searching a string.  Arguments are $1:
-** string to search in, $2: string to search for, $3: starting position.
-** Optional arguments may include the strings: "wrap" to make the search
-** wrap around the beginning or end of the string, "backward" or "forward"
-** to change the search direction ("forward" is the default), "literal",
-** "case" or "regex" to change the search type (default is "literal").
-**
-** Returns the starting position of the match, or -1 if nothing matched.
-** also returns the ending position of the match in $searchEndPos
+** The part of searchStringMS and searchMS which doesn't depend on what is being
+** searched. Arguments are $1: string to search for, $2: starting position,
+** followed by the optional search arguments. "length" is the length of the
+** text, and "search" searches it.
 */
-std::error_code searchStringMS(DocumentWidget *document, Arguments arguments, DataValue *result) {
+template <class Func>
+std::error_code searchText(Arguments arguments, int64_t length, DataValue *result, Func search) {
 
 	int64_t beginPos = 0;
 	WrapMode wrap;
 	SearchType type;
 	QString searchStr;
 	Direction direction;
-	std::string string;
 
 	bool found      = false;
 	bool skipSearch = false;
 
 	// Validate arguments and convert to proper types
-	if (arguments.size() < 3) {
+	if (arguments.size() < 2) {
 		return MacroErrorCode::TooFewArguments;
 	}
 
-	if (const std::error_code ec = ReadArguments(arguments, 0, &string, &searchStr, &beginPos)) {
+	if (const std::error_code ec = ReadArguments(arguments, 0, &searchStr, &beginPos)) {
 		return ec;
 	}
 
-	if (const std::error_code ec = ReadSearchArgs(arguments.subspan(3), &direction, &type, &wrap)) {
+	if (const std::error_code ec = ReadSearchArgs(arguments.subspan(2), &direction, &type, &wrap)) {
 		return ec;
 	}
 
-	auto len = static_cast<int64_t>(to_string(arguments[0]).size());
-	if (beginPos > len) {
+	if (beginPos > length) {
 		if (direction == Direction::Forward) {
 			if (wrap == WrapMode::Wrap) {
 				beginPos = 0; // Wrap immediately
@@ -2222,12 +2285,12 @@ std::error_code searchStringMS(DocumentWidget *document, Arguments arguments, Da
 				skipSearch = true;
 			}
 		} else {
-			beginPos = len;
+			beginPos = length;
 		}
 	} else if (beginPos < 0) {
 		if (direction == Direction::Backward) {
 			if (wrap == WrapMode::Wrap) {
-				beginPos = len; // Wrap immediately
+				beginPos = length; // Wrap immediately
 			} else {
 				found      = false;
 				skipSearch = true;
@@ -2240,15 +2303,7 @@ std::error_code searchStringMS(DocumentWidget *document, Arguments arguments, Da
 	Search::Result searchResult = {-1, 0, 0, 0};
 
 	if (!skipSearch) {
-		found = Search::SearchString(
-			string,
-			searchStr,
-			direction,
-			type,
-			wrap,
-			beginPos,
-			&searchResult,
-			document->getWindowDelimiters());
+		found = search(searchStr, direction, type, wrap, beginPos, &searchResult);
 	}
 
 	// Return the results
@@ -2257,6 +2312,51 @@ std::error_code searchStringMS(DocumentWidget *document, Arguments arguments, Da
 	return MacroErrorCode::Success;
 }
 
+/*
+** Built-in macro subroutine for searching a string.  Arguments are $1:
+** string to search in, $2: string to search for, $3: starting position.
+** Optional arguments may include the strings: "wrap" to make the search
+** wrap around the beginning or end of the string, "backward" or "forward"
+** to change the search direction ("forward" is the default), "literal",
+** "case" or "regex" to change the search type (default is "literal").
+**
+** Returns the starting position of the match, or -1 if nothing matched.
+** also returns the ending position of the match in $searchEndPos
+*/
+std::error_code searchStringMS(DocumentWidget *document, Arguments arguments, DataValue *result) {
+
+	std::string string;
+	std::string_view text;
+
+	// Validate arguments and convert to proper types
+	if (arguments.size() < 3) {
+		return MacroErrorCode::TooFewArguments;
+	}
+
+	// search strings where they lie, rather than a copy of them
+	if (is_string(arguments[0])) {
+		text = to_string_view(arguments[0]);
+	} else {
+		if (const std::error_code ec = ReadArguments(arguments, 0, &string)) {
+			return ec;
+		}
+
+		text = string;
+	}
+
+	return searchText(arguments.subspan(1), static_cast<int64_t>(text.size()), result, [&](const QString &searchStr, Direction direction, SearchType type, WrapMode wrap, int64_t beginPos, Search::Result *searchResult) {
+		return Search::SearchString(
+			text,
+			searchStr,
+			direction,
+			type,
+			wrap,
+			beginPos,
+			searchResult,
+			document->getWindowDelimiters());
+	});
+}
+
 /*
 ** Built-in macro subroutine for searching silently in a window without
 ** dialogs, beeps, or changes to the selection.  Arguments are: $1: string to
@@ -2270,28 +2370,25 @@ std::error_code searchStringMS(DocumentWidget *document, Arguments arguments, Da
 ** also returns the ending position of the match in $searchEndPos
 */
 std::error_code searchMS(DocumentWidget *document, Arguments arguments, DataValue *result) {
-	DataValue newArgList[9];
 
-	/* Use the search string routine, by adding the buffer contents as the
-	 * string argument */
 	if (arguments.size() > 8) {
 		return MacroErrorCode::WrongNumberOfArguments;
 	}
 
-	// NOTE(eteran): the original version of this code was copy-free
-	// in the interest of making the macro code simpler
-	// we just make a copy here. If we duplicate the code in searchStringMS
-	// here and thus don't have to pass things in a DataValue, we can once again
-	// make it copy free
-	newArgList[0] = make_value(document->buffer()->BufAsString());
-
-	// copy other arguments to the new argument list
-	std::copy(arguments.begin(), arguments.end(), &newArgList[1]);
+	// search the document's buffer where it lies, rather than a copy of it
+	TextBuffer *buffer = document->buffer();
 
-	return searchStringMS(
-		document,
-		Arguments(newArgList, arguments.size() + 1),
-		result);
+	return searchText(arguments, buffer->length(), result, [&](const QString &searchStr, Direction direction, SearchType type, WrapMode wrap, int64_t beginPos, Search::Result *searchResult) {
+		return Search::SearchBuffer(
+			buffer,
+			searchStr,
+			direction,
+			type,
+			wrap,
+			beginPos,
+			searchResult,
+			document->getWindowDelimiters());
+	});
 }
 
 /*
@@ -2482,6 +2579,82 @@ std::error_code getenvMS(DocumentWidget * /*document*/, Arguments arguments, Dat
 	return MacroErrorCode::Success;
 }
 
+/*
+** Built-in macro subroutine for controlling the macro profiler:
+**
+**   macro_profile()                         returns the report of the statistics collected so far
+**   macro_profile("start"|"stop"|"reset")   starts or stops collecting them, or discards them
+*/
+std::error_code macroProfileMS(DocumentWidget * /*document*/, Arguments arguments, DataValue *result) {
+
+	if (arguments.size() > 1) {
+		return MacroErrorCode::TooManyArguments;
+	}
+
+	if (arguments.empty()) {
+		*result = make_value(MacroProfileReport());
+		return MacroErrorCode::Success;
+	}
+
+	std::string action;
+	if (const std::error_code ec = ReadArgument(arguments[0], &action)) {
+		return ec;
+	}
+
+	if (action == "start") {
+		SetMacroProfiling(true);
+	} else if (action == "stop") {
+		SetMacroProfiling(false);
+	} else if (action == "reset") {
+		ResetMacroProfile();
+	} else {
+		return MacroErrorCode::InvalidArgument;
+	}
+
+	*result = make_value();
+	return MacroErrorCode::Success;
+}
+
+/*
+** Built-in macro subroutine for finding out how well the cache of compiled
+** regular expressions used by searches and replacements is working. Takes no
+** arguments. Returns an array with the following keys:
+**    hits, misses, evictions.
+*/
+std::error_code regexCacheStatsMS(DocumentWidget * /*document*/, Arguments arguments, DataValue *result) {
+
+	if (!arguments.empty()) {
+		return MacroErrorCode::TooManyArguments;
+	}
+
+	const RegexCache::Statistics stats = Search::RegexCacheStatistics();
+
+	// macro integers are 32 bits wide, so saturate rather than wrap
+	auto toValue = [](uint64_t n) {
+		return make_value(static_cast<int>(std::min<uint64_t>(n, std::numeric_limits<int>::max())));
+	};
+
+	// set up result
+	*result = make_value(std::make_shared<Array>());
+
+	DataValue element = toValue(stats.hits);
+	if (!ArrayInsert(result, "hits", &element)) {
+		return MacroErrorCode::InsertFailed;
+	}
+
+	element = toValue(stats.misses);
+	if (!ArrayInsert(result, "misses", &element)) {
+		return MacroErrorCode::InsertFailed;
+	}
+
+	element = toValue(stats.evictions);
+	if (!ArrayInsert(result, "evictions", &element)) {
+		return MacroErrorCode::InsertFailed;
+	}
+
+	return MacroErrorCode::Success;
+}
+
 std::error_code shellCmdMS(DocumentWidget *document, Arguments arguments, DataValue *result) {
 
 	QString cmdString;
@@ -5097,6 +5270,8 @@ const SubRoutine MacroSubrs[] = {
 	{"get_style_at_pos", getStyleAtPosMS},
 	{"filename_dialog", filenameDialogMS},
 	{"raise_window", raiseWindowMS},
+	{"macro_profile", macroProfileMS},
+	{"regex_cache_stats", regexCacheStatsMS},
 };
 
 const SubRoutine SpecialVars[] = {
@@ -5289,6 +5464,8 @@ bool ReadCheckMacroString(QWidget *dialogParent, const QString &string, Document
 					errMsg);
 			}
 
+			prog->name = routineName.toStdString();
+
 			if (runDocument) {
 				if (Symbol *const sym = LookupSymbolEx(routineName)) {
 
@@ -5330,6 +5507,8 @@ bool ReadCheckMacroString(QWidget *dialogParent, const QString &string, Document
 					errMsg);
 			}
 
+			prog->name = errIn.toStdString();
+
 			if (runDocument) {
 
 				if (!runDocument->macroCmdData_) {
@@ -5,6 +5,7 @@
 #include "DocumentWidget.h"
 #include "EditFlags.h"
 #include "Macro.h"
+#include "MacroProfile.h"
 #include "MainWindow.h"
 #include "NeditServer.h"
 #include "Preferences.h"
@@ -29,7 +30,7 @@ constexpr const char HelpText[] =
 	"                [-lm languagemode] [-rows n] [-columns n] [-font font]\n"
 	"                [-geometry geometry] [-iconic] [-noiconic] [-svrname name]\n"
 	"                [-import file] [-tabbed] [-untabbed] [-group] [-V|-version]\n"
-	"                [-h|-help] [--] [file...]\n";
+	"                [-profile-macros] [-h|-help] [--] [file...]\n";
 
 /**
  * @brief Gets the index of the next argument parameter.
@@ -53,6 +54,10 @@ int GetArgumentParameter(const QStringList &args, int argIndex) {
  * @brief Destructor for Main class.
  */
 Main::~Main() {
+	if (profileMacros_) {
+		fprintf(stderr, "%s", MacroProfileReport().c_str());
+	}
+
 	CleanupMacroGlobals();
 }
 
@@ -102,7 +107,9 @@ Main::Main(const QStringList &args) {
 
 	/* Process -import command line argument before others which might
 	   open windows (loading preferences doesn't update menu settings,
-	   which would then be out of sync with the real preference settings) */
+	   which would then be out of sync with the real preference settings).
+	   -profile-macros is processed here too, so that it covers the macros
+	   run when the first window opens */
 	for (int i = 1; i < args.size(); ++i) {
 
 		const QString &arg = args[i];
@@ -114,6 +121,9 @@ Main::Main(const QStringList &args) {
 		if (arg == QStringLiteral("-import")) {
 			i = GetArgumentParameter(args, i);
 			Preferences::ImportPrefFile(args[i]);
+		} else if (arg == QStringLiteral("-profile-macros")) {
+			profileMacros_ = true;
+			SetMacroProfiling(true);
 		}
 	}
 
@@ -247,6 +257,8 @@ Main::Main(const QStringList &args) {
 			langMode = args[i];
 		} else if (opts && args[i] == QStringLiteral("-import")) {
 			i = GetArgumentParameter(args, i); // already processed, skip
+		} else if (opts && args[i] == QStringLiteral("-profile-macros")) {
+			// already processed, skip
 		} else if (opts && (args[i] == QStringLiteral("-V") || args[i] == QStringLiteral("-version"))) {
 			const QString infoString = DialogAbout::createInfoString();
 			printf("%s", qPrintable(infoString));
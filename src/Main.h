@@ -22,6 +22,7 @@ private:
 
 private:
 	std::unique_ptr<NeditServer> server_;
+	bool profileMacros_ = false;
 };
 
 #endif
@@ -6894,9 +6894,6 @@ bool MainWindow::searchWindow(DocumentWidget *document, const QString &searchStr
 		return false;
 	}
 
-	// get the entire text buffer from the text area widget
-	const std::string_view fileString = buffer->BufAsString();
-
 	/* If we're already outside the boundaries, we must consider wrapping
 	   immediately (Note: fileEnd+1 is a valid starting position. Consider
 	   searching for $ at the end of a file ending with \n.) */
@@ -6909,8 +6906,8 @@ bool MainWindow::searchWindow(DocumentWidget *document, const QString &searchStr
 	bool found;
 	if (iSearchStartPos_ == -1) { // normal search
 
-		found = !outsideBounds && Search::SearchString(
-									  fileString,
+		found = !outsideBounds && Search::SearchBuffer(
+									  buffer,
 									  searchString,
 									  direction,
 									  searchType,
@@ -6952,8 +6949,8 @@ bool MainWindow::searchWindow(DocumentWidget *document, const QString &searchStr
 						}
 					}
 
-					found = Search::SearchString(
-						fileString,
+					found = Search::SearchBuffer(
+						buffer,
 						searchString,
 						direction,
 						searchType,
@@ -6981,8 +6978,8 @@ bool MainWindow::searchWindow(DocumentWidget *document, const QString &searchStr
 						}
 					}
 
-					found = Search::SearchString(
-						fileString,
+					found = Search::SearchBuffer(
+						buffer,
 						searchString,
 						direction,
 						searchType,
@@ -7007,8 +7004,8 @@ bool MainWindow::searchWindow(DocumentWidget *document, const QString &searchStr
 			outsideBounds = false;
 		}
 
-		found = !outsideBounds && Search::SearchString(
-									  fileString,
+		found = !outsideBounds && Search::SearchBuffer(
+									  buffer,
 									  searchString,
 									  direction,
 									  searchType,
@@ -7770,10 +7767,7 @@ bool MainWindow::replaceAll(DocumentWidget *document, TextArea *area, const QStr
 		delimiters);
 
 	if (!newFileString) {
-		if (document->multiFileBusy_) {
-			// only needed during multi-file replacements
-			document->replaceFailed_ = true;
-		} else if (Preferences::GetPrefSearchDialogs()) {
+		if (Preferences::GetPrefSearchDialogs()) {
 
 			if (dialogFind_) {
 				if (!dialogFind_->keepDialog()) {
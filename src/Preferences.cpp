@@ -1183,6 +1183,10 @@ bool GetPrefUndoModifiesSelection() {
 	return Settings::undoModifiesSelection;
 }
 
+bool GetPrefSyncOnSave() {
+	return Settings::syncOnSave;
+}
+
 bool GetPrefFocusOnRaise() {
 	return Settings::focusOnRaise;
 }
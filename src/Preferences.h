@@ -65,6 +65,7 @@ bool GetPrefTabBarHideOne();
 bool GetPrefToolTips();
 bool GetPrefTypingHidesPointer();
 bool GetPrefUndoModifiesSelection();
+bool GetPrefSyncOnSave();
 bool GetPrefWarnExit();
 bool GetPrefWarnFileMods();
 bool GetPrefWarnRealFileMods();
@@ -130,6 +130,33 @@ size_t RangesetTable::index1ofPos(TextCursor pos, bool needs_color) {
 	return 0;
 }
 
+/**
+ * @brief Collect the positions where the result of index1ofPos(pos, true) may
+ * change within a range of the buffer, which are the starts and ends of the
+ * ranges of colored rangesets which overlap it.
+ *
+ * @param start The start of the range.
+ * @param end The end of the range.
+ * @param boundaries Where to append the positions, unsorted.
+ */
+void RangesetTable::colorBoundaries(TextCursor start, TextCursor end, std::vector<TextCursor> *boundaries) const {
+
+	for (const Rangeset &set : sets_) {
+		if (set.color_set_ < 0 || set.color_name_.isNull()) {
+			continue;
+		}
+
+		auto it = std::upper_bound(set.ranges_.begin(), set.ranges_.end(), start, [](TextCursor pos, const TextRange &range) {
+			return pos < range.end;
+		});
+
+		for (; it != set.ranges_.end() && it->start <= end; ++it) {
+			boundaries->push_back(it->start);
+			boundaries->push_back(it->end);
+		}
+	}
+}
+
 /**
  * @brief Assign a color pixel value to a rangeset via the rangeset table.
  * If the color is invalid, the color_set flag is set to an invalid (negative) value.
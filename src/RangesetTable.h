@@ -26,6 +26,7 @@ public:
 	std::vector<uint8_t> labels() const;
 	void forgetLabel(int label);
 	void assignColor(size_t index, const QColor &color);
+	void colorBoundaries(TextCursor start, TextCursor end, std::vector<TextCursor> *boundaries) const;
 	void updatePos(TextCursor pos, int64_t ins, int64_t del);
 
 public:
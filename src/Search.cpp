@@ -5,15 +5,17 @@
 #include "MainWindow.h"
 #include "Preferences.h"
 #include "Regex.h"
+#include "RegexCache.h"
 #include "TextBuffer.h"
 #include "UserCommands.h"
-#include "Util/String.h"
+#include "Util/LiteralSearch.h"
 #include "Util/algorithm.h"
 #include "Util/utils.h"
 
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 #include <gsl/gsl_util>
 
@@ -28,248 +30,474 @@ Search::HistoryEntry SearchReplaceHistory[MaxSearchHistory];
 int NHist     = 0;
 int HistStart = 0;
 
+// Compiled form of recently used search expressions, shared by every search and replace
+RegexCache CompiledExpressions;
+
 /**
- * @brief
- *
- * @param string
- * @param searchString
- * @param wrap
- * @param beginPos
- * @param delimiters
- * @param defaultFlags
- * @return
+ * @brief The text being searched, as the list of contiguous pieces that it is
+ * stored in. This lets a document's buffer be searched where it lies, rather
+ * than first moving its gap (or otherwise rearranging its storage) to make
+ * the whole text contiguous, which costs as much as a copy of the document.
  */
-std::optional<Search::Result> ForwardRegexSearch(std::string_view string, std::string_view searchString, WrapMode wrap, int64_t beginPos, const char *delimiters, int defaultFlags) {
+class SegmentedText {
+public:
+	struct Segment {
+		std::string_view text;
+		size_t offset; // position of the first character of the segment in the whole text
+	};
 
-	try {
-		Regex compiledRE(searchString, defaultFlags);
+public:
+	explicit SegmentedText(std::string_view string)
+		: string_(string), size_(string.size()) {
+
+		if (!string.empty()) {
+			segments_.push_back({string, 0});
+		}
+	}
+
+	explicit SegmentedText(TextBuffer *buffer)
+		: buffer_(buffer), size_(static_cast<size_t>(buffer->length())) {
+
+		size_t offset = 0;
+		buffer->BufForEachSegment(buffer->BufStartOfBuffer(), buffer->BufEndOfBuffer(), [this, &offset](std::string_view piece) {
+			if (!piece.empty()) {
+				segments_.push_back({piece, offset});
+				offset += piece.size();
+			}
+		});
+	}
 
-		// search from beginPos to end of string
-		if (compiledRE.execute(string, static_cast<size_t>(beginPos), delimiters, false)) {
+public:
+	size_t size() const noexcept {
+		return size_;
+	}
+
+	const std::vector<Segment> &segments() const noexcept {
+		return segments_;
+	}
+
+	/**
+	 * @brief Returns the character at `pos`, which must be less than size().
+	 */
+	char operator[](size_t pos) const noexcept {
+		auto it = std::upper_bound(segments_.begin(), segments_.end(), pos, [](size_t p, const Segment &segment) {
+			return p < segment.offset;
+		});
+
+		--it;
+		return it->text[pos - it->offset];
+	}
+
+	/**
+	 * @brief Returns a copy of the characters in the range [from, to).
+	 */
+	std::string copy(size_t from, size_t to) const {
+		std::string result;
+		result.reserve(to - from);
 
-			Search::Result result;
-			result.start    = compiledRE.startp[0] - string.data();
-			result.end      = compiledRE.endp[0] - string.data();
-			result.extentFW = compiledRE.extentpFW - string.data();
-			result.extentBW = compiledRE.extentpBW - string.data();
-			return result;
+		for (const Segment &segment : segments_) {
+			const size_t first = segment.offset;
+			const size_t last  = segment.offset + segment.text.size();
+			if (last <= from) {
+				continue;
+			}
+
+			if (first >= to) {
+				break;
+			}
+
+			const size_t a = std::max(from, first);
+			const size_t b = std::min(to, last);
+			result.append(segment.text.substr(a - first, b - a));
 		}
 
-		// if wrap turned off, we're done
-		if (wrap == WrapMode::NoWrap) {
-			return {};
+		return result;
+	}
+
+	/**
+	 * @brief Returns the whole text as one contiguous string. For a buffer,
+	 * this moves its gap, or with chunked storage views a copy of its text,
+	 * after which it is searched as a single segment.
+	 */
+	std::string_view contiguous() {
+		if (!buffer_) {
+			return string_;
 		}
 
-		// search from the beginning of the string to beginPos
-		if (compiledRE.execute(string, 0, static_cast<size_t>(beginPos), delimiters, false)) {
+		string_ = buffer_->BufAsString();
+		buffer_ = nullptr;
 
-			Search::Result result;
-			result.start    = compiledRE.startp[0] - string.data();
-			result.end      = compiledRE.endp[0] - string.data();
-			result.extentFW = compiledRE.extentpFW - string.data();
-			result.extentBW = compiledRE.extentpBW - string.data();
-			return result;
+		segments_.clear();
+		if (!string_.empty()) {
+			segments_.push_back({string_, 0});
 		}
 
-		return {};
-	} catch (const RegexError &e) {
-		Q_UNUSED(e)
-		/* Note that this does not process errors from compiling the expression.
-		 * It assumes that the expression was checked earlier.
-		 */
-		return {};
+		return string_;
 	}
-}
 
-/**
- * @brief
- *
- * @param string
- * @param searchString
- * @param wrap
- * @param beginPos
- * @param delimiters
- * @param defaultFlags
- * @return
- */
-std::optional<Search::Result> BackwardRegexSearch(std::string_view string, std::string_view searchString, WrapMode wrap, int64_t beginPos, const char *delimiters, int defaultFlags) {
+	/**
+	 * @brief Returns the position of the first match of `search` which starts
+	 * in the range [from, to), or npos. Each segment is searched directly, and
+	 * the matches which straddle the end of a segment are looked for in a copy
+	 * of the few characters on either side of it.
+	 */
+	size_t forward(const LiteralSearch &search, size_t from, size_t to) const {
 
-	try {
-		Regex compiledRE(searchString, defaultFlags);
+		constexpr size_t npos = LiteralSearch::npos;
+		const size_t m        = search.size();
+		to                    = std::min(to, size_);
 
-		// search from beginPos to start of file.  A negative begin pos
-		// says begin searching from the far end of the file.
-		if (beginPos >= 0) {
-			if (compiledRE.execute(string, 0, static_cast<size_t>(beginPos), -1, -1, delimiters, true)) {
-
-				Search::Result result;
-				result.start    = compiledRE.startp[0] - string.data();
-				result.end      = compiledRE.endp[0] - string.data();
-				result.extentFW = compiledRE.extentpFW - string.data();
-				result.extentBW = compiledRE.extentpBW - string.data();
-				return result;
+		for (const Segment &segment : segments_) {
+			const size_t first = segment.offset;
+			const size_t last  = segment.offset + segment.text.size();
+			if (last <= from) {
+				continue;
 			}
-		}
 
-		// if wrap turned off, we're done
-		if (wrap == WrapMode::NoWrap) {
-			return {};
-		}
+			if (first >= to) {
+				break;
+			}
+
+			const size_t a = std::max(from, first);
+			const size_t b = std::min(to, last);
 
-		// search from the end of the string to beginPos
-		if (beginPos < 0) {
-			beginPos = 0;
+			const size_t pos = search.forward(segment.text, a - first, b - first);
+			if (pos != npos) {
+				return first + pos;
+			}
+
+			if (last < size_ && m > 1) {
+				const size_t lo = std::max(a, last - std::min(last, m - 1));
+				if (lo < b) {
+					const std::string window = copy(lo, std::min(size_, b - 1 + m));
+					const size_t p           = search.forward(window, 0, b - lo);
+					if (p != npos) {
+						return lo + p;
+					}
+				}
+			}
 		}
 
-		if (compiledRE.execute(string, static_cast<size_t>(beginPos), delimiters, true)) {
-			Search::Result result;
-			result.start    = compiledRE.startp[0] - string.data();
-			result.end      = compiledRE.endp[0] - string.data();
-			result.extentFW = compiledRE.extentpFW - string.data();
-			result.extentBW = compiledRE.extentpBW - string.data();
-			return result;
+		return npos;
+	}
+
+	/**
+	 * @brief Returns the position of the last match of `search` which starts
+	 * in the range [from, to), or npos.
+	 */
+	size_t backward(const LiteralSearch &search, size_t from, size_t to) const {
+
+		constexpr size_t npos = LiteralSearch::npos;
+		const size_t m        = search.size();
+		to                    = std::min(to, size_);
+
+		for (auto it = segments_.rbegin(); it != segments_.rend(); ++it) {
+			const size_t first = it->offset;
+			const size_t last  = it->offset + it->text.size();
+			if (first >= to) {
+				continue;
+			}
+
+			if (last <= from) {
+				break;
+			}
+
+			const size_t a = std::max(from, first);
+			const size_t b = std::min(to, last);
+
+			if (last < size_ && m > 1) {
+				const size_t lo = std::max(a, last - std::min(last, m - 1));
+				if (lo < b) {
+					const std::string window = copy(lo, std::min(size_, b - 1 + m));
+					const size_t p           = search.backward(window, 0, b - lo);
+					if (p != npos) {
+						return lo + p;
+					}
+				}
+			}
+
+			const size_t pos = search.backward(it->text, a - first, b - first);
+			if (pos != npos) {
+				return first + pos;
+			}
 		}
 
-		return {};
-	} catch (const RegexError &e) {
-		Q_UNUSED(e)
-		/* Note that this does not process errors from compiling the expression.
-		 * It assumes that the expression was checked earlier.
-		 */
-		return {};
+		return npos;
 	}
+
+private:
+	TextBuffer *buffer_ = nullptr;
+	std::string_view string_;
+	std::vector<Segment> segments_;
+	size_t size_;
+};
+
+/**
+ * @brief Converts a successful regex match to a search result.
+ *
+ * @param match The match.
+ * @param base The address of the character at position `offset`.
+ * @param offset The position of `base` in the whole text.
+ * @return The search result.
+ */
+Search::Result MakeResult(const RegexMatch &match, const char *base, size_t offset) {
+	const auto origin = gsl::narrow<int64_t>(offset);
+
+	Search::Result result;
+	result.start    = origin + (match.startp[0] - base);
+	result.end      = origin + (match.endp[0] - base);
+	result.extentFW = origin + (match.extentpFW - base);
+	result.extentBW = origin + (match.extentpBW - base);
+	return result;
 }
 
 /**
- * @brief
+ * @brief Finds the first (or, in reverse, the last) match of `re` which starts
+ * in the range [from, to), where `to` may be one past the end of the text.
  *
- * @param string
- * @param searchString
- * @param direction
- * @param wrap
- * @param beginPos
- * @param delimiters
- * @param defaultFlags
- * @return
+ * Each segment is searched where it lies. If an attempt needs to look beyond
+ * the segment it started in, that segment's result can't be trusted, so the
+ * rest of the range is searched again in a contiguous copy of the text.
+ *
+ * @param re The compiled regular expression.
+ * @param text The text to search.
+ * @param from The first position at which a match may start.
+ * @param to One past the last position at which a match may start.
+ * @param reverse If true, find the last match rather than the first.
+ * @param delimiters The word delimiters, or nullptr for the default set.
+ * @return The match, if any.
  */
-std::optional<Search::Result> SearchRegex(std::string_view string, std::string_view searchString, Direction direction, WrapMode wrap, int64_t beginPos, const char *delimiters, int defaultFlags) {
+std::optional<Search::Result> FindRegex(const Regex &re, SegmentedText &text, size_t from, size_t to, bool reverse, const char *delimiters) {
+
+	const size_t length  = text.size();
+	const auto &segments = text.segments();
+	RegexMatch match;
 
-	switch (direction) {
-	case Direction::Forward:
-		return ForwardRegexSearch(string, searchString, wrap, beginPos, delimiters, defaultFlags);
-	case Direction::Backward:
-		return BackwardRegexSearch(string, searchString, wrap, beginPos, delimiters, defaultFlags);
+	auto searchContiguous = [&](size_t a, size_t b) -> std::optional<Search::Result> {
+		const std::string_view string = text.contiguous();
+		const int prev                = (a == 0) ? -1 : string[a - 1];
+
+		if (re.execute(&match, string, a, reverse ? b - 1 : std::min(b, length), prev, -1, delimiters, reverse)) {
+			return MakeResult(match, string.data(), 0);
+		}
+
+		return {};
+	};
+
+	if (from >= to) {
+		return {};
 	}
 
-	Q_UNREACHABLE();
+	if (segments.empty()) {
+		return searchContiguous(from, to);
+	}
+
+	auto searchSegment = [&](size_t index, size_t a, size_t b) {
+		const SegmentedText::Segment &segment = segments[index];
+		const size_t last                     = segment.offset + segment.text.size();
+		const bool lastSegment                = (index + 1 == segments.size());
+		const char *base                      = segment.text.data();
+
+		const int prev = (a == 0) ? -1 : text[a - 1];
+		const int succ = lastSegment ? -1 : text[last];
+		const char *p  = base + (a - segment.offset);
+		const char *q  = base + ((reverse ? b - 1 : b) - segment.offset);
+
+		return re.ExecRE(&match, p, q, reverse, prev, succ, delimiters, base, nullptr, base + segment.text.size());
+	};
+
+	if (!reverse) {
+		for (size_t i = 0; i < segments.size(); ++i) {
+			const size_t first = segments[i].offset;
+			const size_t last  = first + segments[i].text.size();
+			if (last <= from && i + 1 != segments.size()) {
+				continue;
+			}
+
+			if (first >= to) {
+				break;
+			}
+
+			const size_t a = std::max(from, first);
+			const size_t b = std::min(to, last);
+
+			const bool found = searchSegment(i, a, b);
+			if ((match.hitStart && i != 0) || (match.hitEnd && i + 1 != segments.size())) {
+				return searchContiguous(a, to);
+			}
+
+			if (found) {
+				return MakeResult(match, segments[i].text.data(), first);
+			}
+		}
+	} else {
+		for (size_t i = segments.size(); i-- > 0;) {
+			const size_t first = segments[i].offset;
+			const size_t last  = first + segments[i].text.size() + (i + 1 == segments.size() ? 1 : 0);
+			if (first >= to) {
+				continue;
+			}
+
+			if (last <= from) {
+				break;
+			}
+
+			const size_t a = std::max(from, first);
+			const size_t b = std::min(to, last);
+
+			const bool found = searchSegment(i, a, b);
+			if ((match.hitStart && i != 0) || (match.hitEnd && i + 1 != segments.size())) {
+				return searchContiguous(from, b);
+			}
+
+			if (found) {
+				return MakeResult(match, segments[i].text.data(), first);
+			}
+		}
+	}
+
+	return {};
 }
 
 /**
  * @brief
  *
- * @param string
+ * @param text
  * @param searchString
- * @param caseSensitivity
  * @param direction
  * @param wrap
  * @param beginPos
+ * @param delimiters
+ * @param defaultFlags
  * @return
  */
-std::optional<Search::Result> SearchLiteral(std::string_view string, std::string_view searchString, Direction direction, WrapMode wrap, int64_t beginPos, Qt::CaseSensitivity caseSensitivity) {
+std::optional<Search::Result> SearchRegex(SegmentedText &text, std::string_view searchString, Direction direction, WrapMode wrap, int64_t beginPos, const char *delimiters, int defaultFlags) {
 
-	if (searchString.empty()) {
-		return {};
-	}
+	try {
+		const std::shared_ptr<const Regex> compiledRE = CompiledExpressions.get(searchString, defaultFlags);
 
-	std::string lcString;
-	std::string ucString;
+		const size_t length = text.size();
+		const auto begin    = static_cast<size_t>(std::clamp<int64_t>(beginPos, 0, gsl::narrow<int64_t>(length)));
 
-	if (caseSensitivity == Qt::CaseSensitive) {
-		lcString = std::string(searchString);
-		ucString = std::string(searchString);
-	} else {
-		ucString = ToUpper(searchString);
-		lcString = ToLower(searchString);
-	}
-
-	const auto first = string.begin();
-	const auto mid   = first + beginPos;
-	const auto last  = string.end();
-
-	auto do_search = [&](std::string_view::iterator it) -> std::optional<Search::Result> {
-		if (*it == ucString[0] || *it == lcString[0]) {
-			// matched first character
-			auto ucPtr   = ucString.begin();
-			auto lcPtr   = lcString.begin();
-			auto tempPtr = it;
-
-			while (tempPtr != last && (*tempPtr == *ucPtr || *tempPtr == *lcPtr)) {
-				++tempPtr;
-				++ucPtr;
-				++lcPtr;
-
-				if (ucPtr == ucString.end()) {
-					// matched whole string
-					Search::Result result;
-					result.start    = it - string.begin();
-					result.end      = tempPtr - string.begin();
-					result.extentBW = result.start;
-					result.extentFW = result.end;
-					return result;
-				}
+		std::optional<Search::Result> result;
+
+		if (direction == Direction::Forward) {
+			// search from beginPos to end of string, then from start of string to beginPos
+			result = FindRegex(*compiledRE, text, begin, length + 1, false, delimiters);
+			if (!result && wrap == WrapMode::Wrap) {
+				result = FindRegex(*compiledRE, text, 0, begin, false, delimiters);
+			}
+		} else {
+			// search from beginPos to start of file.  A negative begin pos
+			// says begin searching from the far end of the file.
+			if (beginPos >= 0) {
+				result = FindRegex(*compiledRE, text, 0, begin + 1, true, delimiters);
+			}
+
+			if (!result && wrap == WrapMode::Wrap) {
+				result = FindRegex(*compiledRE, text, begin, length + 1, true, delimiters);
 			}
 		}
 
+		return result;
+	} catch (const RegexError &e) {
+		Q_UNUSED(e)
+		/* Note that this does not process errors from compiling the expression.
+		 * It assumes that the expression was checked earlier.
+		 */
 		return {};
-	};
+	}
+}
 
-	if (direction == Direction::Forward) {
+/**
+ * @brief Finds the first match of `search` in `text`, in the order that
+ * the search direction and wrap mode visit them, which `accept` agrees with.
+ *
+ * @param text The text to search.
+ * @param search The compiled literal search.
+ * @param direction The direction to search in.
+ * @param wrap Whether to wrap around the start/end of the string.
+ * @param beginPos The position to start searching from. A negative position
+ * when searching backwards means starting at the far end of the string.
+ * @param accept Called with the position of each candidate match, returns
+ * true if it should be reported.
+ * @return The match, if any.
+ */
+template <class Pred>
+std::optional<Search::Result> FindLiteral(const SegmentedText &text, const LiteralSearch &search, Direction direction, WrapMode wrap, int64_t beginPos, Pred accept) {
 
-		// search from beginPos to end of string
-		for (auto it = mid; it != last; ++it) {
-			if (std::optional<Search::Result> result = do_search(it)) {
-				return result;
-			}
-		}
+	constexpr size_t npos = LiteralSearch::npos;
+	const size_t length   = text.size();
+	const auto begin      = static_cast<size_t>(std::clamp<int64_t>(beginPos, 0, gsl::narrow<int64_t>(length)));
 
-		if (wrap == WrapMode::NoWrap) {
-			return {};
+	auto findForward = [&](size_t from, size_t to) {
+		for (size_t pos = text.forward(search, from, to); pos != npos; pos = text.forward(search, pos + 1, to)) {
+			if (accept(pos)) {
+				return pos;
+			}
 		}
+		return npos;
+	};
 
-		// search from start of file to beginPos
-		for (auto it = first; it != mid; ++it) {
-			if (std::optional<Search::Result> result = do_search(it)) {
-				return result;
+	auto findBackward = [&](size_t from, size_t to) {
+		for (size_t pos = text.backward(search, from, to); pos != npos; pos = text.backward(search, from, pos)) {
+			if (accept(pos)) {
+				return pos;
 			}
 		}
+		return npos;
+	};
 
-		return {};
-	}
+	size_t pos = npos;
 
-	// Direction::Backward
-	// search from beginPos to start of file.  A negative begin pos
-	// says begin searching from the far end of the file
+	if (direction == Direction::Forward) {
+		// search from beginPos to end of string, then from start of string to beginPos
+		pos = findForward(begin, length);
+		if (pos == npos && wrap == WrapMode::Wrap) {
+			pos = findForward(0, begin);
+		}
+	} else {
+		// search from beginPos to start of string, then from end of string to beginPos
+		if (beginPos >= 0) {
+			pos = findBackward(0, begin + 1);
+		}
 
-	if (beginPos >= 0) {
-		for (auto it = mid; it >= first; --it) {
-			if (std::optional<Search::Result> result = do_search(it)) {
-				return result;
-			}
+		if (pos == npos && wrap == WrapMode::Wrap) {
+			pos = findBackward(begin, length + 1);
 		}
 	}
 
-	if (wrap == WrapMode::NoWrap) {
+	if (pos == npos) {
 		return {};
 	}
 
-	// search from end of file to beginPos
-	for (auto it = last; it >= mid; --it) {
-		if (std::optional<Search::Result> result = do_search(it)) {
-			return result;
-		}
+	Search::Result result;
+	result.start    = gsl::narrow<int64_t>(pos);
+	result.end      = gsl::narrow<int64_t>(pos + search.size());
+	result.extentBW = result.start;
+	result.extentFW = result.end;
+	return result;
+}
+
+/**
+ * @brief
+ *
+ * @param text
+ * @param searchString
+ * @param caseSensitivity
+ * @param direction
+ * @param wrap
+ * @param beginPos
+ * @return
+ */
+std::optional<Search::Result> SearchLiteral(const SegmentedText &text, std::string_view searchString, Direction direction, WrapMode wrap, int64_t beginPos, Qt::CaseSensitivity caseSensitivity) {
+
+	if (searchString.empty()) {
+		return {};
 	}
 
-	return {};
+	const LiteralSearch search(searchString, caseSensitivity == Qt::CaseSensitive);
+	return FindLiteral(text, search, direction, wrap, beginPos, [](size_t) { return true; });
 }
 
 /*
@@ -286,145 +514,54 @@ std::optional<Search::Result> SearchLiteral(std::string_view string, std::string
 **  will suffice in that case.
 **
 */
-std::optional<Search::Result> SearchLiteralWord(std::string_view string, std::string_view searchString, Direction direction, WrapMode wrap, int64_t beginPos, const char *delimiters, Qt::CaseSensitivity caseSensitivity) {
+std::optional<Search::Result> SearchLiteralWord(const SegmentedText &text, std::string_view searchString, Direction direction, WrapMode wrap, int64_t beginPos, const char *delimiters, Qt::CaseSensitivity caseSensitivity) {
 
 	if (searchString.empty()) {
 		return {};
 	}
 
-	std::string lcString;
-	std::string ucString;
-	bool cignore_L = false;
-	bool cignore_R = false;
-
-	const auto first = string.begin();
-	const auto mid   = first + beginPos;
-	const auto last  = string.end();
-
-	auto do_search_word = [&](const std::string_view::iterator it) -> std::optional<Search::Result> {
-		if (*it == ucString[0] || *it == lcString[0]) {
-
-			// matched first character
-			auto ucPtr   = ucString.begin();
-			auto lcPtr   = lcString.begin();
-			auto tempPtr = it;
-
-			while (tempPtr != last && (*tempPtr == *ucPtr || *tempPtr == *lcPtr)) {
-				++tempPtr;
-				++ucPtr;
-				++lcPtr;
-
-				if (ucPtr == ucString.end() &&                                                 // matched whole string
-					(cignore_R || safe_isspace(*tempPtr) || ::strchr(delimiters, *tempPtr)) && // next char right delimits word ?
-					(cignore_L || it == string.begin() ||                                      // border case
-					 safe_isspace(it[-1]) || ::strchr(delimiters, it[-1]))) {                  // next char left delimits word ?
-
-					Search::Result result;
-					result.start    = it - string.begin();
-					result.end      = tempPtr - string.begin();
-					result.extentBW = result.start;
-					result.extentFW = result.end;
-					return result;
-				}
-
-				// NOTE(eteran): this doesn't seem possible, but just being careful
-				if (ucPtr == ucString.end()) {
-					break;
-				}
-			}
-		}
-
-		return {};
-	};
-
 	// If there is no language mode, we use the default list of delimiters
 	const QByteArray delimiterString = Preferences::GetPrefDelimiters().toLatin1();
 	if (!delimiters) {
 		delimiters = delimiterString.data();
 	}
 
-	if (safe_isspace(searchString.front()) || ::strchr(delimiters, searchString.front())) {
-		cignore_L = true;
-	}
-
-	if (safe_isspace(searchString.back()) || ::strchr(delimiters, searchString.back())) {
-		cignore_R = true;
-	}
-
-	if (caseSensitivity == Qt::CaseSensitive) {
-		ucString = std::string(searchString);
-		lcString = std::string(searchString);
-	} else {
-		ucString = ToUpper(searchString);
-		lcString = ToLower(searchString);
-	}
-
-	if (direction == Direction::Forward) {
-
-		// search from beginPos to end of string
-		for (auto it = mid; it != last; ++it) {
-			if (std::optional<Search::Result> result = do_search_word(it)) {
-				return result;
-			}
-		}
-
-		if (wrap == WrapMode::NoWrap) {
-			return {};
-		}
-
-		// search from start of file to beginPos
-		for (auto it = first; it != mid; ++it) {
-			if (std::optional<Search::Result> result = do_search_word(it)) {
-				return result;
-			}
-		}
-		return {};
-	}
+	auto isDelimiter = [delimiters](char ch) {
+		return safe_isspace(ch) || ::strchr(delimiters, ch);
+	};
 
-	// Direction::Backward
-	// search from beginPos to start of file. A negative begin pos
-	// says begin searching from the far end of the file
-	if (beginPos >= 0) {
-		for (auto it = mid; it >= first; --it) {
-			if (std::optional<Search::Result> result = do_search_word(it)) {
-				return result;
-			}
-		}
-	}
+	const bool cignore_L = isDelimiter(searchString.front());
+	const bool cignore_R = isDelimiter(searchString.back());
 
-	if (wrap == WrapMode::NoWrap) {
-		return {};
-	}
+	const LiteralSearch search(searchString, caseSensitivity == Qt::CaseSensitive);
 
-	// search from end of file to beginPos
-	for (auto it = last; it >= mid; --it) {
-		if (std::optional<Search::Result> result = do_search_word(it)) {
-			return result;
-		}
-	}
-	return {};
+	return FindLiteral(text, search, direction, wrap, beginPos, [&](size_t pos) {
+		const size_t end = pos + search.size();
+		return (cignore_R || end == text.size() || isDelimiter(text[end])) && // next char right delimits word ?
+			   (cignore_L || pos == 0 || isDelimiter(text[pos - 1]));          // next char left delimits word ?
+	});
 }
 
 /*
-** Search the string "string" for "searchString", beginning at "beginPos".
+** Search the text "text" for "searchString", beginning at "beginPos".
 ** "delimiters" may be used to provide an alternative set of word delimiters
 ** for regular expression "<" and ">" characters, or simply passed as nullptr
 ** for the default delimiter set.
 */
-std::optional<Search::Result> SearchStringEx(std::string_view string, std::string_view searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, const char *delimiters) {
+std::optional<Search::Result> SearchStringEx(SegmentedText &text, std::string_view searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, const char *delimiters) {
 	switch (searchType) {
 	case SearchType::CaseSenseWord:
-		return SearchLiteralWord(string, searchString, direction, wrap, beginPos, delimiters, Qt::CaseSensitive);
+		return SearchLiteralWord(text, searchString, direction, wrap, beginPos, delimiters, Qt::CaseSensitive);
 	case SearchType::LiteralWord:
-		return SearchLiteralWord(string, searchString, direction, wrap, beginPos, delimiters, Qt::CaseInsensitive);
+		return SearchLiteralWord(text, searchString, direction, wrap, beginPos, delimiters, Qt::CaseInsensitive);
 	case SearchType::CaseSense:
-		return SearchLiteral(string, searchString, direction, wrap, beginPos, Qt::CaseSensitive);
+		return SearchLiteral(text, searchString, direction, wrap, beginPos, Qt::CaseSensitive);
 	case SearchType::Literal:
-		return SearchLiteral(string, searchString, direction, wrap, beginPos, Qt::CaseInsensitive);
+		return SearchLiteral(text, searchString, direction, wrap, beginPos, Qt::CaseInsensitive);
 	case SearchType::Regex:
-		return SearchRegex(string, searchString, direction, wrap, beginPos, delimiters, RE_DEFAULT_STANDARD);
+		return SearchRegex(text, searchString, direction, wrap, beginPos, delimiters, RE_DEFAULT_STANDARD);
 	case SearchType::RegexNoCase:
-		return SearchRegex(string, searchString, direction, wrap, beginPos, delimiters, RE_DEFAULT_CASE_INSENSITIVE);
+		return SearchRegex(text, searchString, direction, wrap, beginPos, delimiters, RE_DEFAULT_CASE_INSENSITIVE);
 	}
 
 	Q_UNREACHABLE();
@@ -432,19 +569,20 @@ std::optional<Search::Result> SearchStringEx(std::string_view string, std::strin
 
 /*
 ** Substitutes a replace string for a string that was matched using a
-** regular expression.  This was added later and is rather inefficient
-** because instead of using the compiled regular expression that was used
-** to make the match in the first place, it re-compiles the expression
-** and redoes the search on the already-matched string.  This allows the
-** code to continue using strings to represent the search and replace
-** items.
+** regular expression.  Instead of using the compiled regular expression
+** that was used to make the match in the first place, it looks the
+** expression up again (normally finding it in the cache of compiled
+** expressions) and redoes the search on the already-matched string.  This
+** allows the code to continue using strings to represent the search and
+** replace items.
 */
 bool ReplaceUsingRegex(std::string_view searchStr, std::string_view replaceStr, std::string_view sourceStr, int64_t beginPos, std::string &dest, int prevChar, const char *delimiters, int defaultFlags) {
 	// TODO(eteran): just return an optional<std::string>
 	try {
-		Regex compiledRE(searchStr, defaultFlags);
-		compiledRE.execute(sourceStr, static_cast<size_t>(beginPos), sourceStr.size(), prevChar, -1, delimiters, false);
-		return compiledRE.SubstituteRE(replaceStr, dest);
+		const std::shared_ptr<const Regex> compiledRE = CompiledExpressions.get(searchStr, defaultFlags);
+		RegexMatch match;
+		compiledRE->execute(&match, sourceStr, static_cast<size_t>(beginPos), sourceStr.size(), prevChar, -1, delimiters, false);
+		return compiledRE->SubstituteRE(match, replaceStr, dest);
 	} catch (const RegexError &e) {
 		Q_UNUSED(e)
 		return false;
@@ -458,134 +596,75 @@ bool ReplaceUsingRegex(std::string_view searchStr, std::string_view replaceStr,
 ** and return a string covering the range between the start of the
 ** first replacement (returned in "copyStart", and the end of the last
 ** replacement (returned in "copyEnd")
+**
+** This only reads "inString" and its other arguments, so it is safe to call
+** from a worker thread on a snapshot of a document's text.
 */
 std::optional<std::string> Search::ReplaceAllInString(std::string_view inString, const QString &searchString, const QString &replaceString, SearchType searchType, int64_t *copyStart, int64_t *copyEnd, const QString &delimiters) {
 
-	Result searchResult;
-	int64_t lastEndPos;
-
 	// reject empty string
 	if (searchString.isNull()) {
 		return {};
 	}
 
-	/* rehearse the search first to determine the size of the buffer needed
-	   to hold the substituted text.  No substitution done here yet */
-	bool found           = true;
-	const int replaceLen = replaceString.size();
-	int nFound           = 0;
-	int64_t removeLen    = 0;
-	int64_t addLen       = 0;
-	int64_t beginPos     = 0;
+	// convert the strings once, rather than once per match
+	const std::string searchStr    = searchString.toStdString();
+	const std::string replaceStr   = replaceString.toStdString();
+	const QByteArray delimitersStr = delimiters.toLatin1();
+	const char *delimitersPtr      = delimiters.isNull() ? nullptr : delimitersStr.data();
+	const bool isRegex             = IsRegexType(searchType);
+	const int defaultFlags         = DefaultRegexFlags(searchType);
 
-	*copyStart = -1;
+	/* Substitute as we go, copying the text between the replacements to the
+	   new buffer. There is no need to rehearse the whole search first just to
+	   find out how large the result will be */
+	std::string outString;
+	int64_t beginPos   = 0;
+	int64_t lastEndPos = -1;
 
-	while (found) {
-		found = SearchString(
-			inString,
-			searchString,
-			Direction::Forward,
-			searchType,
-			WrapMode::NoWrap,
-			beginPos,
-			&searchResult,
-			delimiters);
-
-		if (found) {
-			if (*copyStart < 0) {
-				*copyStart = searchResult.start;
-			}
+	*copyStart = -1;
 
-			*copyEnd = searchResult.end;
-			// start next after match unless match was empty, then endPos+1
-			beginPos = (searchResult.start == searchResult.end) ? searchResult.end + 1 : searchResult.end;
-			++nFound;
-			removeLen += searchResult.end - searchResult.start;
-			if (IsRegexType(searchType)) {
-				std::string replaceResult;
-
-				ReplaceUsingRE(
-					searchString,
-					replaceString,
-					inString.substr(static_cast<size_t>(searchResult.extentBW)),
-					searchResult.start - searchResult.extentBW,
-					replaceResult,
-					searchResult.start == 0 ? -1 : inString[static_cast<size_t>(searchResult.start) - 1],
-					delimiters,
-					DefaultRegexFlags(searchType));
-
-				addLen += gsl::narrow<int64_t>(replaceResult.size());
-			} else {
-				addLen += replaceLen;
-			}
+	SegmentedText text(inString);
+	while (std::optional<Result> searchResult = SearchStringEx(text, searchStr, Direction::Forward, searchType, WrapMode::NoWrap, beginPos, delimitersPtr)) {
 
-			if (searchResult.end == gsl::narrow<int64_t>(inString.size())) {
-				break;
-			}
+		if (lastEndPos < 0) {
+			*copyStart = searchResult->start;
+		} else {
+			outString.append(inString.substr(static_cast<size_t>(lastEndPos), static_cast<size_t>(searchResult->start - lastEndPos)));
 		}
-	}
-
-	if (nFound == 0) {
-		return {};
-	}
-
-	const int64_t copyLen = *copyEnd - *copyStart;
 
-	std::string outString;
-	outString.reserve(static_cast<size_t>(copyLen - removeLen + addLen));
-
-	/* Scan through the text buffer again, substituting the replace string
-	   and copying the part between replaced text to the new buffer  */
-	found      = true;
-	beginPos   = {};
-	lastEndPos = {};
-
-	while (found) {
-		found = SearchString(
-			inString,
-			searchString,
-			Direction::Forward,
-			searchType,
-			WrapMode::NoWrap,
-			beginPos,
-			&searchResult,
-			delimiters);
-
-		if (found) {
-			if (beginPos != 0) {
-				outString.append(
-					&inString[static_cast<size_t>(lastEndPos)],
-					&inString[static_cast<size_t>(lastEndPos + (searchResult.start - lastEndPos))]);
-			}
-
-			if (IsRegexType(searchType)) {
-				std::string replaceResult;
-
-				ReplaceUsingRE(
-					searchString,
-					replaceString,
-					inString.substr(static_cast<size_t>(searchResult.extentBW)),
-					searchResult.start - searchResult.extentBW,
-					replaceResult,
-					searchResult.start == 0 ? -1 : inString[static_cast<size_t>(searchResult.start) - 1],
-					delimiters,
-					DefaultRegexFlags(searchType));
-
-				outString.append(replaceResult);
-			} else {
-				outString.append(replaceString.toStdString());
-			}
+		if (isRegex) {
+			std::string replaceResult;
+
+			ReplaceUsingRegex(
+				searchStr,
+				replaceStr,
+				inString.substr(static_cast<size_t>(searchResult->extentBW)),
+				searchResult->start - searchResult->extentBW,
+				replaceResult,
+				searchResult->start == 0 ? -1 : inString[static_cast<size_t>(searchResult->start) - 1],
+				delimitersPtr,
+				defaultFlags);
+
+			outString.append(replaceResult);
+		} else {
+			outString.append(replaceStr);
+		}
 
-			lastEndPos = searchResult.end;
+		lastEndPos = searchResult->end;
 
-			// start next after match unless match was empty, then endPos+1
-			beginPos = (searchResult.start == searchResult.end) ? searchResult.end + 1 : searchResult.end;
-			if (searchResult.end == gsl::narrow<int64_t>(inString.size())) {
-				break;
-			}
+		// start next after match unless match was empty, then endPos+1
+		beginPos = (searchResult->start == searchResult->end) ? searchResult->end + 1 : searchResult->end;
+		if (searchResult->end == gsl::narrow<int64_t>(inString.size())) {
+			break;
 		}
 	}
 
+	if (lastEndPos < 0) {
+		return {};
+	}
+
+	*copyEnd = lastEndPos;
 	return outString;
 }
 
@@ -602,7 +681,8 @@ std::optional<std::string> Search::ReplaceAllInString(std::string_view inString,
  * @return
  */
 std::optional<Search::Result> Search::SearchString(std::string_view string, const QString &searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, const QString &delimiters) {
-	return SearchStringEx(string, searchString.toStdString(), direction, searchType, wrap, beginPos, delimiters.isNull() ? nullptr : delimiters.toLatin1().data());
+	SegmentedText text(string);
+	return SearchStringEx(text, searchString.toStdString(), direction, searchType, wrap, beginPos, delimiters.isNull() ? nullptr : delimiters.toLatin1().data());
 }
 
 /**
@@ -630,6 +710,53 @@ bool Search::SearchString(std::string_view string, const QString &searchString,
 	return false;
 }
 
+/**
+ * @brief Searches the text of `buffer` in place, without moving its gap or
+ * otherwise making it contiguous, unless a regular expression needs to look
+ * across the boundary between two of its pieces.
+ *
+ * @param buffer
+ * @param searchString
+ * @param direction
+ * @param searchType
+ * @param wrap
+ * @param beginPos
+ * @param delimiters
+ * @return
+ */
+std::optional<Search::Result> Search::SearchBuffer(TextBuffer *buffer, const QString &searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, const QString &delimiters) {
+
+	assert(buffer);
+
+	SegmentedText text(buffer);
+	return SearchStringEx(text, searchString.toStdString(), direction, searchType, wrap, beginPos, delimiters.isNull() ? nullptr : delimiters.toLatin1().data());
+}
+
+/**
+ * @brief
+ *
+ * @param buffer
+ * @param searchString
+ * @param direction
+ * @param searchType
+ * @param wrap
+ * @param beginPos
+ * @param result
+ * @param delimiters
+ * @return
+ */
+bool Search::SearchBuffer(TextBuffer *buffer, const QString &searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, Result *result, const QString &delimiters) {
+
+	assert(result);
+
+	if (std::optional<Result> r = SearchBuffer(buffer, searchString, direction, searchType, wrap, beginPos, delimiters)) {
+		*result = *r;
+		return true;
+	}
+
+	return false;
+}
+
 /**
  * @brief
  *
@@ -793,3 +920,13 @@ auto Search::HistoryByIndex(int index) -> HistoryEntry * {
 
 	return &SearchReplaceHistory[n];
 }
+
+/**
+ * @brief Returns the hit, miss and eviction counts of the cache of compiled
+ * expressions used by searches and replacements.
+ *
+ * @return The cache statistics.
+ */
+RegexCache::Statistics Search::RegexCacheStatistics() {
+	return CompiledExpressions.statistics();
+}
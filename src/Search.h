@@ -3,7 +3,9 @@
 #define SEARCH_H_
 
 #include "Direction.h"
+#include "RegexCache.h"
 #include "SearchType.h"
+#include "TextBufferFwd.h"
 #include "WrapMode.h"
 
 #include <QString>
@@ -33,6 +35,8 @@ struct Result {
 
 bool IsRegexType(SearchType searchType);
 bool ReplaceUsingRE(const QString &searchStr, const QString &replaceStr, std::string_view sourceStr, int64_t beginPos, std::string &dest, int prevChar, const QString &delimiters, int defaultFlags);
+bool SearchBuffer(TextBuffer *buffer, const QString &searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, Result *result, const QString &delimiters);
+std::optional<Result> SearchBuffer(TextBuffer *buffer, const QString &searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, const QString &delimiters);
 bool SearchString(std::string_view string, const QString &searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, Result *result, const QString &delimiters);
 std::optional<Result> SearchString(std::string_view string, const QString &searchString, Direction direction, SearchType searchType, WrapMode wrap, int64_t beginPos, const QString &delimiters);
 int DefaultRegexFlags(SearchType searchType);
@@ -40,6 +44,7 @@ int HistoryIndex(int nCycles);
 std::optional<std::string> ReplaceAllInString(std::string_view inString, const QString &searchString, const QString &replaceString, SearchType searchType, int64_t *copyStart, int64_t *copyEnd, const QString &delimiters);
 void SaveSearchHistory(const QString &searchString, QString replaceString, SearchType searchType, bool isIncremental);
 HistoryEntry *HistoryByIndex(int index);
+RegexCache::Statistics RegexCacheStatistics();
 
 }
 
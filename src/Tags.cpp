@@ -5,6 +5,7 @@
 #include "MainWindow.h"
 #include "Preferences.h"
 #include "Search.h"
+#include "TagsDatabase.h"
 #include "TextArea.h"
 #include "TextBuffer.h"
 #include "Util/FileSystem.h"
@@ -20,11 +21,15 @@
 #include <QRegularExpression>
 #include <QTextStream>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <deque>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <vector>
 
 #ifdef Q_OS_UNIX
 #include <sys/param.h>
@@ -38,6 +43,8 @@ namespace {
 
 int LoadTagsFile(const QString &tagSpec, int index, int recLevel);
 QList<Tag> GetUniqueTags(QList<Tag> &tags);
+std::optional<Tag> ParseCTagsLine(const QString &line, const QString &tagPath, int index);
+bool ParseETagsDefinition(const QString &line, const QString &file, const QString &tagPath, int index, std::optional<Tag> *tag);
 
 struct CalltipAlias {
 	QString dest;
@@ -60,8 +67,16 @@ constexpr int TipDefaultLines = 4;
 // used  in AddRelTagsFile and AddTagsFile
 int16_t TagFileIndex = 0;
 
+// A tags file which is searched in place, rather than loaded into LoadedTags
+struct TagsFileDatabase {
+	std::unique_ptr<TagsDatabase> db;
+	QString path; // the directory of the tags file
+	int index;
+};
+
 QMultiHash<QString, Tag> LoadedTags;
 QMultiHash<QString, Tag> LoadedTips;
+std::vector<TagsFileDatabase> LoadedDatabases;
 
 /**
  * @brief Check if a line is empty or contains only whitespace characters.
@@ -114,6 +129,40 @@ QString StripRight(QString s) {
 	return s.replace(re, QString());
 }
 
+/**
+ * @brief Look up a tag in the tags files which are searched in place.
+ *
+ * @param name The name of the tag.
+ * @return The tags with that name.
+ */
+QList<Tag> LookupDatabases(const QString &name) {
+
+	QList<Tag> tags;
+
+	const QByteArray key = name.toUtf8();
+	for (const TagsFileDatabase &entry : LoadedDatabases) {
+		for (const TagsDatabase::Match &match : entry.db->lookup(std::string_view(key.constData(), static_cast<size_t>(key.size())))) {
+
+			const QString line = QString::fromUtf8(match.line.data(), static_cast<int>(match.line.size()));
+
+			std::optional<Tag> tag;
+			if (entry.db->isETags()) {
+				const QString file = QString::fromUtf8(match.file.data(), static_cast<int>(match.file.size()));
+				ParseETagsDefinition(line, file, entry.path, entry.index, &tag);
+			} else {
+				tag = ParseCTagsLine(line, entry.path, entry.index);
+			}
+
+			// NOTE: the index may guess the name of an old style etags definition a little differently
+			if (tag && tag->name == name) {
+				tags.append(*tag);
+			}
+		}
+	}
+
+	return tags;
+}
+
 /**
  * @brief Get unique tags from a list of tags.
  *
@@ -122,7 +171,12 @@ QString StripRight(QString s) {
  */
 QList<Tag> GetTagFromTable(QMultiHash<QString, Tag> &table, const QString &name) {
 	auto tags = table.values(name);
-	tags      = GetUniqueTags(tags);
+
+	if (&table == &LoadedTags) {
+		tags += LookupDatabases(name);
+	}
+
+	tags = GetUniqueTags(tags);
 	return tags;
 }
 
@@ -191,10 +245,19 @@ std::deque<File> *TagListByType(SearchMode mode) {
 bool DeleteTag(int index) {
 	int del = 0;
 
+	if (searchMode != SearchMode::TIP) {
+		auto it = std::remove_if(LoadedDatabases.begin(), LoadedDatabases.end(), [index](const TagsFileDatabase &entry) {
+			return entry.index == index;
+		});
+
+		del += static_cast<int>(std::distance(it, LoadedDatabases.end()));
+		LoadedDatabases.erase(it, LoadedDatabases.end());
+	}
+
 	QMultiHash<QString, Tag> *table = HashTableByType(searchMode);
 
 	if (table->isEmpty()) {
-		return false;
+		return del > 0;
 	}
 
 	for (auto it = table->begin(); it != table->end();) {
@@ -210,24 +273,24 @@ bool DeleteTag(int index) {
 }
 
 /**
- * @brief Scans a line from a ctags tags file and adds the tag to the hash table.
+ * @brief Parses a line from a ctags tags file.
  *
- * @param line The line to scan from the ctags file.
+ * @param line The line to parse.
  * @param tagPath The path to the tags file.
- * @param index The index of the tag in the tags file.
- * @return The number of tag specifications added, or 0 if the line is not valid.
+ * @param index The index of the tags file.
+ * @return The tag, or an empty optional if the line is not valid.
  */
-int ScanCTagsLine(const QString &line, const QString &tagPath, int index) {
+std::optional<Tag> ParseCTagsLine(const QString &line, const QString &tagPath, int index) {
 
 	static const auto regex = QRegularExpression(QStringLiteral(R"(^([^\t]+)\t([^\t]+)\t([^\n]+)$)"));
 
 	const QRegularExpressionMatch match = regex.match(line);
 	if (!match.hasMatch()) {
-		return 0;
+		return {};
 	}
 
 	if (match.lastCapturedIndex() != 3) {
-		return 0;
+		return {};
 	}
 
 	const QString name   = match.captured(1);
@@ -235,7 +298,7 @@ int ScanCTagsLine(const QString &line, const QString &tagPath, int index) {
 	QString searchString = match.captured(3);
 
 	if (name.startsWith(QLatin1Char('!'))) {
-		return 0;
+		return {};
 	}
 
 	int pos;
@@ -280,50 +343,62 @@ int ScanCTagsLine(const QString &line, const QString &tagPath, int index) {
 	}
 
 	// No ability to read language mode right now
-	return AddTag(
-		name,
-		file,
-		PLAIN_LANGUAGE_MODE,
-		searchString,
-		pos,
-		tagPath,
-		index);
+	return Tag{name, file, searchString, tagPath, PLAIN_LANGUAGE_MODE, pos, index};
 }
 
 /**
- * @brief Scans a line from an etags tags file and adds the tag to the hash table.
+ * @brief Scans a line from a ctags tags file and adds the tag to the hash table.
  *
- * @param line The line to scan from the etags file.
+ * @param line The line to scan from the ctags file.
  * @param tagPath The path to the tags file.
  * @param index The index of the tag in the tags file.
- * @param file The destination file for the tag definition, which may be modified.
- * @param recLevel The current recursion level for tags file inclusion.
  * @return The number of tag specifications added, or 0 if the line is not valid.
  */
-int ScanETagsLine(const QString &line, const QString &tagPath, int index, QString &file, int recLevel) {
+int ScanCTagsLine(const QString &line, const QString &tagPath, int index) {
 
-	// check for destination file separator
-	if (line.startsWith(QLatin1Char('\014'))) { // <np>
-		file = QString();
+	const std::optional<Tag> tag = ParseCTagsLine(line, tagPath, index);
+	if (!tag) {
 		return 0;
 	}
 
-	// check for standard definition line
+	return AddTag(
+		tag->name,
+		tag->file,
+		tag->language,
+		tag->searchString,
+		tag->posInf,
+		tag->path,
+		tag->index);
+}
+
+/**
+ * @brief Parses a definition line from an etags tags file.
+ *
+ * @param line The line to parse.
+ * @param file The destination file for the tag definition.
+ * @param tagPath The path to the tags file.
+ * @param index The index of the tags file.
+ * @param tag Receives the tag, if the line defines one whose name can be made out.
+ * @return `true` if the line is a definition line, `false` otherwise.
+ */
+bool ParseETagsDefinition(const QString &line, const QString &file, const QString &tagPath, int index, std::optional<Tag> *tag) {
+
 	const int posDEL = line.lastIndexOf(QLatin1Char('\177'));
 	const int posSOH = line.lastIndexOf(QLatin1Char('\001'));
 	const int posCOM = line.lastIndexOf(QLatin1Char(','));
 
-	if (!file.isEmpty() && posDEL != -1 && (posSOH > posDEL) && (posCOM > posSOH)) {
+	if (posDEL != -1 && (posSOH > posDEL) && (posCOM > posSOH)) {
 		// exuberant ctags -e style
 		const QString searchString = line.left(posDEL);
 		const QString name         = line.mid(posDEL + 1, (posSOH - posDEL) - 1);
 		const int pos              = line.mid(posCOM + 1).toInt();
 
 		// No ability to set language mode for the moment
-		return AddTag(name, file, PLAIN_LANGUAGE_MODE, searchString, pos, tagPath, index);
+		*tag = Tag{name, file, searchString, tagPath, PLAIN_LANGUAGE_MODE, pos, index};
+		return true;
 	}
 
-	if (!file.isEmpty() && posDEL != -1 && (posCOM > posDEL)) {
+	if (posDEL != -1 && (posCOM > posDEL)) {
 		// old etags style, part  name<soh>  is missing here!
 		const QString searchString = line.left(posDEL);
 
@@ -336,7 +411,8 @@ int ScanETagsLine(const QString &line, const QString &tagPath, int index, QStrin
 		}
 
 		if (len < 0) {
-			return 0;
+			tag->reset();
+			return true;
 		}
 
 		int pos = len;
@@ -348,9 +424,43 @@ int ScanETagsLine(const QString &line, const QString &tagPath, int index, QStrin
 		const QString name = searchString.mid(pos + 1, len - pos);
 		pos                = line.mid(posCOM + 1).toInt();
 
-		return AddTag(name, file, PLAIN_LANGUAGE_MODE, searchString, pos, tagPath, index);
+		*tag = Tag{name, file, searchString, tagPath, PLAIN_LANGUAGE_MODE, pos, index};
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Scans a line from an etags tags file and adds the tag to the hash table.
+ *
+ * @param line The line to scan from the etags file.
+ * @param tagPath The path to the tags file.
+ * @param index The index of the tag in the tags file.
+ * @param file The destination file for the tag definition, which may be modified.
+ * @param recLevel The current recursion level for tags file inclusion.
+ * @return The number of tag specifications added, or 0 if the line is not valid.
+ */
+int ScanETagsLine(const QString &line, const QString &tagPath, int index, QString &file, int recLevel) {
+
+	// check for destination file separator
+	if (line.startsWith(QLatin1Char('\014'))) { // <np>
+		file = QString();
+		return 0;
+	}
+
+	// check for standard definition line
+	std::optional<Tag> tag;
+	if (!file.isEmpty() && ParseETagsDefinition(line, file, tagPath, index, &tag)) {
+		if (!tag) {
+			return 0;
+		}
+
+		return AddTag(tag->name, tag->file, tag->language, tag->searchString, tag->posInf, tag->path, tag->index);
 	}
 
+	const int posCOM = line.lastIndexOf(QLatin1Char(','));
+
 	// check for destination file spec
 	if (!line.isEmpty() && posCOM != -1) {
 
@@ -378,6 +488,7 @@ int ScanETagsLine(const QString &line, const QString &tagPath, int index, QStrin
  * @param index The index of the tags file in the list of loaded tags files.
  * @param recLevel The current recursion level for tags file inclusion.
  * @return The number of tag specifications added, or 0 if the file could not be loaded.
+ * A file which is searched in place counts as 1.
  */
 int LoadTagsFile(const QString &tagSpec, int index, int recLevel) {
 
@@ -397,13 +508,27 @@ int LoadTagsFile(const QString &tagSpec, int index, int recLevel) {
 		return 0;
 	}
 
+	const PathInfo tagPathInfo = ParseFilename(resolvedTagsFile);
+
+	/* Search the file where it lies if possible, so that only the tags which
+	   are looked up are ever parsed. Building an index for it may take a while
+	   the first time */
+	MainWindow::allDocumentsBusy(tr("Loading tags file..."));
+	std::unique_ptr<TagsDatabase> db = TagsDatabase::open(resolvedTagsFile, []() {
+		MainWindow::allDocumentsBusy(tr("Loading tags file..."));
+	});
+	MainWindow::allDocumentsUnbusy();
+
+	if (db) {
+		LoadedDatabases.push_back({std::move(db), tagPathInfo.pathname, index});
+		return 1;
+	}
+
 	QFile f(resolvedTagsFile);
 	if (!f.open(QIODevice::ReadOnly)) {
 		return 0;
 	}
 
-	const PathInfo tagPathInfo = ParseFilename(resolvedTagsFile);
-
 	QString filename;
 
 	QTextStream stream(&f);
@@ -1191,20 +1316,21 @@ QList<Tag> LookupTag(const QString &name, SearchMode mode) {
 	return LookupTagFromList(&TagsFileList, name, mode);
 }
 
+namespace {
+
 /**
- * @brief Perform a regex search in a buffer using a search string.
- * ctags search expressions are literal strings with a search direction flag,
- * line starting "^" and ending "$" delimiters. This routine translates them
- * into NEdit compatible regular expressions and does the search. Etags
- * search expressions are plain literals strings.
+ * @brief The body of both versions of FakeRegexSearch, which differ only in
+ * what they search.
  *
- * @param buffer The buffer to search in.
+ * @param length The length of the text to search.
  * @param searchString The search string to use, which may contain regex-like syntax.
  * @param startPos The starting position for the search, which may be -1 for etags mode.
  * @param endPos Where to store the end position of the found match.
+ * @param search Searches the text with a regex, in a direction, from a position.
  * @return `true` if a match is found, `false` otherwise.
  */
-bool FakeRegexSearch(std::string_view buffer, const QString &searchString, int64_t *startPos, int64_t *endPos) {
+template <class Func>
+bool FakeRegexSearchText(int64_t length, const QString &searchString, int64_t *startPos, int64_t *endPos, Func search) {
 
 	if (searchString.isEmpty()) {
 		return false;
@@ -1214,8 +1340,6 @@ bool FakeRegexSearch(std::string_view buffer, const QString &searchString, int64
 	Direction dir;
 	bool ctagsMode;
 
-	const std::string_view fileString = buffer;
-
 	// determine search direction and start position
 	if (*startPos != -1) { // etags mode!
 		dir            = Direction::Forward;
@@ -1227,7 +1351,7 @@ bool FakeRegexSearch(std::string_view buffer, const QString &searchString, int64
 		ctagsMode      = true;
 	} else if (searchString.size() > 1 && searchString[0] == QLatin1Char('?')) {
 		dir            = Direction::Backward;
-		searchStartPos = ssize(fileString);
+		searchStartPos = length;
 		ctagsMode      = true;
 	} else {
 		qWarning("NEdit: Error parsing tag file search string");
@@ -1282,30 +1406,14 @@ bool FakeRegexSearch(std::string_view buffer, const QString &searchString, int64
 
 	Search::Result searchResult;
 
-	bool found = Search::SearchString(
-		fileString,
-		searchSubs,
-		dir,
-		SearchType::Regex,
-		WrapMode::NoWrap,
-		searchStartPos,
-		&searchResult,
-		QString());
+	bool found = search(searchSubs, dir, searchStartPos, &searchResult);
 
 	if (!found && !ctagsMode) {
 		/* position of the target definition could have been drifted before
 		   startPos, if nothing has been found by now try searching backward
 		   again from startPos.
 		*/
-		found = Search::SearchString(
-			fileString,
-			searchSubs,
-			Direction::Backward,
-			SearchType::Regex,
-			WrapMode::NoWrap,
-			searchStartPos,
-			&searchResult,
-			QString());
+		found = search(searchSubs, Direction::Backward, searchStartPos, &searchResult);
 	}
 
 	// return the result
@@ -1320,6 +1428,43 @@ bool FakeRegexSearch(std::string_view buffer, const QString &searchString, int64
 	return false;
 }
 
+}
+
+/**
+ * @brief Perform a regex search in a buffer using a search string.
+ * ctags search expressions are literal strings with a search direction flag,
+ * line starting "^" and ending "$" delimiters. This routine translates them
+ * into NEdit compatible regular expressions and does the search. Etags
+ * search expressions are plain literals strings.
+ *
+ * @param buffer The buffer to search in.
+ * @param searchString The search string to use, which may contain regex-like syntax.
+ * @param startPos The starting position for the search, which may be -1 for etags mode.
+ * @param endPos Where to store the end position of the found match.
+ * @return `true` if a match is found, `false` otherwise.
+ */
+bool FakeRegexSearch(std::string_view buffer, const QString &searchString, int64_t *startPos, int64_t *endPos) {
+	return FakeRegexSearchText(ssize(buffer), searchString, startPos, endPos, [buffer](const QString &regex, Direction direction, int64_t beginPos, Search::Result *result) {
+		return Search::SearchString(buffer, regex, direction, SearchType::Regex, WrapMode::NoWrap, beginPos, result, QString());
+	});
+}
+
+/**
+ * @brief Perform a regex search in a document's text buffer using a search
+ * string, searching the buffer where it lies rather than a copy of it.
+ *
+ * @param buffer The buffer to search in.
+ * @param searchString The search string to use, which may contain regex-like syntax.
+ * @param startPos The starting position for the search, which may be -1 for etags mode.
+ * @param endPos Where to store the end position of the found match.
+ * @return `true` if a match is found, `false` otherwise.
+ */
+bool FakeRegexSearch(TextBuffer *buffer, const QString &searchString, int64_t *startPos, int64_t *endPos) {
+	return FakeRegexSearchText(buffer->length(), searchString, startPos, endPos, [buffer](const QString &regex, Direction direction, int64_t beginPos, Search::Result *result) {
+		return Search::SearchBuffer(buffer, regex, direction, SearchType::Regex, WrapMode::NoWrap, beginPos, result, QString());
+	});
+}
+
 /**
  * @brief Show a matching calltip for a tag.
  * This reads from either a source code file (if searchMode == TIP_FROM_TAG)
@@ -3,6 +3,7 @@
 #define TAGS_H_
 
 #include "CallTip.h"
+#include "TextBufferFwd.h"
 #include "Util/QtHelper.h"
 
 #include <QDateTime>
@@ -63,6 +64,7 @@ bool AddRelativeTagsFile(const QString &tagSpec, const QString &windowPath, Sear
 bool AddTagsFile(const QString &tagSpec, SearchMode mode);
 bool DeleteTagsFile(const QString &tagSpec, SearchMode mode, bool force_unload);
 bool FakeRegexSearch(std::string_view buffer, const QString &searchString, int64_t *startPos, int64_t *endPos);
+bool FakeRegexSearch(TextBuffer *buffer, const QString &searchString, int64_t *startPos, int64_t *endPos);
 int TagsShowCalltip(TextArea *area, const QString &text);
 void ShowMatchingCalltip(QWidget *parent, TextArea *area, int id);
 
@@ -0,0 +1,575 @@
+
+#include "TagsDatabase.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtDebug>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Written at the start of an index file, followed by its entries and then by
+// its section positions
+struct IndexHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t entrySize;
+	uint64_t fileSize; // the size and modification time of the tags file it was made from
+	int64_t fileTime;
+	uint64_t count;
+	uint64_t sectionCount;
+};
+
+constexpr char IndexMagic[8]    = {'N', 'E', 'D', 'I', 'T', 'T', 'A', 'G'};
+constexpr uint32_t IndexVersion = 3;
+
+// Index entries keep the name as a 32-bit offset and length within its line
+constexpr uint64_t MaxIndexedLine = std::numeric_limits<uint32_t>::max();
+
+// How many lines to scan between calls of the progress function
+constexpr uint64_t ProgressInterval = 65536;
+
+/**
+ * @brief Get the name of the tag which a ctags line defines.
+ *
+ * @param line The line.
+ * @return The name, which is everything up to the first tab.
+ */
+std::string_view CTagsName(std::string_view line) noexcept {
+	return line.substr(0, line.find('\t'));
+}
+
+/**
+ * @brief Check whether a byte can be part of an identifier.
+ *
+ * @param ch The byte.
+ * @return `true` if it is a letter, digit or underscore, or part of a
+ * multibyte character, `false` otherwise.
+ */
+bool IsIdentifierByte(char ch) noexcept {
+	const auto uch = static_cast<unsigned char>(ch);
+	return std::isalnum(uch) || uch == '_' || uch >= 0x80;
+}
+
+/**
+ * @brief Get the name of the tag which an etags definition line defines, the
+ * way Tags::ScanETagsLine does.
+ *
+ * @param line The line.
+ * @return The name, which is empty if the line isn't a definition.
+ */
+std::string_view ETagsName(std::string_view line) noexcept {
+
+	const size_t posDEL = line.rfind('\177');
+	const size_t posSOH = line.rfind('\001');
+	const size_t posCOM = line.rfind(',');
+
+	if (posDEL == std::string_view::npos || posCOM == std::string_view::npos || posCOM < posDEL) {
+		return {};
+	}
+
+	// exuberant ctags -e style
+	if (posSOH != std::string_view::npos && posSOH > posDEL && posCOM > posSOH) {
+		return line.substr(posDEL + 1, posSOH - posDEL - 1);
+	}
+
+	// old etags style, the name is the last identifier before the DEL
+	size_t end = posDEL;
+	while (end > 0 && !IsIdentifierByte(line[end - 1])) {
+		--end;
+	}
+
+	size_t start = end;
+	while (start > 0 && IsIdentifierByte(line[start - 1])) {
+		--start;
+	}
+
+	return line.substr(start, end - start);
+}
+
+/**
+ * @brief Compare two tag names the way a sorted ctags file orders them.
+ *
+ * @param lhs The first name.
+ * @param rhs The second name.
+ * @param foldCase Whether the file was sorted without regard to case.
+ * @return Less than, equal to or greater than zero, as for `strcmp`.
+ */
+int CompareNames(std::string_view lhs, std::string_view rhs, bool foldCase) noexcept {
+
+	if (!foldCase) {
+		return lhs.compare(rhs);
+	}
+
+	const size_t n = std::min(lhs.size(), rhs.size());
+	for (size_t i = 0; i < n; ++i) {
+		const int a = std::toupper(static_cast<unsigned char>(lhs[i]));
+		const int b = std::toupper(static_cast<unsigned char>(rhs[i]));
+		if (a != b) {
+			return a - b;
+		}
+	}
+
+	if (lhs.size() == rhs.size()) {
+		return 0;
+	}
+
+	return lhs.size() < rhs.size() ? -1 : 1;
+}
+
+/**
+ * @brief Get where the index of a tags file is kept.
+ *
+ * @param filename The canonical path of the tags file.
+ * @return The path of the index file, or an empty string if there is nowhere
+ * to keep it.
+ */
+QString IndexFileName(const QString &filename) {
+
+	const QString cache = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+	if (cache.isEmpty()) {
+		return QString();
+	}
+
+	const QDir dir(QStringLiteral("%1/nedit-ng/tags").arg(cache));
+	if (!dir.mkpath(QStringLiteral("."))) {
+		return QString();
+	}
+
+	const QByteArray hash = QCryptographicHash::hash(filename.toUtf8(), QCryptographicHash::Sha1).toHex();
+	return dir.filePath(QStringLiteral("%1.idx").arg(QString::fromLatin1(hash)));
+}
+
+}
+
+/**
+ * @brief Open a tags file for lookups, indexing it if necessary.
+ *
+ * @param filename The canonical path of the tags file.
+ * @param progress Called now and then while an index is being built, so that
+ * the caller can keep the user interface alive.
+ * @return The database, or nullptr if the file can't be used this way, such as
+ * an etags file which includes other tags files, in which case it should be
+ * loaded the traditional way.
+ */
+std::unique_ptr<TagsDatabase> TagsDatabase::open(const QString &filename, const std::function<void()> &progress) {
+
+	// NOTE: the constructor is private, so std::make_unique can't be used
+	std::unique_ptr<TagsDatabase> db(new TagsDatabase);
+
+	db->file_.setFileName(filename);
+	if (!db->file_.open(QIODevice::ReadOnly) || db->file_.size() == 0) {
+		return nullptr;
+	}
+
+	db->size_ = static_cast<uint64_t>(db->file_.size());
+	db->data_ = reinterpret_cast<const char *>(db->file_.map(0, db->file_.size()));
+	if (!db->data_) {
+		return nullptr;
+	}
+
+	// the first character of the file decides whether it is an etags or a ctags file
+	db->etags_   = (db->data_[0] == '\f');
+	db->sorting_ = db->etags_ ? Sorting::Unsorted : db->readSorting();
+
+	if (db->sorting_ != Sorting::Unsorted) {
+		return db;
+	}
+
+	const QFileInfo info(filename);
+	const QString indexFile = IndexFileName(filename);
+
+	if (!indexFile.isEmpty() && db->mapIndex(indexFile, info)) {
+		return db;
+	}
+
+	if (!db->buildIndex(progress)) {
+		return nullptr;
+	}
+
+	if (!indexFile.isEmpty()) {
+		db->saveIndex(indexFile, info);
+	}
+
+	return db;
+}
+
+/**
+ * @brief Get the line which starts at a position, without its line ending.
+ *
+ * @param pos The position of the start of the line.
+ * @return The line.
+ */
+std::string_view TagsDatabase::lineAt(uint64_t pos) const noexcept {
+
+	const auto newline = static_cast<const char *>(std::memchr(data_ + pos, '\n', size_ - pos));
+	const uint64_t end = newline ? static_cast<uint64_t>(newline - data_) : size_;
+
+	std::string_view line(data_ + pos, end - pos);
+	if (!line.empty() && line.back() == '\r') {
+		line.remove_suffix(1);
+	}
+
+	return line;
+}
+
+/**
+ * @brief Find the first line which starts at or after a position.
+ *
+ * @param pos The position.
+ * @return The position of the start of the line, or the size of the file if
+ * there is no such line.
+ */
+uint64_t TagsDatabase::lineStartAfter(uint64_t pos) const noexcept {
+
+	if (pos == 0) {
+		return 0;
+	}
+
+	const auto newline = static_cast<const char *>(std::memchr(data_ + pos - 1, '\n', size_ - (pos - 1)));
+	return newline ? static_cast<uint64_t>(newline - data_) + 1 : size_;
+}
+
+/**
+ * @brief Get the name of the tag which an index entry refers to.
+ *
+ * @param entry The entry.
+ * @return The name of the tag, which is empty if the entry doesn't lie within
+ * the file, as it may not if the index was damaged or tampered with.
+ */
+std::string_view TagsDatabase::nameOf(const IndexEntry &entry) const noexcept {
+
+	if (entry.line >= size_ || entry.name > size_ - entry.line || entry.nameLength > size_ - entry.line - entry.name) {
+		return {};
+	}
+
+	return std::string_view(data_ + entry.line + entry.name, entry.nameLength);
+}
+
+/**
+ * @brief Get the file name of the etags section which an index entry's line is
+ * in.
+ *
+ * @param entry The entry, which lies within the file.
+ * @return The file name, which is empty if the section can't be found.
+ */
+std::string_view TagsDatabase::sectionFileOf(const IndexEntry &entry) const noexcept {
+
+	// the last section which starts before the line
+	const uint64_t *section = std::upper_bound(sections_, sections_ + sectionCount_, entry.line);
+	if (section == sections_ || *(section - 1) >= size_) {
+		return {};
+	}
+
+	const std::string_view fileLine = lineAt(*(section - 1));
+	return fileLine.substr(0, fileLine.rfind(','));
+}
+
+/**
+ * @brief Make an index entry for a tag line.
+ *
+ * @param line The line, which lies in the mapped file and is no longer than
+ * MaxIndexedLine.
+ * @param name The name of the tag, which lies within the line.
+ * @return The entry.
+ */
+TagsDatabase::IndexEntry TagsDatabase::makeEntry(std::string_view line, std::string_view name) const noexcept {
+
+	IndexEntry entry;
+	entry.line       = static_cast<uint64_t>(line.data() - data_);
+	entry.name       = static_cast<uint32_t>(name.data() - line.data());
+	entry.nameLength = static_cast<uint32_t>(name.size());
+	return entry;
+}
+
+/**
+ * @brief Read how a ctags file is sorted from its pseudo-tags.
+ *
+ * @return The sorting which the file claims.
+ */
+TagsDatabase::Sorting TagsDatabase::readSorting() const noexcept {
+
+	static constexpr std::string_view SortedTag = "!_TAG_FILE_SORTED\t";
+
+	uint64_t pos = 0;
+	while (pos < size_ && data_[pos] == '!') {
+		const std::string_view line = lineAt(pos);
+
+		if (line.substr(0, SortedTag.size()) == SortedTag && line.size() > SortedTag.size()) {
+			switch (line[SortedTag.size()]) {
+			case '1':
+				return Sorting::Sorted;
+			case '2':
+				return Sorting::FoldCase;
+			default:
+				return Sorting::Unsorted;
+			}
+		}
+
+		pos = lineStartAfter(pos + 1);
+	}
+
+	return Sorting::Unsorted;
+}
+
+/**
+ * @brief Index the tag lines of the file by name.
+ *
+ * @param progress Called now and then while the file is being scanned.
+ * @return `true` if the file was indexed, `false` if it can't be, because it
+ * is an etags file which includes other tags files.
+ */
+bool TagsDatabase::buildIndex(const std::function<void()> &progress) {
+
+	std::vector<IndexEntry> entries;
+	std::vector<uint64_t> sections;
+
+	uint64_t nLines = 0;
+	bool haveFile   = false;
+
+	for (uint64_t pos = 0; pos < size_; pos = lineStartAfter(pos + 1)) {
+
+		if (progress && ++nLines % ProgressInterval == 0) {
+			progress();
+		}
+
+		const std::string_view line = lineAt(pos);
+		const bool indexable        = line.size() <= MaxIndexedLine;
+
+		if (!etags_) {
+			// a tag line has a name, a file and an address, separated by tabs
+			const size_t tab = line.find('\t');
+			if (indexable && tab != 0 && tab != std::string_view::npos && line.find('\t', tab + 1) != std::string_view::npos && line[0] != '!') {
+				entries.push_back(makeEntry(line, line.substr(0, tab)));
+			}
+			continue;
+		}
+
+		// a form feed starts the section of another file
+		if (!line.empty() && line[0] == '\f') {
+			haveFile = false;
+			continue;
+		}
+
+		const size_t posDEL = line.rfind('\177');
+		const size_t posCOM = line.rfind(',');
+
+		// a definition, which is skipped if no name can be made out, as Tags::ScanETagsLine does
+		if (haveFile && posDEL != std::string_view::npos && posCOM != std::string_view::npos && posCOM > posDEL) {
+			const std::string_view name = ETagsName(line);
+			if (indexable && !name.empty()) {
+				entries.push_back(makeEntry(line, name));
+			}
+			continue;
+		}
+
+		// otherwise, the file name which starts a section
+		if (posCOM != std::string_view::npos) {
+			if (line.substr(posCOM + 1, 7) == "include") {
+				return false;
+			}
+
+			sections.push_back(pos);
+			haveFile = true;
+		}
+	}
+
+	std::stable_sort(entries.begin(), entries.end(), [this](const IndexEntry &lhs, const IndexEntry &rhs) {
+		return nameOf(lhs) < nameOf(rhs);
+	});
+
+	indexData_    = std::move(entries);
+	index_        = indexData_.data();
+	indexSize_    = indexData_.size();
+	sectionData_  = std::move(sections);
+	sections_     = sectionData_.data();
+	sectionCount_ = sectionData_.size();
+	return true;
+}
+
+/**
+ * @brief Use the index which was saved for the file, if it is up to date.
+ *
+ * @param indexFile The path of the index file.
+ * @param info The tags file.
+ * @return `true` if the index could be used, `false` otherwise.
+ */
+bool TagsDatabase::mapIndex(const QString &indexFile, const QFileInfo &info) {
+
+	indexFile_.setFileName(indexFile);
+	if (!indexFile_.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+
+	const qint64 size = indexFile_.size();
+	if (size < static_cast<qint64>(sizeof(IndexHeader))) {
+		indexFile_.close();
+		return false;
+	}
+
+	const uchar *data = indexFile_.map(0, size);
+	if (!data) {
+		indexFile_.close();
+		return false;
+	}
+
+	IndexHeader header;
+	std::memcpy(&header, data, sizeof(header));
+
+	const uint64_t payload = static_cast<uint64_t>(size) - sizeof(IndexHeader);
+
+	const bool current = std::memcmp(header.magic, IndexMagic, sizeof(IndexMagic)) == 0 &&
+						 header.version == IndexVersion &&
+						 header.entrySize == sizeof(IndexEntry) &&
+						 header.fileSize == size_ &&
+						 header.fileTime == info.lastModified().toMSecsSinceEpoch() &&
+						 header.count <= payload / sizeof(IndexEntry) &&
+						 header.sectionCount == (payload - header.count * sizeof(IndexEntry)) / sizeof(uint64_t);
+
+	if (!current) {
+		indexFile_.close();
+		return false;
+	}
+
+	// NOTE: the header and the entries are multiples of 8 bytes long, and the mapping is page aligned, so everything is suitably aligned.
+	// The entries aren't checked here, lookups only trust the ones they read as far as they have checked them
+	index_        = reinterpret_cast<const IndexEntry *>(data + sizeof(IndexHeader));
+	indexSize_    = header.count;
+	sections_     = reinterpret_cast<const uint64_t *>(data + sizeof(IndexHeader) + header.count * sizeof(IndexEntry));
+	sectionCount_ = header.sectionCount;
+	return true;
+}
+
+/**
+ * @brief Save the index of the file, so that it needn't be built again until
+ * the file changes.
+ *
+ * @param indexFile The path of the index file.
+ * @param info The tags file.
+ */
+void TagsDatabase::saveIndex(const QString &indexFile, const QFileInfo &info) const {
+
+	IndexHeader header;
+	std::memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+	header.version   = IndexVersion;
+	header.entrySize = sizeof(IndexEntry);
+	header.fileSize  = size_;
+	header.fileTime  = info.lastModified().toMSecsSinceEpoch();
+	header.count        = indexSize_;
+	header.sectionCount = sectionCount_;
+
+	const auto entriesSize  = static_cast<qint64>(indexSize_ * sizeof(IndexEntry));
+	const auto sectionsSize = static_cast<qint64>(sectionCount_ * sizeof(uint64_t));
+
+	QSaveFile file(indexFile);
+	if (!file.open(QIODevice::WriteOnly) ||
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header)) != static_cast<qint64>(sizeof(header)) ||
+		file.write(reinterpret_cast<const char *>(index_), entriesSize) != entriesSize ||
+		file.write(reinterpret_cast<const char *>(sections_), sectionsSize) != sectionsSize ||
+		!file.commit()) {
+		qWarning("NEdit: could not save tags index %s: %s", qPrintable(indexFile), qPrintable(file.errorString()));
+	}
+}
+
+/**
+ * @brief Find the lines which define a tag.
+ *
+ * @param name The name of the tag.
+ * @return The lines, in the order they appear in the file.
+ */
+std::vector<TagsDatabase::Match> TagsDatabase::lookup(std::string_view name) const {
+
+	if (name.empty()) {
+		return {};
+	}
+
+	if (sorting_ != Sorting::Unsorted) {
+		return lookupSorted(name);
+	}
+
+	return lookupIndexed(name);
+}
+
+/**
+ * @brief Find the lines which define a tag in a sorted ctags file, by binary
+ * searching the file itself.
+ *
+ * @param name The name of the tag.
+ * @return The lines.
+ */
+std::vector<TagsDatabase::Match> TagsDatabase::lookupSorted(std::string_view name) const {
+
+	const bool foldCase = (sorting_ == Sorting::FoldCase);
+
+	// find the first line whose name doesn't sort before `name`
+	uint64_t lo = 0;
+	uint64_t hi = size_;
+	while (lo < hi) {
+		const uint64_t mid   = lo + (hi - lo) / 2;
+		const uint64_t start = lineStartAfter(mid);
+
+		if (start < size_ && CompareNames(CTagsName(lineAt(start)), name, foldCase) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	// a file sorted without regard to case may have other names mixed in with the matches
+	std::vector<Match> matches;
+	for (uint64_t pos = lineStartAfter(lo); pos < size_; pos = lineStartAfter(pos + 1)) {
+		const std::string_view line     = lineAt(pos);
+		const std::string_view lineName = CTagsName(line);
+
+		if (CompareNames(lineName, name, foldCase) != 0) {
+			break;
+		}
+
+		if (lineName == name) {
+			matches.push_back({line, {}});
+		}
+	}
+
+	return matches;
+}
+
+/**
+ * @brief Find the lines which define a tag using the file's index.
+ *
+ * @param name The name of the tag.
+ * @return The lines.
+ */
+std::vector<TagsDatabase::Match> TagsDatabase::lookupIndexed(std::string_view name) const {
+
+	const IndexEntry *first = index_;
+	const IndexEntry *last  = index_ + indexSize_;
+
+	// NOTE: nameOf checks each entry which is probed, so a damaged index can give wrong matches, but can't send us outside of the file
+	first = std::lower_bound(first, last, name, [this](const IndexEntry &entry, std::string_view key) {
+		return nameOf(entry) < key;
+	});
+
+	// `name` isn't empty, so an entry whose name matches lies within the file
+	std::vector<Match> matches;
+	for (; first != last && nameOf(*first) == name; ++first) {
+
+		Match match;
+		match.line = lineAt(first->line);
+
+		if (etags_) {
+			match.file = sectionFileOf(*first);
+		}
+
+		matches.push_back(match);
+	}
+
+	return matches;
+}
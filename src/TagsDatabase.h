@@ -0,0 +1,94 @@
+
+#ifndef TAGS_DATABASE_H_
+#define TAGS_DATABASE_H_
+
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+class QFileInfo;
+
+/**
+ * @brief A ctags or etags file which is searched where it lies, rather than
+ * being loaded.
+ *
+ * The file is mapped into memory. A ctags file which says that it is sorted,
+ * with a "!_TAG_FILE_SORTED" pseudo-tag of 1 or 2, is binary searched as is.
+ * Any other file gets an index: the positions of its tag lines and of their
+ * names, ordered by tag name. The index is kept in the user's cache directory,
+ * so that it is only built once for each version of the file, and is mapped as
+ * well. Either way, only the lines of the tags which are looked up are ever
+ * parsed.
+ */
+class TagsDatabase {
+public:
+	// A line of the tags file which defines a tag
+	struct Match {
+		std::string_view line;
+		std::string_view file; // for etags, the file name of the section the line is in
+	};
+
+public:
+	static std::unique_ptr<TagsDatabase> open(const QString &filename, const std::function<void()> &progress);
+
+public:
+	TagsDatabase(const TagsDatabase &)            = delete;
+	TagsDatabase &operator=(const TagsDatabase &) = delete;
+	~TagsDatabase()                               = default;
+
+public:
+	bool isETags() const noexcept { return etags_; }
+	std::vector<Match> lookup(std::string_view name) const;
+
+private:
+	enum class Sorting : uint8_t {
+		Unsorted,
+		Sorted,
+		FoldCase
+	};
+
+	// The position of a tag line and of the tag's name within it. For etags, the
+	// file name of the line's section is found from the section positions
+	struct IndexEntry {
+		uint64_t line;
+		uint32_t name; // relative to the line
+		uint32_t nameLength;
+	};
+
+private:
+	TagsDatabase() = default;
+
+private:
+	std::string_view lineAt(uint64_t pos) const noexcept;
+	std::string_view nameOf(const IndexEntry &entry) const noexcept;
+	std::string_view sectionFileOf(const IndexEntry &entry) const noexcept;
+	IndexEntry makeEntry(std::string_view line, std::string_view name) const noexcept;
+	uint64_t lineStartAfter(uint64_t pos) const noexcept;
+	Sorting readSorting() const noexcept;
+	bool buildIndex(const std::function<void()> &progress);
+	bool mapIndex(const QString &indexFile, const QFileInfo &info);
+	void saveIndex(const QString &indexFile, const QFileInfo &info) const;
+	std::vector<Match> lookupSorted(std::string_view name) const;
+	std::vector<Match> lookupIndexed(std::string_view name) const;
+
+private:
+	QFile file_;
+	QFile indexFile_;
+	const char *data_         = nullptr; // the mapped tags file
+	uint64_t size_            = 0;
+	const IndexEntry *index_  = nullptr; // the index, in indexFile_ if it could be mapped, otherwise in indexData_
+	uint64_t indexSize_       = 0;
+	const uint64_t *sections_ = nullptr; // for etags, the positions of the lines which start sections, likewise
+	uint64_t sectionCount_    = 0;
+	std::vector<IndexEntry> indexData_;
+	std::vector<uint64_t> sectionData_;
+	Sorting sorting_ = Sorting::Unsorted;
+	bool etags_      = false;
+};
+
+#endif
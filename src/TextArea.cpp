@@ -10,10 +10,12 @@
 #include "LineNumberArea.h"
 #include "Preferences.h"
 #include "RangesetTable.h"
+#include "SignalBlocker.h"
 #include "SmartIndentEvent.h"
 #include "TextAreaMimeData.h"
 #include "TextBuffer.h"
 #include "TextEditEvent.h"
+#include "Util/Environment.h"
 #include "Util/algorithm.h"
 #include "X11Colors.h"
 
@@ -38,6 +40,9 @@
 #include <QtGlobal>
 
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
 
 #include <gsl/gsl_util>
@@ -92,6 +97,16 @@ constexpr int CalltipEdgeGuard = 5;
 // Length of delay in milliseconds for vertical auto-scrolling
 constexpr int VerticalScrollDelay = 50;
 
+// Wrapped line counts over more characters (or lines) than these limits are
+// answered by the wrap index, anything smaller just wraps the text
+constexpr int64_t WrapIndexScanLimit = WrapIndex::PieceSize;
+constexpr int64_t WrapIndexLineLimit = 128;
+
+// How long to spend measuring the wrap index before the text is shown, and
+// on each pass of measuring the rest of it in the background
+constexpr std::chrono::milliseconds WrapIndexSyncBudget(50);
+constexpr std::chrono::milliseconds WrapIndexTimeSlice(4);
+
 /* Masks for text drawing methods.  These are or'd together to form an
    integer which describes what drawing calls to use to draw a string */
 constexpr int StyleLookupShift = 0;
@@ -542,11 +557,13 @@ TextArea::TextArea(DocumentWidget *document, TextBuffer *buffer, const QFont &fo
 	autoScrollTimer_  = new QTimer(this);
 	cursorBlinkTimer_ = new QTimer(this);
 	clickTimer_       = new QTimer(this);
+	wrapIndexTimer_   = new QTimer(this);
 	lineNumberArea_   = new LineNumberArea(this);
 
 	autoScrollTimer_->setSingleShot(true);
 	connect(autoScrollTimer_, &QTimer::timeout, this, &TextArea::autoScrollTimerTimeout);
 	connect(cursorBlinkTimer_, &QTimer::timeout, this, &TextArea::cursorBlinkTimerTimeout);
+	connect(wrapIndexTimer_, &QTimer::timeout, this, &TextArea::wrapIndexTimerTimeout);
 
 	clickTimer_->setSingleShot(true);
 	connect(clickTimer_, &QTimer::timeout, this, [this]() {
@@ -974,6 +991,15 @@ TextArea::~TextArea() {
 		buffer_->BufRemoveModifyCB(ModifiedCallback, this);
 		buffer_->BufRemovePreDeleteCB(PreDeleteCallback, this);
 	}
+
+	// report how well the glyph run cache did, for tuning its capacity
+	if (!GetEnvironmentVariable("NEDIT_GLYPH_CACHE_STATS").isEmpty()) {
+		const uint64_t lookups = glyphRuns_.hits() + glyphRuns_.misses();
+		qDebug("NEdit: glyph run cache: %llu lookups, %llu hits (%.1f%%)",
+			   static_cast<unsigned long long>(lookups),
+			   static_cast<unsigned long long>(glyphRuns_.hits()),
+			   lookups ? 100.0 * static_cast<double>(glyphRuns_.hits()) / static_cast<double>(lookups) : 0.0);
+	}
 }
 
 /**
@@ -1004,11 +1030,14 @@ void TextArea::verticalScrollBar_valueChanged(int value) {
 	updateVScrollBarRange();
 	updateHScrollBarRange();
 
-	// NOTE(eteran): the original code seemed to do some cleverness
-	//               involving copying the parts that were "moved"
-	//               to avoid doing some work. For now, we'll just repaint
-	//               the whole thing. It's not as fast/clever, but it'll work
-	viewport()->update();
+	/* If some of the lines which were displayed are still visible, move them
+	   and only repaint the lines which have been scrolled into view. Qt moves
+	   any pending updates along with them */
+	if (lineDelta != 0 && std::abs(lineDelta) < nVisibleLines_) {
+		viewport()->scroll(0, gsl::narrow<int>(lineDelta) * fixedFontHeight_, viewport()->contentsRect());
+	} else {
+		viewport()->update();
+	}
 
 	// Refresh line number/calltip display if its up and we've scrolled vertically
 	if (lineDelta != 0) {
@@ -1044,6 +1073,31 @@ void TextArea::cursorBlinkTimerTimeout() {
 	}
 }
 
+/**
+ * @brief Handles the timeout event for the wrap index timer, measuring some
+ * more of the display lines which the index has only estimated. Once they
+ * are all measured, the line count and scroll bar are brought up to date.
+ */
+void TextArea::wrapIndexTimerTimeout() {
+
+	if (!continuousWrap_) {
+		wrapIndexTimer_->stop();
+		return;
+	}
+
+	wrapIndex_.measure(WrapIndexTimeSlice);
+
+	if (wrapIndex_.complete()) {
+		wrapIndexTimer_->stop();
+
+		nBufferLines_ = wrapIndex_.rows();
+		topLineNum_   = wrapIndex_.rowOf(firstChar_) + 1;
+
+		updateVScrollBarRange();
+		no_signals(verticalScrollBar())->setValue(gsl::narrow<int>(topLineNum_));
+	}
+}
+
 /**
  * @brief Handles the timeout event for the auto-scroll timer.
  */
@@ -1531,6 +1585,14 @@ void TextArea::bufModifiedCallback(TextCursor pos, int64_t nInserted, int64_t nD
 	   of continuous wrap mode, how much has changed */
 	if (continuousWrap_) {
 		findWrapRange(deletedText, pos, nInserted, nDeleted, &wrapModStart, &wrapModEnd, &linesInserted, &linesDeleted);
+
+		// the wrap index must be up to date before anything below counts lines
+		if (nInserted != 0 || nDeleted != 0) {
+			wrapIndex_.update(pos, nInserted, nDeleted, linesInserted, linesDeleted);
+			if (!wrapIndex_.complete()) {
+				wrapIndexTimer_->start();
+			}
+		}
 	} else {
 		linesInserted = (nInserted == 0) ? 0 : buffer_->BufCountLines(pos, pos + nInserted);
 		linesDeleted  = (nDeleted == 0) ? 0 : CountNewlines(deletedText);
@@ -2356,6 +2418,11 @@ TextCursor TextArea::countBackwardNLines(TextCursor startPos, int64_t nLines) co
 		return buffer_->BufCountBackwardNLines(startPos, nLines);
 	}
 
+	// a long way back, the wrap index can find the line without wrapping everything in between
+	if (nLines > WrapIndexLineLimit) {
+		return wrapIndex_.positionOfRow(std::max<int64_t>(0, wrapIndex_.rowOf(startPos) - nLines));
+	}
+
 	int64_t retLines;
 	TextCursor retPos;
 	TextCursor retLineStart;
@@ -2400,6 +2467,25 @@ void TextArea::resetAbsLineNum() {
 	offsetAbsLineNum(buffer_->BufStartOfBuffer());
 }
 
+/**
+ * @brief Discard the wrap index after something which affects wrapping has
+ * changed. In continuous wrap mode, as much of the new index as can be
+ * measured quickly is measured right away, and the rest in the background.
+ */
+void TextArea::resetWrapIndex() {
+
+	wrapIndex_.clear();
+
+	if (continuousWrap_) {
+		wrapIndex_.measure(WrapIndexSyncBudget);
+		if (!wrapIndex_.complete()) {
+			wrapIndexTimer_->start();
+		}
+	} else {
+		wrapIndexTimer_->stop();
+	}
+}
+
 /**
  * @brief Refresh a rectangle of the text display.  left and top are in coordinates of
  * the text drawing window
@@ -2448,6 +2534,11 @@ TextCursor TextArea::forwardNLines(TextCursor startPos, int64_t nLines, bool sta
 		return startPos;
 	}
 
+	// a long way forward, the wrap index can find the line without wrapping everything in between
+	if (nLines > WrapIndexLineLimit) {
+		return wrapIndex_.positionOfRow(wrapIndex_.rowOf(startPos) + nLines);
+	}
+
 	// use the common line counting routine to count forward
 	TextCursor retPos;
 	TextCursor retLineStart;
@@ -2881,10 +2972,33 @@ void TextArea::redisplayLine(QPainter *painter, int visLineNum, int leftClip, in
 			   buffer_->highlight.rangeTouchesRectSel(rangeStart, rangeEnd);
 	};
 
-	if (continuousWrap_ && rangeTouchesRectSel(lineStartPos, lineStartPos + currentLine.size())) {
+	const bool rectSelected = rangeTouchesRectSel(lineStartPos, lineStartPos + currentLine.size());
+
+	if (continuousWrap_ && rectSelected) {
 		dispIndexOffset = buffer_->BufCountDispChars(buffer_->BufStartOfLine(lineStartPos), lineStartPos);
 	}
 
+	/* The style of a character only depends on its display column when a
+	   rectangular selection touches the line. Otherwise, work out the styles
+	   of the whole line up front, as runs, and step through them as the
+	   characters are visited (in increasing order) */
+	if (!rectSelected) {
+		computeStyleRuns(lineStartPos, currentLine);
+	}
+
+	size_t run   = 0;
+	auto styleAt = [&](size_t index, int64_t dispIndex, char ch) {
+		if (rectSelected) {
+			return styleOfPos(lineStartPos, lineSize, index, dispIndex, ch);
+		}
+
+		while (styleRuns_[run].end <= index) {
+			++run;
+		}
+
+		return styleRuns_[run].style;
+	};
+
 	/* Step through character positions from the beginning of the line (even if
 	 * that's off the left edge of the displayed area) to find the first
 	 * character position that's not clipped, and the x coordinate for drawing
@@ -2903,7 +3017,7 @@ void TextArea::redisplayLine(QPainter *painter, int visLineNum, int leftClip, in
 			charLen  = TextBuffer::BufCharWidth(baseChar, outIndex, tabDist);
 		}
 
-		style               = styleOfPos(lineStartPos, lineSize, startIndex, dispIndexOffset + outIndex, baseChar);
+		style               = styleAt(startIndex, dispIndexOffset + outIndex, baseChar);
 		const int charWidth = (startIndex >= lineSize) ? fixedFontWidth_ : lengthToWidth(charLen);
 
 		if (startX + charWidth >= leftClip) {
@@ -2945,7 +3059,7 @@ void TextArea::redisplayLine(QPainter *painter, int visLineNum, int leftClip, in
 			charLen  = TextBuffer::BufExpandCharacter(baseChar, outIndex, expandedChar, tabDist);
 		}
 
-		uint32_t charStyle = styleOfPos(lineStartPos, lineSize, charIndex, dispIndexOffset + outIndex, baseChar);
+		uint32_t charStyle = styleAt(charIndex, dispIndexOffset + outIndex, baseChar);
 
 		for (int i = 0; i < charLen; ++i) {
 
@@ -2953,7 +3067,7 @@ void TextArea::redisplayLine(QPainter *painter, int visLineNum, int leftClip, in
 			 * certain types of selections work correctly
 			 */
 			if (i != 0 && charIndex < lineSize && currentLine[charIndex] == '\t') {
-				charStyle = styleOfPos(lineStartPos, lineSize, charIndex, dispIndexOffset + outIndex, '\t');
+				charStyle = styleAt(charIndex, dispIndexOffset + outIndex, '\t');
 			}
 
 			if (charStyle != style) {
@@ -3069,6 +3183,124 @@ uint32_t TextArea::styleOfPos(TextCursor lineStartPos, size_t lineLen, size_t li
 	return style;
 }
 
+/**
+ * @brief Work out the drawing style of every character of a display line, and
+ * of the blank area following it, as styleOfPos() would, storing them as runs
+ * of characters with the same style in styleRuns_. Rather than testing every
+ * character against every selection and rangeset, the line is divided at the
+ * boundaries of the selections and colored rangesets which touch it, and
+ * within each division only the highlight style and background class of each
+ * character can differ. The last run covers the blank area.
+ *
+ * Lines touched by a rectangular selection must use styleOfPos() instead,
+ * since the style then also depends on the display column.
+ *
+ * @param lineStartPos The position of the start of the line, or -1 if the line has no text.
+ * @param line The text of the line.
+ */
+void TextArea::computeStyleRuns(TextCursor lineStartPos, std::string_view line) {
+
+	const size_t lineSize = line.size();
+
+	styleRuns_.clear();
+
+	auto addRun = [this](size_t end, uint32_t style) {
+		if (!styleRuns_.empty() && styleRuns_.back().style == style) {
+			styleRuns_.back().end = end;
+		} else {
+			styleRuns_.push_back({end, style});
+		}
+	};
+
+	if (lineStartPos == -1 || !buffer_) {
+		addRun(SIZE_MAX, FillMask);
+		return;
+	}
+
+	const TextCursor lineEndPos = lineStartPos + lineSize;
+
+	// the highlight styles of the characters, parsing any which are unfinished
+	UTextBuffer::string_type styles;
+	if (styleBuffer_) {
+		styles = styleBuffer_->BufGetRange(lineStartPos, lineEndPos);
+		for (size_t i = 0; i < styles.size(); ++i) {
+			if (styles[i] == unfinishedStyle_) {
+				(unfinishedHighlightCB_)(this, lineStartPos + i, highlightCBArg_);
+				styles.replace(i, UTextBuffer::string_type::npos, styleBuffer_->BufGetRange(lineStartPos + i, lineEndPos));
+			}
+		}
+	}
+
+	// the positions where a selection or colored rangeset starts or ends
+	std::vector<TextCursor> boundaries;
+	for (const TextBuffer::Selection *sel : {&buffer_->primary, &buffer_->highlight, &buffer_->secondary}) {
+		if (sel->hasSelection() && !sel->isRectangular()) {
+			boundaries.push_back(sel->start());
+			boundaries.push_back(sel->end());
+		}
+	}
+
+	if (document_->rangesetTable_) {
+		document_->rangesetTable_->colorBoundaries(lineStartPos, lineEndPos, &boundaries);
+	}
+
+	boundaries.erase(std::remove_if(boundaries.begin(), boundaries.end(), [lineStartPos, lineEndPos](TextCursor pos) {
+						 return pos <= lineStartPos || pos >= lineEndPos;
+					 }),
+					 boundaries.end());
+
+	boundaries.push_back(lineEndPos);
+	std::sort(boundaries.begin(), boundaries.end());
+	boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+	TextCursor divisionStart = lineStartPos;
+	for (const TextCursor divisionEnd : boundaries) {
+
+		// the selections and rangesets are the same throughout the division
+		uint32_t divisionStyle = 0;
+
+		if (buffer_->primary.inSelection(divisionStart, lineStartPos, 0)) {
+			divisionStyle |= PrimaryMask;
+		}
+
+		if (buffer_->highlight.inSelection(divisionStart, lineStartPos, 0)) {
+			divisionStyle |= HighlightMask;
+		}
+
+		if (buffer_->secondary.inSelection(divisionStart, lineStartPos, 0)) {
+			divisionStyle |= SecondaryMask;
+		}
+
+		if (document_->rangesetTable_) {
+			const size_t rangesetIndex = document_->rangesetTable_->index1ofPos(divisionStart, true);
+			divisionStyle |= ((rangesetIndex << RangesetShift) & RangesetMask);
+		}
+
+		for (auto i = static_cast<size_t>(divisionStart - lineStartPos); i < static_cast<size_t>(divisionEnd - lineStartPos); ++i) {
+			uint32_t style = divisionStyle;
+
+			if (!styles.empty()) {
+				style |= styles[i];
+			}
+
+			// NOTE: the character is promoted the same way styleOfPos() promotes it
+			if (!bgClass_.empty()) {
+				const auto index = static_cast<size_t>(static_cast<int>(line[i]));
+				if (index < bgClass_.size()) {
+					style |= (bgClass_[index] << BacklightShift);
+				}
+			}
+
+			addRun(i + 1, style);
+		}
+
+		divisionStart = divisionEnd;
+	}
+
+	// the blank area following the text
+	addRun(SIZE_MAX, styleOfPos(lineStartPos, lineSize, lineSize, 0, '\0'));
+}
+
 /*
 ** Draw a string or blank area according to parameter "style", using the
 ** appropriate colors and drawing method for that style, with top left
@@ -3220,7 +3452,11 @@ void TextArea::drawString(QPainter *painter, uint32_t style, int x, int y, int t
 
 	painter->setPen(fground);
 	if (Q_LIKELY(fastPath)) {
-		painter->drawText(rect, Qt::TextSingleLine | Qt::TextDontClip | Qt::AlignVCenter | Qt::AlignLeft, s);
+		if (const GlyphRun *run = glyphRuns_.lookup(s, renderFont, fixedFontHeight_)) {
+			painter->drawStaticText(QPointF(x, y + run->top), run->text);
+		} else {
+			painter->drawText(rect, Qt::TextSingleLine | Qt::TextDontClip | Qt::AlignVCenter | Qt::AlignLeft, s);
+		}
 	} else {
 		for (const QChar ch : s) {
 			painter->drawText(rect, Qt::TextSingleLine | Qt::TextDontClip | Qt::AlignVCenter | Qt::AlignLeft, {ch});
@@ -3349,6 +3585,7 @@ void TextArea::handleResize(bool widthChanged) {
 		const TextCursor start        = buffer_->BufStartOfBuffer();
 		const TextCursor end          = buffer_->BufEndOfBuffer();
 
+		resetWrapIndex();
 		nBufferLines_ = countLines(start, end, /*startPosIsLineStart=*/true);
 		firstChar_    = startOfLine(firstChar_);
 		topLineNum_   = countLines(start, firstChar_, /*startPosIsLineStart=*/true) + 1;
@@ -3395,6 +3632,11 @@ int64_t TextArea::countLines(TextCursor startPos, TextCursor endPos, bool startP
 		return buffer_->BufCountLines(startPos, endPos);
 	}
 
+	// long ranges are counted by the wrap index rather than by wrapping them
+	if (endPos - startPos > WrapIndexScanLimit) {
+		return wrapIndex_.rowOf(endPos) - wrapIndex_.rowOf(startPos);
+	}
+
 	int64_t retLines;
 	TextCursor retPos;
 	TextCursor retLineStart;
@@ -6878,6 +7120,8 @@ void TextArea::setWrapMode(bool wrap, int wrapMargin) {
 	continuousWrap_ = wrap;
 	wrapMargin_     = wrapMargin;
 
+	resetWrapIndex();
+
 	// wrapping can change change the total number of lines, re-count
 	nBufferLines_ = countLines(buffer_->BufStartOfBuffer(), buffer_->BufEndOfBuffer(), /*startPosIsLineStart=*/true);
 
@@ -7261,8 +7505,9 @@ void TextArea::setFont(const QFont &font) {
 	font_ = font;
 	updateFontMetrics(font);
 
-	// force recalculation of font related parameters
-	handleResize(/*widthChanged=*/false);
+	/* force recalculation of font related parameters. In continuous wrap
+	 * mode the font also decides how much text fits on each line */
+	handleResize(/*widthChanged=*/continuousWrap_);
 
 	// force a recalculation of the line numbers
 	setLineNumCols(getLineNumCols());
@@ -7899,6 +8144,9 @@ void TextArea::updateFontMetrics(const QFont &font) {
 	fixedFontHeight_ = std::max(standardHeight, boldHeight);
 
 	widerBold_ = Font::maxWidth(fm) != Font::maxWidth(fmb);
+
+	// the cached runs were laid out with the old font
+	glyphRuns_.clear();
 }
 
 /**
@@ -8058,25 +8306,23 @@ void TextArea::insertStringAP(const QString &string, EventFlags flags) {
  *         column.
  */
 TextCursor TextArea::lineAndColToPosition(Location loc) const {
-	int i;
-	TextCursor lineStart = {};
 
 	// Count lines
 	if (loc.line < 1) {
 		loc.line = 1;
 	}
 
-	auto lineEnd = TextCursor(-1);
-	for (i = 1; i <= loc.line && lineEnd < buffer_->length(); i++) {
-		lineStart = lineEnd + 1;
-		lineEnd   = buffer_->BufEndOfLine(lineStart);
-	}
+	const TextCursor bufferStart = buffer_->BufStartOfBuffer();
+	const TextCursor bufferEnd   = buffer_->BufEndOfBuffer();
 
 	// If line is beyond end of buffer, position at last character in buffer
-	if (loc.line >= i) {
-		return lineEnd;
+	if (loc.line > buffer_->BufCountLines(bufferStart, bufferEnd) + 1) {
+		return bufferEnd;
 	}
 
+	const TextCursor lineStart = buffer_->BufCountForwardNLines(bufferStart, loc.line - 1);
+	const TextCursor lineEnd   = buffer_->BufEndOfLine(lineStart);
+
 	// Start character index at zero
 	int charIndex = 0;
 
@@ -8088,7 +8334,8 @@ TextCursor TextArea::lineAndColToPosition(Location loc) const {
 		// Count columns, expanding each character
 		const std::string lineStr = buffer_->BufGetRange(lineStart, lineEnd);
 		int outIndex              = 0;
-		for (TextCursor cur = lineStart; cur < lineEnd; ++cur, ++charIndex) {
+		TextCursor cur            = lineStart;
+		for (; cur < lineEnd; ++cur, ++charIndex) {
 
 			charLen = TextBuffer::BufCharWidth(lineStr[charIndex], outIndex, buffer_->BufGetTabDistance());
 
@@ -8108,7 +8355,7 @@ TextCursor TextArea::lineAndColToPosition(Location loc) const {
 		}
 
 		// If we are beyond the end of the line, back up one space
-		if ((i >= lineEnd) && (charIndex > 0)) {
+		if ((cur >= lineEnd) && (charIndex > 0)) {
 			--charIndex;
 		}
 	}
@@ -8738,6 +8985,16 @@ int TextArea::fixedFontWidth() const {
 	return fixedFontWidth_;
 }
 
+/**
+ * @brief Returns the cache of the layouts of the runs of text which have been
+ * drawn, whose hit rate is useful for tuning it.
+ *
+ * @return The glyph run cache.
+ */
+const GlyphRunCache &TextArea::glyphRunCache() const {
+	return glyphRuns_;
+}
+
 /**
  * @brief Updates the primary selection in the clipboard.
  *
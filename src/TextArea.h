@@ -6,10 +6,12 @@
 #include "CallTip.h"
 #include "CursorStyles.h"
 #include "DragStates.h"
+#include "GlyphRunCache.h"
 #include "Location.h"
 #include "StyleTableEntry.h"
 #include "TextBufferFwd.h"
 #include "TextCursor.h"
+#include "WrapIndex.h"
 
 #include <QAbstractScrollArea>
 #include <QColor>
@@ -49,6 +51,14 @@ class TextArea final : public QAbstractScrollArea {
 
 private:
 	friend class LineNumberArea;
+	friend class WrapIndex;
+
+private:
+	// A run of characters of a display line which are drawn the same way
+	struct StyleRun {
+		size_t end;     // the index of the character following the run
+		uint32_t style; // the drawing style, as returned by styleOfPos()
+	};
 
 public:
 	enum EventFlag {
@@ -119,6 +129,7 @@ protected:
 private:
 	void cursorBlinkTimerTimeout();
 	void autoScrollTimerTimeout();
+	void wrapIndexTimerTimeout();
 	void verticalScrollBar_valueChanged(int value);
 	void horizontalScrollBar_valueChanged(int value);
 
@@ -200,6 +211,7 @@ public:
 	DocumentWidget *document() const;
 	int fixedFontHeight() const;
 	int fixedFontWidth() const;
+	const GlyphRunCache &glyphRunCache() const;
 	int getColumns() const;
 	int getEmulateTabs() const;
 	int getLineNumCols() const;
@@ -328,6 +340,7 @@ private:
 	void checkAutoScroll(const QPoint &coord);
 	void checkAutoShowInsertPos();
 	void checkMoveSelectionChange(EventFlags flags, TextCursor startPos);
+	void computeStyleRuns(TextCursor lineStartPos, std::string_view line);
 	void drawCursor(QPainter *painter, int x, int y);
 	void drawString(QPainter *painter, uint32_t style, int x, int y, int toX, std::string_view string);
 	void endDrag();
@@ -348,6 +361,7 @@ private:
 	void redisplayRect(const QRect &rect);
 	void repaintLineNumbers();
 	void resetAbsLineNum();
+	void resetWrapIndex();
 	void selectLine();
 	void selectWord(int pointerX);
 	void setCursorStyle(CursorStyles style);
@@ -379,6 +393,7 @@ private:
 	QTimer *clickTimer_                        = nullptr;
 	QTimer *cursorBlinkTimer_                  = nullptr;
 	QTimer *resizeTimer_                       = nullptr;
+	QTimer *wrapIndexTimer_                    = nullptr;
 	QVector<TextCursor> lineStarts_            = {TextCursor()};
 	QWidget *lineNumberArea_                   = nullptr;
 	TextBuffer *buffer_                        = nullptr; // Contains text to be displayed
@@ -440,6 +455,7 @@ private:
 private:
 	BlockDragTypes dragType_; // style of block drag operation
 	CallTip calltip_;
+	GlyphRunCache glyphRuns_; // layouts of the runs of text drawn recently
 	QFont font_;
 	QPoint btnDownCoord_; // Mark the position of last btn down action for deciding when to begin paying attention to motion actions, and where to paste columns
 	QPoint clickPos_;
@@ -448,8 +464,10 @@ private:
 	std::string delimiters_;
 	std::shared_ptr<TextBuffer> dragOrigBuf_; // backup buffer copy used during block dragging of selections
 	std::vector<QColor> bgClassColors_;       // table of colors for each BG class
+	std::vector<StyleRun> styleRuns_;         // the styles of the line being drawn, from computeStyleRuns()
 	std::vector<StyleTableEntry> styleTable_; // Table of fonts and colors for coloring/syntax-highlighting
 	std::vector<uint8_t> bgClass_;            // obtains index into bgClassColors_
+	mutable WrapIndex wrapIndex_{this};       // display line counts for continuous wrap mode
 	uint32_t unfinishedStyle_;                // Style buffer entry which triggers on-the-fly re-parsing of region
 
 private:
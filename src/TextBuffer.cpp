@@ -10,7 +10,15 @@ const char *BasicTextBufferBase::ControlCodeTable[32] = {
 
 // Force full instantiation
 template class BasicTextBuffer<char>;
+#ifdef CHUNKED_STORAGE
+template class chunked_buffer<char>;
+#else
 template class gap_buffer<char>;
+#endif
 
 template class BasicTextBuffer<uint8_t>;
+#ifdef CHUNKED_STORAGE
+template class chunked_buffer<uint8_t>;
+#else
 template class gap_buffer<uint8_t>;
+#endif
@@ -5,7 +5,9 @@
 #include "TextBufferFwd.h"
 #include "TextCursor.h"
 #include "TextRange.h"
+#include "chunked_buffer.h"
 #include "gap_buffer.h"
+#include "line_index.h"
 
 #include <cstdint>
 #include <deque>
@@ -40,6 +42,12 @@ public:
 	using string_type = std::basic_string<Ch, Tr>;
 	using view_type   = std::basic_string_view<Ch, Tr>;
 
+#ifdef CHUNKED_STORAGE
+	using storage_type = chunked_buffer<Ch, Tr>;
+#else
+	using storage_type = gap_buffer<Ch, Tr>;
+#endif
+
 public:
 	using modify_callback_type           = void (*)(TextCursor pos, int64_t nInserted, int64_t nDeleted, int64_t nRestyled, view_type deletedText, void *user);
 	using pre_delete_callback_type       = void (*)(TextCursor pos, int64_t nDeleted, void *user);
@@ -137,7 +145,7 @@ public:
 	TextCursor BufStartOfLine(TextCursor pos) const noexcept;
 	TextCursor BufEndOfBuffer() const noexcept;
 	constexpr TextCursor BufStartOfBuffer() const noexcept { return {}; }
-	view_type BufAsString() noexcept;
+	view_type BufAsString();
 	void BufAddHighPriorityModifyCB(modify_callback_type bufModifiedCB, void *user);
 	void BufAddModifyCB(modify_callback_type bufModifiedCB, void *user);
 	void BufAddPreDeleteCB(pre_delete_callback_type bufPreDeleteCB, void *user);
@@ -181,6 +189,10 @@ public:
 public:
 	bool GetSimpleSelection(TextRange *range) const noexcept;
 
+public:
+	template <class Func>
+	void BufForEachSegment(TextCursor start, TextCursor end, Func &&func) const;
+
 private:
 	std::optional<TextCursor> searchBackward(TextCursor startPos, Ch searchChar) const noexcept;
 	std::optional<TextCursor> searchForward(TextCursor startPos, Ch searchChar) const noexcept;
@@ -200,6 +212,7 @@ private:
 	void updateSelections(TextCursor pos, int64_t nDeleted, int64_t nInserted) noexcept;
 	void sanitizeRange(TextCursor &start, TextCursor &end) const noexcept;
 	void updatePrimarySelection() noexcept;
+	const line_index<storage_type> &lineIndex() const;
 
 private:
 	static string_type unexpandTabs(view_type text, int64_t startIndent, int tabDist);
@@ -226,7 +239,17 @@ private:
 	bool syncXSelection_      = true;
 
 private:
-	gap_buffer<Ch> buffer_;
+	/* Line counting queries which would scan fewer characters (or lines) than
+	 * these limits just scan the text, anything larger is answered by the
+	 * line index, which is built on first use
+	 */
+	static constexpr int64_t LineIndexScanLimit = 16384;
+	static constexpr int64_t LineIndexLineLimit = 128;
+
+private:
+	storage_type buffer_;
+	mutable line_index<storage_type> lineIndex_;
+	mutable bool lineIndexValid_ = false;
 
 private:
 	std::deque<std::pair<pre_delete_callback_type, void *>> preDeleteProcs_; // procedures to call before text is deleted from the buffer; at most one is supported.
@@ -239,7 +262,27 @@ public:
 	Selection highlight;
 };
 
+/**
+ * @brief Calls `func` with each contiguous piece of the text in [start, end),
+ * in order, without copying or rearranging the underlying storage. If `func`
+ * returns a bool, returning `false` stops the traversal.
+ *
+ * @param start The start of the range.
+ * @param end The end of the range.
+ * @param func The function to call with a view of each piece.
+ */
+template <class Ch, class Tr>
+template <class Func>
+void BasicTextBuffer<Ch, Tr>::BufForEachSegment(TextCursor start, TextCursor end, Func &&func) const {
+	sanitizeRange(start, end);
+	buffer_.for_each_segment(to_integer(start), to_integer(end), std::forward<Func>(func));
+}
+
 extern template class BasicTextBuffer<char>;
+#ifdef CHUNKED_STORAGE
+extern template class chunked_buffer<char>;
+#else
 extern template class gap_buffer<char>;
+#endif
 
 #endif
@@ -21,12 +21,14 @@ auto BasicTextBuffer<Ch, Tr>::BufGetAll() const -> string_type {
 
 /**
  * @brief Get the entire contents of a text buffer as a read-only view of
- * contiguous characters
+ * contiguous characters. With chunked storage this is a copy of the text,
+ * which is kept until the buffer is next modified, so callers which can work
+ * a piece at a time should prefer BufForEachSegment.
  *
  * @return A read-only view of the entire contents of the text buffer.
  */
 template <class Ch, class Tr>
-auto BasicTextBuffer<Ch, Tr>::BufAsString() noexcept -> view_type {
+auto BasicTextBuffer<Ch, Tr>::BufAsString() -> view_type {
 	return buffer_.to_view();
 }
 
@@ -48,6 +50,10 @@ void BasicTextBuffer<Ch, Tr>::BufSetAll(view_type text) {
 
 	buffer_.assign(text);
 
+	if (lineIndexValid_) {
+		lineIndex_.assign(buffer_);
+	}
+
 	// Zero all of the existing selections
 	updateSelections(BufStartOfBuffer(), deleteLength, 0);
 
@@ -260,7 +266,16 @@ void BasicTextBuffer<Ch, Tr>::BufCopyFromBuf(BasicTextBuffer<Ch, Tr> *fromBuf, T
 
 	const int64_t length = (fromEnd - fromStart);
 
-	buffer_.insert(to_integer(toPos), fromBuf->buffer_.to_view(to_integer(fromStart), to_integer(fromEnd)));
+	// the text is copied a piece at a time, so the source never needs to be made contiguous
+	int64_t pos = to_integer(toPos);
+	fromBuf->buffer_.for_each_segment(to_integer(fromStart), to_integer(fromEnd), [this, &pos](view_type piece) {
+		buffer_.insert(pos, piece);
+		pos += ssize(piece);
+	});
+
+	if (lineIndexValid_) {
+		lineIndex_.insert(buffer_, to_integer(toPos), length);
+	}
 
 	updateSelections(toPos, 0, length);
 }
@@ -1056,6 +1071,12 @@ TextCursor BasicTextBuffer<Ch, Tr>::BufCountForwardDispChars(TextCursor lineStar
 template <class Ch, class Tr>
 int64_t BasicTextBuffer<Ch, Tr>::BufCountLines(TextCursor startPos, TextCursor endPos) const noexcept {
 
+	if (startPos <= endPos && endPos - startPos > LineIndexScanLimit) {
+		const line_index<storage_type> &index = lineIndex();
+		const TextCursor end                  = std::min(endPos, BufEndOfBuffer());
+		return index.newlines_before(buffer_, to_integer(end)) - index.newlines_before(buffer_, to_integer(startPos));
+	}
+
 	int64_t lineCount = 0;
 
 	TextCursor pos = startPos;
@@ -1087,6 +1108,16 @@ TextCursor BasicTextBuffer<Ch, Tr>::BufCountForwardNLines(TextCursor startPos, i
 		return startPos;
 	}
 
+	if (nLines > LineIndexLineLimit) {
+		const line_index<storage_type> &index = lineIndex();
+		const int64_t target                  = index.newlines_before(buffer_, to_integer(startPos)) + nLines;
+		if (std::optional<int64_t> pos = index.position_after_newline(buffer_, target)) {
+			return TextCursor(*pos);
+		}
+
+		return BufEndOfBuffer();
+	}
+
 	TextCursor pos = startPos;
 	TextCursor end = BufEndOfBuffer();
 
@@ -1116,6 +1147,16 @@ TextCursor BasicTextBuffer<Ch, Tr>::BufCountBackwardNLines(TextCursor startPos,
 		return start;
 	}
 
+	if (nLines > LineIndexLineLimit) {
+		const line_index<storage_type> &index = lineIndex();
+		const int64_t target                  = index.newlines_before(buffer_, to_integer(startPos)) - nLines;
+		if (std::optional<int64_t> pos = index.position_after_newline(buffer_, target)) {
+			return TextCursor(*pos);
+		}
+
+		return start;
+	}
+
 	TextCursor pos    = startPos - 1;
 	int64_t lineCount = -1;
 
@@ -1229,6 +1270,10 @@ int64_t BasicTextBuffer<Ch, Tr>::insert(TextCursor pos, view_type text) noexcept
 
 	buffer_.insert(to_integer(pos), text);
 
+	if (lineIndexValid_) {
+		lineIndex_.insert(buffer_, to_integer(pos), length);
+	}
+
 	updateSelections(pos, 0, length);
 
 	return length;
@@ -1241,6 +1286,10 @@ int64_t BasicTextBuffer<Ch, Tr>::insert(TextCursor pos, Ch ch) noexcept {
 
 	buffer_.insert(to_integer(pos), ch);
 
+	if (lineIndexValid_) {
+		lineIndex_.insert(buffer_, to_integer(pos), length);
+	}
+
 	updateSelections(pos, 0, length);
 
 	return length;
@@ -1339,6 +1388,23 @@ void BasicTextBuffer<Ch, Tr>::callPreDeleteCBs(TextCursor pos, int64_t nDeleted)
 	}
 }
 
+/**
+ * @brief Returns the newline index of the buffer, building it first if this
+ * is the first time it is needed. Once built, the index is kept up to date
+ * by every modification of the buffer.
+ *
+ * @return The newline index of the buffer.
+ */
+template <class Ch, class Tr>
+auto BasicTextBuffer<Ch, Tr>::lineIndex() const -> const line_index<storage_type> & {
+	if (!lineIndexValid_) {
+		lineIndex_.assign(buffer_);
+		lineIndexValid_ = true;
+	}
+
+	return lineIndex_;
+}
+
 /*
 ** Internal (non-redisplaying) version of BufRemove.  Removes the contents
 ** of the buffer between start and end (and moves the gap to the site of
@@ -1349,6 +1415,10 @@ void BasicTextBuffer<Ch, Tr>::deleteRange(TextCursor start, TextCursor end) noex
 
 	buffer_.erase(to_integer(start), to_integer(end));
 
+	if (lineIndexValid_) {
+		lineIndex_.erase(buffer_, to_integer(start), to_integer(end));
+	}
+
 	// fix up any selections which might be affected by the change
 	updateSelections(start, end - start, 0);
 }
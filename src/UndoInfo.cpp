@@ -11,3 +11,21 @@
 UndoInfo::UndoInfo(UndoTypes undoType, TextCursor start, TextCursor end)
 	: type(undoType), startPos(start), endPos(end) {
 }
+
+/**
+ * @brief Returns the amount of memory used by this record.
+ *
+ * @return The number of bytes used.
+ */
+size_t UndoInfo::memoryUsage() const noexcept {
+	return sizeof(UndoInfo) + oldText.memoryUsage();
+}
+
+/**
+ * @brief Returns the amount of disk used by this record.
+ *
+ * @return The number of bytes used.
+ */
+size_t UndoInfo::diskUsage() const noexcept {
+	return oldText.diskUsage();
+}
@@ -3,17 +3,26 @@
 #define UNDO_INFO_H_
 
 #include "TextCursor.h"
+#include "UndoText.h"
 
-#include <string>
+#include <cstddef>
+#include <cstdint>
 
 /* The accumulated list of undo operations can potentially consume huge
    amounts of memory.  These tuning parameters determine how much undo
-   information is retained.  Normally, the list is kept between UNDO_OP_LIMIT and
-   UNDO_OP_TRIMTO in length (when the list reaches UNDO_OP_LIMIT, it is
-   trimmed to UNDO_OP_TRIMTO then allowed to grow back to UNDO_OP_LIMIT). */
-
-constexpr auto UNDO_OP_LIMIT  = 400u;
-constexpr auto UNDO_OP_TRIMTO = 200u;
+   information is retained.  Normally, the memory used by the list is kept
+   between UNDO_MEMORY_TRIMTO and UNDO_MEMORY_LIMIT bytes (when the list
+   reaches UNDO_MEMORY_LIMIT, the oldest records are discarded until it is
+   back down to UNDO_MEMORY_TRIMTO).  The text of large records is compressed,
+   and the largest are moved out to temporary files, one for each record and
+   deleted along with it, whose total size, counting the redo list's files
+   too, is limited in the same way by UNDO_DISK_LIMIT and UNDO_DISK_TRIMTO.
+   The most recent record is always kept, however large it is. */
+
+constexpr size_t UNDO_MEMORY_LIMIT  = 64u * 1024u * 1024u;
+constexpr size_t UNDO_MEMORY_TRIMTO = 48u * 1024u * 1024u;
+constexpr size_t UNDO_DISK_LIMIT    = 2048u * 1024u * 1024u;
+constexpr size_t UNDO_DISK_TRIMTO   = 1536u * 1024u * 1024u;
 
 enum UndoTypes {
 	UNDO_NOOP,
@@ -29,19 +38,23 @@ enum UndoTypes {
 class UndoInfo {
 public:
 	explicit UndoInfo(UndoTypes undoType, TextCursor start, TextCursor end);
-	UndoInfo(const UndoInfo &)            = default;
+	UndoInfo(const UndoInfo &)            = delete;
 	UndoInfo(UndoInfo &&)                 = default;
-	UndoInfo &operator=(const UndoInfo &) = default;
+	UndoInfo &operator=(const UndoInfo &) = delete;
 	UndoInfo &operator=(UndoInfo &&)      = default;
 	~UndoInfo()                           = default;
 
 public:
-	std::string oldText;
+	size_t diskUsage() const noexcept;
+	size_t memoryUsage() const noexcept;
+
+public:
+	UndoText oldText;
 	UndoTypes type;
 	TextCursor startPos;
 	TextCursor endPos;
-	bool inUndo          = false; // flag to indicate undo command on this record in progress. Redirects SaveUndoInfo to save the next modifications on the redo list instead of the undo list.
-	bool restoresToSaved = false; // flag to indicate undoing this operation will restore file to last saved (unmodified) state
+	uint64_t sequence = 0;     // identifies the record. Undoing the record whose sequence is DocumentInfo::savedSequence restores the file to its last saved (unmodified) state
+	bool inUndo       = false; // flag to indicate undo command on this record in progress. Redirects SaveUndoInfo to save the next modifications on the redo list instead of the undo list.
 };
 
 #endif
@@ -0,0 +1,270 @@
+
+#include "UndoText.h"
+#include "Util/Compress.h"
+
+#include <QDir>
+#include <QTemporaryFile>
+#include <QtDebug>
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace {
+
+// text at least this long is compressed, if that makes it smaller
+constexpr size_t CompressThreshold = 4096;
+
+// text which is still at least this long after compression is moved to a file
+constexpr size_t SpillThreshold = 1048576;
+
+}
+
+/**
+ * @brief Constructor for UndoText. Large amounts of text are packed straight
+ * away, compressing them directly rather than from a copy.
+ *
+ * @param text The text to save.
+ */
+UndoText::UndoText(std::string_view text)
+	: size_(text.size()) {
+
+	if (size_ >= CompressThreshold) {
+		std::string compressed = CompressBlock(text);
+		if (compressed.size() < size_) {
+			data_       = std::move(compressed);
+			compressed_ = true;
+		}
+
+		packed_ = true;
+	}
+
+	if (!compressed_) {
+		data_ = std::string(text);
+	}
+
+	spill();
+}
+
+UndoText::UndoText(UndoText &&other) noexcept
+	: data_(std::move(other.data_)), spillFile_(std::move(other.spillFile_)), size_(other.size_), storedSize_(other.storedSize_), compressed_(other.compressed_), packed_(other.packed_) {
+
+	other.size_ = 0;
+}
+
+UndoText &UndoText::operator=(UndoText &&other) noexcept {
+	if (this != &other) {
+		data_       = std::move(other.data_);
+		spillFile_  = std::move(other.spillFile_);
+		size_       = other.size_;
+		storedSize_ = other.storedSize_;
+		compressed_ = other.compressed_;
+		packed_     = other.packed_;
+
+		other.size_ = 0;
+	}
+
+	return *this;
+}
+
+UndoText::~UndoText() = default;
+
+/**
+ * @brief Deletes the file holding the text, if there is one, giving its space
+ * back straight away.
+ */
+void UndoText::release() noexcept {
+	spillFile_ = nullptr;
+}
+
+/**
+ * @return true if there is no text, false otherwise.
+ */
+bool UndoText::empty() const noexcept {
+	return size_ == 0;
+}
+
+/**
+ * @return The length of the text.
+ */
+size_t UndoText::size() const noexcept {
+	return size_;
+}
+
+/**
+ * @return The number of bytes of memory used to hold the text.
+ */
+size_t UndoText::memoryUsage() const noexcept {
+	return data_.capacity();
+}
+
+/**
+ * @return The number of bytes of disk used to hold the text.
+ */
+size_t UndoText::diskUsage() const noexcept {
+	return spillFile_ ? storedSize_ : 0;
+}
+
+/**
+ * @brief Reads back what was written to the file holding the text.
+ *
+ * @return The stored form of the text, or an empty optional on failure.
+ */
+std::optional<std::string> UndoText::readSpilled() const {
+
+	// NOTE: reopening a closed QTemporaryFile opens the same file again
+	if (!spillFile_->open()) {
+		return {};
+	}
+
+	std::string data(storedSize_, '\0');
+	const bool ok = spillFile_->read(&data[0], static_cast<qint64>(storedSize_)) == static_cast<qint64>(storedSize_);
+	spillFile_->close();
+
+	if (!ok) {
+		return {};
+	}
+
+	return data;
+}
+
+/**
+ * @brief Returns the text, decompressing it or reading it back from its file
+ * as needed.
+ *
+ * @return The text, or an empty optional if it could not be recovered.
+ */
+std::optional<std::string> UndoText::str() const {
+
+	std::optional<std::string> stored;
+	if (spillFile_) {
+		stored = readSpilled();
+		if (!stored) {
+			qCritical("NEdit: could not read undo information from %s: %s", qPrintable(spillFile_->fileName()), qPrintable(spillFile_->errorString()));
+			return {};
+		}
+	}
+
+	const std::string_view data = stored ? *stored : data_;
+	if (!compressed_) {
+		return std::string(data);
+	}
+
+	std::string text(size_, '\0');
+	if (!DecompressBlock(data, &text[0], size_)) {
+		qCritical("NEdit: corrupt undo information");
+		return {};
+	}
+
+	return text;
+}
+
+/**
+ * @brief Brings the text back into memory, uncompressed, so that it can be
+ * modified.
+ *
+ * @return `true` if the text is in memory, `false` if it could not be
+ * recovered, in which case it is left where it was.
+ */
+bool UndoText::unpack() {
+
+	if (!spillFile_ && !compressed_) {
+		return true;
+	}
+
+	std::optional<std::string> text = str();
+	if (!text) {
+		return false;
+	}
+
+	data_ = std::move(*text);
+	release();
+	compressed_ = false;
+	return true;
+}
+
+/**
+ * @brief Compresses the text if it is large enough for that to be worthwhile,
+ * and moves it to a file if it is still large after that.
+ */
+void UndoText::pack() {
+
+	if (packed_) {
+		return;
+	}
+
+	if (!compressed_ && size_ >= CompressThreshold) {
+		std::string compressed = CompressBlock(data_);
+		if (compressed.size() < size_) {
+			data_       = std::move(compressed);
+			compressed_ = true;
+		}
+	}
+
+	data_.shrink_to_fit();
+	packed_ = true;
+	spill();
+}
+
+/**
+ * @brief Moves the text to a temporary file if it is large. If that fails,
+ * the text simply stays in memory.
+ */
+void UndoText::spill() {
+
+	if (spillFile_ || data_.size() < SpillThreshold) {
+		return;
+	}
+
+	auto file = std::make_unique<QTemporaryFile>(QDir::temp().filePath(QLatin1String("nedit-undo-XXXXXX")));
+	if (!file->open()) {
+		qWarning("NEdit: could not create undo file: %s", qPrintable(file->errorString()));
+		return;
+	}
+
+	if (file->write(data_.data(), static_cast<qint64>(data_.size())) != static_cast<qint64>(data_.size()) || !file->flush()) {
+		qWarning("NEdit: could not write to undo file %s: %s", qPrintable(file->fileName()), qPrintable(file->errorString()));
+		return;
+	}
+
+	// closed until it is needed again, so that a long history doesn't hold a descriptor for every record
+	file->close();
+
+	spillFile_  = std::move(file);
+	storedSize_ = data_.size();
+	std::string().swap(data_);
+}
+
+/**
+ * @brief Adds `text` to the end of the saved text.
+ *
+ * @param text The text to add.
+ * @return `true` on success, `false` if the saved text could not be recovered.
+ */
+bool UndoText::append(std::string_view text) {
+	if (!unpack()) {
+		return false;
+	}
+
+	data_.append(text);
+	size_   = data_.size();
+	packed_ = false;
+	return true;
+}
+
+/**
+ * @brief Adds `text` to the beginning of the saved text.
+ *
+ * @param text The text to add.
+ * @return `true` on success, `false` if the saved text could not be recovered.
+ */
+bool UndoText::prepend(std::string_view text) {
+	if (!unpack()) {
+		return false;
+	}
+
+	data_.insert(0, text);
+	size_   = data_.size();
+	packed_ = false;
+	return true;
+}
@@ -0,0 +1,55 @@
+
+#ifndef UNDO_TEXT_H_
+#define UNDO_TEXT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+class QTemporaryFile;
+
+/**
+ * @brief The text saved by an undo record. Small amounts of text are kept as
+ * they are. Larger amounts are compressed, and the largest are moved out to a
+ * temporary file of their own, so that long undo histories and huge edits
+ * don't have to be kept in memory. The file is deleted along with the record.
+ */
+class UndoText {
+public:
+	UndoText() = default;
+	explicit UndoText(std::string_view text);
+	UndoText(const UndoText &)            = delete;
+	UndoText &operator=(const UndoText &) = delete;
+	UndoText(UndoText &&other) noexcept;
+	UndoText &operator=(UndoText &&other) noexcept;
+	~UndoText();
+
+public:
+	bool empty() const noexcept;
+	size_t diskUsage() const noexcept;
+	size_t memoryUsage() const noexcept;
+	size_t size() const noexcept;
+	std::optional<std::string> str() const;
+	bool append(std::string_view text);
+	void pack();
+	bool prepend(std::string_view text);
+
+private:
+	std::optional<std::string> readSpilled() const;
+	void release() noexcept;
+	void spill();
+	bool unpack();
+
+private:
+	std::string data_;                          // the text, its compressed form, or nothing if it is in spillFile_
+	std::unique_ptr<QTemporaryFile> spillFile_; // the file holding the text, if it has been moved out of memory
+	size_t size_       = 0;                     // the length of the text
+	size_t storedSize_ = 0;                     // the length of what was written to spillFile_
+	bool compressed_   = false;                 // data_ (or spillFile_) holds the compressed form of the text
+	bool packed_       = false;                 // the text hasn't changed since it was last packed
+};
+
+#endif
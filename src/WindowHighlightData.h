@@ -2,6 +2,7 @@
 #ifndef WINDOW_HIGHLIGHT_DATA_H_
 #define WINDOW_HIGHLIGHT_DATA_H_
 
+#include "BackgroundHighlighter.h"
 #include "HighlightData.h"
 #include "ReparseContext.h"
 #include "StyleTableEntry.h"
@@ -22,6 +23,10 @@ struct WindowHighlightData {
 	std::unique_ptr<HighlightData[]> pass2Patterns;
 	PatternSet *patternSetForWindow    = nullptr;
 	ReparseContext contextRequirements = {0, 0};
+
+	// stops its thread, which matches against pass1Patterns, before the
+	// patterns are freed
+	std::unique_ptr<BackgroundHighlighter> backgroundHighlighter;
 };
 
 #endif
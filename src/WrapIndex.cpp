@@ -0,0 +1,514 @@
+
+#include "WrapIndex.h"
+#include "TextArea.h"
+#include "TextBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+/**
+ * @brief Constructor for WrapIndex.
+ *
+ * @param area The text area whose display lines are counted.
+ */
+WrapIndex::WrapIndex(const TextArea *area)
+	: area_(area) {
+}
+
+/**
+ * @brief Recomputes the subtree totals of a node from its children.
+ *
+ * @param n The node to update.
+ */
+void WrapIndex::recompute(Node *n) noexcept {
+	n->totalChars      = charsOf(n->left.get()) + n->chars + charsOf(n->right.get());
+	n->totalRows       = rowsOf(n->left.get()) + n->rows + rowsOf(n->right.get());
+	n->totalUnmeasured = unmeasuredOf(n->left.get()) + (n->measured ? 0 : 1) + unmeasuredOf(n->right.get());
+}
+
+/**
+ * @brief Generates a pseudo random priority for a new treap node.
+ *
+ * @return The new priority.
+ */
+uint32_t WrapIndex::nextPriority() noexcept {
+	seed_ ^= seed_ << 13;
+	seed_ ^= seed_ >> 17;
+	seed_ ^= seed_ << 5;
+	return seed_;
+}
+
+/**
+ * @brief Concatenates two treaps, every piece of `a` preceding every piece of `b`.
+ *
+ * @param a The left treap.
+ * @param b The right treap.
+ * @return The combined treap.
+ */
+auto WrapIndex::merge(NodePtr a, NodePtr b) -> NodePtr {
+	if (!a) {
+		return b;
+	}
+
+	if (!b) {
+		return a;
+	}
+
+	if (a->priority >= b->priority) {
+		a->right = merge(std::move(a->right), std::move(b));
+		recompute(a.get());
+		return a;
+	}
+
+	b->left = merge(std::move(a), std::move(b->left));
+	recompute(b.get());
+	return b;
+}
+
+/**
+ * @brief Splits a treap into the pieces before character position `pos` and
+ * the pieces after it. `pos` must be on a piece boundary.
+ *
+ * @param t The treap to split.
+ * @param pos The position to split at.
+ * @return The two resulting treaps.
+ */
+auto WrapIndex::split(NodePtr t, int64_t pos) -> std::pair<NodePtr, NodePtr> {
+	if (!t) {
+		return {nullptr, nullptr};
+	}
+
+	const int64_t leftChars = charsOf(t->left.get());
+
+	if (pos <= leftChars) {
+		auto [a, b] = split(std::move(t->left), pos);
+		t->left     = std::move(b);
+		recompute(t.get());
+		return {std::move(a), std::move(t)};
+	}
+
+	assert(pos >= leftChars + t->chars);
+
+	auto [a, b] = split(std::move(t->right), pos - leftChars - t->chars);
+	t->right    = std::move(a);
+	recompute(t.get());
+	return {std::move(t), std::move(b)};
+}
+
+/**
+ * @brief Counts the line breaks in the range [start, end) of the buffer, by
+ * wrapping it the way the text area displays it.
+ *
+ * @param start The start of the range, which must be the start of a line.
+ * @param end The end of the range.
+ * @return The number of line breaks in the range.
+ */
+int64_t WrapIndex::countRows(int64_t start, int64_t end) const {
+
+	if (start >= end) {
+		return 0;
+	}
+
+	TextCursor retPos;
+	TextCursor retLineStart;
+	TextCursor retLineEnd;
+	int64_t retLines;
+	area_->wrappedLineCounter(area_->buffer_, TextCursor(start), TextCursor(end), INT64_MAX, /*startPosIsLineStart=*/true, &retPos, &retLines, &retLineStart, &retLineEnd);
+	return retLines;
+}
+
+/**
+ * @brief Guesses the number of line breaks in the range [start, end) of the
+ * buffer without wrapping it, from the number of newlines in it and the
+ * number of characters which fit on a display line.
+ *
+ * @param start The start of the range.
+ * @param end The end of the range.
+ * @return The estimated number of line breaks in the range.
+ */
+int64_t WrapIndex::estimateRows(int64_t start, int64_t end) const {
+
+	const int64_t newlines = area_->buffer_->BufCountLines(TextCursor(start), TextCursor(end));
+
+	int64_t columns = area_->wrapMargin_;
+	if (columns == 0) {
+		columns = area_->viewport()->contentsRect().width() / std::max(1, area_->fixedFontWidth_);
+	}
+
+	return std::max(newlines, (end - start) / std::max<int64_t>(1, columns));
+}
+
+/**
+ * @brief Builds a treap of pieces covering the range [start, end) of the buffer.
+ *
+ * @param start The start of the range, which must be the start of a line.
+ * @param end The end of the range, which must be the start of a line or the
+ * end of the buffer.
+ * @param measure `true` to wrap the pieces, `false` to estimate them.
+ * @return The root of the new treap.
+ */
+auto WrapIndex::build(int64_t start, int64_t end, bool measure) -> NodePtr {
+
+	const TextBuffer *buffer = area_->buffer_;
+	std::vector<NodePtr> spine;
+
+	while (start < end) {
+
+		// pieces end after a newline, so that wrapping each one starts afresh
+		int64_t pieceEnd = end;
+		if (end - start > PieceSize) {
+			pieceEnd = std::min<int64_t>(end, to_integer(buffer->BufEndOfLine(TextCursor(start + PieceSize - 1))) + 1);
+		}
+
+		auto n      = std::make_unique<Node>();
+		n->chars    = pieceEnd - start;
+		n->rows     = measure ? countRows(start, pieceEnd) : estimateRows(start, pieceEnd);
+		n->measured = measure;
+		n->priority = nextPriority();
+		recompute(n.get());
+		start = pieceEnd;
+
+		// pop everything from the right spine with a lower priority, it
+		// becomes the left subtree of the new node
+		NodePtr last;
+		while (!spine.empty() && spine.back()->priority < n->priority) {
+			NodePtr top = std::move(spine.back());
+			spine.pop_back();
+			top->right = std::move(last);
+			recompute(top.get());
+			last = std::move(top);
+		}
+
+		n->left = std::move(last);
+		recompute(n.get());
+		spine.push_back(std::move(n));
+	}
+
+	// collapse the remaining right spine
+	NodePtr result;
+	while (!spine.empty()) {
+		NodePtr top = std::move(spine.back());
+		spine.pop_back();
+		top->right = std::move(result);
+		recompute(top.get());
+		result = std::move(top);
+	}
+
+	return result;
+}
+
+/**
+ * @brief Rebuilds the index from scratch, with every piece estimated.
+ */
+void WrapIndex::assign() {
+	root_ = build(0, to_integer(area_->buffer_->BufEndOfBuffer()), /*measure=*/false);
+}
+
+/**
+ * @brief Finds the piece containing position `pos`, remembering the path to
+ * it in path_.
+ *
+ * @param pos The position to look up.
+ * @param preferLeft If `pos` is on a piece boundary, `true` selects the piece
+ * ending at `pos` rather than the one starting at it.
+ * @param pieceStart Receives the position of the first character of the piece.
+ * @param rowsBefore Receives the number of line breaks before the piece.
+ * @return The piece, or nullptr if `pos` is outside of the index.
+ */
+auto WrapIndex::locate(int64_t pos, bool preferLeft, int64_t *pieceStart, int64_t *rowsBefore) -> Node * {
+
+	path_.clear();
+
+	Node *current = root_.get();
+	int64_t base  = 0;
+	int64_t rows  = 0;
+
+	while (current) {
+		path_.push_back(current);
+
+		const int64_t first = base + charsOf(current->left.get());
+		const int64_t last  = first + current->chars;
+
+		const bool before = preferLeft ? (pos <= first && current->left) : (pos < first);
+		const bool after  = preferLeft ? (pos > last) : (pos >= last && current->right);
+
+		if (before) {
+			current = current->left.get();
+		} else if (after) {
+			base = last;
+			rows += rowsOf(current->left.get()) + current->rows;
+			current = current->right.get();
+		} else {
+			*pieceStart = first;
+			*rowsBefore = rows + rowsOf(current->left.get());
+			return current;
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * @brief Finds the first piece whose line breaks are estimated, remembering
+ * the path to it in path_.
+ *
+ * @param pieceStart Receives the position of the first character of the piece.
+ * @return The piece, or nullptr if every piece has been measured.
+ */
+auto WrapIndex::firstUnmeasured(int64_t *pieceStart) -> Node * {
+
+	path_.clear();
+
+	Node *current = root_.get();
+	int64_t base  = 0;
+
+	while (current && current->totalUnmeasured != 0) {
+		path_.push_back(current);
+
+		if (unmeasuredOf(current->left.get()) != 0) {
+			current = current->left.get();
+		} else if (!current->measured) {
+			*pieceStart = base + charsOf(current->left.get());
+			return current;
+		} else {
+			base += charsOf(current->left.get()) + current->chars;
+			current = current->right.get();
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * @brief Replaces the estimated line breaks of a piece with the real ones.
+ * The piece must be the last node of path_.
+ *
+ * @param n The piece.
+ * @param pieceStart The position of the first character of the piece.
+ */
+void WrapIndex::measurePiece(Node *n, int64_t pieceStart) {
+
+	assert(!path_.empty() && path_.back() == n);
+
+	n->rows     = countRows(pieceStart, pieceStart + n->chars);
+	n->measured = true;
+
+	for (auto it = path_.rbegin(); it != path_.rend(); ++it) {
+		recompute(*it);
+	}
+}
+
+/**
+ * @brief Measures the pieces whose line breaks are still estimated, in buffer
+ * order, until they are all measured or `budget` is used up. At least one
+ * piece is measured if there are any left.
+ *
+ * @param budget How long to spend.
+ */
+void WrapIndex::measure(std::chrono::milliseconds budget) {
+
+	using Clock = std::chrono::steady_clock;
+
+	if (!root_) {
+		assign();
+	}
+
+	const Clock::time_point deadline = Clock::now() + budget;
+
+	do {
+		int64_t pieceStart;
+		Node *n = firstUnmeasured(&pieceStart);
+		if (!n) {
+			break;
+		}
+
+		measurePiece(n, pieceStart);
+	} while (Clock::now() < deadline);
+}
+
+/**
+ * @brief Gets the number of line breaks in the buffer, which is exact once
+ * the index is complete.
+ *
+ * @return The number of line breaks.
+ */
+int64_t WrapIndex::rows() {
+
+	if (!root_) {
+		assign();
+	}
+
+	return rowsOf(root_.get());
+}
+
+/**
+ * @brief Counts the line breaks before position `pos`, which is also the zero
+ * based display line containing `pos`.
+ *
+ * @param pos The position to look up.
+ * @return The number of line breaks in [0, pos).
+ */
+int64_t WrapIndex::rowOf(TextCursor pos) {
+
+	if (!root_) {
+		assign();
+		if (!root_) {
+			return 0;
+		}
+	}
+
+	const int64_t length = charsOf(root_.get());
+	const int64_t p      = std::clamp<int64_t>(to_integer(pos), 0, length);
+
+	int64_t pieceStart;
+	int64_t rowsBefore;
+	Node *n = locate(p, p == length, &pieceStart, &rowsBefore);
+	if (!n->measured) {
+		measurePiece(n, pieceStart);
+	}
+
+	return rowsBefore + countRows(pieceStart, p);
+}
+
+/**
+ * @brief Finds the start of a display line.
+ *
+ * @param row The zero based number of the display line.
+ * @return The position of the first character of the line, or the end of the
+ * buffer if there are not that many lines.
+ */
+TextCursor WrapIndex::positionOfRow(int64_t row) {
+
+	if (!root_) {
+		assign();
+	}
+
+	if (!root_ || row <= 0) {
+		return area_->buffer_->BufStartOfBuffer();
+	}
+
+	while (true) {
+		path_.clear();
+
+		Node *current     = root_.get();
+		int64_t base      = 0;
+		int64_t remaining = row;
+
+		while (true) {
+			path_.push_back(current);
+
+			const int64_t leftRows = rowsOf(current->left.get());
+
+			if (remaining < leftRows) {
+				current = current->left.get();
+			} else if (remaining - leftRows < current->rows || !current->right) {
+				break;
+			} else {
+				remaining -= leftRows + current->rows;
+				base += charsOf(current->left.get()) + current->chars;
+				current = current->right.get();
+			}
+		}
+
+		const int64_t pieceStart = base + charsOf(current->left.get());
+		const int64_t offset     = remaining - rowsOf(current->left.get());
+
+		// measuring the piece can move the line elsewhere, so look again
+		if (!current->measured) {
+			measurePiece(current, pieceStart);
+			continue;
+		}
+
+		if (offset == 0) {
+			return TextCursor(pieceStart);
+		}
+
+		TextCursor retPos;
+		TextCursor retLineStart;
+		TextCursor retLineEnd;
+		int64_t retLines;
+		area_->wrappedLineCounter(area_->buffer_, TextCursor(pieceStart), area_->buffer_->BufEndOfBuffer(), offset, /*startPosIsLineStart=*/true, &retPos, &retLines, &retLineStart, &retLineEnd);
+		return retPos;
+	}
+}
+
+/**
+ * @brief Updates the index after an edit of the buffer. An edit can only
+ * change the wrapping of the lines it touches. When they are all in one
+ * piece, that piece is adjusted by the number of display lines the text area
+ * counted when it rewrapped them. Otherwise, the pieces containing them are
+ * replaced.
+ *
+ * @param pos The position where the edit starts.
+ * @param nInserted The number of characters inserted.
+ * @param nDeleted The number of characters deleted.
+ * @param linesInserted The number of display lines in the rewrapped range after the edit.
+ * @param linesDeleted The number of display lines in the rewrapped range before the edit.
+ */
+void WrapIndex::update(TextCursor pos, int64_t nInserted, int64_t nDeleted, int64_t linesInserted, int64_t linesDeleted) {
+
+	if (!root_) {
+		assign();
+		return;
+	}
+
+	const int64_t oldLength = charsOf(root_.get());
+	const int64_t newLength = to_integer(area_->buffer_->BufEndOfBuffer());
+
+	// NOTE: if the index missed an edit somehow, it can't be patched
+	if (oldLength + nInserted - nDeleted != newLength) {
+		assign();
+		return;
+	}
+
+	const int64_t start = to_integer(pos);
+	const int64_t end   = start + nDeleted;
+
+	/* the piece which starts at the end of a deletion is replaced too, the
+	   deletion may have joined its first line to the line before it */
+	int64_t firstStart;
+	int64_t lastStart;
+	int64_t rowsBefore;
+	Node *first = locate(start, start == oldLength, &firstStart, &rowsBefore);
+	Node *last  = locate(end, end == oldLength, &lastStart, &rowsBefore);
+
+	const int64_t oldEnd = lastStart + last->chars;
+	int64_t newEnd       = oldEnd + nInserted - nDeleted;
+
+	/* if the edit stays inside one piece, it can't have joined lines across a
+	   piece boundary, so the piece only changes by what was rewrapped. path_
+	   still leads to it from the second locate() */
+	const int64_t chars = newEnd - firstStart;
+	const int64_t rows  = last->rows + linesInserted - linesDeleted;
+	if (first == last && chars >= PieceSize / 4 && chars <= MeasureLimit && rows >= 0) {
+		last->chars = chars;
+		last->rows  = rows;
+
+		for (auto it = path_.rbegin(); it != path_.rend(); ++it) {
+			recompute(*it);
+		}
+
+		return;
+	}
+
+	auto [left, rest]    = split(std::move(root_), firstStart);
+	auto [middle, right] = split(std::move(rest), oldEnd - firstStart);
+	middle.reset();
+
+	// small results absorb the following piece so that repeated edits do not fragment the index
+	if (newEnd - firstStart < PieceSize / 4 && right) {
+		const Node *first = right.get();
+		while (first->left) {
+			first = first->left.get();
+		}
+
+		const int64_t extra    = first->chars;
+		auto [next, remaining] = split(std::move(right), extra);
+		next.reset();
+		right = std::move(remaining);
+		newEnd += extra;
+	}
+
+	root_ = merge(merge(std::move(left), build(firstStart, newEnd, newEnd - firstStart <= MeasureLimit)), std::move(right));
+}
@@ -0,0 +1,105 @@
+
+#ifndef WRAP_INDEX_H_
+#define WRAP_INDEX_H_
+
+#include "TextCursor.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class TextArea;
+
+/**
+ * @brief An incrementally maintained count of the display lines of a TextArea
+ * in continuous wrap mode.
+ *
+ * The buffer is divided into consecutive pieces of whole lines, roughly
+ * PieceSize characters each, and the number of line breaks (newlines and
+ * wraps) in each piece is kept in the nodes of an implicit treap, much like
+ * the newlines of a TextBuffer are kept by its line_index. This makes both
+ * "position to display line" and "display line to position" queries O(log n)
+ * plus the wrapping of at most one piece. An edit inside a piece costs
+ * O(log n), using the display lines which the text area counts anyway when
+ * it rewraps the edited lines. An edit which spans pieces also costs the
+ * wrapping of the pieces it touched.
+ *
+ * Wrapping a piece is the expensive part, so a piece's count may be an
+ * estimate, made from its length and its number of newlines, until the piece
+ * is measured. Queries measure the piece they land in on demand, and
+ * measure() measures the rest a little at a time. Since a piece never splits
+ * a line, no piece's count depends on any other's.
+ *
+ * The index must be cleared whenever anything which affects wrapping, such as
+ * the width of the text area, its font or its wrap margin, changes, and told
+ * about every edit after it has been applied to the buffer.
+ */
+class WrapIndex {
+public:
+	static constexpr int64_t PieceSize = 16384;
+
+	// Edits which leave no more than this many characters to rewrap are
+	// measured immediately, anything larger is estimated
+	static constexpr int64_t MeasureLimit = PieceSize * 4;
+
+private:
+	struct Node {
+		std::unique_ptr<Node> left;
+		std::unique_ptr<Node> right;
+		int64_t chars           = 0; // characters in this piece
+		int64_t rows            = 0; // line breaks in this piece, possibly estimated
+		int64_t totalChars      = 0; // characters in this subtree
+		int64_t totalRows       = 0; // line breaks in this subtree
+		int64_t totalUnmeasured = 0; // pieces in this subtree whose rows are estimated
+		uint32_t priority       = 0;
+		bool measured           = false;
+	};
+
+	using NodePtr = std::unique_ptr<Node>;
+
+public:
+	explicit WrapIndex(const TextArea *area);
+	WrapIndex(const WrapIndex &)            = delete;
+	WrapIndex &operator=(const WrapIndex &) = delete;
+	~WrapIndex()                            = default;
+
+public:
+	bool complete() const noexcept { return !root_ || root_->totalUnmeasured == 0; }
+	bool empty() const noexcept { return !root_; }
+	void clear() noexcept { root_.reset(); }
+
+public:
+	int64_t rows();
+	int64_t rowOf(TextCursor pos);
+	TextCursor positionOfRow(int64_t row);
+	void measure(std::chrono::milliseconds budget);
+	void update(TextCursor pos, int64_t nInserted, int64_t nDeleted, int64_t linesInserted, int64_t linesDeleted);
+
+private:
+	static int64_t charsOf(const Node *n) noexcept { return n ? n->totalChars : 0; }
+	static int64_t rowsOf(const Node *n) noexcept { return n ? n->totalRows : 0; }
+	static int64_t unmeasuredOf(const Node *n) noexcept { return n ? n->totalUnmeasured : 0; }
+	static void recompute(Node *n) noexcept;
+	static NodePtr merge(NodePtr a, NodePtr b);
+	static std::pair<NodePtr, NodePtr> split(NodePtr t, int64_t pos);
+
+private:
+	void assign();
+	NodePtr build(int64_t start, int64_t end, bool measure);
+	Node *locate(int64_t pos, bool preferLeft, int64_t *pieceStart, int64_t *rowsBefore);
+	Node *firstUnmeasured(int64_t *pieceStart);
+	int64_t countRows(int64_t start, int64_t end) const;
+	int64_t estimateRows(int64_t start, int64_t end) const;
+	uint32_t nextPriority() noexcept;
+	void measurePiece(Node *n, int64_t pieceStart);
+
+private:
+	const TextArea *area_;
+	NodePtr root_;
+	std::vector<Node *> path_;   // the nodes visited by the last locate() or firstUnmeasured()
+	uint32_t seed_ = 0x2545f491; // state for the xorshift priority generator
+};
+
+#endif
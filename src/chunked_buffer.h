@@ -0,0 +1,952 @@
+
+#ifndef CHUNKED_BUFFER_H_
+#define CHUNKED_BUFFER_H_
+
+#include "Util/Raise.h"
+#include "chunked_buffer_fwd.h"
+#include "chunked_buffer_iterator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A text container which stores its contents as a sequence of bounded
+ * size chunks, held in the nodes of an implicit treap (a randomized balanced
+ * binary tree keyed by position).
+ *
+ * Unlike gap_buffer, no operation ever requires a single allocation the size
+ * of the whole document, and edits cost O(log n) plus O(MaxChunkSize) instead
+ * of an O(n) memmove when the edit location jumps around the document.
+ *
+ * The interface intentionally mirrors gap_buffer so that the two can be used
+ * interchangeably as the storage of a BasicTextBuffer.
+ *
+ * @note `to_view()` hands out contiguous storage. A range which lies within
+ * one chunk is viewed where it is. Any other range is viewed in a contiguous
+ * copy of the text, which is kept beside the chunks until the next edit, so
+ * the chunks themselves are never coalesced. Callers which can work a piece
+ * at a time should use `for_each_segment()` instead.
+ */
+template <class Ch, class Tr>
+class chunked_buffer {
+public:
+	static constexpr int64_t MaxChunkSize  = 64 * 1024;
+	static constexpr int64_t FillChunkSize = (MaxChunkSize / 4) * 3;
+	static constexpr int64_t MinChunkSize  = MaxChunkSize / 4;
+	using string_type                      = std::basic_string<Ch, Tr>;
+	using view_type                        = std::basic_string_view<Ch, Tr>;
+
+public:
+	using value_type             = typename std::allocator<Ch>::value_type;
+	using allocator_type         = std::allocator<Ch>;
+	using size_type              = int64_t;
+	using difference_type        = typename std::allocator<Ch>::difference_type;
+	using reference              = Ch &;
+	using const_reference        = const Ch &;
+	using pointer                = Ch *;
+	using const_pointer          = const Ch *;
+	using iterator               = chunked_buffer_iterator<Ch, Tr, false>;
+	using const_iterator         = chunked_buffer_iterator<Ch, Tr, true>;
+	using reverse_iterator       = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+	struct node {
+		string_type text;
+		std::unique_ptr<node> left;
+		std::unique_ptr<node> right;
+		size_type size    = 0; // total number of characters in this subtree
+		uint32_t priority = 0;
+	};
+
+	using node_ptr = std::unique_ptr<node>;
+
+public:
+	chunked_buffer();
+	explicit chunked_buffer(size_type reserve_size);
+	chunked_buffer(const chunked_buffer &)            = delete;
+	chunked_buffer &operator=(const chunked_buffer &) = delete;
+	chunked_buffer(chunked_buffer &&)                 = delete;
+	chunked_buffer &operator=(chunked_buffer &&)      = delete;
+	~chunked_buffer()                                 = default;
+
+public:
+	iterator begin() noexcept { return iterator(this, 0); }
+	iterator end() noexcept { return iterator(this, size()); }
+	const_iterator begin() const noexcept { return const_iterator(this, 0); }
+	const_iterator end() const noexcept { return const_iterator(this, size()); }
+	const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+	const_iterator cend() const noexcept { return const_iterator(this, size()); }
+
+	reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+	const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+	const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(end()); }
+	const_reverse_iterator crend() const noexcept { return const_reverse_iterator(begin()); }
+
+public:
+	size_type size() const noexcept { return root_ ? root_->size : 0; }
+	bool empty() const noexcept { return size() == 0; }
+	void swap(chunked_buffer &other) noexcept;
+
+public:
+	Ch operator[](size_type n) const noexcept;
+	Ch &operator[](size_type n) noexcept;
+	Ch at(size_type n) const;
+	Ch &at(size_type n);
+
+public:
+	int compare(size_type pos, view_type str) const noexcept;
+	int compare(size_type pos, Ch ch) const noexcept;
+
+public:
+	string_type to_string() const;
+	string_type to_string(size_type start, size_type end) const;
+	view_type to_view();
+	view_type to_view(size_type start, size_type end);
+
+public:
+	template <class F>
+	void for_each_segment(size_type start, size_type end, F &&func) const;
+
+public:
+	size_type erase(size_type start, size_type end);
+	void append(Ch ch);
+	void append(view_type str);
+	void assign(view_type str);
+	void clear() noexcept;
+	void insert(size_type pos, Ch ch);
+	void insert(size_type pos, view_type str);
+	void replace(size_type start, size_type end, Ch ch);
+	void replace(size_type start, size_type end, view_type str);
+
+private:
+	static size_type subtree_size(const node *n) noexcept { return n ? n->size : 0; }
+	static void update(node *n) noexcept;
+	static node_ptr merge(node_ptr a, node_ptr b);
+	static std::pair<node_ptr, node_ptr> split(node_ptr t, size_type pos);
+	static bool insert_in_place(node *n, size_type pos, view_type str);
+	static bool erase_in_place(node *n, size_type start, size_type end);
+
+	template <class F>
+	static bool visit(const node *n, size_type base, size_type start, size_type end, F &func);
+
+private:
+	node_ptr build(view_type str);
+	uint32_t next_priority() noexcept;
+	const node *find(size_type n, size_type *node_start) const noexcept;
+	void coalesce(size_type pos);
+	void join(size_type start, size_type end);
+	void invalidate_cache() noexcept { cache_node_ = nullptr; }
+	void discard_contiguous() noexcept;
+
+private:
+	node_ptr root_;
+	string_type contiguous_;             // a copy of the whole text, for views which span chunks
+	bool contiguous_valid_ = false;      // `true` if contiguous_ matches the chunks
+	uint32_t seed_         = 0x9e3779b9; // state for the xorshift priority generator
+
+	// cache of the most recently accessed chunk, so that sequential
+	// character access through operator[] or iterators is O(1) amortized
+	mutable const node *cache_node_ = nullptr;
+	mutable size_type cache_start_  = 0;
+};
+
+/**
+ * @brief Default constructor for chunked_buffer.
+ */
+template <class Ch, class Tr>
+chunked_buffer<Ch, Tr>::chunked_buffer()
+	: chunked_buffer(0) {
+}
+
+/**
+ * @brief Constructor for chunked_buffer with a specified reserve size.
+ *
+ * @param reserve_size Ignored, chunks are allocated on demand. Accepted so
+ * that this class is a drop in replacement for gap_buffer.
+ */
+template <class Ch, class Tr>
+chunked_buffer<Ch, Tr>::chunked_buffer(size_type reserve_size) {
+	(void)reserve_size;
+}
+
+/**
+ * @brief Recomputes the cached subtree size of a node from its children.
+ *
+ * @param n The node to update.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::update(node *n) noexcept {
+	n->size = subtree_size(n->left.get()) + static_cast<size_type>(n->text.size()) + subtree_size(n->right.get());
+}
+
+/**
+ * @brief Generates a pseudo random priority for a new treap node.
+ *
+ * @return The new priority.
+ */
+template <class Ch, class Tr>
+uint32_t chunked_buffer<Ch, Tr>::next_priority() noexcept {
+	seed_ ^= seed_ << 13;
+	seed_ ^= seed_ >> 17;
+	seed_ ^= seed_ << 5;
+	return seed_;
+}
+
+/**
+ * @brief Concatenates two treaps, every character of `a` preceding every
+ * character of `b`.
+ *
+ * @param a The left treap.
+ * @param b The right treap.
+ * @return The combined treap.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::merge(node_ptr a, node_ptr b) -> node_ptr {
+	if (!a) {
+		return b;
+	}
+
+	if (!b) {
+		return a;
+	}
+
+	if (a->priority >= b->priority) {
+		a->right = merge(std::move(a->right), std::move(b));
+		update(a.get());
+		return a;
+	}
+
+	b->left = merge(std::move(a), std::move(b->left));
+	update(b.get());
+	return b;
+}
+
+/**
+ * @brief Splits a treap into two, the first holding the characters [0, pos)
+ * and the second holding the rest. If `pos` falls inside of a chunk, that
+ * chunk is cut in two.
+ *
+ * @param t The treap to split.
+ * @param pos The position to split at.
+ * @return The two resulting treaps.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::split(node_ptr t, size_type pos) -> std::pair<node_ptr, node_ptr> {
+	if (!t) {
+		return {nullptr, nullptr};
+	}
+
+	const size_type left_size = subtree_size(t->left.get());
+	const auto length         = static_cast<size_type>(t->text.size());
+
+	if (pos <= left_size) {
+		auto [a, b] = split(std::move(t->left), pos);
+		t->left     = std::move(b);
+		update(t.get());
+		return {std::move(a), std::move(t)};
+	}
+
+	if (pos >= left_size + length) {
+		auto [a, b] = split(std::move(t->right), pos - left_size - length);
+		t->right    = std::move(a);
+		update(t.get());
+		return {std::move(t), std::move(b)};
+	}
+
+	// the split point is inside of this node's chunk, the tail inherits the
+	// node's priority so the heap property still holds for the right subtree
+	const auto offset = static_cast<size_t>(pos - left_size);
+
+	auto tail      = std::make_unique<node>();
+	tail->text     = t->text.substr(offset);
+	tail->priority = t->priority;
+	tail->right    = std::move(t->right);
+	t->text.erase(offset);
+
+	update(tail.get());
+	update(t.get());
+	return {std::move(t), std::move(tail)};
+}
+
+/**
+ * @brief Builds a treap holding `str`, broken up into chunks of FillChunkSize.
+ * Uses the linear time Cartesian tree construction.
+ *
+ * @param str The text to store.
+ * @return The root of the new treap.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::build(view_type str) -> node_ptr {
+
+	std::vector<node_ptr> spine;
+
+	while (!str.empty()) {
+		const size_t length = std::min(str.size(), static_cast<size_t>(FillChunkSize));
+
+		auto n      = std::make_unique<node>();
+		n->text     = string_type(str.substr(0, length));
+		n->priority = next_priority();
+		update(n.get());
+		str.remove_prefix(length);
+
+		// pop everything from the right spine with a lower priority, it
+		// becomes the left subtree of the new node
+		node_ptr last;
+		while (!spine.empty() && spine.back()->priority < n->priority) {
+			node_ptr top = std::move(spine.back());
+			spine.pop_back();
+			top->right = std::move(last);
+			update(top.get());
+			last = std::move(top);
+		}
+
+		n->left = std::move(last);
+		update(n.get());
+		spine.push_back(std::move(n));
+	}
+
+	// collapse the remaining right spine
+	node_ptr result;
+	while (!spine.empty()) {
+		node_ptr top = std::move(spine.back());
+		spine.pop_back();
+		top->right = std::move(result);
+		update(top.get());
+		result = std::move(top);
+	}
+
+	return result;
+}
+
+/**
+ * @brief Finds the chunk which contains the character at position `n`.
+ *
+ * @param n The position of the character.
+ * @param node_start Receives the position of the first character of the chunk.
+ * @return The node holding the chunk.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::find(size_type n, size_type *node_start) const noexcept -> const node * {
+
+	if (cache_node_ && n >= cache_start_ && n < cache_start_ + static_cast<size_type>(cache_node_->text.size())) {
+		*node_start = cache_start_;
+		return cache_node_;
+	}
+
+	const node *current = root_.get();
+	size_type base      = 0;
+
+	while (current) {
+		const size_type left_size = subtree_size(current->left.get());
+		const auto length         = static_cast<size_type>(current->text.size());
+
+		if (n < base + left_size) {
+			current = current->left.get();
+		} else if (n < base + left_size + length) {
+			cache_node_  = current;
+			cache_start_ = base + left_size;
+			*node_start  = cache_start_;
+			return current;
+		} else {
+			base += left_size + length;
+			current = current->right.get();
+		}
+	}
+
+	return nullptr;
+}
+
+/**
+ * @brief Returns the character at the specified index.
+ *
+ * @param n The index of the character to retrieve.
+ * @return The character at the specified index.
+ */
+template <class Ch, class Tr>
+Ch chunked_buffer<Ch, Tr>::operator[](size_type n) const noexcept {
+	size_type start;
+	const node *const chunk = find(n, &start);
+	return chunk->text[static_cast<size_t>(n - start)];
+}
+
+/**
+ * @brief Returns the character at the specified index.
+ *
+ * @param n The index of the character to retrieve.
+ * @return The character at the specified index.
+ */
+template <class Ch, class Tr>
+Ch &chunked_buffer<Ch, Tr>::operator[](size_type n) noexcept {
+
+	// the character may be written through the reference
+	discard_contiguous();
+
+	size_type start;
+	auto chunk = const_cast<node *>(find(n, &start));
+	return chunk->text[static_cast<size_t>(n - start)];
+}
+
+/**
+ * @brief Returns the character at the specified index, throwing an exception if out of range.
+ *
+ * @param n The index of the character to retrieve.
+ * @return The character at the specified index.
+ */
+template <class Ch, class Tr>
+Ch chunked_buffer<Ch, Tr>::at(size_type n) const {
+
+	if (n >= size() || n < 0) {
+		Raise<std::out_of_range>("chunked_buffer::at");
+	}
+
+	return (*this)[n];
+}
+
+/**
+ * @brief Returns the character at the specified index, throwing an exception if out of range.
+ *
+ * @param n The index of the character to retrieve.
+ * @return The character at the specified index.
+ */
+template <class Ch, class Tr>
+Ch &chunked_buffer<Ch, Tr>::at(size_type n) {
+
+	if (n >= size() || n < 0) {
+		Raise<std::out_of_range>("chunked_buffer::at");
+	}
+
+	return (*this)[n];
+}
+
+/**
+ * @brief Visits, in order, the contiguous pieces of the subtree rooted at `n`
+ * which overlap [start, end).
+ *
+ * @param n The root of the subtree.
+ * @param base The position of the first character of the subtree.
+ * @param start The start of the range to visit.
+ * @param end The end of the range to visit.
+ * @param func Called with each piece, returns `false` to stop the traversal.
+ * @return `false` if the traversal was stopped early.
+ */
+template <class Ch, class Tr>
+template <class F>
+bool chunked_buffer<Ch, Tr>::visit(const node *n, size_type base, size_type start, size_type end, F &func) {
+
+	if (!n || start >= base + n->size || end <= base) {
+		return true;
+	}
+
+	const size_type left_size = subtree_size(n->left.get());
+	const auto length         = static_cast<size_type>(n->text.size());
+
+	if (!visit(n->left.get(), base, start, end, func)) {
+		return false;
+	}
+
+	const size_type chunk_start = base + left_size;
+	const size_type first       = std::max(start, chunk_start);
+	const size_type last        = std::min(end, chunk_start + length);
+
+	if (first < last) {
+		const view_type piece(n->text.data() + (first - chunk_start), static_cast<size_t>(last - first));
+		if (!func(piece)) {
+			return false;
+		}
+	}
+
+	return visit(n->right.get(), chunk_start + length, start, end, func);
+}
+
+/**
+ * @brief Calls `func` with each contiguous piece of the range [start, end),
+ * in order. If `func` returns a bool, returning `false` stops the traversal.
+ *
+ * @param start The start of the range.
+ * @param end The end of the range.
+ * @param func The function to call for each piece.
+ */
+template <class Ch, class Tr>
+template <class F>
+void chunked_buffer<Ch, Tr>::for_each_segment(size_type start, size_type end, F &&func) const {
+
+	assert(start <= size() && start >= 0);
+	assert(end <= size() && end >= 0);
+	assert(start <= end);
+
+	auto wrapper = [&func](view_type piece) {
+		if constexpr (std::is_same_v<decltype(func(piece)), bool>) {
+			return func(piece);
+		} else {
+			func(piece);
+			return true;
+		}
+	};
+
+	visit(root_.get(), 0, start, end, wrapper);
+}
+
+/**
+ * @brief Compares a substring starting at the specified position with another string.
+ *
+ * @param pos The starting position in the buffer.
+ * @param str The string to compare with.
+ * @return An integer less than, equal to, or greater than zero if the substring is
+ * less than, equal to, or greater than the specified string.
+ */
+template <class Ch, class Tr>
+int chunked_buffer<Ch, Tr>::compare(size_type pos, view_type str) const noexcept {
+
+	auto posEnd = pos + static_cast<size_type>(str.size());
+	if (posEnd > size()) {
+		return 1;
+	}
+
+	if (pos < 0) {
+		return -1;
+	}
+
+	int result = 0;
+	for_each_segment(pos, posEnd, [&result, &str](view_type piece) {
+		result = Tr::compare(piece.data(), str.data(), piece.size());
+		str.remove_prefix(piece.size());
+		return result == 0;
+	});
+
+	return result;
+}
+
+/**
+ * @brief Compares a character at the specified position with another character.
+ *
+ * @param pos The position in the buffer to compare.
+ * @param ch The character to compare with.
+ * @return An integer less than, equal to, or greater than zero if the character at
+ * the specified position is less than, equal to, or greater than the specified character.
+ */
+template <class Ch, class Tr>
+int chunked_buffer<Ch, Tr>::compare(size_type pos, Ch ch) const noexcept {
+	if (pos >= size()) {
+		return 1;
+	}
+
+	if (pos < 0) {
+		return -1;
+	}
+
+	const Ch buffer_char = (*this)[pos];
+	return Tr::compare(&buffer_char, &ch, 1);
+}
+
+/**
+ * @brief Converts the contents of the buffer to a string.
+ *
+ * @return A string containing the contents of the buffer.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::to_string() const -> string_type {
+	return to_string(0, size());
+}
+
+/**
+ * @brief Converts a range of the buffer to a string.
+ *
+ * @param start The starting position of the range.
+ * @param end The ending position of the range.
+ * @return A string containing the specified range of the buffer.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::to_string(size_type start, size_type end) const -> string_type {
+	string_type text;
+	text.reserve(static_cast<size_t>(end - start));
+	for_each_segment(start, end, [&text](view_type piece) {
+		text.append(piece);
+	});
+	return text;
+}
+
+/**
+ * @brief Converts the contents of the buffer to a string view.
+ *
+ * @return A string view containing the contents of the buffer.
+ *
+ * @note Unless the buffer is a single chunk, this views a copy of the text,
+ * which is kept until the buffer is next modified.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::to_view() -> view_type {
+	return to_view(0, size());
+}
+
+/**
+ * @brief Converts a substring of the buffer to a string view.
+ *
+ * @param start The starting position of the range.
+ * @param end The ending position of the range.
+ *
+ * @return A string view containing the the substring of the buffer.
+ *
+ * @note If the range does not lie within a single chunk, this views a copy of
+ * the whole text, which is kept until the buffer is next modified. The chunks
+ * are left as they are.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::to_view(size_type start, size_type end) -> view_type {
+
+	assert(start <= size() && start >= 0);
+	assert(end <= size() && end >= 0);
+	assert(start <= end);
+
+	if (start == end) {
+		return view_type();
+	}
+
+	size_type chunk_start;
+	const node *chunk = find(start, &chunk_start);
+	if (end <= chunk_start + static_cast<size_type>(chunk->text.size())) {
+		return view_type(chunk->text.data() + (start - chunk_start), static_cast<size_t>(end - start));
+	}
+
+	if (!contiguous_valid_) {
+		contiguous_       = to_string();
+		contiguous_valid_ = true;
+	}
+
+	return view_type(contiguous_.data() + start, static_cast<size_t>(end - start));
+}
+
+/**
+ * @brief Releases the contiguous copy of the text made by to_view(), which no
+ * longer matches the chunks once they are modified.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::discard_contiguous() noexcept {
+	if (contiguous_valid_ || !contiguous_.empty()) {
+		contiguous_       = string_type();
+		contiguous_valid_ = false;
+	}
+}
+
+/**
+ * @brief Replaces the chunks which cover exactly [start, end) with a single
+ * chunk holding the same text.
+ *
+ * @param start The position of the first character of the first chunk.
+ * @param end The position after the last character of the last chunk.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::join(size_type start, size_type end) {
+
+	auto [left, rest]    = split(std::move(root_), start);
+	auto [middle, right] = split(std::move(rest), end - start);
+
+	auto n = std::make_unique<node>();
+	n->text.reserve(static_cast<size_t>(end - start));
+
+	auto append = [&n](view_type piece) {
+		n->text.append(piece);
+		return true;
+	};
+
+	visit(middle.get(), 0, 0, end - start, append);
+	n->priority = next_priority();
+	update(n.get());
+
+	root_ = merge(merge(std::move(left), std::move(n)), std::move(right));
+	invalidate_cache();
+}
+
+/**
+ * @brief Joins the chunk containing `pos` with a neighbour if it has become
+ * small, so that repeated edits can't leave the buffer made of many tiny
+ * chunks.
+ *
+ * @param pos A position within the chunk. Positions outside of the buffer are
+ * ignored.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::coalesce(size_type pos) {
+
+	if (pos < 0 || pos >= size()) {
+		return;
+	}
+
+	size_type start;
+	const node *chunk   = find(pos, &start);
+	const auto length   = static_cast<size_type>(chunk->text.size());
+	const size_type end = start + length;
+	if (length >= MinChunkSize) {
+		return;
+	}
+
+	if (end < size()) {
+		size_type next_start;
+		const node *next = find(end, &next_start);
+		if (length + static_cast<size_type>(next->text.size()) <= MaxChunkSize) {
+			join(start, end + static_cast<size_type>(next->text.size()));
+			return;
+		}
+	}
+
+	if (start > 0) {
+		size_type prev_start;
+		const node *prev = find(start - 1, &prev_start);
+		if (static_cast<size_type>(prev->text.size()) + length <= MaxChunkSize) {
+			join(prev_start, end);
+		}
+	}
+}
+
+/**
+ * @brief Appends a string to the end of the buffer.
+ *
+ * @param str The string to append.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::append(view_type str) {
+	insert(size(), str);
+}
+
+/**
+ * @brief Appends a character to the end of the buffer.
+ *
+ * @param ch The character to append.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::append(Ch ch) {
+	insert(size(), ch);
+}
+
+/**
+ * @brief Attempts to insert a string directly into the chunk containing
+ * `pos`, without changing the shape of the tree.
+ *
+ * @param n The root of the subtree to insert into.
+ * @param pos The position, relative to the subtree, to insert at.
+ * @param str The string to insert.
+ * @return `true` if the chunk had room and the string was inserted.
+ */
+template <class Ch, class Tr>
+bool chunked_buffer<Ch, Tr>::insert_in_place(node *n, size_type pos, view_type str) {
+
+	if (!n) {
+		return false;
+	}
+
+	const size_type left_size = subtree_size(n->left.get());
+	const auto length         = static_cast<size_type>(n->text.size());
+
+	bool inserted;
+
+	// NOTE: positions on a chunk boundary prefer the chunk to their
+	// left, so that typing at the end of a chunk keeps extending it
+	if (n->left && pos <= left_size) {
+		inserted = insert_in_place(n->left.get(), pos, str);
+	} else if (pos <= left_size + length) {
+		inserted = length + static_cast<size_type>(str.size()) <= MaxChunkSize;
+		if (inserted) {
+			n->text.insert(static_cast<size_t>(pos - left_size), str);
+		}
+	} else {
+		inserted = insert_in_place(n->right.get(), pos - left_size - length, str);
+	}
+
+	if (inserted) {
+		n->size += static_cast<size_type>(str.size());
+	}
+
+	return inserted;
+}
+
+/**
+ * @brief Inserts a string at the specified position in the buffer.
+ *
+ * @param pos The position at which to insert the string.
+ * @param str The string to insert.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::insert(size_type pos, view_type str) {
+
+	assert(pos <= size() && pos >= 0);
+
+	if (str.empty()) {
+		return;
+	}
+
+	discard_contiguous();
+	invalidate_cache();
+
+	if (insert_in_place(root_.get(), pos, str)) {
+		return;
+	}
+
+	const auto length  = static_cast<size_type>(str.size());
+	auto [left, right] = split(std::move(root_), pos);
+	root_              = merge(merge(std::move(left), build(str)), std::move(right));
+
+	// splitting a chunk, and the end of the new text, can leave small chunks at either seam
+	coalesce(pos - 1);
+	coalesce(pos + length - 1);
+	coalesce(pos + length);
+}
+
+/**
+ * @brief Inserts a character at the specified position in the buffer.
+ *
+ * @param pos The position at which to insert the character.
+ * @param ch The character to insert.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::insert(size_type pos, Ch ch) {
+	insert(pos, view_type(&ch, 1));
+}
+
+/**
+ * @brief Attempts to erase a range which lies entirely within one chunk
+ * directly from that chunk, without changing the shape of the tree. Chunks
+ * are never allowed to become empty this way.
+ *
+ * @param n The root of the subtree to erase from.
+ * @param start The start of the range, relative to the subtree.
+ * @param end The end of the range, relative to the subtree.
+ * @return `true` if the range was erased.
+ */
+template <class Ch, class Tr>
+bool chunked_buffer<Ch, Tr>::erase_in_place(node *n, size_type start, size_type end) {
+
+	if (!n) {
+		return false;
+	}
+
+	const size_type left_size = subtree_size(n->left.get());
+	const auto length         = static_cast<size_type>(n->text.size());
+
+	bool erased;
+
+	if (end <= left_size) {
+		erased = erase_in_place(n->left.get(), start, end);
+	} else if (start >= left_size + length) {
+		erased = erase_in_place(n->right.get(), start - left_size - length, end - left_size - length);
+	} else {
+		erased = start >= left_size && end <= left_size + length && (end - start) < length;
+		if (erased) {
+			n->text.erase(static_cast<size_t>(start - left_size), static_cast<size_t>(end - start));
+		}
+	}
+
+	if (erased) {
+		n->size -= (end - start);
+	}
+
+	return erased;
+}
+
+/**
+ * @brief Erases a range of characters from the buffer.
+ *
+ * @param start The starting position of the range to erase.
+ * @param end The ending position of the range to erase.
+ * @return The position of the first character after the erased range.
+ */
+template <class Ch, class Tr>
+auto chunked_buffer<Ch, Tr>::erase(size_type start, size_type end) -> size_type {
+
+	assert(start <= size() && start >= 0);
+	assert(end <= size() && end >= 0);
+	assert(start <= end);
+
+	if (start == end) {
+		return start;
+	}
+
+	discard_contiguous();
+	invalidate_cache();
+
+	if (!erase_in_place(root_.get(), start, end)) {
+		auto [left, rest]    = split(std::move(root_), start);
+		auto [middle, right] = split(std::move(rest), end - start);
+		(void)middle;
+
+		root_ = merge(std::move(left), std::move(right));
+	}
+
+	// what remains of the chunks on either side of the deleted range may be small
+	coalesce(start - 1);
+	coalesce(start);
+	return start;
+}
+
+/**
+ * @brief Replaces a range of characters in the buffer with a string.
+ *
+ * @param start The starting position of the range to replace.
+ * @param end The ending position of the range to replace.
+ * @param str The string to insert in place of the erased range.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::replace(size_type start, size_type end, view_type str) {
+	insert(erase(start, end), str);
+}
+
+/**
+ * @brief Replaces a range of characters in the buffer with a character.
+ *
+ * @param start The starting position of the range to replace.
+ * @param end The ending position of the range to replace.
+ * @param ch The character to insert in place of the erased range.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::replace(size_type start, size_type end, Ch ch) {
+	insert(erase(start, end), ch);
+}
+
+/**
+ * @brief Assigns a string to the buffer, replacing its current contents.
+ *
+ * @param str The string to assign to the buffer.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::assign(view_type str) {
+	clear();
+	root_ = build(str);
+}
+
+/**
+ * @brief Clears the buffer, removing all its contents.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::clear() noexcept {
+	root_.reset();
+	discard_contiguous();
+	invalidate_cache();
+}
+
+/**
+ * @brief Swaps the contents of this buffer with another buffer.
+ *
+ * @param other The other buffer to swap with.
+ */
+template <class Ch, class Tr>
+void chunked_buffer<Ch, Tr>::swap(chunked_buffer &other) noexcept {
+	using std::swap;
+
+	swap(root_, other.root_);
+	swap(contiguous_, other.contiguous_);
+	swap(contiguous_valid_, other.contiguous_valid_);
+	swap(seed_, other.seed_);
+	invalidate_cache();
+	other.invalidate_cache();
+}
+
+#endif
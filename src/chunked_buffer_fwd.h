@@ -0,0 +1,10 @@
+
+#ifndef CHUNKED_BUFFER_FWD_H_
+#define CHUNKED_BUFFER_FWD_H_
+
+#include <string>
+
+template <class Ch = char, class Tr = std::char_traits<Ch>>
+class chunked_buffer;
+
+#endif
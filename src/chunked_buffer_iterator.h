@@ -0,0 +1,146 @@
+
+#ifndef CHUNKED_BUFFER_ITERATOR_H_
+#define CHUNKED_BUFFER_ITERATOR_H_
+
+#include "chunked_buffer_fwd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+
+template <class Ch, class Tr, bool IsConst>
+class chunked_buffer_iterator {
+	using buffer_type = typename std::conditional<IsConst, const chunked_buffer<Ch, Tr>, chunked_buffer<Ch, Tr>>::type;
+	using size_type   = typename buffer_type::size_type;
+
+	template <class CharT, class Traits, bool Const>
+	friend class chunked_buffer_iterator;
+
+public:
+	using difference_type   = std::ptrdiff_t;
+	using iterator_category = std::random_access_iterator_tag;
+	using pointer           = typename std::conditional<IsConst, const Ch *, Ch *>::type;
+	using reference         = typename std::conditional<IsConst, const Ch &, Ch &>::type;
+	using value_type        = Ch;
+
+public:
+	chunked_buffer_iterator() = default;
+	chunked_buffer_iterator(buffer_type *buf, size_type pos)
+		: buf_(buf), pos_(pos) {}
+
+public:
+	// for construction of a const-iterator from a non-const iterator
+	// These only exist for the const version
+	template <bool Const = IsConst, class = typename std::enable_if<Const>::type>
+	chunked_buffer_iterator(const chunked_buffer_iterator<Ch, Tr, false> &other)
+		: buf_(other.buf_), pos_(other.pos_) {}
+
+	template <bool Const = IsConst, class = typename std::enable_if<Const>::type>
+	chunked_buffer_iterator &operator=(const chunked_buffer_iterator<Ch, Tr, false> &rhs) {
+		chunked_buffer_iterator(rhs).swap(*this);
+		return *this;
+	}
+
+public:
+	chunked_buffer_iterator(const chunked_buffer_iterator &rhs)         = default;
+	chunked_buffer_iterator &operator=(const chunked_buffer_iterator &) = default;
+
+public:
+	chunked_buffer_iterator &operator+=(difference_type rhs) {
+		pos_ += rhs;
+		return *this;
+	}
+	chunked_buffer_iterator &operator-=(difference_type rhs) {
+		pos_ -= rhs;
+		return *this;
+	}
+
+public:
+	chunked_buffer_iterator &operator++() {
+		++pos_;
+		return *this;
+	}
+	chunked_buffer_iterator &operator--() {
+		--pos_;
+		return *this;
+	}
+	chunked_buffer_iterator operator++(int) {
+		chunked_buffer_iterator tmp(*this);
+		++pos_;
+		return tmp;
+	}
+	chunked_buffer_iterator operator--(int) {
+		chunked_buffer_iterator tmp(*this);
+		--pos_;
+		return tmp;
+	}
+
+public:
+	chunked_buffer_iterator operator+(difference_type rhs) const { return chunked_buffer_iterator(buf_, pos_ + rhs); }
+	chunked_buffer_iterator operator-(difference_type rhs) const { return chunked_buffer_iterator(buf_, pos_ - rhs); }
+
+public:
+	difference_type operator-(const chunked_buffer_iterator &rhs) const {
+		assert(buf_ == rhs.buf_);
+		return pos_ - rhs.pos_;
+	}
+	friend chunked_buffer_iterator operator+(difference_type lhs, const chunked_buffer_iterator &rhs) { return chunked_buffer_iterator(rhs.buf_, lhs + rhs.pos_); }
+	friend chunked_buffer_iterator operator-(difference_type lhs, const chunked_buffer_iterator &rhs) { return chunked_buffer_iterator(rhs.buf_, lhs - rhs.pos_); }
+
+public:
+	reference operator*() const { return (*buf_)[pos_]; }
+	reference operator[](difference_type offset) const { return (*buf_)[pos_ + offset]; }
+	pointer operator->() const { return &((*buf_)[pos_]); }
+
+public:
+	void swap(chunked_buffer_iterator &other) {
+		using std::swap;
+		swap(pos_, other.pos_);
+		swap(buf_, other.buf_);
+	}
+
+public:
+	// templated to allow comparison between const/non-const iterators
+	template <class CharT, class Traits, bool Const>
+	bool operator==(const chunked_buffer_iterator<CharT, Traits, Const> &rhs) const {
+		assert(buf_ == rhs.buf_);
+		return pos_ == rhs.pos_;
+	}
+
+	template <class CharT, class Traits, bool Const>
+	bool operator!=(const chunked_buffer_iterator<CharT, Traits, Const> &rhs) const {
+		assert(buf_ == rhs.buf_);
+		return pos_ != rhs.pos_;
+	}
+
+	template <class CharT, class Traits, bool Const>
+	bool operator>(const chunked_buffer_iterator<CharT, Traits, Const> &rhs) const {
+		assert(buf_ == rhs.buf_);
+		return pos_ > rhs.pos_;
+	}
+
+	template <class CharT, class Traits, bool Const>
+	bool operator<(const chunked_buffer_iterator<CharT, Traits, Const> &rhs) const {
+		assert(buf_ == rhs.buf_);
+		return pos_ < rhs.pos_;
+	}
+
+	template <class CharT, class Traits, bool Const>
+	bool operator>=(const chunked_buffer_iterator<CharT, Traits, Const> &rhs) const {
+		assert(buf_ == rhs.buf_);
+		return pos_ >= rhs.pos_;
+	}
+
+	template <class CharT, class Traits, bool Const>
+	bool operator<=(const chunked_buffer_iterator<CharT, Traits, Const> &rhs) const {
+		assert(buf_ == rhs.buf_);
+		return pos_ <= rhs.pos_;
+	}
+
+private:
+	buffer_type *buf_ = nullptr;
+	size_type pos_    = 0;
+};
+
+#endif
@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
 
 template <class Ch, class Tr>
 class gap_buffer {
@@ -81,6 +82,10 @@ public:
 	view_type to_view() noexcept;
 	view_type to_view(size_type start, size_type end) noexcept;
 
+public:
+	template <class F>
+	void for_each_segment(size_type start, size_type end, F &&func) const;
+
 public:
 	size_type erase(size_type start, size_type end) noexcept;
 	void append(Ch ch);
@@ -372,6 +377,46 @@ auto gap_buffer<Ch, Tr>::to_view(size_type start, size_type end) noexcept -> vie
 	return view_type(text + start, static_cast<size_t>(end - start));
 }
 
+/**
+ * @brief Calls `func` with each contiguous piece of the range [start, end),
+ * in order, without moving the gap. There are at most two pieces, one on
+ * each side of the gap. If `func` returns a bool, returning `false` stops
+ * the traversal.
+ *
+ * @param start The start of the range.
+ * @param end The end of the range.
+ * @param func The function to call for each piece.
+ */
+template <class Ch, class Tr>
+template <class F>
+void gap_buffer<Ch, Tr>::for_each_segment(size_type start, size_type end, F &&func) const {
+
+	assert(start <= size() && start >= 0);
+	assert(end <= size() && end >= 0);
+	assert(start <= end);
+
+	auto call = [&func](view_type piece) {
+		if constexpr (std::is_same_v<decltype(func(piece)), bool>) {
+			return func(piece);
+		} else {
+			func(piece);
+			return true;
+		}
+	};
+
+	if (start < gap_start_) {
+		const size_type last = std::min(end, gap_start_);
+		if (!call(view_type(&buf_[start], static_cast<size_t>(last - start)))) {
+			return;
+		}
+	}
+
+	if (end > gap_start_) {
+		const size_type first = std::max(start, gap_start_);
+		call(view_type(&buf_[first + gap_size()], static_cast<size_t>(end - first)));
+	}
+}
+
 /**
  * @brief Appends a string to the end of the gap buffer.
  *
@@ -0,0 +1,463 @@
+
+#ifndef LINE_INDEX_H_
+#define LINE_INDEX_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief An incrementally maintained index of the newlines in a text storage
+ * (such as a gap_buffer or a chunked_buffer).
+ *
+ * The text is divided into consecutive pieces of roughly PieceSize
+ * characters, and the number of characters and newlines in each piece is
+ * kept in the nodes of an implicit treap. This makes both "offset to line
+ * number" and "line number to offset" queries O(log n) plus a scan of at
+ * most one piece, and each edit costs O(log n) plus a rescan of the pieces
+ * that it touched.
+ *
+ * The index does not hold a reference to the text, the storage is passed in
+ * to every operation that needs to look at characters. Edits must be reported
+ * after they have been applied to the storage.
+ */
+template <class Storage>
+class line_index {
+public:
+	using size_type = int64_t;
+	using view_type = typename Storage::view_type;
+	using char_type = typename view_type::value_type;
+
+public:
+	static constexpr size_type PieceSize    = 4096;
+	static constexpr size_type MinPieceSize = PieceSize / 4;
+
+private:
+	struct node {
+		std::unique_ptr<node> left;
+		std::unique_ptr<node> right;
+		size_type chars          = 0; // characters in this piece
+		size_type newlines       = 0; // newlines in this piece
+		size_type total_chars    = 0; // characters in this subtree
+		size_type total_newlines = 0; // newlines in this subtree
+		uint32_t priority        = 0;
+	};
+
+	using node_ptr = std::unique_ptr<node>;
+
+public:
+	line_index()                              = default;
+	line_index(const line_index &)            = delete;
+	line_index &operator=(const line_index &) = delete;
+	line_index(line_index &&)                 = default;
+	line_index &operator=(line_index &&)      = default;
+	~line_index()                             = default;
+
+public:
+	bool empty() const noexcept { return !root_; }
+	size_type newlines() const noexcept { return root_ ? root_->total_newlines : 0; }
+	void clear() noexcept { root_.reset(); }
+
+public:
+	void assign(const Storage &text);
+	void insert(const Storage &text, size_type pos, size_type length);
+	void erase(const Storage &text, size_type start, size_type end);
+
+public:
+	size_type newlines_before(const Storage &text, size_type pos) const;
+	std::optional<size_type> position_after_newline(const Storage &text, size_type n) const;
+
+private:
+	static size_type chars_of(const node *n) noexcept { return n ? n->total_chars : 0; }
+	static size_type newlines_of(const node *n) noexcept { return n ? n->total_newlines : 0; }
+	static void update(node *n) noexcept;
+	static node_ptr merge(node_ptr a, node_ptr b);
+	static std::pair<node_ptr, node_ptr> split(node_ptr t, size_type pos);
+	static size_type count_newlines(const Storage &text, size_type start, size_type end);
+
+private:
+	node_ptr build(const Storage &text, size_type start, size_type end);
+	uint32_t next_priority() noexcept;
+	void locate(size_type pos, bool prefer_left, size_type *piece_start, size_type *piece_end) const noexcept;
+	void rescan(const Storage &text, size_type start, size_type old_end, size_type new_end);
+
+private:
+	node_ptr root_;
+	uint32_t seed_ = 0x2545f491; // state for the xorshift priority generator
+};
+
+/**
+ * @brief Recomputes the subtree totals of a node from its children.
+ *
+ * @param n The node to update.
+ */
+template <class Storage>
+void line_index<Storage>::update(node *n) noexcept {
+	n->total_chars    = chars_of(n->left.get()) + n->chars + chars_of(n->right.get());
+	n->total_newlines = newlines_of(n->left.get()) + n->newlines + newlines_of(n->right.get());
+}
+
+/**
+ * @brief Generates a pseudo random priority for a new treap node.
+ *
+ * @return The new priority.
+ */
+template <class Storage>
+uint32_t line_index<Storage>::next_priority() noexcept {
+	seed_ ^= seed_ << 13;
+	seed_ ^= seed_ >> 17;
+	seed_ ^= seed_ << 5;
+	return seed_;
+}
+
+/**
+ * @brief Concatenates two treaps, every piece of `a` preceding every piece of `b`.
+ *
+ * @param a The left treap.
+ * @param b The right treap.
+ * @return The combined treap.
+ */
+template <class Storage>
+auto line_index<Storage>::merge(node_ptr a, node_ptr b) -> node_ptr {
+	if (!a) {
+		return b;
+	}
+
+	if (!b) {
+		return a;
+	}
+
+	if (a->priority >= b->priority) {
+		a->right = merge(std::move(a->right), std::move(b));
+		update(a.get());
+		return a;
+	}
+
+	b->left = merge(std::move(a), std::move(b->left));
+	update(b.get());
+	return b;
+}
+
+/**
+ * @brief Splits a treap into the pieces before character position `pos` and
+ * the pieces after it. `pos` must be on a piece boundary.
+ *
+ * @param t The treap to split.
+ * @param pos The position to split at.
+ * @return The two resulting treaps.
+ */
+template <class Storage>
+auto line_index<Storage>::split(node_ptr t, size_type pos) -> std::pair<node_ptr, node_ptr> {
+	if (!t) {
+		return {nullptr, nullptr};
+	}
+
+	const size_type left_chars = chars_of(t->left.get());
+
+	if (pos <= left_chars) {
+		auto [a, b] = split(std::move(t->left), pos);
+		t->left     = std::move(b);
+		update(t.get());
+		return {std::move(a), std::move(t)};
+	}
+
+	assert(pos >= left_chars + t->chars);
+
+	auto [a, b] = split(std::move(t->right), pos - left_chars - t->chars);
+	t->right    = std::move(a);
+	update(t.get());
+	return {std::move(t), std::move(b)};
+}
+
+/**
+ * @brief Counts the newlines in the range [start, end) of `text`.
+ *
+ * @param text The text to scan.
+ * @param start The start of the range.
+ * @param end The end of the range.
+ * @return The number of newlines in the range.
+ */
+template <class Storage>
+auto line_index<Storage>::count_newlines(const Storage &text, size_type start, size_type end) -> size_type {
+	size_type count = 0;
+	text.for_each_segment(start, end, [&count](view_type piece) {
+		count += std::count(piece.begin(), piece.end(), char_type('\n'));
+	});
+	return count;
+}
+
+/**
+ * @brief Builds a treap of pieces covering the range [start, end) of `text`.
+ *
+ * @param text The text to scan.
+ * @param start The start of the range.
+ * @param end The end of the range.
+ * @return The root of the new treap.
+ */
+template <class Storage>
+auto line_index<Storage>::build(const Storage &text, size_type start, size_type end) -> node_ptr {
+
+	std::vector<node_ptr> spine;
+
+	while (start < end) {
+		const size_type length = std::min(end - start, PieceSize);
+
+		auto n      = std::make_unique<node>();
+		n->chars    = length;
+		n->newlines = count_newlines(text, start, start + length);
+		n->priority = next_priority();
+		update(n.get());
+		start += length;
+
+		// pop everything from the right spine with a lower priority, it
+		// becomes the left subtree of the new node
+		node_ptr last;
+		while (!spine.empty() && spine.back()->priority < n->priority) {
+			node_ptr top = std::move(spine.back());
+			spine.pop_back();
+			top->right = std::move(last);
+			update(top.get());
+			last = std::move(top);
+		}
+
+		n->left = std::move(last);
+		update(n.get());
+		spine.push_back(std::move(n));
+	}
+
+	// collapse the remaining right spine
+	node_ptr result;
+	while (!spine.empty()) {
+		node_ptr top = std::move(spine.back());
+		spine.pop_back();
+		top->right = std::move(result);
+		update(top.get());
+		result = std::move(top);
+	}
+
+	return result;
+}
+
+/**
+ * @brief Finds the piece containing position `pos`.
+ *
+ * @param pos The position to look up.
+ * @param prefer_left If `pos` is on a piece boundary, `true` selects the piece
+ * ending at `pos` rather than the one starting at it.
+ * @param piece_start Receives the position of the first character of the piece.
+ * @param piece_end Receives the position one past the last character of the piece.
+ */
+template <class Storage>
+void line_index<Storage>::locate(size_type pos, bool prefer_left, size_type *piece_start, size_type *piece_end) const noexcept {
+
+	const node *current = root_.get();
+	size_type base      = 0;
+
+	while (current) {
+		const size_type left_chars = chars_of(current->left.get());
+		const size_type first      = base + left_chars;
+		const size_type last       = first + current->chars;
+
+		const bool before = prefer_left ? (pos <= first && current->left) : (pos < first);
+		const bool after  = prefer_left ? (pos > last) : (pos >= last && current->right);
+
+		if (before) {
+			current = current->left.get();
+		} else if (after) {
+			base    = last;
+			current = current->right.get();
+		} else {
+			*piece_start = first;
+			*piece_end   = last;
+			return;
+		}
+	}
+
+	*piece_start = 0;
+	*piece_end   = 0;
+}
+
+/**
+ * @brief Replaces the pieces covering [start, old_end) with freshly scanned
+ * pieces covering [start, new_end). Small results absorb the following piece
+ * so that repeated edits do not fragment the index.
+ *
+ * @param text The text, with the edit already applied.
+ * @param start The start of the affected pieces, on a piece boundary.
+ * @param old_end The end of the affected pieces before the edit, on a piece boundary.
+ * @param new_end The end of the affected range after the edit.
+ */
+template <class Storage>
+void line_index<Storage>::rescan(const Storage &text, size_type start, size_type old_end, size_type new_end) {
+
+	auto [left, rest]    = split(std::move(root_), start);
+	auto [middle, right] = split(std::move(rest), old_end - start);
+	middle.reset();
+
+	if (new_end - start < MinPieceSize && right) {
+		const node *first = right.get();
+		while (first->left) {
+			first = first->left.get();
+		}
+
+		const size_type extra = first->chars;
+		auto [next, remaining] = split(std::move(right), extra);
+		next.reset();
+		right = std::move(remaining);
+		new_end += extra;
+	}
+
+	root_ = merge(merge(std::move(left), build(text, start, new_end)), std::move(right));
+}
+
+/**
+ * @brief Rebuilds the index from scratch.
+ *
+ * @param text The text to index.
+ */
+template <class Storage>
+void line_index<Storage>::assign(const Storage &text) {
+	root_ = build(text, 0, text.size());
+}
+
+/**
+ * @brief Updates the index after `length` characters were inserted at `pos`.
+ *
+ * @param text The text, with the insertion already applied.
+ * @param pos The position of the insertion.
+ * @param length The number of characters inserted.
+ */
+template <class Storage>
+void line_index<Storage>::insert(const Storage &text, size_type pos, size_type length) {
+
+	if (length == 0) {
+		return;
+	}
+
+	if (!root_) {
+		assign(text);
+		return;
+	}
+
+	size_type piece_start;
+	size_type piece_end;
+	locate(pos, true, &piece_start, &piece_end);
+	rescan(text, piece_start, piece_end, piece_end + length);
+}
+
+/**
+ * @brief Updates the index after the characters [start, end) were erased.
+ *
+ * @param text The text, with the erasure already applied.
+ * @param start The start of the erased range.
+ * @param end The end of the erased range, before the erasure.
+ */
+template <class Storage>
+void line_index<Storage>::erase(const Storage &text, size_type start, size_type end) {
+
+	if (start == end || !root_) {
+		return;
+	}
+
+	size_type first_start;
+	size_type first_end;
+	size_type last_start;
+	size_type last_end;
+	locate(start, false, &first_start, &first_end);
+	locate(end, true, &last_start, &last_end);
+	rescan(text, first_start, last_end, last_end - (end - start));
+}
+
+/**
+ * @brief Counts the newlines before position `pos`, which is also the zero
+ * based line number of the line containing `pos`.
+ *
+ * @param text The indexed text.
+ * @param pos The position to look up.
+ * @return The number of newlines in [0, pos).
+ */
+template <class Storage>
+auto line_index<Storage>::newlines_before(const Storage &text, size_type pos) const -> size_type {
+
+	const node *current = root_.get();
+	size_type base      = 0;
+	size_type count     = 0;
+
+	while (current) {
+		const size_type left_chars = chars_of(current->left.get());
+
+		if (pos < base + left_chars) {
+			current = current->left.get();
+		} else if (pos < base + left_chars + current->chars) {
+			count += newlines_of(current->left.get());
+			return count + count_newlines(text, base + left_chars, pos);
+		} else {
+			count += newlines_of(current->left.get()) + current->newlines;
+			base += left_chars + current->chars;
+			current = current->right.get();
+		}
+	}
+
+	return count;
+}
+
+/**
+ * @brief Finds the position immediately following the `n`th newline of the
+ * text, which is also the start of the zero based line `n`.
+ *
+ * @param text The indexed text.
+ * @param n The one based number of the newline to find.
+ * @return The position after the newline, or an empty optional if the text
+ * has fewer than `n` newlines.
+ */
+template <class Storage>
+auto line_index<Storage>::position_after_newline(const Storage &text, size_type n) const -> std::optional<size_type> {
+
+	if (n < 1 || n > newlines()) {
+		return {};
+	}
+
+	const node *current = root_.get();
+	size_type base      = 0;
+	size_type before    = 0;
+
+	while (current) {
+		const size_type left_newlines = newlines_of(current->left.get());
+
+		if (n <= before + left_newlines) {
+			current = current->left.get();
+		} else if (n <= before + left_newlines + current->newlines) {
+			break;
+		} else {
+			before += left_newlines + current->newlines;
+			base += chars_of(current->left.get()) + current->chars;
+			current = current->right.get();
+		}
+	}
+
+	assert(current);
+
+	const size_type piece_start = base + chars_of(current->left.get());
+	size_type remaining         = n - before - newlines_of(current->left.get());
+	size_type result            = piece_start;
+
+	text.for_each_segment(piece_start, piece_start + current->chars, [&remaining, &result](view_type piece) {
+		for (size_t i = 0; i < piece.size(); ++i) {
+			if (piece[i] == char_type('\n') && --remaining == 0) {
+				result += static_cast<size_type>(i) + 1;
+				return false;
+			}
+		}
+
+		result += static_cast<size_type>(piece.size());
+		return true;
+	});
+
+	return result;
+}
+
+#endif